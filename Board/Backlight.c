@@ -0,0 +1,266 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		LCD backlight dimming.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+#define BACKLIGHT_PIN			6			//PB6
+#define LIGHT_SENSOR_PIN		7			//PC7, INT4
+
+//Reasons for the backlight to be below the set level
+#define BACKLIGHT_FLAG_OFF		0x01		//Turned off with the 'bkl' command
+#define BACKLIGHT_FLAG_IDLE		0x02		//Menu has timed out
+#define BACKLIGHT_FLAG_DARK		0x04		//Light sensor reports a dark room
+
+//Duty cycle (out of HARDWARE_TIMER_0_TOP_VALUE+1) for each level, gamma = 2.2
+static const uint8_t BacklightGamma[BACKLIGHT_MAX_LEVEL+1] PROGMEM =
+{
+	0,   1,   1,   2,   2,   3,   4,   6,   7,   9,  11,  14,  16,  19,  23,  26,
+	30,  34,  38,  43,  48,  54,  59,  65,  72,  78,  85,  93, 100, 108, 116, 125
+};
+
+static volatile uint8_t BacklightFlags;
+static volatile uint8_t BacklightTarget;		//Level being faded to
+static volatile uint8_t BacklightCurrent;		//Level being output
+static uint8_t BacklightDuty;					//Duty cycle of BacklightCurrent
+static uint8_t BacklightFadeCount;
+
+//Work out the level to fade to from the settings and flags
+static void Backlight_UpdateTarget(void)
+{
+	uint8_t Level;
+	uint8_t Flags = BacklightFlags;
+
+	Level = Settings.BacklightLevel;
+	if((Flags & BACKLIGHT_FLAG_DARK) != 0)
+	{
+		Level = Level >> 1;
+	}
+	if(((Flags & BACKLIGHT_FLAG_IDLE) != 0) && (Settings.BacklightIdleLevel < Level))
+	{
+		Level = Settings.BacklightIdleLevel;
+	}
+	if((Flags & BACKLIGHT_FLAG_OFF) != 0)
+	{
+		Level = 0;
+	}
+	BacklightTarget = Level;
+	return;
+}
+
+static void Backlight_SetFlag(uint8_t Flag, uint8_t State)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	if(State != 0)
+	{
+		BacklightFlags |= Flag;
+	}
+	else
+	{
+		BacklightFlags &= ~Flag;
+	}
+	Backlight_UpdateTarget();
+	SREG = sreg;
+	return;
+}
+
+//Fade to a new level after the settings have changed
+static void Backlight_Refresh(void)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	Backlight_UpdateTarget();
+	SREG = sreg;
+	return;
+}
+
+void Backlight_Init(void)
+{
+	//Start dark and fade in
+	PORTB &= ~(1<<BACKLIGHT_PIN);
+	DDRB |= (1<<BACKLIGHT_PIN);
+
+	if(Settings.BacklightLevel > BACKLIGHT_MAX_LEVEL)
+	{
+		Settings.BacklightLevel = BACKLIGHT_MAX_LEVEL;
+	}
+	if(Settings.BacklightIdleLevel > BACKLIGHT_MAX_LEVEL)
+	{
+		Settings.BacklightIdleLevel = BACKLIGHT_MAX_LEVEL;
+	}
+
+	Backlight_SetAuto(Settings.BacklightAuto);
+	return;
+}
+
+void Backlight_Enable(uint8_t Enable)
+{
+	Backlight_SetFlag(BACKLIGHT_FLAG_OFF, (Enable == 0));
+	return;
+}
+
+void Backlight_SetLevel(uint8_t Level)
+{
+	if(Level > BACKLIGHT_MAX_LEVEL)
+	{
+		Level = BACKLIGHT_MAX_LEVEL;
+	}
+	Settings.BacklightLevel = Level;
+	Backlight_SetFlag(BACKLIGHT_FLAG_OFF, 0);
+	return;
+}
+
+void Backlight_SetIdleLevel(uint8_t Level)
+{
+	if(Level > BACKLIGHT_MAX_LEVEL)
+	{
+		Level = BACKLIGHT_MAX_LEVEL;
+	}
+	Settings.BacklightIdleLevel = Level;
+	Backlight_Refresh();
+	return;
+}
+
+void Backlight_SetAuto(uint8_t Enable)
+{
+	uint8_t sreg;
+
+	Settings.BacklightAuto = (Enable != 0);
+
+	sreg = SREG;
+	cli();
+	if(Enable != 0)
+	{
+		//The light sensor interrupt line is open drain, pull it up and interrupt on both edges
+		DDRC &= ~(1<<LIGHT_SENSOR_PIN);
+		PORTC |= (1<<LIGHT_SENSOR_PIN);
+		EICRB = (EICRB & 0xFC) | (1<<ISC40);
+		EIFR = (1<<INTF4);
+		EIMSK |= (1<<INT4);
+		Backlight_SetFlag(BACKLIGHT_FLAG_DARK, ((PINC & (1<<LIGHT_SENSOR_PIN)) == 0));
+	}
+	else
+	{
+		EIMSK &= ~(1<<INT4);
+		Backlight_SetFlag(BACKLIGHT_FLAG_DARK, 0);
+	}
+	SREG = sreg;
+	return;
+}
+
+void Backlight_Idle(void)
+{
+	Backlight_SetFlag(BACKLIGHT_FLAG_IDLE, 1);
+	return;
+}
+
+void Backlight_Wake(void)
+{
+	Backlight_SetFlag(BACKLIGHT_FLAG_IDLE, 0);
+	return;
+}
+
+uint8_t Backlight_Level(void)
+{
+	return BacklightCurrent;
+}
+
+void Backlight_Tick(void)
+{
+	uint8_t Level;
+
+	//End of the on part of the PWM period, compare B turns the backlight on again near the end of this one
+	if(BacklightDuty <= HARDWARE_TIMER_0_TOP_VALUE)
+	{
+		PORTB &= ~(1<<BACKLIGHT_PIN);
+	}
+
+	BacklightFadeCount++;
+	if(BacklightFadeCount < BACKLIGHT_FADE_STEP_MS)
+	{
+		return;
+	}
+	BacklightFadeCount = 0;
+
+	Level = BacklightCurrent;
+	if(Level < BacklightTarget)
+	{
+		Level++;
+	}
+	else if(Level > BacklightTarget)
+	{
+		Level--;
+	}
+	else
+	{
+		return;
+	}
+	BacklightCurrent = Level;
+	BacklightDuty = pgm_read_byte(&BacklightGamma[Level]);
+
+	if(BacklightDuty == 0)
+	{
+		TIMSK0 &= ~(1<<OCIE0B);
+		PORTB &= ~(1<<BACKLIGHT_PIN);
+	}
+	else if(BacklightDuty > HARDWARE_TIMER_0_TOP_VALUE)
+	{
+		TIMSK0 &= ~(1<<OCIE0B);
+		PORTB |= (1<<BACKLIGHT_PIN);
+	}
+	else
+	{
+		//The on part is at the end of the period, clear of the rest of the compare A interrupt
+		OCR0B = HARDWARE_TIMER_0_TOP_VALUE - BacklightDuty;
+		TIMSK0 |= (1<<OCIE0B);
+	}
+	return;
+}
+
+//Start of the on part of the PWM period
+ISR(TIMER0_COMPB_vect)
+{
+	PORTB |= (1<<BACKLIGHT_PIN);
+}
+
+//The light sensor pulls its interrupt line low while the room is dark
+ISR(INT4_vect)
+{
+	if((PINC & (1<<LIGHT_SENSOR_PIN)) == 0)
+	{
+		BacklightFlags |= BACKLIGHT_FLAG_DARK;
+	}
+	else
+	{
+		BacklightFlags &= ~BACKLIGHT_FLAG_DARK;
+	}
+	Backlight_UpdateTarget();
+}
+
+/** @} */
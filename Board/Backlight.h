@@ -0,0 +1,79 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		LCD backlight dimming header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The backlight is on PB6, which is not connected to a timer output. It is
+*	dimmed by timer 0 instead: the compare B interrupt turns the backlight on
+*	near the end of each period, and the 1ms compare A interrupt turns it off
+*	at the start of the next one. OCR0B sets the duty cycle, giving a 1kHz PWM
+*	with 125 steps. The on part is at the end of the period so the compare B
+*	edge does not have to wait for the rest of the compare A interrupt, which
+*	would make the low levels too bright. The off edge comes a few us late,
+*	the time the compare A interrupt takes to get to Backlight_Tick(), which
+*	adds a small constant to every level.
+*
+*	Brightness is set as a level from 0 to BACKLIGHT_MAX_LEVEL, which is mapped
+*	to a duty cycle through a gamma table so each level looks like the same
+*	change in brightness. Changes fade one level at a time from the 1ms
+*	interrupt, so the main loop does nothing while a fade runs.
+*
+*	@{
+*/
+
+#ifndef _BACKLIGHT_H_
+#define _BACKLIGHT_H_
+
+#include <stdint.h>
+
+#define BACKLIGHT_MAX_LEVEL			31
+
+#define BACKLIGHT_FADE_STEP_MS		16		//Time between fade steps, a full fade takes ~0.5s
+
+/** Set up the backlight pin and timer 0 compare B, and fade in to the saved level. Call after timer 0 is set up and the settings are loaded. */
+void Backlight_Init(void);
+
+/** Turn the backlight on or off. The level is kept. */
+void Backlight_Enable(uint8_t Enable);
+
+/** Set the brightness level used when the panel is in use. */
+void Backlight_SetLevel(uint8_t Level);
+
+/** Set the brightness level used when the menu has timed out. */
+void Backlight_SetIdleLevel(uint8_t Level);
+
+/** Turn ambient light dimming on or off. When on, the backlight is dimmed while the light sensor reports a dark room. */
+void Backlight_SetAuto(uint8_t Enable);
+
+/** Fade to the idle level. Called when the menu times out. */
+void Backlight_Idle(void);
+
+/** Fade back to the normal level. Called when a button is pressed. */
+void Backlight_Wake(void);
+
+/** Returns the level the backlight is at now, which differs from the set level during a fade. */
+uint8_t Backlight_Level(void);
+
+/** Start a PWM period and step any fade. Called at the start of the timer 0 compare A interrupt. */
+void Backlight_Tick(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,240 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Two line big digit clock for the idle screen.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+//Segment glyphs
+static const uint8_t BigClockTop[8] PROGMEM		= {0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const uint8_t BigClockBottom[8] PROGMEM	= {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F};
+static const uint8_t BigClockBoth[8] PROGMEM	= {0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F};
+
+//Cell codes used in the digit table
+#define BIGCLOCK_SPACE		0
+#define BIGCLOCK_BLOCK		1
+#define BIGCLOCK_TOP		2
+#define BIGCLOCK_BOTTOM		3
+#define BIGCLOCK_BOTH		4
+
+#define BIGCLOCK_BLOCK_CHAR	0xFF		//Solid block in the HD44780 character ROM
+#define BIGCLOCK_COLON_CHAR	0xA5		//Centered dot in the HD44780 character ROM
+
+#define BIGCLOCK_BLANK		10			//Digit value that draws an empty digit (leading zero of the hour)
+#define BIGCLOCK_INVALID	0xFF
+
+//Cells of each digit, top line left to right then bottom line left to right
+static const uint8_t BigClockDigits[10][6] PROGMEM =
+{
+	{BIGCLOCK_BLOCK,	BIGCLOCK_TOP,		BIGCLOCK_BLOCK,		BIGCLOCK_BLOCK,		BIGCLOCK_BOTTOM,	BIGCLOCK_BLOCK},	//0
+	{BIGCLOCK_TOP,		BIGCLOCK_BLOCK,		BIGCLOCK_SPACE,		BIGCLOCK_BOTTOM,	BIGCLOCK_BLOCK,		BIGCLOCK_BOTTOM},	//1
+	{BIGCLOCK_BOTH,		BIGCLOCK_BOTH,		BIGCLOCK_BLOCK,		BIGCLOCK_BLOCK,		BIGCLOCK_BOTTOM,	BIGCLOCK_BOTTOM},	//2
+	{BIGCLOCK_BOTH,		BIGCLOCK_BOTH,		BIGCLOCK_BLOCK,		BIGCLOCK_BOTTOM,	BIGCLOCK_BOTTOM,	BIGCLOCK_BLOCK},	//3
+	{BIGCLOCK_BLOCK,	BIGCLOCK_BOTTOM,	BIGCLOCK_BLOCK,		BIGCLOCK_SPACE,		BIGCLOCK_SPACE,		BIGCLOCK_BLOCK},	//4
+	{BIGCLOCK_BLOCK,	BIGCLOCK_BOTH,		BIGCLOCK_BOTH,		BIGCLOCK_BOTTOM,	BIGCLOCK_BOTTOM,	BIGCLOCK_BLOCK},	//5
+	{BIGCLOCK_BLOCK,	BIGCLOCK_BOTH,		BIGCLOCK_BOTH,		BIGCLOCK_BLOCK,		BIGCLOCK_BOTTOM,	BIGCLOCK_BLOCK},	//6
+	{BIGCLOCK_TOP,		BIGCLOCK_TOP,		BIGCLOCK_BLOCK,		BIGCLOCK_SPACE,		BIGCLOCK_SPACE,		BIGCLOCK_BLOCK},	//7
+	{BIGCLOCK_BLOCK,	BIGCLOCK_BOTH,		BIGCLOCK_BLOCK,		BIGCLOCK_BLOCK,		BIGCLOCK_BOTTOM,	BIGCLOCK_BLOCK},	//8
+	{BIGCLOCK_BLOCK,	BIGCLOCK_BOTH,		BIGCLOCK_BLOCK,		BIGCLOCK_BOTTOM,	BIGCLOCK_BOTTOM,	BIGCLOCK_BLOCK},	//9
+};
+
+//Left column of each of the four big digits
+static const uint8_t BigClockColumn[4] PROGMEM = {0, 3, 7, 10};
+
+#define BIGCLOCK_COLON_COLUMN	6
+#define BIGCLOCK_SMALL_COLUMN	14
+
+//Character codes for each cell code, filled in when the glyphs are acquired
+static uint8_t BigClockChars[5];
+
+//What is currently on the screen
+static uint8_t BigClockActive;
+static uint8_t BigClockSmall;		//The segment glyphs could not be loaded, the time is shown as hh:mm:ss
+static uint8_t ShownDigits[4];
+static uint8_t ShownSec;
+static uint8_t ShownPM;
+
+static void BigClock_DrawDigit(uint8_t Position, uint8_t Digit)
+{
+	uint8_t i;
+	uint8_t Cell = BIGCLOCK_SPACE;
+	uint8_t Column = pgm_read_byte(&BigClockColumn[Position]);
+
+	LCDGeo_GotoXY(Column, 0);
+	for(i = 0; i < 6; i++)
+	{
+		if(i == 3)
+		{
+			LCDGeo_GotoXY(Column, 1);
+		}
+
+		if(Digit != BIGCLOCK_BLANK)
+		{
+			Cell = pgm_read_byte(&BigClockDigits[Digit][i]);
+		}
+		lcd_data(BigClockChars[Cell]);
+	}
+	return;
+}
+
+void BigClock_Start(const TimeAndDate *Time)
+{
+	uint8_t i;
+
+	//Don't take a second set of glyph references if the clock is being redrawn
+	BigClock_Stop();
+
+	BigClockChars[BIGCLOCK_SPACE]	= ' ';
+	BigClockChars[BIGCLOCK_BLOCK]	= BIGCLOCK_BLOCK_CHAR;
+	BigClockChars[BIGCLOCK_TOP]		= Glyph_Acquire(BigClockTop);
+	BigClockChars[BIGCLOCK_BOTTOM]	= Glyph_Acquire(BigClockBottom);
+	BigClockChars[BIGCLOCK_BOTH]	= Glyph_Acquire(BigClockBoth);
+
+	//GLYPH_NO_SLOT is the same code as the solid block, so a missing glyph would draw as one
+	BigClockSmall = 0;
+	for(i = BIGCLOCK_TOP; i <= BIGCLOCK_BOTH; i++)
+	{
+		if(BigClockChars[i] == GLYPH_NO_SLOT)
+		{
+			BigClockSmall = 1;
+		}
+	}
+
+	for(i = 0; i < 4; i++)
+	{
+		ShownDigits[i] = BIGCLOCK_INVALID;
+	}
+	ShownSec = BIGCLOCK_INVALID;
+	ShownPM = BIGCLOCK_INVALID;
+	BigClockActive = 1;
+
+	if(BigClockSmall == 1)
+	{
+		//The CGRAM is taken by something else, give back the glyphs that were loaded and use normal characters
+		for(i = BIGCLOCK_TOP; i <= BIGCLOCK_BOTH; i++)
+		{
+			Glyph_Release(BigClockChars[i]);
+		}
+		BigClock_Update(Time);
+		return;
+	}
+
+	LCDGeo_GotoXY(BIGCLOCK_COLON_COLUMN, 0);
+	lcd_data(BIGCLOCK_COLON_CHAR);
+	LCDGeo_GotoXY(BIGCLOCK_COLON_COLUMN, 1);
+	lcd_data(BIGCLOCK_COLON_CHAR);
+
+	BigClock_Update(Time);
+	return;
+}
+
+void BigClock_Update(const TimeAndDate *Time)
+{
+	uint8_t i;
+	uint8_t Hour;
+	uint8_t PM;
+	uint8_t Digits[4];
+
+	if(BigClockActive == 0)
+	{
+		return;
+	}
+
+	if(BigClockSmall == 1)
+	{
+		if(Time->sec != ShownSec)
+		{
+			LCDGeo_GotoXY(0, 0);
+			Format_Time(lcd_putc, Time->hour, Time->min, Time->sec);
+			ShownSec = Time->sec;
+		}
+		return;
+	}
+
+	//Convert to a 12 hour clock, hour 0 is 12 AM
+	Hour = Time->hour;
+	PM = 0;
+	if(Hour >= 12)
+	{
+		Hour -= 12;
+		PM = 1;
+	}
+	if(Hour == 0)
+	{
+		Hour = 12;
+	}
+
+	Digits[0] = (Hour >= 10) ? 1 : BIGCLOCK_BLANK;
+	Digits[1] = (Hour >= 10) ? Hour - 10 : Hour;
+	Digits[2] = 0;
+	Digits[3] = Time->min;
+	while(Digits[3] >= 10)
+	{
+		Digits[3] -= 10;
+		Digits[2]++;
+	}
+
+	for(i = 0; i < 4; i++)
+	{
+		if(Digits[i] != ShownDigits[i])
+		{
+			BigClock_DrawDigit(i, Digits[i]);
+			ShownDigits[i] = Digits[i];
+		}
+	}
+
+	if(PM != ShownPM)
+	{
+		LCDGeo_GotoXY(BIGCLOCK_SMALL_COLUMN, 0);
+		lcd_data(PM ? 'P' : 'A');
+		lcd_data('M');
+		ShownPM = PM;
+	}
+
+	if(Time->sec != ShownSec)
+	{
+		LCDGeo_GotoXY(BIGCLOCK_SMALL_COLUMN, 1);
+		Format_Dec2(lcd_putc, Time->sec);
+		ShownSec = Time->sec;
+	}
+	return;
+}
+
+uint8_t BigClock_Running(void)
+{
+	return BigClockActive;
+}
+
+void BigClock_Stop(void)
+{
+	if((BigClockActive == 1) && (BigClockSmall == 0))
+	{
+		Glyph_Release(BigClockChars[BIGCLOCK_TOP]);
+		Glyph_Release(BigClockChars[BIGCLOCK_BOTTOM]);
+		Glyph_Release(BigClockChars[BIGCLOCK_BOTH]);
+	}
+	BigClockActive = 0;
+	return;
+}
+
+/** @} */
@@ -0,0 +1,60 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Two line big digit clock for the idle screen header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Hours and minutes are drawn 3 columns wide and 2 lines high from three
+*	CGRAM segment glyphs plus the built in solid block. AM/PM and the seconds
+*	are shown in normal characters in the last two columns:
+*
+*		col: 0  3  6 7  10  14
+*		     HH HH : MM MM  AM
+*		     HH HH : MM MM  ss
+*
+*	After the first draw only the digits that changed are rewritten, so a
+*	normal second costs one cursor move and two characters.
+*
+*	If the glyphs can not all be loaded because the CGRAM slots are in use,
+*	the clock gives back the ones it got and shows hh:mm:ss at the top left
+*	instead. The next BigClock_Start() tries the glyphs again.
+*
+*	@{
+*/
+
+#ifndef _BIGCLOCK_H_
+#define _BIGCLOCK_H_
+
+#include <stdint.h>
+
+/** Load the segment glyphs and draw the whole clock. The LCD should be cleared first. */
+void BigClock_Start(const TimeAndDate *Time);
+
+/** Redraw the parts of the clock that changed since the last call. Does nothing if the clock is not started. */
+void BigClock_Update(const TimeAndDate *Time);
+
+/** Returns 1 if the clock has been started. */
+uint8_t BigClock_Running(void);
+
+/** Release the segment glyphs. Call this before drawing something else on the LCD. */
+void BigClock_Stop(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,236 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Command name lookup and completion.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+#include "CmdTrieData.h"		//Generated, see tools/gen_cmdtrie.py for the node layout
+
+#define CMDTRIE_NONE				0xFFFF	//Node offset when no name matches
+
+//Node flags
+#define CMDTRIE_END					0x80	//A command name ends at this node
+#define CMDTRIE_CHILDREN			0x7F	//Mask for the number of children
+
+static const char CmdTrie_HelpDescription[] PROGMEM = "List the commands";
+
+static uint8_t CmdTrieHelpCount;
+
+static uint8_t CmdTrie_Byte(uint16_t Offset)
+{
+	return pgm_read_byte(&CmdTrie[Offset]);
+}
+
+//Offset of the flags byte of a node
+static uint16_t CmdTrie_Flags(uint16_t Node)
+{
+	return Node + 1 + CmdTrie_Byte(Node);
+}
+
+//Offset of a node's child
+static uint16_t CmdTrie_Child(uint16_t Node, uint8_t Child)
+{
+	uint16_t Offset = CmdTrie_Flags(Node);
+
+	Offset += 2 + ((CmdTrie_Byte(Offset) & CMDTRIE_END) ? 1 : 0) + (Child * 2);
+	return CmdTrie_Byte(Offset) | (CmdTrie_Byte(Offset + 1) << 8);
+}
+
+//Follow the prefix down the trie. Returns the node the prefix ends in, and sets Matched
+//to the number of characters of that node's label that are part of the prefix.
+static uint16_t CmdTrie_Walk(const char *Prefix, uint8_t Length, uint8_t *Matched)
+{
+	uint16_t Node = 0;
+	uint16_t Child;
+	uint8_t Used = 0;
+	uint8_t LabelLength;
+	uint8_t Children;
+	uint8_t i;
+
+	while(1)
+	{
+		LabelLength = CmdTrie_Byte(Node);
+		for(i = 0; i < LabelLength; i++)
+		{
+			if(Used == Length)
+			{
+				*Matched = i;
+				return Node;
+			}
+			if(CmdTrie_Byte(Node + 1 + i) != (uint8_t)Prefix[Used])
+			{
+				return CMDTRIE_NONE;
+			}
+			Used++;
+		}
+		if(Used == Length)
+		{
+			*Matched = LabelLength;
+			return Node;
+		}
+
+		//Children are sorted, and no two start with the same character
+		Children = CmdTrie_Byte(CmdTrie_Flags(Node)) & CMDTRIE_CHILDREN;
+		for(i = 0; i < Children; i++)
+		{
+			Child = CmdTrie_Child(Node, i);
+			if(CmdTrie_Byte(Child + 1) == (uint8_t)Prefix[Used])
+			{
+				break;
+			}
+		}
+		if(i == Children)
+		{
+			return CMDTRIE_NONE;
+		}
+		Node = Child;
+	}
+}
+
+int16_t CmdTrie_Find(const char *Name, uint8_t Length)
+{
+	uint16_t Node;
+	uint16_t Flags;
+	uint8_t Matched;
+
+	Node = CmdTrie_Walk(Name, Length, &Matched);
+	if((Node == CMDTRIE_NONE) || (Matched != CmdTrie_Byte(Node)))
+	{
+		return -1;
+	}
+
+	Flags = CmdTrie_Flags(Node);
+	if((CmdTrie_Byte(Flags) & CMDTRIE_END) == 0)
+	{
+		return -1;
+	}
+	return CmdTrie_Byte(Flags + 2);
+}
+
+uint8_t CmdTrie_Complete(const char *Prefix, uint8_t Length, char *Completion, uint8_t Size)
+{
+	uint16_t Node;
+	uint8_t Matched;
+	uint8_t LabelLength;
+	uint8_t i = 0;
+
+	Node = CmdTrie_Walk(Prefix, Length, &Matched);
+	if(Node == CMDTRIE_NONE)
+	{
+		Completion[0] = 0;
+		return 0;
+	}
+
+	//Edges are compressed, so everything below the node starts with the rest of its label
+	LabelLength = CmdTrie_Byte(Node);
+	while(((Matched + i) < LabelLength) && (i < (Size - 1)))
+	{
+		Completion[i] = CmdTrie_Byte(Node + 1 + Matched + i);
+		i++;
+	}
+	Completion[i] = 0;
+	return CmdTrie_Byte(CmdTrie_Flags(Node) + 1);
+}
+
+static void CmdTrie_Visit(uint16_t Node, char *Name, uint8_t Used, CmdTrieVisitor Visitor)
+{
+	uint16_t Flags;
+	uint8_t LabelLength;
+	uint8_t Children;
+	uint8_t i;
+
+	LabelLength = CmdTrie_Byte(Node);
+	for(i = 0; i < LabelLength; i++)
+	{
+		Name[Used++] = CmdTrie_Byte(Node + 1 + i);
+	}
+	Name[Used] = 0;
+
+	Flags = CmdTrie_Flags(Node);
+	if(CmdTrie_Byte(Flags) & CMDTRIE_END)
+	{
+		Visitor(Name, CmdTrie_Byte(Flags + 2));
+	}
+
+	Children = CmdTrie_Byte(Flags) & CMDTRIE_CHILDREN;
+	for(i = 0; i < Children; i++)
+	{
+		CmdTrie_Visit(CmdTrie_Child(Node, i), Name, Used, Visitor);
+	}
+	return;
+}
+
+void CmdTrie_ForEach(const char *Prefix, uint8_t Length, CmdTrieVisitor Visitor)
+{
+	char Name[CMDTRIE_LONGEST + 1];
+	uint16_t Node;
+	uint8_t Matched;
+
+	Node = CmdTrie_Walk(Prefix, Length, &Matched);
+	if(Node == CMDTRIE_NONE)
+	{
+		return;
+	}
+
+	//The visit adds the whole label of the node, so only copy the prefix up to the node
+	memcpy(Name, Prefix, Length - Matched);
+	CmdTrie_Visit(Node, Name, Length - Matched, Visitor);
+	return;
+}
+
+static void CmdTrie_HelpLine(const char *Name, uint8_t Command)
+{
+	CommandListItem Item;
+	uint8_t i;
+
+	for(i = 0; Name[i] != 0; i++)
+	{
+		Console_PutChar(Name[i]);
+	}
+	for(; i < (MAX_COMMAND_LENGTH + 2); i++)
+	{
+		Console_PutChar(' ');
+	}
+
+	if(Command == CMDTRIE_BUILTIN)
+	{
+		Format_Puts_p(Console_PutChar, CmdTrie_HelpDescription);
+	}
+	else
+	{
+		memcpy_P(&Item, &AppCommandList[Command], sizeof(CommandListItem));
+		Format_Puts_p(Console_PutChar, Item.DescriptionString);
+	}
+	Console_PutChar('\n');
+	CmdTrieHelpCount++;
+	return;
+}
+
+uint8_t CmdTrie_Help(const char *Prefix, uint8_t Length)
+{
+	CmdTrieHelpCount = 0;
+	CmdTrie_ForEach(Prefix, Length, CmdTrie_HelpLine);
+	return CmdTrieHelpCount;
+}
+
+/** @} */
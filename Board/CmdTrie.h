@@ -0,0 +1,67 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Command name lookup and completion header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The command names in AppCommandList are kept in a prefix trie in program
+*	memory, generated from Board/commands.c by tools/gen_cmdtrie.py when the
+*	firmware is built. Looking up or completing a prefix only follows one path
+*	down the trie, so it takes time in proportion to the length of the prefix
+*	and not the number of commands.
+*
+*	The interpreter's built in 'help' command is in the trie as well, with the
+*	command number CMDTRIE_BUILTIN.
+*
+*	@{
+*/
+
+#ifndef _CMDTRIE_H_
+#define _CMDTRIE_H_
+
+#include <stdint.h>
+
+#define CMDTRIE_BUILTIN				0xFF	//Command number of names that are not in AppCommandList
+
+/** Called for each name by CmdTrie_ForEach(). Name is 0 terminated and only valid during the call. */
+typedef void (*CmdTrieVisitor)(const char *Name, uint8_t Command);
+
+/** Look up a command name.
+*	\return the index in AppCommandList, CMDTRIE_BUILTIN, or -1 if there is no command with that name
+*/
+int16_t CmdTrie_Find(const char *Name, uint8_t Length);
+
+/** Complete a command name.
+*	\param[out] Completion	The characters that all names starting with Prefix have after it, 0 terminated
+*	\param[in] Size			Size of Completion
+*	\return the number of names that start with Prefix
+*/
+uint8_t CmdTrie_Complete(const char *Prefix, uint8_t Length, char *Completion, uint8_t Size);
+
+/** Call Visitor for each name that starts with Prefix, in alphabetical order. */
+void CmdTrie_ForEach(const char *Prefix, uint8_t Length, CmdTrieVisitor Visitor);
+
+/** Print the name and description of each command that starts with Prefix.
+*	\return the number of commands printed
+*/
+uint8_t CmdTrie_Help(const char *Prefix, uint8_t Length);
+
+#endif
+
+/** @} */
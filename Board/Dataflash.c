@@ -0,0 +1,215 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		AT45DB041D dataflash driver.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+//Commands (see the AT45DB041D data sheet)
+#define DATAFLASH_CMD_READ					0x03	//Continuous array read, up to 33MHz
+#define DATAFLASH_CMD_BUFFER1_WRITE			0x84
+#define DATAFLASH_CMD_BUFFER2_WRITE			0x87
+#define DATAFLASH_CMD_BUFFER1_READ			0xD1	//Low frequency buffer read, no don't care byte
+#define DATAFLASH_CMD_BUFFER2_READ			0xD3
+#define DATAFLASH_CMD_BUFFER1_PROGRAM		0x88	//Buffer to main memory page program without built-in erase
+#define DATAFLASH_CMD_BUFFER2_PROGRAM		0x89
+#define DATAFLASH_CMD_BLOCK_ERASE			0x50
+#define DATAFLASH_CMD_STATUS				0xD7
+#define DATAFLASH_CMD_ID					0x9F
+
+#define DATAFLASH_STATUS_READY				0x80
+#define DATAFLASH_ID_MANUFACTURER			0x1F	//Atmel
+#define DATAFLASH_ID_DEVICE					0x24	//AT45DB041
+
+#define DATAFLASH_NO_BUFFER					0xFF
+
+//Status reads before the chip is given up on. A read takes at least 4us, so
+//this is well over the longest block erase, 100ms.
+#define DATAFLASH_READY_POLLS				40000
+
+//Buffer being programmed into the main memory, or DATAFLASH_NO_BUFFER
+static uint8_t DataflashBusyBuffer;
+
+//Send a command with a page and byte address. With 264 byte pages, the page is in bits 9 and up.
+static void Dataflash_Command(uint8_t Command, uint16_t Page, uint16_t Offset)
+{
+	uint32_t Address = ((uint32_t)Page << 9) | Offset;
+
+	SPI_Select(SPI_DEVICE_DATAFLASH);
+	SPI_Transfer(Command);
+	SPI_Transfer(Address >> 16);
+	SPI_Transfer(Address >> 8);
+	SPI_Transfer(Address);
+	return;
+}
+
+//Returns 1 if the ID is an AT45DB041
+static uint8_t Dataflash_CheckID(void)
+{
+	uint8_t Manufacturer;
+	uint8_t Device;
+
+	SPI_Select(SPI_DEVICE_DATAFLASH);
+	SPI_Transfer(DATAFLASH_CMD_ID);
+	Manufacturer = SPI_Transfer(0x00);
+	Device = SPI_Transfer(0x00);
+	SPI_Deselect();
+
+	return (Manufacturer == DATAFLASH_ID_MANUFACTURER) && (Device == DATAFLASH_ID_DEVICE);
+}
+
+uint8_t Dataflash_Init(void)
+{
+	DataflashBusyBuffer = DATAFLASH_NO_BUFFER;
+
+	//Without the chip MISO reads low, which looks like busy, so check the ID first.
+	//The processor can be reset while the chip is still programming or erasing,
+	//and a busy chip does not answer the ID command.
+	if(!Dataflash_CheckID())
+	{
+		if((Dataflash_WaitReady() != 0) || !Dataflash_CheckID())
+		{
+			return 1;
+		}
+	}
+	return Dataflash_WaitReady();
+}
+
+uint8_t Dataflash_Busy(void)
+{
+	uint8_t Status;
+
+	SPI_Select(SPI_DEVICE_DATAFLASH);
+	SPI_Transfer(DATAFLASH_CMD_STATUS);
+	Status = SPI_Transfer(0x00);
+	SPI_Deselect();
+
+	if(Status & DATAFLASH_STATUS_READY)
+	{
+		DataflashBusyBuffer = DATAFLASH_NO_BUFFER;
+		return 0;
+	}
+	return 1;
+}
+
+uint8_t Dataflash_WaitReady(void)
+{
+	uint16_t Polls;
+
+	for(Polls = 0; Polls < DATAFLASH_READY_POLLS; Polls++)
+	{
+		if(!Dataflash_Busy())
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+uint8_t Dataflash_BufferWrite(uint8_t Buffer, uint16_t Offset, const void *Data, uint16_t Length)
+{
+	const uint8_t *Bytes = Data;
+
+	//The other buffer can be written while a page is programmed
+	if((Buffer == DataflashBusyBuffer) && (Dataflash_WaitReady() != 0))
+	{
+		return 1;
+	}
+
+	Dataflash_Command((Buffer == 0) ? DATAFLASH_CMD_BUFFER1_WRITE : DATAFLASH_CMD_BUFFER2_WRITE, 0, Offset);
+	while(Length-- > 0)
+	{
+		SPI_Transfer(*Bytes++);
+	}
+	SPI_Deselect();
+	return 0;
+}
+
+uint8_t Dataflash_BufferRead(uint8_t Buffer, uint16_t Offset, void *Data, uint16_t Length)
+{
+	uint8_t *Bytes = Data;
+
+	if((Buffer == DataflashBusyBuffer) && (Dataflash_WaitReady() != 0))
+	{
+		return 1;
+	}
+
+	Dataflash_Command((Buffer == 0) ? DATAFLASH_CMD_BUFFER1_READ : DATAFLASH_CMD_BUFFER2_READ, 0, Offset);
+	while(Length-- > 0)
+	{
+		*Bytes++ = SPI_Transfer(0x00);
+	}
+	SPI_Deselect();
+	return 0;
+}
+
+uint8_t Dataflash_BufferProgram(uint8_t Buffer, uint16_t Page)
+{
+	if(Dataflash_WaitReady() != 0)
+	{
+		return 1;
+	}
+	Dataflash_Command((Buffer == 0) ? DATAFLASH_CMD_BUFFER1_PROGRAM : DATAFLASH_CMD_BUFFER2_PROGRAM, Page, 0);
+	SPI_Deselect();
+	DataflashBusyBuffer = Buffer;
+	return 0;
+}
+
+uint8_t Dataflash_EraseBlock(uint16_t Block)
+{
+	if(Dataflash_WaitReady() != 0)
+	{
+		return 1;
+	}
+	Dataflash_Command(DATAFLASH_CMD_BLOCK_ERASE, Block * DATAFLASH_BLOCK_PAGES, 0);
+	SPI_Deselect();
+	return 0;
+}
+
+uint8_t Dataflash_Read(uint16_t Page, uint16_t Offset, void *Data, uint16_t Length)
+{
+	uint8_t *Bytes = Data;
+
+	if(Dataflash_ReadStart(Page, Offset) != 0)
+	{
+		return 1;
+	}
+	while(Length-- > 0)
+	{
+		*Bytes++ = SPI_Transfer(0x00);
+	}
+	SPI_Deselect();
+	return 0;
+}
+
+uint8_t Dataflash_ReadStart(uint16_t Page, uint16_t Offset)
+{
+	if(Dataflash_WaitReady() != 0)
+	{
+		return 1;
+	}
+	Dataflash_Command(DATAFLASH_CMD_READ, Page, Offset);
+	return 0;
+}
+
+/** @} */
@@ -0,0 +1,88 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		AT45DB041D dataflash driver header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The chip has 2048 pages of 264 bytes, erased 8 pages (a block) at a time,
+*	and two 264 byte SRAM buffers. Pages are programmed from a buffer, and
+*	while one buffer is being programmed the other one can be written. The
+*	driver keeps track of which buffer is busy, and only waits for the chip
+*	when a command needs it. If the chip is still busy after that wait the
+*	command is not sent and the function returns 1, so a stuck or missing
+*	chip does not get a buffer write or program over the top of its last one.
+*
+*	@{
+*/
+
+#ifndef _DATAFLASH_H_
+#define _DATAFLASH_H_
+
+#include <stdint.h>
+
+#define DATAFLASH_PAGE_SIZE			264
+#define DATAFLASH_PAGES				2048
+#define DATAFLASH_BLOCK_PAGES		8
+#define DATAFLASH_BLOCKS			(DATAFLASH_PAGES / DATAFLASH_BLOCK_PAGES)
+
+/** Check that the chip is there and wait for it to finish what it was doing before a reset.
+*	\return 0 if an AT45DB041 answered and is ready, 1 if not
+*/
+uint8_t Dataflash_Init(void);
+
+/** Returns 1 while the chip is programming or erasing. */
+uint8_t Dataflash_Busy(void);
+
+/** Wait until the chip is not busy, for a bit longer than the longest erase.
+*	\return 0 if it is ready, 1 if it is still busy
+*/
+uint8_t Dataflash_WaitReady(void);
+
+/** Write to one of the SRAM buffers. Only waits if that buffer is being programmed.
+*	\param[in] Buffer	0 or 1
+*	\param[in] Offset	Byte in the buffer, the write wraps around at the end
+*	\return 0 if the data was written, 1 if the chip stayed busy
+*/
+uint8_t Dataflash_BufferWrite(uint8_t Buffer, uint16_t Offset, const void *Data, uint16_t Length);
+
+/** Read back one of the SRAM buffers. Only waits if that buffer is being programmed. Returns 1 if the chip stayed busy. */
+uint8_t Dataflash_BufferRead(uint8_t Buffer, uint16_t Offset, void *Data, uint16_t Length);
+
+/** Start programming a page from a buffer. The page must already be erased. Returns without waiting for the program to finish.
+*	\return 0 if the program was started, 1 if the chip stayed busy
+*/
+uint8_t Dataflash_BufferProgram(uint8_t Buffer, uint16_t Page);
+
+/** Start erasing a block of 8 pages. Returns without waiting for the erase to finish.
+*	\return 0 if the erase was started, 1 if the chip stayed busy
+*/
+uint8_t Dataflash_EraseBlock(uint16_t Block);
+
+/** Read from the main memory, the read continues into the next pages. Returns 1 if the chip stayed busy. */
+uint8_t Dataflash_Read(uint16_t Page, uint16_t Offset, void *Data, uint16_t Length);
+
+/** Start a read and leave the chip selected, so the bytes can be read with
+*	SPI_Transfer() or SPI_ReadCrc(). End it with SPI_Deselect().
+*	\return 0 if the read was started, 1 if the chip stayed busy and is not selected
+*/
+uint8_t Dataflash_ReadStart(uint16_t Page, uint16_t Offset);
+
+#endif
+
+/** @} */
@@ -0,0 +1,208 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Fixed point filters for the sensor channels.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+#if RECORDER_CHANNELS != SETTINGS_FILTER_CHANNELS
+#error "The filter settings need an entry for each recorder channel"
+#endif
+
+typedef struct
+{
+	int16_t History[FILTER_MEDIAN_MAX];		//Last readings, the oldest is replaced first
+	uint8_t Count;							//Readings in History
+	uint8_t Next;							//Where the next reading goes
+	int32_t Average;						//With FILTER_EMA_FRACTION_BITS fraction bits
+	int16_t Output;
+	uint8_t Valid;							//Set by the first reading
+} FilterState;
+
+static FilterState FilterChannels[RECORDER_CHANNELS];
+
+static uint8_t Filter_Valid(uint8_t Median, uint8_t Shift)
+{
+	return ((Median <= 1) || (Median == 3) || (Median == 5)) && (Shift <= FILTER_SHIFT_MAX);
+}
+
+void Filter_Init(void)
+{
+	uint8_t sreg;
+	uint8_t i;
+
+	sreg = SREG;
+	cli();
+	for(i = 0; i < RECORDER_CHANNELS; i++)
+	{
+		if(!Filter_Valid(Settings.FilterMedian[i], Settings.FilterShift[i]))
+		{
+			Settings.FilterMedian[i] = 1;
+			Settings.FilterShift[i] = 0;
+		}
+	}
+	memset(FilterChannels, 0, sizeof(FilterChannels));
+	SREG = sreg;
+	return;
+}
+
+uint8_t Filter_Configure(uint8_t Channel, uint8_t Median, uint8_t Shift)
+{
+	uint8_t sreg;
+
+	if((Channel >= RECORDER_CHANNELS) || !Filter_Valid(Median, Shift))
+	{
+		return 1;
+	}
+
+	sreg = SREG;
+	cli();
+	Settings.FilterMedian[Channel] = (Median > 1) ? Median : 1;
+	Settings.FilterShift[Channel] = Shift;
+	memset(&FilterChannels[Channel], 0, sizeof(FilterState));
+	SREG = sreg;
+	return 0;
+}
+
+//Insertion sort of a copy, at most 10 compares for 5 readings
+static int16_t Filter_Median(const int16_t *History, uint8_t Count)
+{
+	int16_t Sorted[FILTER_MEDIAN_MAX];
+	int16_t Value;
+	uint8_t i;
+	uint8_t j;
+
+	for(i = 0; i < Count; i++)
+	{
+		Value = History[i];
+		for(j = i; (j > 0) && (Sorted[j - 1] > Value); j--)
+		{
+			Sorted[j] = Sorted[j - 1];
+		}
+		Sorted[j] = Value;
+	}
+
+	//The lower of the middle two while there are an even number
+	return Sorted[(Count - 1) / 2];
+}
+
+int16_t Filter_Apply(uint8_t Channel, int16_t Value)
+{
+	FilterState *Filter;
+	uint8_t Median;
+	uint8_t Shift;
+	int32_t Scaled;
+
+	if(Channel >= RECORDER_CHANNELS)
+	{
+		return Value;
+	}
+	Filter = &FilterChannels[Channel];
+	Median = Settings.FilterMedian[Channel];
+	Shift = Settings.FilterShift[Channel];
+
+	if(Median > 1)
+	{
+		Filter->History[Filter->Next] = Value;
+		Filter->Next = (Filter->Next + 1 < Median) ? (Filter->Next + 1) : 0;
+		if(Filter->Count < Median)
+		{
+			Filter->Count++;
+		}
+		Value = Filter_Median(Filter->History, Filter->Count);
+	}
+
+	if(Shift > 0)
+	{
+		Scaled = (int32_t)Value << FILTER_EMA_FRACTION_BITS;
+		if(Filter->Valid)
+		{
+			Filter->Average += (Scaled - Filter->Average) >> Shift;
+		}
+		else
+		{
+			Filter->Average = Scaled;
+		}
+		Value = (Filter->Average + (1 << (FILTER_EMA_FRACTION_BITS - 1))) >> FILTER_EMA_FRACTION_BITS;
+	}
+
+	Filter->Output = Value;
+	Filter->Valid = 1;
+	return Value;
+}
+
+uint8_t Filter_GetValue(uint8_t Channel, int16_t *Value)
+{
+	uint8_t sreg;
+	uint8_t Valid;
+
+	if(Channel >= RECORDER_CHANNELS)
+	{
+		return 1;
+	}
+
+	sreg = SREG;
+	cli();
+	*Value = FilterChannels[Channel].Output;
+	Valid = FilterChannels[Channel].Valid;
+	SREG = sreg;
+	return Valid ? 0 : 1;
+}
+
+void Filter_Print(void)
+{
+	uint8_t Median;
+	uint8_t Shift;
+	uint8_t i;
+
+	for(i = 0; i < RECORDER_CHANNELS; i++)
+	{
+		Median = Settings.FilterMedian[i];
+		Shift = Settings.FilterShift[i];
+
+		Format_Puts_p(Console_PutChar, Recorder_ChannelName(i));
+		Format_Puts_P(Console_PutChar, ": ");
+		if(Median > 1)
+		{
+			Format_Puts_P(Console_PutChar, "median of ");
+			Format_UInt(Console_PutChar, Median, 0, ' ');
+			if(Shift > 0)
+			{
+				Format_Puts_P(Console_PutChar, ", ");
+			}
+		}
+		if(Shift > 0)
+		{
+			Format_Puts_P(Console_PutChar, "average 1/");
+			Format_UInt(Console_PutChar, 1 << Shift, 0, ' ');
+		}
+		if((Median <= 1) && (Shift == 0))
+		{
+			Format_Puts_P(Console_PutChar, "none");
+		}
+		Console_PutChar('\n');
+	}
+	return;
+}
+
+/** @} */
@@ -0,0 +1,72 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Fixed point filters for the sensor channels header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Each recorder channel has its own filters, which Recorder_SetValue() runs
+*	on every reading before it is stored:
+*	- A median of the last N readings (N is 3 or 5), which removes single
+*	  spikes without smearing steps.
+*	- Then an exponential moving average, y += (x - y) / 2^Shift. The average
+*	  is kept with FILTER_EMA_FRACTION_BITS extra bits, so it settles on the
+*	  input exactly instead of stopping up to 2^Shift counts short.
+*
+*	The first reading after a change of settings starts the average at that
+*	reading, and the median works on the readings it has until it has N.
+*	The settings are kept in the EEPROM with the other settings.
+*
+*	@{
+*/
+
+#ifndef _FILTER_H_
+#define _FILTER_H_
+
+#include <stdint.h>
+
+#define FILTER_MEDIAN_MAX			5		//Longest median
+#define FILTER_SHIFT_MAX			7		//Slowest average, 1/128 of the change each reading
+#define FILTER_EMA_FRACTION_BITS	8
+
+/** Load the settings of every channel and forget the readings so far. */
+void Filter_Init(void);
+
+/** Set the filters of a channel and start it again. The caller saves the settings.
+*	\param[in] Median	Readings in the median, 3 or 5, or 0 or 1 for none
+*	\param[in] Shift	Average weight 1/2^Shift, 0 for none
+*	\return 0 if they were set, 1 if the channel or a setting is not valid
+*/
+uint8_t Filter_Configure(uint8_t Channel, uint8_t Median, uint8_t Shift);
+
+/** Filter a reading. Call with interrupts off.
+*	\return the filtered value
+*/
+int16_t Filter_Apply(uint8_t Channel, int16_t Value);
+
+/** Get the last filtered value of a channel.
+*	\return 0 if there is one, 1 if the channel has had no readings
+*/
+uint8_t Filter_GetValue(uint8_t Channel, int16_t *Value);
+
+/** Print the filters of each channel to the console. */
+void Filter_Print(void);
+
+#endif
+
+/** @} */
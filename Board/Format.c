@@ -0,0 +1,240 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Lightweight number formatting routines.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+//The AVR has no divide instruction, so digits are found by repeated subtraction
+static const uint16_t PowersOfTen[] PROGMEM = {10000, 1000, 100, 10, 1};
+static const uint32_t LongPowersOfTen[] PROGMEM = {1000000000, 100000000, 10000000, 1000000, 100000, 10000};
+
+static const char HexDigits[] PROGMEM = "0123456789ABCDEF";
+
+void Format_Puts_p(FormatSink Sink, const char *progmem_s)
+{
+	char c;
+
+	while((c = pgm_read_byte(progmem_s++)) != 0)
+	{
+		Sink(c);
+	}
+	return;
+}
+
+void Format_Dec2(FormatSink Sink, uint8_t Value)
+{
+	char Tens = '0';
+
+	while(Value >= 10)
+	{
+		Value -= 10;
+		Tens++;
+	}
+	Sink(Tens);
+	Sink('0' + Value);
+	return;
+}
+
+void Format_BCD(FormatSink Sink, uint8_t Value)
+{
+	Sink('0' + (Value >> 4));
+	Sink('0' + (Value & 0x0F));
+	return;
+}
+
+void Format_Hex2(FormatSink Sink, uint8_t Value)
+{
+	Sink(pgm_read_byte(&HexDigits[Value >> 4]));
+	Sink(pgm_read_byte(&HexDigits[Value & 0x0F]));
+	return;
+}
+
+void Format_UInt(FormatSink Sink, uint16_t Value, uint8_t Width, char Pad)
+{
+	uint8_t i;
+	uint8_t Digit;
+	uint8_t Started = 0;
+	uint16_t Power;
+
+	for(i = 0; i < 5; i++)
+	{
+		Power = pgm_read_word(&PowersOfTen[i]);
+		Digit = 0;
+		while(Value >= Power)
+		{
+			Value -= Power;
+			Digit++;
+		}
+
+		if((Digit != 0) || (Started == 1) || (i == 4))
+		{
+			Started = 1;
+			Sink('0' + Digit);
+		}
+		else if(Width > (4 - i))
+		{
+			//Leading position inside the requested width
+			Sink(Pad);
+		}
+	}
+	return;
+}
+
+void Format_ULong(FormatSink Sink, uint32_t Value)
+{
+	uint8_t i;
+	uint8_t Digit;
+	uint8_t Started = 0;
+	uint32_t Power;
+
+	//The top six digits here, the rest by Format_UInt()
+	for(i = 0; i < 6; i++)
+	{
+		Power = pgm_read_dword(&LongPowersOfTen[i]);
+		Digit = 0;
+		while(Value >= Power)
+		{
+			Value -= Power;
+			Digit++;
+		}
+
+		if((Digit != 0) || (Started == 1))
+		{
+			Started = 1;
+			Sink('0' + Digit);
+		}
+	}
+	Format_UInt(Sink, (uint16_t)Value, Started ? 4 : 0, '0');
+	return;
+}
+
+void Format_Int(FormatSink Sink, int16_t Value)
+{
+	uint16_t Magnitude = Value;
+
+	//Negated in unsigned arithmetic, -32768 does not fit in an int16_t
+	if(Value < 0)
+	{
+		Sink('-');
+		Magnitude = (uint16_t)0 - Magnitude;
+	}
+	Format_UInt(Sink, Magnitude, 0, ' ');
+	return;
+}
+
+void Format_Decimal(FormatSink Sink, int16_t Value, uint8_t Digits)
+{
+	uint16_t Magnitude;
+	uint16_t Power;
+
+	if(Value < 0)
+	{
+		Sink('-');
+		Magnitude = (uint16_t)0 - (uint16_t)Value;
+	}
+	else
+	{
+		Magnitude = Value;
+	}
+
+	if((Digits == 0) || (Digits > 4))
+	{
+		Format_UInt(Sink, Magnitude, 0, ' ');
+		return;
+	}
+
+	//Split off the whole part, the remainder is the fractional digits
+	Power = pgm_read_word(&PowersOfTen[4 - Digits]);
+	Format_UInt(Sink, Magnitude / Power, 0, ' ');
+	Sink('.');
+	Format_UInt(Sink, Magnitude % Power, Digits, '0');
+	return;
+}
+
+void Format_Fixed(FormatSink Sink, int32_t Value, uint8_t FracBits, uint8_t Digits)
+{
+	uint32_t Magnitude;
+	uint32_t Whole;
+	uint32_t Fraction;
+	uint32_t Mask;
+
+	if(Value < 0)
+	{
+		Sink('-');
+		Magnitude = (uint32_t)0 - (uint32_t)Value;
+	}
+	else
+	{
+		Magnitude = Value;
+	}
+
+	//Sensor values have a 16-bit whole part, only larger ones need the 32-bit digits
+	Mask = (1UL << FracBits) - 1;
+	Fraction = Magnitude & Mask;
+	Whole = Magnitude >> FracBits;
+	if(Whole > 0xFFFF)
+	{
+		Format_ULong(Sink, Whole);
+	}
+	else
+	{
+		Format_UInt(Sink, (uint16_t)Whole, 0, ' ');
+	}
+
+	if(Digits > 0)
+	{
+		Sink('.');
+		while(Digits > 0)
+		{
+			//Multiply by 10 as (x<<3)+(x<<1) to avoid the multiply routine on larger values
+			Fraction = (Fraction << 3) + (Fraction << 1);
+			Sink('0' + (uint8_t)(Fraction >> FracBits));
+			Fraction &= Mask;
+			Digits--;
+		}
+	}
+	return;
+}
+
+void Format_Time(FormatSink Sink, uint8_t Hour, uint8_t Min, uint8_t Sec)
+{
+	Format_Dec2(Sink, Hour);
+	Sink(':');
+	Format_Dec2(Sink, Min);
+	Sink(':');
+	Format_Dec2(Sink, Sec);
+	return;
+}
+
+void Format_Date(FormatSink Sink, uint8_t Month, uint8_t Day, uint16_t Year)
+{
+	Format_Dec2(Sink, Month);
+	Sink('/');
+	Format_Dec2(Sink, Day);
+	Sink('/');
+	Format_UInt(Sink, Year, 4, '0');
+	return;
+}
+
+/** @} */
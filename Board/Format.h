@@ -0,0 +1,77 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Lightweight number formatting routines header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	These routines replace fprintf/printf_P for the fixed formats used by the
+*	firmware. Each routine writes its characters straight to a sink function,
+*	so nothing goes through vfprintf or a FILE stream. lcd_putc and
+*	Console_PutChar can both be used as a sink.
+*
+*	@{
+*/
+
+#ifndef _FORMAT_H_
+#define _FORMAT_H_
+
+#include <stdint.h>
+
+/** Character output function used by the formatting routines. */
+typedef void (*FormatSink)(char c);
+
+/** Write a string from program memory to the sink. */
+void Format_Puts_p(FormatSink Sink, const char *progmem_s);
+
+/** Write a two digit, zero padded decimal number (0-99) to the sink. */
+void Format_Dec2(FormatSink Sink, uint8_t Value);
+
+/** Write a packed BCD byte (as read from an RTC) as two digits. */
+void Format_BCD(FormatSink Sink, uint8_t Value);
+
+/** Write a byte as two uppercase hex digits. */
+void Format_Hex2(FormatSink Sink, uint8_t Value);
+
+/** Write an unsigned number, padded on the left with Pad to at least Width (max 5) characters. */
+void Format_UInt(FormatSink Sink, uint16_t Value, uint8_t Width, char Pad);
+
+/** Write an unsigned 32 bit number. */
+void Format_ULong(FormatSink Sink, uint32_t Value);
+
+/** Write a signed number. A minus sign is added for negative values. */
+void Format_Int(FormatSink Sink, int16_t Value);
+
+/** Write a signed decimal fixed point number, e.g. 2345 with 2 digits is written as 23.45 */
+void Format_Decimal(FormatSink Sink, int16_t Value, uint8_t Digits);
+
+/** Write a signed binary fixed point number with FracBits fractional bits, rounded down to Digits decimal places. */
+void Format_Fixed(FormatSink Sink, int32_t Value, uint8_t FracBits, uint8_t Digits);
+
+/** Write a time as hh:mm:ss */
+void Format_Time(FormatSink Sink, uint8_t Hour, uint8_t Min, uint8_t Sec);
+
+/** Write a date as mm/dd/yyyy */
+void Format_Date(FormatSink Sink, uint8_t Month, uint8_t Day, uint16_t Year);
+
+/** Write a string constant to the sink, the string is automatically stored in program memory. */
+#define Format_Puts_P(Sink, __s)		Format_Puts_p((Sink), PSTR(__s))
+
+#endif
+
+/** @} */
@@ -0,0 +1,154 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		CGRAM custom character manager.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+const uint8_t Glyph_ArrowUp[8] PROGMEM		= {0x04, 0x0E, 0x15, 0x04, 0x04, 0x04, 0x04, 0x00};
+const uint8_t Glyph_ArrowDown[8] PROGMEM	= {0x04, 0x04, 0x04, 0x04, 0x15, 0x0E, 0x04, 0x00};
+const uint8_t Glyph_ArrowLeft[8] PROGMEM	= {0x00, 0x04, 0x08, 0x1F, 0x08, 0x04, 0x00, 0x00};
+const uint8_t Glyph_ArrowRight[8] PROGMEM	= {0x00, 0x04, 0x02, 0x1F, 0x02, 0x04, 0x00, 0x00};
+
+const uint8_t Glyph_Bar[5][8] PROGMEM =
+{
+	{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+	{0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},
+	{0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C},
+	{0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E},
+	{0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+};
+
+typedef struct
+{
+	const uint8_t *Source;		//Glyph currently loaded in the slot, NULL if the slot is empty
+	uint8_t RefCount;			//Number of outstanding Glyph_Acquire calls
+	uint8_t LastUse;			//Value of GlyphUseCount the last time the slot was acquired
+} GlyphSlot;
+
+static GlyphSlot GlyphSlots[GLYPH_SLOTS];
+static uint8_t GlyphUseCount;
+
+//Copy a glyph into CGRAM without moving the DDRAM cursor
+static void Glyph_Upload(uint8_t Slot, const uint8_t *Glyph)
+{
+	uint8_t i;
+	uint8_t Address;
+
+	Address = lcd_getcurrentaddress();
+	lcd_command((1<<LCD_CGRAM) | (Slot << 3));
+	for(i = 0; i < 8; i++)
+	{
+		lcd_data(pgm_read_byte(Glyph++));
+	}
+	lcd_gotoaddress(Address);
+	return;
+}
+
+void Glyph_Init(void)
+{
+	uint8_t i;
+
+	for(i = 0; i < GLYPH_SLOTS; i++)
+	{
+		GlyphSlots[i].Source = NULL;
+		GlyphSlots[i].RefCount = 0;
+		GlyphSlots[i].LastUse = 0;
+	}
+	GlyphUseCount = 0;
+	return;
+}
+
+uint8_t Glyph_Find(const uint8_t *Glyph)
+{
+	uint8_t i;
+
+	for(i = 0; i < GLYPH_SLOTS; i++)
+	{
+		if(GlyphSlots[i].Source == Glyph)
+		{
+			return i;
+		}
+	}
+	return GLYPH_NO_SLOT;
+}
+
+uint8_t Glyph_Acquire(const uint8_t *Glyph)
+{
+	uint8_t i;
+	uint8_t Slot;
+	uint8_t Age;
+	uint8_t OldestAge = 0;
+
+	GlyphUseCount++;
+
+	Slot = Glyph_Find(Glyph);
+	if(Slot == GLYPH_NO_SLOT)
+	{
+		//Not loaded. Use an empty slot if there is one, otherwise the unreferenced slot that was used longest ago.
+		//The age is taken as a difference so the 8-bit use counter can wrap.
+		for(i = 0; i < GLYPH_SLOTS; i++)
+		{
+			if(GlyphSlots[i].RefCount != 0)
+			{
+				continue;
+			}
+
+			if(GlyphSlots[i].Source == NULL)
+			{
+				Slot = i;
+				break;
+			}
+
+			Age = GlyphUseCount - GlyphSlots[i].LastUse;
+			if((Slot == GLYPH_NO_SLOT) || (Age > OldestAge))
+			{
+				Slot = i;
+				OldestAge = Age;
+			}
+		}
+
+		if(Slot == GLYPH_NO_SLOT)
+		{
+			return GLYPH_NO_SLOT;
+		}
+
+		Glyph_Upload(Slot, Glyph);
+		GlyphSlots[Slot].Source = Glyph;
+	}
+
+	GlyphSlots[Slot].RefCount++;
+	GlyphSlots[Slot].LastUse = GlyphUseCount;
+	return Slot;
+}
+
+void Glyph_Release(uint8_t Slot)
+{
+	if((Slot < GLYPH_SLOTS) && (GlyphSlots[Slot].RefCount > 0))
+	{
+		GlyphSlots[Slot].RefCount--;
+	}
+	return;
+}
+
+/** @} */
@@ -0,0 +1,68 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		CGRAM custom character manager header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The HD44780 has 8 user defined characters (character codes 0-7). A glyph
+*	is an 8 byte bitmap stored in program memory, one byte per row with the
+*	pixels in the low 5 bits. Glyph_Acquire() returns the character code the
+*	glyph can be written with, uploading it to a free or least recently used
+*	slot only if it is not already loaded. A slot is never reused while it
+*	has references, so anything still on the screen keeps its shape.
+*
+*	@{
+*/
+
+#ifndef _GLYPH_H_
+#define _GLYPH_H_
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#define GLYPH_SLOTS				8		//Number of CGRAM characters on the HD44780
+#define GLYPH_NO_SLOT			0xFF	//Returned by Glyph_Acquire if every slot is in use
+
+//Stock glyphs
+extern const uint8_t Glyph_ArrowUp[8] PROGMEM;
+extern const uint8_t Glyph_ArrowDown[8] PROGMEM;
+extern const uint8_t Glyph_ArrowLeft[8] PROGMEM;
+extern const uint8_t Glyph_ArrowRight[8] PROGMEM;
+
+/** Bar graph columns, Glyph_Bar[n] has the leftmost n+1 pixel columns filled. */
+extern const uint8_t Glyph_Bar[5][8] PROGMEM;
+
+/** Forget the contents of all slots. Call this if the LCD has lost power. */
+void Glyph_Init(void);
+
+/** Get a reference to a glyph, loading it into CGRAM if needed.
+*	\param[in] Glyph	8 byte glyph bitmap in program memory
+*	\return The character code to write to the LCD, or GLYPH_NO_SLOT if all 8 slots are referenced.
+*/
+uint8_t Glyph_Acquire(const uint8_t *Glyph);
+
+/** Drop a reference taken with Glyph_Acquire. The slot stays loaded until it is needed for another glyph. */
+void Glyph_Release(uint8_t Slot);
+
+/** Returns the character code of a glyph if it is loaded, or GLYPH_NO_SLOT. Does not take a reference. */
+uint8_t Glyph_Find(const uint8_t *Glyph);
+
+#endif
+
+/** @} */
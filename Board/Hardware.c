@@ -25,8 +25,6 @@
 
 #include "main.h"
 
-#define HARDWARE_TIMER_0_TOP_VALUE	124
-
 //Global variables needed for the timer
 TimeAndDate TimerStartTime;
 volatile uint16_t TimerStartMS;
@@ -39,15 +37,22 @@ volatile uint16_t ElapsedMS;
 
 //volatile uint8_t OutputTimeToLCD;
 
-volatile uint8_t ButtonInputTimeoutCount;
+//Button timers, counted down by the 1ms timer interrupt
+static volatile uint16_t ButtonDebounceMS;
+static volatile uint16_t MenuTimeoutMS;
+static volatile uint8_t MenuTimedOut;
+static volatile uint8_t ClockChanged;		//Set each second, the clock or sensor readings are drawn from the main loop
 
 
 //Stuff for the LCD menu
 //TODO: this should probably get it's own file or somthing.
 
-//Sets the timeout on the menu. After ~ 8*(1+n) seconds of no button presses, the menu will revert to the idle state
-//TODO: fix this so that 0=no menu timout, 1=8s, 2=16s, etc...
-#define LCD_BUTTON_TIMEOUT			2
+//Buttons are enabled again this long after a press
+#define LCD_BUTTON_DEBOUNCE_MS		250
+
+//After this long with no button presses the menu reverts to the idle state, 0 for no timeout.
+//The same as the old timer 1 timeout: four overflows at Fcpu/1024, 4 * 65536 * 1024 / 8MHz.
+#define LCD_MENU_TIMEOUT_MS			33554
 
 #define LCD_MENU_STATUS_IDLE		0
 #define LCD_MENU_STATUS_MAIN_MENU	1
@@ -60,10 +65,29 @@ volatile uint8_t ButtonInputTimeoutCount;
 #define LCD_MENU_BUTTON_RIGHT		4
 #define LCD_MENU_BUTTON_CENTER		5
 
+//Number of columns available for menu text, the last column is used for the navigation arrows
+#define LCD_MENU_TEXT_WIDTH			(LCDColumns-1)
+
+//What the sensor menu items show, the center button steps through them
+#define LCD_SENSOR_VIEW_NOW			0		//Latest filtered reading, then each rolling window in turn
+#define LCD_SENSOR_VIEWS			(ROLLING_WINDOWS + 1)
+#define LCD_SENSOR_NONE				0xFF
+
 //Global variables
 uint8_t LCDMenuState;		//Indicated the state of the LCD
 uint8_t LCDButtonState;		//Indicated if a button is pressed
 
+//CGRAM characters for the menu navigation arrows. These are loaded the first time a menu is drawn and kept loaded.
+static uint8_t MenuArrowLeft = GLYPH_NO_SLOT;
+static uint8_t MenuArrowRight = GLYPH_NO_SLOT;
+
+//Channel shown by the selected sensor menu item, redrawn every second
+static uint8_t SensorChannel = LCD_SENSOR_NONE;
+static uint8_t SensorView;
+static uint8_t SensorColumn;
+
+static const char SensorWindowNames[ROLLING_WINDOWS][3] PROGMEM = {"1m", "1h"};
+
 //uint8_t MinOffset;
 //uint8_t HourOffset;
 //uint8_t SecOffset;
@@ -80,13 +104,16 @@ static void GetTime_Enter(void)
 	
 	//Set up the LCD to have a blinking cursor
 	lcd_init(LCD_DISP_ON_CURSOR_BLINK);
+	LCDGeo_Init();
 	lcd_clrscr();
 	
 	GetTime(&CurrentTime);
 
 	LCDMenuState = LCD_MENU_STATUS_TIME;
-	fprintf(&LCDStream, "Set Time:\n%02u:%02u:%02u", CurrentTime.hour, CurrentTime.min, CurrentTime.sec);
-	lcd_gotoxy(0, 1);
+	lcd_puts_P("Set Time:");
+	LCDGeo_GotoXY(0, 1);
+	Format_Time(lcd_putc, CurrentTime.hour, CurrentTime.min, CurrentTime.sec);
+	LCDGeo_GotoXY(0, 1);
 	
 	return;
 }
@@ -105,21 +132,185 @@ static void Level1Item1_Select(void)
 	lcd_puts("SELECT");
 }
 
+//Write to the LCD up to the arrow column
+static void Sensor_PutChar(char c)
+{
+	if(SensorColumn < LCD_MENU_TEXT_WIDTH)
+	{
+		lcd_putc(c);
+		SensorColumn++;
+	}
+	return;
+}
+
+//Clear the rest of the line up to the arrow column and move to the start of the next
+static void Sensor_EndLine(uint8_t Line)
+{
+	while(SensorColumn < LCD_MENU_TEXT_WIDTH)
+	{
+		Sensor_PutChar(' ');
+	}
+	SensorColumn = 0;
+	LCDGeo_GotoXY(0, Line);
+	return;
+}
+
+/** Draw the selected sensor view, over the whole text area so no old characters are left. */
+static void Sensor_Draw(void)
+{
+	RollingStats Stats;
+	int16_t Value;
+	uint8_t Window;
+
+	SensorColumn = 0;
+	LCDGeo_GotoXY(0, 0);
+	if(SensorView == LCD_SENSOR_VIEW_NOW)
+	{
+		Format_Puts_p(Sensor_PutChar, Recorder_ChannelName(SensorChannel));
+		Sensor_EndLine(1);
+		if(Filter_GetValue(SensorChannel, &Value) == 0)
+		{
+			Recorder_PrintValue(Sensor_PutChar, SensorChannel, Value);
+			Format_Puts_p(Sensor_PutChar, Recorder_ChannelUnit(SensorChannel));
+		}
+		else
+		{
+			Format_Puts_P(Sensor_PutChar, "No reading");
+		}
+	}
+	else
+	{
+		//Mean on the first line, range on the second
+		Window = SensorView - 1;
+		Format_Puts_p(Sensor_PutChar, SensorWindowNames[Window]);
+		Format_Puts_P(Sensor_PutChar, " avg ");
+		if(Rolling_Get(SensorChannel, Window, &Stats) == 0)
+		{
+			Recorder_PrintValue(Sensor_PutChar, SensorChannel, Stats.Mean);
+			Sensor_EndLine(1);
+			Recorder_PrintValue(Sensor_PutChar, SensorChannel, Stats.Min);
+			Format_Puts_P(Sensor_PutChar, " - ");
+			Recorder_PrintValue(Sensor_PutChar, SensorChannel, Stats.Max);
+		}
+		else
+		{
+			Sensor_EndLine(1);
+			Format_Puts_P(Sensor_PutChar, "No readings");
+		}
+	}
+	Sensor_EndLine(1);
+	return;
+}
+
+static void Sensor_Select(uint8_t Channel)
+{
+	SensorChannel = Channel;
+	SensorView = LCD_SENSOR_VIEW_NOW;
+	Sensor_Draw();
+	return;
+}
+
+static void SensorPressure_Select(void)
+{
+	Sensor_Select(RECORDER_CHANNEL_PRESSURE);
+	return;
+}
+
+static void SensorTemperature_Select(void)
+{
+	Sensor_Select(RECORDER_CHANNEL_TEMPERATURE);
+	return;
+}
+
+static void SensorHumidity_Select(void)
+{
+	Sensor_Select(RECORDER_CHANNEL_HUMIDITY);
+	return;
+}
+
+/** The center button steps through the views of a sensor. */
+static void Sensor_Enter(void)
+{
+	SensorView++;
+	if(SensorView >= LCD_SENSOR_VIEWS)
+	{
+		SensorView = LCD_SENSOR_VIEW_NOW;
+	}
+	Sensor_Draw();
+	return;
+}
+
+/** Draw arrows in the right column of the menu to show if the item has a child (right) or parent (left) menu. */
+static void MenuDrawArrows(void)
+{
+	if(MENU_CHILD != &NULL_MENU)
+	{
+		if(MenuArrowRight == GLYPH_NO_SLOT)
+		{
+			MenuArrowRight = Glyph_Acquire(Glyph_ArrowRight);
+		}
+		LCDGeo_GotoXY(LCDColumns-1, 0);
+		lcd_putc(MenuArrowRight);
+	}
+	
+	if(MENU_PARENT != &NULL_MENU)
+	{
+		if(MenuArrowLeft == GLYPH_NO_SLOT)
+		{
+			MenuArrowLeft = Glyph_Acquire(Glyph_ArrowLeft);
+		}
+		LCDGeo_GotoXY(LCDColumns-1, 1);
+		lcd_putc(MenuArrowLeft);
+	}
+	return;
+}
+
 /** Generic function to write the text of a menu.
  *
  *  \param[in] Text   Text of the selected menu to write, in \ref MENU_ITEM_STORAGE memory space
  */
 static void Generic_Write(const char* Text)
 {
+	uint8_t Line;
+	uint8_t Length;
+	uint8_t i;
+	
+	//Stop any scrolling text from the previous menu
+	Marquee_Stop();
+	SensorChannel = LCD_SENSOR_NONE;
+	
 	if (Text)
 	{
 		lcd_clrscr();
-		lcd_puts_p(Text);
+		for(Line = 0; Line < LCDLines; Line++)
+		{
+			//Write the part of the line that fits, lines that are too long scroll
+			Length = Marquee_LineLength(Text);
+			LCDGeo_GotoXY(0, Line);
+			for(i = 0; (i < Length) && (i < LCD_MENU_TEXT_WIDTH); i++)
+			{
+				lcd_data(pgm_read_byte(Text + i));
+			}
+			if(Length > LCD_MENU_TEXT_WIDTH)
+			{
+				Marquee_Start(Text, Line, LCD_MENU_TEXT_WIDTH);
+			}
+			
+			Text += Length;
+			if(pgm_read_byte(Text) != '\n')
+			{
+				break;
+			}
+			Text++;
+		}
+		MenuDrawArrows();
 	}
 }
 
 void LCDMenuButtonPressed(uint8_t Button)
 {
+	Trace_Event(TRACE_EVENT_BUTTON, Button, LCDMenuState);
+	Backlight_Wake();
 	if(LCDButtonState == LCD_MENU_BUTTON_NONE)
 	{
 		LCDButtonState = Button;
@@ -132,12 +323,17 @@ void LCDMenuButtonPressed(uint8_t Button)
 
 
 //MENU_ITEM(Name, Next, Previous, Parent, Child, SelectFunc, EnterFunc, Text)
-MENU_ITEM(Menu_1, Menu_2, Menu_3, NULL_MENU, Menu_1_1,  NULL, NULL, "Menu\nItem 1");
+MENU_ITEM(Menu_1, Menu_2, Menu_4, NULL_MENU, Menu_1_1,  NULL, NULL, "Menu\nItem 1");
 MENU_ITEM(Menu_2, Menu_3, Menu_1, NULL_MENU, NULL_MENU, NULL, GetTime_Enter, "Menu\nSet Time");
-MENU_ITEM(Menu_3, Menu_1, Menu_2, NULL_MENU, NULL_MENU, NULL, Jump_To_Bootloader, "Menu\nDFU Mode");
+MENU_ITEM(Menu_3, Menu_4, Menu_2, NULL_MENU, NULL_MENU, NULL, Jump_To_Bootloader, "Menu\nDFU Mode");
+MENU_ITEM(Menu_4, Menu_1, Menu_3, NULL_MENU, Menu_4_1, NULL, NULL, "Menu\nSensors");
 
 MENU_ITEM(Menu_1_1, Menu_1_2, Menu_1_2, Menu_1, NULL_MENU, NULL, NULL, "1.1");
-MENU_ITEM(Menu_1_2, Menu_1_1, Menu_1_1, Menu_1, NULL_MENU, NULL, NULL, "Jon is funny\n  looking!");
+MENU_ITEM(Menu_1_2, Menu_1_1, Menu_1_1, Menu_1, NULL_MENU, NULL, NULL, "Jon is funny looking!");
+
+MENU_ITEM(Menu_4_1, Menu_4_2, Menu_4_3, Menu_4, NULL_MENU, SensorPressure_Select, Sensor_Enter, "Pressure");
+MENU_ITEM(Menu_4_2, Menu_4_3, Menu_4_1, Menu_4, NULL_MENU, SensorTemperature_Select, Sensor_Enter, "Temperature");
+MENU_ITEM(Menu_4_3, Menu_4_1, Menu_4_2, Menu_4, NULL_MENU, SensorHumidity_Select, Sensor_Enter, "Humidity");
 
 /****************************************************************/
 
@@ -178,10 +374,17 @@ void HardwareInit( void )
 	TimerRunning = 0;
 	
 	
-	ButtonInputTimeoutCount = 0;
+	ButtonDebounceMS = 0;
+	MenuTimeoutMS = 0;
+	MenuTimedOut = 0;
+	ClockChanged = 0;
+	SensorChannel = LCD_SENSOR_NONE;
 	LCDMenuState = LCD_MENU_STATUS_IDLE;
 	LCDButtonState = LCD_MENU_BUTTON_NONE;
 	
+	Scheduler_Init();
+	Recorder_Init();
+	
 	//Disable watchdog if enabled by bootloader/fuses
 	MCUSR &= ~(1 << WDRF);
 	wdt_disable();
@@ -206,17 +409,8 @@ void HardwareInit( void )
 	OCR0A = HARDWARE_TIMER_0_TOP_VALUE;
 	
 	
-	//Setup timer 1 for switch debouncing
-	//Normal Mode
-	//Clock is Fcpu/1024
-	//OCR0A interrupt ~every 250ms
-	TCCR1A = 0x00;
-	TCCR1B = 0x00;
-	TCNT1H = 0x00;		//clear the timer
-	TCNT1L = 0x00;
-	TIMSK1 = 0x03;
-	OCR1AH = 0x07;
-	OCR1AL = 0xA1;
+	//Timer 1 clocks the I2C bus, set up by SoftI2C_Init
+	//Button debouncing and the menu timeout run on the 1ms interrupt
 	
 	//Enable interrupts globally
 	sei();
@@ -224,16 +418,20 @@ void HardwareInit( void )
 	//Setup GPIO Pins
 	
 	//PORT B:
-	//	0: Dataflash CS line			(Out, high)
-	//	4: Pressure sensor CS line		(Out, high)
-	//	6: Backlight control			(Out, high)
+	//	0: Dataflash CS line			(Out, high, set up by SPI_Init)
+	//	1-3: SPI SCK, MOSI, MISO		(set up by SPI_Init)
+	//	4: Pressure sensor CS line		(Out, high, set up by SPI_Init)
+	//	0-5: LCD data, RW and RS		(shared with the SPI, see SPI_LcdBegin)
+	//	6: Backlight control			(Out, PWM, see Backlight.c)
+	//	7: I2C SCL						(Open drain, set up by SoftI2C_Init)
 	DDRB	= (1<<6);
-	PORTB	= (1<<6);
+	PORTB	= 0x00;
 	
 	//PORT C:
 	//	4: Config line 1			(Input, pullup)
 	//	5: Config line 2			(Input, pullup)
-	//	7: Light sensor interrupt 	(Input, pullup)
+	//	6: I2C SDA					(Open drain, set up by SoftI2C_Init)
+	//	7: Light sensor interrupt 	(Input, pullup, set up by Backlight_Init)
 	//DDRC	= 0x00;
 	//PORTC	= (1<<4) | (1<<5) | (1<<7);
 	
@@ -243,10 +441,15 @@ void HardwareInit( void )
 	//DDRD	= (1<<2);
 	//PORTD	= 0x00;
 
+	LineEdit_Init();
 	USB_Init();
 	
-	//Initalize LCD
+	//Initalize LCD, the size and controller type come from the settings
+	Settings_Load();
+	Backlight_Init();
 	lcd_init(LCD_DISP_ON);
+	LCDGeo_Init();
+	Glyph_Init();
 	
 	//clear display and home cursor
 	lcd_clrscr();
@@ -257,6 +460,35 @@ void HardwareInit( void )
 	Menu_SetGenericWriteCallback(Generic_Write);
 	//Menu_Navigate(&Menu_1);
 	
+	//Sensor readings are filtered and summed up on their way to the recorder
+	Filter_Init();
+	Rolling_Init();
+	
+	//Recorded data goes to the dataflash, if there is one
+	SPI_Init();
+	if(LogStore_Init() == 0)
+	{
+		Recorder_SetBackend(LogStore_RecorderBackend);
+	}
+	else
+	{
+		Recorder_SetBackend(NULL);
+		LOG_WARN("No dataflash");
+	}
+	
+	//Pressure readings go to the recorder
+	if((MPL115A1_Init() != 0) || (MPL115A1_SetPeriod(MPL115A1_PERIOD) != 0))
+	{
+		LOG_WARN("No pressure sensor");
+	}
+	
+	//So are temperature and humidity
+	SoftI2C_Init();
+	if((SHT25_Init() != 0) || (SHT25_SetPeriod(SHT25_PERIOD) != 0))
+	{
+		LOG_WARN("No humidity sensor");
+	}
+	
 	
 	return;
 }
@@ -312,10 +544,10 @@ void EnableButtons(void)
 	PORTD |= 0x33;		//Enable pullups on PD0, PD1, PD4, and PD5
 	
 	EICRA = 0x0A;		//INT0 and INT1 trigger on falling edge
-	EICRB = 0x08;		//INT5 trigger on falling edge
+	EICRB = (EICRB & 0x03) | 0x08;		//INT5 trigger on falling edge, INT4 is the light sensor
 	
-	EIFR = 0xFF;		//Clear all interrupts
-	EIMSK = 0x23;		//Enable INT0, INT1, INT5
+	EIFR = ~(1<<INTF4);		//Clear all button interrupts
+	EIMSK = (EIMSK & (1<<INT4)) | 0x23;		//Enable INT0, INT1, INT5
 	
 	PCMSK1 = 0x18;		//Unmask PCINT11 and PCINT12
 	PCIFR = 0x03;		//Clear pin change interrupts
@@ -326,21 +558,32 @@ void EnableButtons(void)
 
 void DisableButtons(void)
 {
-	EIMSK = 0x00;		//Disable interrupts
+	EIMSK &= (1<<INT4);		//Disable button interrupts
 	PCICR = 0x00;		//Disable pin change interrupts
 	
-	EIFR = 0xFF;		//Clear all interrupts
+	EIFR = ~(1<<INTF4);		//Clear all button interrupts
 	PCIFR = 0x03;		//Clear pin change interrupts
 	return;
 }
 
 void StartDebounceTimer(void)
 {
-	ButtonInputTimeoutCount = 0;
-	TCCR1B &= 0xF8;		//Stop the timer (if it is running)
-	TCNT1H = 0x00;		//clear the timer
-	TCNT1L = 0x00;
-	TCCR1B |= 0x05;		//Start timer 1 for debouncing
+	ButtonDebounceMS = LCD_BUTTON_DEBOUNCE_MS;
+	MenuTimeoutMS = LCD_MENU_TIMEOUT_MS;
+	return;
+}
+
+//Called from the 1ms timer interrupt
+static void ButtonTimers_Tick(void)
+{
+	if((ButtonDebounceMS > 0) && (--ButtonDebounceMS == 0))
+	{
+		EnableButtons();
+	}
+	if((MenuTimeoutMS > 0) && (--MenuTimeoutMS == 0))
+	{
+		MenuTimedOut = 1;
+	}
 	return;
 }
 
@@ -397,7 +640,7 @@ void SetTime( TimeAndDate TimeToSet )
 	}
 	
 	//Check for leap year, and determine how many days per month.
-	if(TheTime.month == 4)
+	if(TheTime.month == 2)
 	{
 		if(IsLeapYear(TheTime.year) == 1)
 		{
@@ -453,7 +696,13 @@ void StopTimer(void)
 		TimerEndTime.sec = TheTime.sec;
 		TimerEndMS = ElapsedMS;
 		TimerEndRemainder = TCNT0;
-		printf_P(PSTR("Time: %02u sec %04u ms %04u us\n"), TimerEndTime.sec-TimerStartTime.sec, TimerEndMS-TimerStartMS , (HARDWARE_TIMER_0_TOP_VALUE - TimerRemainder) + TimerEndRemainder);
+		Format_Puts_P(Console_PutChar, "Time: ");
+		Format_Dec2(Console_PutChar, TimerEndTime.sec-TimerStartTime.sec);
+		Format_Puts_P(Console_PutChar, " sec ");
+		Format_UInt(Console_PutChar, TimerEndMS-TimerStartMS, 4, '0');
+		Format_Puts_P(Console_PutChar, " ms ");
+		Format_UInt(Console_PutChar, (HARDWARE_TIMER_0_TOP_VALUE - TimerRemainder) + TimerEndRemainder, 4, '0');
+		Format_Puts_P(Console_PutChar, " us\n");
 		//Reset the timer value
 		TimerRunning = 0;
 	}
@@ -471,7 +720,7 @@ uint8_t DaysPerMonth(uint8_t MonthNumber)
 	{
 		return 28;
 	}
-	else if((MonthNumber == 4) ||(MonthNumber == 6) ||(MonthNumber == 9) ||(MonthNumber == 12))
+	else if((MonthNumber == 4) ||(MonthNumber == 6) ||(MonthNumber == 9) ||(MonthNumber == 11))
 	{
 		return 30;
 	}
@@ -506,6 +755,34 @@ uint8_t IsLeapYear(uint16_t TheYear)
 	return 0;
 }
 
+uint32_t TimeToSeconds(const TimeAndDate *Time)
+{
+	uint32_t Days = 0;
+	uint16_t Year;
+	uint8_t Month;
+	
+	if((Time->year < 2000) || (Time->day == 0))
+	{
+		return 0;
+	}
+	
+	for(Year = 2000; Year < Time->year; Year++)
+	{
+		Days += 365 + IsLeapYear(Year);
+	}
+	for(Month = 1; Month < Time->month; Month++)
+	{
+		Days += DaysPerMonth(Month);
+		if(Month == 2)
+		{
+			Days += IsLeapYear(Time->year);
+		}
+	}
+	Days += Time->day - 1;
+	
+	return (((Days * 24) + Time->hour) * 60 + Time->min) * 60 + Time->sec;
+}
+
 /*Button:
  * 1 - left
  * 2 - right
@@ -519,6 +796,7 @@ void HandleButtonPress(void)
 	uint8_t temp1;
 	int8_t temp2;
 	uint8_t temp3;
+	uint8_t EditBase;
 	
 	TimeAndDate TimeToSet;
 	
@@ -529,6 +807,29 @@ void HandleButtonPress(void)
 	
 	
 	
+	//Port B is only given to the LCD when there is something to draw, the queued SPI and I2C transfers run the rest of the time
+	if((MenuTimedOut == 0) && (LCDButtonState == LCD_MENU_BUTTON_NONE) && (ClockChanged == 0))
+	{
+		return;
+	}
+	SPI_LcdBegin();
+	
+	//The timeout is noticed by the 1ms interrupt, the LCD is only written from here
+	if(MenuTimedOut)
+	{
+		MenuTimedOut = 0;
+		Trace_Event(TRACE_EVENT_MENU_TIMEOUT, 0, 0);
+		
+		//Switch LCD back to idle state
+		Marquee_Stop();
+		lcd_init(LCD_DISP_ON);
+		LCDGeo_Init();
+		lcd_clrscr();
+		BigClock_Start(&TheTime);
+		Backlight_Idle();
+		LCDMenuState = LCD_MENU_STATUS_IDLE;
+	}
+	
 	if(LCDButtonState != LCD_MENU_BUTTON_NONE)
 	{
 	//uint8_t LCD_Pos;
@@ -538,6 +839,7 @@ void HandleButtonPress(void)
 		if(LCDMenuState == LCD_MENU_STATUS_IDLE)
 		{
 			LCDMenuState = LCD_MENU_STATUS_MAIN_MENU;
+			BigClock_Stop();
 			lcd_clrscr();
 			Menu_Navigate(&Menu_1);
 		}
@@ -561,64 +863,66 @@ void HandleButtonPress(void)
 			}
 			else if(LCDButtonState == LCD_MENU_BUTTON_CENTER)
 			{
+				Marquee_Stop();
 				Menu_EnterCurrentItem();
 			}
 		}
 		else if(LCDMenuState == LCD_MENU_STATUS_TIME)
 		{
-			//Read the currently selected address
-			temp1 = lcd_getcurrentaddress();
+			//Read the currently selected position in the time, the time is at the start of the second line
+			EditBase = LCD_ADDRESS(0, 1);
+			temp1 = lcd_getcurrentaddress() - EditBase;
 			
 			//Read the current value of the selected section
-			if((temp1 == 0x42) || (temp1 == 0x45))
+			if((temp1 == 2) || (temp1 == 5))
 			{
 				temp2 = 0xFF;
 			}
-			else if(temp1 < 0x42)	//Hours
+			else if(temp1 < 2)	//Hours
 			{
-				temp2 = (lcd_getcharacterataddress(0x40)-0x30)*10 + (lcd_getcharacterataddress(0x41)-0x30);
+				temp2 = (lcd_getcharacterataddress(EditBase+0)-0x30)*10 + (lcd_getcharacterataddress(EditBase+1)-0x30);
 			}
-			else if(temp1 < 0x45)	//Minutes
+			else if(temp1 < 5)	//Minutes
 			{
-				temp2 = (lcd_getcharacterataddress(0x43)-0x30)*10 + (lcd_getcharacterataddress(0x44)-0x30);
+				temp2 = (lcd_getcharacterataddress(EditBase+3)-0x30)*10 + (lcd_getcharacterataddress(EditBase+4)-0x30);
 			}
 			else					//Seconds
 			{
-				temp2 = (lcd_getcharacterataddress(0x46)-0x30)*10 + (lcd_getcharacterataddress(0x47)-0x30);
+				temp2 = (lcd_getcharacterataddress(EditBase+6)-0x30)*10 + (lcd_getcharacterataddress(EditBase+7)-0x30);
 			}
-			lcd_gotoaddress(temp1);
-			printf("addr is 0x%02X value is %u\n", temp1, temp2);
+			lcd_gotoaddress(EditBase+temp1);
+			Trace_Event(TRACE_EVENT_TIME_EDIT, EditBase+temp1, (uint8_t)temp2);
 			
 			if(LCDButtonState == LCD_MENU_BUTTON_LEFT)
 			{
 				//temp1 = lcd_getcurrentaddress();
-				if(temp1 > 0x40)
+				if(temp1 > 0)
 				{
-					lcd_gotoxy(temp1-0x40-1, 1);
+					LCDGeo_GotoXY(temp1-1, 1);
 					temp1--;
 				}
-				if((temp1 == 0x42) || (temp1 == 0x45))
+				if((temp1 == 2) || (temp1 == 5))
 				{
-					lcd_gotoxy(temp1-0x40-1, 1);
+					LCDGeo_GotoXY(temp1-1, 1);
 				}
 			}
 			else if(LCDButtonState == LCD_MENU_BUTTON_RIGHT)
 			{
 				//temp1 = lcd_getcurrentaddress();
 				
-				if(temp1 < 0x47)
+				if(temp1 < 7)
 				{
-					lcd_gotoxy(temp1-0x40+1, 1);
+					LCDGeo_GotoXY(temp1+1, 1);
 					temp1++;
 				}
-				if((temp1 == 0x42) || (temp1 == 0x45))
+				if((temp1 == 2) || (temp1 == 5))
 				{
-					lcd_gotoxy(temp1-0x40+1, 1);
+					LCDGeo_GotoXY(temp1+1, 1);
 				}
 			}
 			else if(LCDButtonState == LCD_MENU_BUTTON_UP)
 			{
-				if(temp1 == 0x40)		//good
+				if(temp1 == 0)		//good
 				{
 					temp2 += 10;
 					if(temp2 > 23)
@@ -630,7 +934,7 @@ void HandleButtonPress(void)
 						}
 					}
 				}
-				else if(temp1 == 0x41)	//good
+				else if(temp1 == 1)	//good
 				{
 					temp2 += 1;
 					if(temp2 > 23)
@@ -638,7 +942,7 @@ void HandleButtonPress(void)
 						temp2 = temp2 - 24;
 					}
 				}
-				else if((temp1 == 0x43) || (temp1 == 0x46))
+				else if((temp1 == 3) || (temp1 == 6))
 				{
 					temp2 += 10;
 					if(temp2 > 59)
@@ -646,7 +950,7 @@ void HandleButtonPress(void)
 						temp2 = temp2 - 60;
 					}
 				}
-				else if((temp1 == 0x44) || (temp1 == 0x47))
+				else if((temp1 == 4) || (temp1 == 7))
 				{
 					temp2 += 1;
 					if(temp2 > 59)
@@ -656,32 +960,33 @@ void HandleButtonPress(void)
 				}
 				
 				//temp2 is now the new value
-				printf("Writing %u to addr 0x%02X\n", temp2, temp1);
-				if(temp1 < 0x42)
+				Format_Puts_P(Console_PutChar, "Writing ");
+				Format_UInt(Console_PutChar, temp2, 0, ' ');
+				Format_Puts_P(Console_PutChar, " to addr 0x");
+				Format_Hex2(Console_PutChar, EditBase+temp1);
+				Console_PutChar('\n');
+				if(temp1 < 2)
 				{
-					printf("a\n");
-					lcd_gotoaddress(0x40);
-					fprintf(&LCDStream, "%02u", temp2);
-					lcd_gotoaddress(temp1);
+					lcd_gotoaddress(EditBase+0);
+					Format_Dec2(lcd_putc, temp2);
+					lcd_gotoaddress(EditBase+temp1);
 				}
-				else if(temp1 < 0x45)
+				else if(temp1 < 5)
 				{
-					printf("b\n");
-					lcd_gotoaddress(0x43);
-					fprintf(&LCDStream, "%02u", temp2);
-					lcd_gotoaddress(temp1);
+					lcd_gotoaddress(EditBase+3);
+					Format_Dec2(lcd_putc, temp2);
+					lcd_gotoaddress(EditBase+temp1);
 				}
 				else
 				{
-					printf("c\n");
-					lcd_gotoaddress(0x46);
-					fprintf(&LCDStream, "%02u", temp2);
-					lcd_gotoaddress(temp1);
+					lcd_gotoaddress(EditBase+6);
+					Format_Dec2(lcd_putc, temp2);
+					lcd_gotoaddress(EditBase+temp1);
 				}
 			}	
 			else if(LCDButtonState == LCD_MENU_BUTTON_DOWN)
 			{
-				if(temp1 == 0x40)
+				if(temp1 == 0)
 				{
 					temp2 -= 10;
 					if(temp2 < 0)
@@ -693,7 +998,7 @@ void HandleButtonPress(void)
 						}
 					}
 				}
-				else if(temp1 == 0x41)	//good
+				else if(temp1 == 1)	//good
 				{
 					temp2 -= 1;
 					if(temp2 < 0)
@@ -701,7 +1006,7 @@ void HandleButtonPress(void)
 						temp2 = temp2 + 24;
 					}
 				}
-				else if((temp1 == 0x43) || (temp1 == 0x46))
+				else if((temp1 == 3) || (temp1 == 6))
 				{
 					temp2 -= 10;
 					if(temp2 < 0)
@@ -709,7 +1014,7 @@ void HandleButtonPress(void)
 						temp2 = temp2 + 60;
 					}
 				}
-				else if((temp1 == 0x44) || (temp1 == 0x47))
+				else if((temp1 == 4) || (temp1 == 7))
 				{
 					temp2 -= 1;
 					if(temp2 < 0)
@@ -719,33 +1024,37 @@ void HandleButtonPress(void)
 				}
 				
 				//temp2 is now the new value
-				printf("Writing %u to addr 0x%02X\n", temp2, temp1);
-				if(temp1 < 0x42)
+				Format_Puts_P(Console_PutChar, "Writing ");
+				Format_UInt(Console_PutChar, temp2, 0, ' ');
+				Format_Puts_P(Console_PutChar, " to addr 0x");
+				Format_Hex2(Console_PutChar, EditBase+temp1);
+				Console_PutChar('\n');
+				if(temp1 < 2)
 				{
-					lcd_gotoaddress(0x40);
-					fprintf(&LCDStream, "%02u", temp2);
-					lcd_gotoaddress(temp1);
+					lcd_gotoaddress(EditBase+0);
+					Format_Dec2(lcd_putc, temp2);
+					lcd_gotoaddress(EditBase+temp1);
 				}
-				else if(temp1 < 0x45)
+				else if(temp1 < 5)
 				{
-					lcd_gotoaddress(0x43);
-					fprintf(&LCDStream, "%02u", temp2);
-					lcd_gotoaddress(temp1);
+					lcd_gotoaddress(EditBase+3);
+					Format_Dec2(lcd_putc, temp2);
+					lcd_gotoaddress(EditBase+temp1);
 				}
 				else
 				{
-					lcd_gotoaddress(0x46);
-					fprintf(&LCDStream, "%02u", temp2);
-					lcd_gotoaddress(temp1);
+					lcd_gotoaddress(EditBase+6);
+					Format_Dec2(lcd_putc, temp2);
+					lcd_gotoaddress(EditBase+temp1);
 				}
 			}
 			else if(LCDButtonState == LCD_MENU_BUTTON_CENTER)
 			{
 				
 				GetTime(&TimeToSet);
-				TimeToSet.hour = (lcd_getcharacterataddress(0x40)-0x30)*10 + (lcd_getcharacterataddress(0x41)-0x30);
-				TimeToSet.min = (lcd_getcharacterataddress(0x43)-0x30)*10 + (lcd_getcharacterataddress(0x44)-0x30);
-				TimeToSet.sec = (lcd_getcharacterataddress(0x46)-0x30)*10 + (lcd_getcharacterataddress(0x47)-0x30);
+				TimeToSet.hour = (lcd_getcharacterataddress(EditBase+0)-0x30)*10 + (lcd_getcharacterataddress(EditBase+1)-0x30);
+				TimeToSet.min = (lcd_getcharacterataddress(EditBase+3)-0x30)*10 + (lcd_getcharacterataddress(EditBase+4)-0x30);
+				TimeToSet.sec = (lcd_getcharacterataddress(EditBase+6)-0x30)*10 + (lcd_getcharacterataddress(EditBase+7)-0x30);
 				SetTime(TimeToSet);
 				LCDMenuState = LCD_MENU_STATUS_MAIN_MENU;
 				
@@ -753,36 +1062,68 @@ void HandleButtonPress(void)
 		}
 	}
 	LCDButtonState = LCD_MENU_BUTTON_NONE;
+	
+	//Put the time on the LCD here rather than in the timer interrupt, which could land in the middle of an SPI transfer on port B
+	if(ClockChanged)
+	{
+		ClockChanged = 0;
+		if(LCDMenuState == LCD_MENU_STATUS_IDLE)
+		{
+			GetTime(&TimeToSet);
+			if(BigClock_Running() == 0)
+			{
+				//First second after power up
+				lcd_clrscr();
+				BigClock_Start(&TimeToSet);
+			}
+			else
+			{
+				BigClock_Update(&TimeToSet);
+			}
+		}
+		else if((LCDMenuState == LCD_MENU_STATUS_MAIN_MENU) && (SensorChannel != LCD_SENSOR_NONE))
+		{
+			Sensor_Draw();
+		}
+	}
+	SPI_LcdEnd();
 	return;
 }
 
 
 ISR(INT0_vect)
 {
+	ISRStats_Enter(ISRSTATS_INT0);
 	DisableButtons();
 	StartDebounceTimer();
 	LCDMenuButtonPressed(LCD_MENU_BUTTON_LEFT);
 	//HandleButtonPress(LCD_MENU_BUTTON_LEFT);	//Left
+	ISRStats_Exit(ISRSTATS_INT0);
 }
 
 ISR(INT1_vect)
 {
+	ISRStats_Enter(ISRSTATS_INT1);
 	DisableButtons();
 	StartDebounceTimer();
 	LCDMenuButtonPressed(LCD_MENU_BUTTON_UP);
 	//HandleButtonPress(LCD_MENU_BUTTON_UP);	//Up
+	ISRStats_Exit(ISRSTATS_INT1);
 }
 
 ISR(INT5_vect)
 {
+	ISRStats_Enter(ISRSTATS_INT5);
 	DisableButtons();
 	StartDebounceTimer();
 	LCDMenuButtonPressed(LCD_MENU_BUTTON_CENTER);
 	//HandleButtonPress(LCD_MENU_BUTTON_CENTER);	//Center
+	ISRStats_Exit(ISRSTATS_INT5);
 }
 
 ISR(PCINT1_vect)
 {
+	ISRStats_Enter(ISRSTATS_PCINT1);
 	if((PINC & 0x04) == 0x00)
 	{
 		DisableButtons();
@@ -797,51 +1138,39 @@ ISR(PCINT1_vect)
 		LCDMenuButtonPressed(LCD_MENU_BUTTON_RIGHT);
 		//HandleButtonPress(LCD_MENU_BUTTON_RIGHT);	//Right
 	}
-}
-
-//Timer 1 is used for debouncing
-//This timer is started when a button is pressed
-//This interrupt will trigger 250ms later, and re-enable the buttons
-ISR(TIMER1_COMPA_vect)
-{
-	EnableButtons();
-}
-
-ISR(TIMER1_OVF_vect)
-{
-	if(ButtonInputTimeoutCount > LCD_BUTTON_TIMEOUT)
-	{
-		TCCR1B &= 0xF8;		//Disable timer 1
-		
-		//Switch LCD back to idle state
-		lcd_init(LCD_DISP_ON);
-		lcd_clrscr();
-		lcd_puts("Idle\n");
-		ButtonInputTimeoutCount = 0;
-		LCDMenuState = 0;
-	}
-	else
-	{
-		ButtonInputTimeoutCount++;
-	}
+	ISRStats_Exit(ISRSTATS_PCINT1);
 }
 
 //Timer interrupt 0 for basic timing stuff
 ISR(TIMER0_COMPA_vect)
 {
 	uint16_t inByte;
-	ElapsedMS++;
 	uint8_t DPM;
 	
+	//Read TCNT0 before anything else, it gives the latency of this interrupt
+	ISRStats_Enter(ISRSTATS_TIMER0_COMPA);
+	ElapsedMS++;
+	Trace_Tick();
+	
+	//Next, so the backlight PWM edge has as little jitter as possible
+	Backlight_Tick();
+	ButtonTimers_Tick();
+	Scheduler_Tick();
+	Recorder_Tick();
+	
 	//Handle USB stuff
 	//This happens every ~8 ms
 	if( ((ElapsedMS & 0x0007) == 0x0000) )
 	{
-		//receive and process a character from the USB CDC interface
-		inByte = CDC_Device_ReceiveByte(&VirtualSerial_CDC_Interface);
-		if((inByte > 0) && (inByte < 255))
+		//Receive a character from the USB CDC interface, the main loop edits the line.
+		//It stays in the endpoint while the main loop is behind.
+		if(!LineEdit_QueueFull())
 		{
-			CommandGetInputChar(inByte);	//NOTE: this limits the device to recieve a single character every 8ms (I think). This should not be a problem for user input.
+			inByte = CDC_Device_ReceiveByte(&VirtualSerial_CDC_Interface);
+			if((inByte > 0) && (inByte < 255))
+			{
+				LineEdit_Queue(inByte);	//NOTE: this limits the device to recieve a single character every 8ms (I think). This should not be a problem for user input.
+			}
 		}
 		
 		CDC_Device_USBTask(&VirtualSerial_CDC_Interface);
@@ -851,6 +1180,7 @@ ISR(TIMER0_COMPA_vect)
 	if(ElapsedMS >= 1000)
 	{
 		ElapsedMS = 0;
+		Rolling_Second();
 		TheTime.sec += 1;
 		if(TheTime.sec > 59)
 		{
@@ -860,9 +1190,9 @@ ISR(TIMER0_COMPA_vect)
 			{
 				TheTime.min = 0;
 				TheTime.hour += 1;
-				if(TheTime.hour > 24)
+				if(TheTime.hour > 23)
 				{
-					TheTime.hour = 1;
+					TheTime.hour = 0;
 					TheTime.day += 1;
 					
 					//Determine the number of days in the month.
@@ -883,30 +1213,18 @@ ISR(TIMER0_COMPA_vect)
 					}
 					if(TheTime.day > DPM)
 					{
-						TheTime.day = 0;
+						TheTime.day = 1;
 						TheTime.month += 1;
 						if(TheTime.month > 12)
 						{
-							TheTime.month = 0;
+							TheTime.month = 1;
 							TheTime.year += 1;
 						}
 					}
 				}
 			}
 		}
-	//put time on the lcd screen
-	if(LCDMenuState == LCD_MENU_STATUS_IDLE)
-	{
-		lcd_gotoxy(0, 1);
-		if(TheTime.hour > 12)
-		{
-			fprintf(&LCDStream, "%02u:%02u:%02u PM\n", TheTime.hour-12, TheTime.min, TheTime.sec);
-		}
-		else
-		{
-			fprintf(&LCDStream, "%02u:%02u:%02u AM\n", TheTime.hour, TheTime.min, TheTime.sec);
-		}
-	}
+	ClockChanged = 1;
 	/*else if (LCDMenuState == LCD_MENU_STATUS_TIME)
 	{
 		lcd_gotoxy(0, 1);
@@ -916,6 +1234,7 @@ ISR(TIMER0_COMPA_vect)
 	
 	
 	}
+	ISRStats_Exit(ISRSTATS_TIMER0_COMPA);
 }
 
 /** @} */
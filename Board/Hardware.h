@@ -28,6 +28,12 @@
 #ifndef _HARDWARE_H_
 #define _HARDWARE_H_
 
+//Timer 0 counts to this value and restarts every 1ms, at 8us per count
+#define HARDWARE_TIMER_0_TOP_VALUE	124
+
+//Milliseconds into the current second, counted by the timer 0 interrupt
+extern volatile uint16_t ElapsedMS;
+
 /** initalizes the hardware used for the environmental sensor
 *	- GPIO directions.
 *	- Timer 0 interrupts every 1ms for timing functions.
@@ -74,6 +80,9 @@ uint8_t IsLeapYear(uint16_t TheYear);
 //Returns the number of days in the month. Will always return 28 for February, aditional checks will be needed to correct for leap years.
 uint8_t DaysPerMonth(uint8_t MonthNumber);
 
+//Returns the number of seconds from 1/1/2000 00:00:00 to the time, or 0 for times before that
+uint32_t TimeToSeconds(const TimeAndDate *Time);
+
 #endif
 
 /** @} */
@@ -0,0 +1,212 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		I2C bus scan.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+#define I2CSCAN_NAME_LENGTH			8
+#define I2CSCAN_MINUTE				(60000UL * (HARDWARE_TIMER_0_TOP_VALUE + 1))	//Timer 0 counts
+
+/** A device that can be at First to Last, and is known by the ID register
+*	reading Match in the bits of Mask.
+*/
+typedef struct
+{
+	uint8_t First;
+	uint8_t Last;
+	uint8_t Register;				//Byte written before the read, for some devices with a command bit
+	uint8_t Mask;
+	uint8_t Match;
+	char Name[I2CSCAN_NAME_LENGTH];
+} I2CScanDevice;
+
+//The first device that matches is used, so the more exact matches go first
+static const I2CScanDevice I2CScanDevices[] PROGMEM =
+{
+	{ 0x18, 0x1F, 0x07, 0xFF, 0x04, "MCP9808" },		//Device ID
+	{ 0x1E, 0x1E, 0x0A, 0xFF, 0x48, "HMC5883" },		//Identification A, 'H'
+	{ 0x29, 0x29, 0xB2, 0xFF, 0x50, "TSL2591" },		//ID register
+	{ 0x29, 0x29, 0x8A, 0xF0, 0x50, "TSL2561" },		//ID register, the part number
+	{ 0x39, 0x39, 0x8A, 0xF0, 0x50, "TSL2561" },
+	{ 0x49, 0x49, 0x8A, 0xF0, 0x50, "TSL2561" },
+	{ 0x40, 0x40, 0xE7, 0x38, 0x38, "SHT2x" },			//User register, the reserved bits are set
+	{ 0x76, 0x77, 0xD0, 0xFF, 0x55, "BMP180" },			//Chip ID
+	{ 0x76, 0x77, 0xD0, 0xFF, 0x58, "BMP280" },
+	{ 0x76, 0x77, 0xD0, 0xFF, 0x60, "BME280" },
+};
+
+#define I2CSCAN_DEVICES			(sizeof(I2CScanDevices) / sizeof(I2CScanDevice))
+
+//Time into the minute in timer 0 counts
+static uint32_t I2CScan_Now(void)
+{
+	TimeAndDate Now;
+	uint16_t Milliseconds;
+	uint8_t Count;
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	GetTime(&Now);
+	Milliseconds = ElapsedMS;
+	Count = TCNT0;
+
+	//The timer went past the top but the interrupt has not counted it yet
+	if(((TIFR0 & (1<<OCF0A)) != 0) && (Count < (HARDWARE_TIMER_0_TOP_VALUE / 2)))
+	{
+		Milliseconds++;
+	}
+	SREG = sreg;
+	return ((uint32_t)Now.sec * 1000 + Milliseconds) * (HARDWARE_TIMER_0_TOP_VALUE + 1) + Count;
+}
+
+uint8_t I2CScan_Run(uint8_t HalfBitUS, I2CScanResult *Result)
+{
+	SoftI2CStats Before;
+	SoftI2CStats After;
+	uint8_t OldHalfBit = SoftI2C_GetHalfBit();
+	uint8_t Address;
+	uint8_t Status;
+	uint32_t Start;
+	uint32_t Counts;
+
+	if(SoftI2C_SetHalfBit(HalfBitUS) != 0)
+	{
+		return 1;
+	}
+
+	memset(Result, 0, sizeof(I2CScanResult));
+	Result->HalfBit = HalfBitUS;
+
+	SoftI2C_GetStats(&Before);
+	Start = I2CScan_Now();
+	for(Address = I2CSCAN_FIRST_ADDRESS; Address <= I2CSCAN_LAST_ADDRESS; Address++)
+	{
+		Status = SoftI2C_Transfer(Address, NULL, 0, NULL, 0);
+		Result->Probes++;
+		if(Status == SOFTI2C_STATUS_OK)
+		{
+			Result->Found[Address >> 3] |= (1 << (Address & 0x07));
+			Result->Devices++;
+		}
+		else if(Status != SOFTI2C_STATUS_ADDRESS_NACK)
+		{
+			//The bus is stuck, every other address would fail the same way
+			Result->Status = Status;
+			break;
+		}
+	}
+	Counts = (I2CScan_Now() + I2CSCAN_MINUTE - Start) % I2CSCAN_MINUTE;
+	SoftI2C_GetStats(&After);
+
+	Result->TimeUS = Counts * (1000 / (HARDWARE_TIMER_0_TOP_VALUE + 1));
+	Result->StretchTicks = After.StretchTicks - Before.StretchTicks;
+	SoftI2C_SetHalfBit(OldHalfBit);
+	return 0;
+}
+
+uint8_t I2CScan_Found(const I2CScanResult *Result, uint8_t Address)
+{
+	return (Result->Found[(Address >> 3) & 0x0F] & (1 << (Address & 0x07))) != 0;
+}
+
+const char *I2CScan_Identify(uint8_t Address)
+{
+	uint8_t i;
+	uint8_t Register;
+	uint8_t Value;
+
+	for(i = 0; i < I2CSCAN_DEVICES; i++)
+	{
+		if((Address < pgm_read_byte(&I2CScanDevices[i].First)) || (Address > pgm_read_byte(&I2CScanDevices[i].Last)))
+		{
+			continue;
+		}
+
+		Register = pgm_read_byte(&I2CScanDevices[i].Register);
+		if(SoftI2C_Transfer(Address, &Register, 1, &Value, 1) != SOFTI2C_STATUS_OK)
+		{
+			continue;
+		}
+		if((Value & pgm_read_byte(&I2CScanDevices[i].Mask)) == pgm_read_byte(&I2CScanDevices[i].Match))
+		{
+			return I2CScanDevices[i].Name;
+		}
+	}
+	return NULL;
+}
+
+void I2CScan_Print(const I2CScanResult *Result)
+{
+	const char *Name;
+	uint8_t Address;
+
+	for(Address = I2CSCAN_FIRST_ADDRESS; Address <= I2CSCAN_LAST_ADDRESS; Address++)
+	{
+		if(!I2CScan_Found(Result, Address))
+		{
+			continue;
+		}
+
+		Format_Puts_P(Console_PutChar, "0x");
+		Format_Hex2(Console_PutChar, Address);
+		Console_PutChar(' ');
+		Name = I2CScan_Identify(Address);
+		if(Name != NULL)
+		{
+			Format_Puts_p(Console_PutChar, Name);
+		}
+		else
+		{
+			Console_PutChar('?');
+		}
+		Console_PutChar('\n');
+	}
+
+	if(Result->Status != SOFTI2C_STATUS_OK)
+	{
+		Format_Puts_P(Console_PutChar, "Bus error ");
+		Format_UInt(Console_PutChar, Result->Status, 0, ' ');
+		Format_Puts_P(Console_PutChar, " at 0x");
+		Format_Hex2(Console_PutChar, I2CSCAN_FIRST_ADDRESS + Result->Probes - 1);
+		Format_Puts_P(Console_PutChar, ", scan stopped\n");
+	}
+
+	Format_UInt(Console_PutChar, Result->Devices, 0, ' ');
+	Format_Puts_P(Console_PutChar, " found, ");
+	Format_UInt(Console_PutChar, Result->Probes, 0, ' ');
+	Format_Puts_P(Console_PutChar, " addresses at ");
+	Format_UInt(Console_PutChar, (500 + Result->HalfBit / 2) / Result->HalfBit, 0, ' ');
+	Format_Puts_P(Console_PutChar, " kHz in ");
+	Format_ULong(Console_PutChar, Result->TimeUS);
+	Format_Puts_P(Console_PutChar, " us, ");
+	Format_ULong(Console_PutChar, (uint32_t)Result->Probes * I2CSCAN_PROBE_TICKS * Result->HalfBit);
+	Format_Puts_P(Console_PutChar, " us with no stretching, stretched ");
+	Format_UInt(Console_PutChar, Result->StretchTicks, 0, ' ');
+	Format_Puts_P(Console_PutChar, " ticks\n");
+	return;
+}
+
+/** @} */
@@ -0,0 +1,84 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+/** \file
+*	\brief		I2C bus scan header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Each address from I2CSCAN_FIRST_ADDRESS to I2CSCAN_LAST_ADDRESS is sent
+*	with no data. An address that is not acked ends there with a stop, so a
+*	probe is only the 23 ticks of a start, the address and a stop. The probes
+*	go out back to back, there is only one bus to put them on. A clock stretch
+*	timeout or lost arbitration means the bus itself is stuck, so the scan
+*	stops there instead of timing out on every address.
+*
+*	The time for the probes is measured with timer 0 and printed next to the
+*	time they take with no stretching. SCL that is slow to rise, from too much
+*	capacitance or a weak pull up, is seen as stretching and makes the scan
+*	slower than that.
+*
+*	Devices that were found are looked up in a table by address and then told
+*	apart by reading an ID register, see I2CScan_Identify().
+*
+*	@{
+*/
+
+#ifndef _I2CSCAN_H_
+#define _I2CSCAN_H_
+
+#include <stdint.h>
+
+#define I2CSCAN_FIRST_ADDRESS		0x08	//0x00 to 0x07 are reserved
+#define I2CSCAN_LAST_ADDRESS		0x77	//0x78 to 0x7F are reserved
+#define I2CSCAN_PROBE_TICKS			23		//Start, address and stop
+#define I2CSCAN_MIN_KHZ				2		//The half bit is a byte of us
+#define I2CSCAN_MAX_KHZ				(500 / SOFTI2C_MIN_HALF_BIT_US)
+
+/** What a scan found. */
+typedef struct
+{
+	uint8_t Found[16];				//One bit per address, address 0 is bit 0 of byte 0
+	uint8_t Devices;
+	uint8_t Probes;					//Addresses sent
+	uint8_t Status;					//SOFTI2C_STATUS_OK, or the bus error that stopped the scan
+	uint8_t HalfBit;				//us
+	uint32_t TimeUS;				//For the probes
+	uint16_t StretchTicks;
+} I2CScanResult;
+
+/** Probe every address with the given half bit, then put the old one back.
+*	\return 0 if the scan ran, 1 if the half bit is too short
+*/
+uint8_t I2CScan_Run(uint8_t HalfBitUS, I2CScanResult *Result);
+
+/** Returns 1 if the scan found the address. */
+uint8_t I2CScan_Found(const I2CScanResult *Result, uint8_t Address);
+
+/** Find out which device is at an address by reading its ID register.
+*	\return The name in flash, or NULL if it is not a known device
+*/
+const char *I2CScan_Identify(uint8_t Address);
+
+/** Print the devices, with their names, and the timing to the console. */
+void I2CScan_Print(const I2CScanResult *Result);
+
+#endif
+
+/** @} */
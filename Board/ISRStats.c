@@ -0,0 +1,207 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Interrupt latency and run time statistics.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+#define ISRSTATS_STROBE_PIN		2			//PD2, the LED
+
+static const char ISRStatsNames[ISRSTATS_COUNT][13] PROGMEM =
+{
+	"TIMER0_COMPA", "TIMER1_COMPA", "INT0", "INT1", "INT5", "PCINT1", "SPI_STC"
+};
+
+static ISRStat ISRStatsTable[ISRSTATS_COUNT];
+static uint8_t ISRStatsMaxLatency;
+static uint16_t ISRStatsLatency[ISRSTATS_BUCKETS];
+
+//State of the interrupt being timed, interrupts do not nest
+static uint8_t ISRStatsStart;
+static uint8_t ISRStatsTickPending;
+
+static uint8_t ISRStatsStrobe = ISRSTATS_STROBE_OFF;
+
+static uint8_t ISRStats_Bucket(uint8_t Value)
+{
+	uint8_t Bucket = 0;
+
+	if(Value > HARDWARE_TIMER_0_TOP_VALUE)
+	{
+		return ISRSTATS_BUCKETS - 1;
+	}
+	while((Value != 0) && (Bucket < (ISRSTATS_BUCKETS - 2)))
+	{
+		Value = Value >> 1;
+		Bucket++;
+	}
+	return Bucket;
+}
+
+static void ISRStats_Halve(uint16_t *Histogram)
+{
+	uint8_t i;
+
+	for(i = 0; i < ISRSTATS_BUCKETS; i++)
+	{
+		Histogram[i] = Histogram[i] >> 1;
+	}
+	return;
+}
+
+void ISRStats_Clear(void)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	memset(ISRStatsTable, 0, sizeof(ISRStatsTable));
+	memset(ISRStatsLatency, 0, sizeof(ISRStatsLatency));
+	ISRStatsMaxLatency = 0;
+	SREG = sreg;
+	return;
+}
+
+void ISRStats_Enter(uint8_t Id)
+{
+	uint8_t Latency;
+
+	ISRStatsStart = TCNT0;
+	ISRStatsTickPending = TIFR0 & (1<<OCF0A);
+
+	if(Id == ISRStatsStrobe)
+	{
+		PORTD |= (1<<ISRSTATS_STROBE_PIN);
+	}
+
+	if(Id == ISRSTATS_TIMER0_COMPA)
+	{
+		Latency = ISRStatsStart;
+		if(Latency > ISRStatsMaxLatency)
+		{
+			ISRStatsMaxLatency = Latency;
+		}
+		ISRStatsLatency[ISRStats_Bucket(Latency)]++;
+	}
+	return;
+}
+
+void ISRStats_Exit(uint8_t Id)
+{
+	ISRStat *Stat = &ISRStatsTable[Id];
+	uint8_t Now = TCNT0;
+	uint16_t Length;
+	uint8_t Wrapped;
+
+	if(Id == ISRStatsStrobe)
+	{
+		PORTD &= ~(1<<ISRSTATS_STROBE_PIN);
+	}
+
+	//A compare during the interrupt sets OCF0A, and the interrupt can not be running across a wrap without one
+	Wrapped = (Now < ISRStatsStart);
+	if((ISRStatsTickPending == 0) && ((TIFR0 & (1<<OCF0A)) != 0))
+	{
+		Wrapped = 1;
+		Stat->DelayedTicks++;
+	}
+	Length = Now - ISRStatsStart;
+	if(Wrapped != 0)
+	{
+		Length = (Now + HARDWARE_TIMER_0_TOP_VALUE + 1) - ISRStatsStart;
+	}
+	if(Length > 0xFF)
+	{
+		Length = 0xFF;
+	}
+
+	if(Length > Stat->MaxLength)
+	{
+		Stat->MaxLength = Length;
+	}
+	Stat->Histogram[ISRStats_Bucket(Length)]++;
+
+	Stat->Count++;
+	if(Stat->Count == 0xFFFF)
+	{
+		Stat->Count = Stat->Count >> 1;
+		Stat->DelayedTicks = Stat->DelayedTicks >> 1;
+		ISRStats_Halve(Stat->Histogram);
+		if(Id == ISRSTATS_TIMER0_COMPA)
+		{
+			ISRStats_Halve(ISRStatsLatency);
+		}
+	}
+	return;
+}
+
+void ISRStats_Get(uint8_t Id, ISRStat *Stat)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	memcpy(Stat, &ISRStatsTable[Id], sizeof(ISRStat));
+	SREG = sreg;
+	return;
+}
+
+uint8_t ISRStats_GetLatency(uint16_t *Histogram)
+{
+	uint8_t sreg;
+	uint8_t MaxLatency;
+
+	sreg = SREG;
+	cli();
+	memcpy(Histogram, ISRStatsLatency, sizeof(ISRStatsLatency));
+	MaxLatency = ISRStatsMaxLatency;
+	SREG = sreg;
+	return MaxLatency;
+}
+
+const char *ISRStats_Name(uint8_t Id)
+{
+	return ISRStatsNames[Id];
+}
+
+void ISRStats_SetStrobe(uint8_t Id)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	PORTD &= ~(1<<ISRSTATS_STROBE_PIN);
+	if(Id < ISRSTATS_COUNT)
+	{
+		DDRD |= (1<<ISRSTATS_STROBE_PIN);
+		ISRStatsStrobe = Id;
+	}
+	else
+	{
+		ISRStatsStrobe = ISRSTATS_STROBE_OFF;
+	}
+	SREG = sreg;
+	return;
+}
+
+/** @} */
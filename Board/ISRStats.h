@@ -0,0 +1,99 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Interrupt latency and run time statistics header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Each instrumented interrupt calls ISRStats_Enter() first and ISRStats_Exit()
+*	last. Times are read from TCNT0, so they are in timer 0 counts of 8us.
+*
+*	- Latency is only measured for the timer 0 compare A interrupt: TCNT0 is
+*	  cleared by the compare match, so its value on entry is the time since the
+*	  interrupt was due. This is the jitter of the 1ms tick.
+*	- Length is the time from entry to exit. If a timer 0 compare happens while
+*	  the interrupt runs, TCNT0 has wrapped and one period is added. Lengths
+*	  over 2ms can not be told apart from shorter ones.
+*	- Delayed ticks counts the times a compare happened during the interrupt,
+*	  so the 1ms tick was held off. For the timer 0 interrupt itself this means
+*	  the next tick was already due when it returned.
+*
+*	When an interrupt's count reaches 65535, its count, histogram and delayed
+*	tick count are halved, so the histogram keeps its shape.
+*
+*	The strobe mode drives the LED pin (PD2) high for the length of one chosen
+*	interrupt, so it can be measured with a scope.
+*
+*	@{
+*/
+
+#ifndef _ISRSTATS_H_
+#define _ISRSTATS_H_
+
+#include <stdint.h>
+
+//Instrumented interrupts
+#define ISRSTATS_TIMER0_COMPA		0
+#define ISRSTATS_TIMER1_COMPA		1
+#define ISRSTATS_INT0				2
+#define ISRSTATS_INT1				3
+#define ISRSTATS_INT5				4
+#define ISRSTATS_PCINT1				5
+#define ISRSTATS_SPI_STC			6
+#define ISRSTATS_COUNT				7
+
+#define ISRSTATS_STROBE_OFF			0xFF
+
+//Histogram buckets, by timer 0 counts: 0, 1, 2-3, 4-7, 8-15, 16-31, 32-124 and over 1ms
+#define ISRSTATS_BUCKETS			8
+
+typedef struct
+{
+	uint16_t Count;
+	uint16_t DelayedTicks;
+	uint8_t MaxLength;
+	uint16_t Histogram[ISRSTATS_BUCKETS];	//Lengths
+} ISRStat;
+
+/** Clear all statistics. */
+void ISRStats_Clear(void);
+
+/** Start timing an interrupt. Call first thing in the interrupt. */
+void ISRStats_Enter(uint8_t Id);
+
+/** Finish timing an interrupt. Call last thing in the interrupt. */
+void ISRStats_Exit(uint8_t Id);
+
+/** Copy the statistics for one interrupt, with interrupts disabled so the copy is consistent. */
+void ISRStats_Get(uint8_t Id, ISRStat *Stat);
+
+/** Copy the latency statistics of the timer 0 compare A interrupt.
+*	\param[out] Histogram	ISRSTATS_BUCKETS counts
+*	\return the maximum latency
+*/
+uint8_t ISRStats_GetLatency(uint16_t *Histogram);
+
+/** Returns the name of an interrupt, in program memory. */
+const char *ISRStats_Name(uint8_t Id);
+
+/** Strobe the LED pin during one interrupt, or ISRSTATS_STROBE_OFF to stop. */
+void ISRStats_SetStrobe(uint8_t Id);
+
+#endif
+
+/** @} */
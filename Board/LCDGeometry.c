@@ -0,0 +1,110 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Runtime LCD size and line addressing.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+//KS0073 commands to switch to 4 line mode (see the KS0073 data sheet)
+#define KS0073_EXTENDED_FUNCTION_REGISTER_ON	0x24	//4-bit mode, extension bit RE = 1
+#define KS0073_4LINES_MODE						0x09	//4 line mode
+#define KS0073_EXTENDED_FUNCTION_REGISTER_OFF	0x20	//4-bit mode, extension bit RE = 0
+
+uint8_t LCDColumns;
+uint8_t LCDLines;
+uint8_t LCDLineAddress[LCDGEO_MAX_LINES];
+
+uint8_t LCDGeo_Valid(uint8_t Columns, uint8_t Lines, uint8_t Controller)
+{
+	if((Columns < LCDGEO_MIN_COLUMNS) || (Columns > LCDGEO_MAX_COLUMNS))
+	{
+		return 0;
+	}
+	if((Lines < 1) || (Lines > LCDGEO_MAX_LINES))
+	{
+		return 0;
+	}
+	if(Controller > LCDGEO_CONTROLLER_KS0073)
+	{
+		return 0;
+	}
+
+	//Lines 3 and 4 of a HD44780 are the right half of lines 1 and 2, so they only exist up to 20 columns
+	if((Controller == LCDGEO_CONTROLLER_HD44780) && (Lines > 2) && (Columns > 20))
+	{
+		return 0;
+	}
+	return 1;
+}
+
+void LCDGeo_Init(void)
+{
+	uint8_t i;
+
+	if(LCDGeo_Valid(Settings.LCDColumns, Settings.LCDLines, Settings.LCDController) == 1)
+	{
+		LCDColumns = Settings.LCDColumns;
+		LCDLines = Settings.LCDLines;
+	}
+	else
+	{
+		LOG_WARN("Invalid LCD size %ux%u, using the default", Settings.LCDColumns, Settings.LCDLines);
+		LCDColumns = LCD_DISP_LENGTH;
+		LCDLines = LCD_LINES;
+	}
+
+	if((Settings.LCDController == LCDGEO_CONTROLLER_KS0073) && (LCDLines > 2))
+	{
+		lcd_command(KS0073_EXTENDED_FUNCTION_REGISTER_ON);
+		lcd_command(KS0073_4LINES_MODE);
+		lcd_command(KS0073_EXTENDED_FUNCTION_REGISTER_OFF);
+		lcd_command(LCD_FUNCTION_4BIT_2LINES);
+
+		//In 4 line mode each line is 0x20 long
+		for(i = 0; i < LCDGEO_MAX_LINES; i++)
+		{
+			LCDLineAddress[i] = i << 5;
+		}
+	}
+	else
+	{
+		//The HD44780 has two 40 character lines, displays with 4 lines show the right half of each as lines 3 and 4
+		LCDLineAddress[0] = LCD_START_LINE1;
+		LCDLineAddress[1] = LCD_START_LINE2;
+		LCDLineAddress[2] = LCD_START_LINE1 + LCDColumns;
+		LCDLineAddress[3] = LCD_START_LINE2 + LCDColumns;
+	}
+	return;
+}
+
+void LCDGeo_GotoXY(uint8_t x, uint8_t y)
+{
+	if(y >= LCDLines)
+	{
+		y = 0;
+	}
+	lcd_gotoaddress(LCD_ADDRESS(x, y));
+	return;
+}
+
+/** @} */
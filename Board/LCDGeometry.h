@@ -0,0 +1,64 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Runtime LCD size and line addressing header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The LCD library is built for the size set in lcd.h. The actual display size
+*	and controller come from the EEPROM settings, so one firmware image works
+*	with 16x2 and 20x4 panels. Application code positions the cursor with
+*	LCDGeo_GotoXY or LCD_ADDRESS instead of lcd_gotoxy and '\n', which use the
+*	compile time size. The DDRAM address of each line is worked out once in
+*	LCDGeo_Init, so positioning is a table lookup and writing characters costs
+*	nothing extra.
+*
+*	@{
+*/
+
+#ifndef _LCDGEOMETRY_H_
+#define _LCDGEOMETRY_H_
+
+#include <stdint.h>
+
+#define LCDGEO_CONTROLLER_HD44780	0
+#define LCDGEO_CONTROLLER_KS0073	1
+
+#define LCDGEO_MAX_LINES			4
+#define LCDGEO_MIN_COLUMNS			8
+#define LCDGEO_MAX_COLUMNS			40
+
+extern uint8_t LCDColumns;
+extern uint8_t LCDLines;
+extern uint8_t LCDLineAddress[LCDGEO_MAX_LINES];
+
+/** DDRAM address of a position on the screen. */
+#define LCD_ADDRESS(x, y)		((uint8_t)(LCDLineAddress[(y)] + (x)))
+
+/** Load the geometry from the settings and build the line address table. Call this after lcd_init. */
+void LCDGeo_Init(void);
+
+/** Move the cursor to a column and line. */
+void LCDGeo_GotoXY(uint8_t x, uint8_t y);
+
+/** Returns 1 if the size and controller are ones the firmware can drive. */
+uint8_t LCDGeo_Valid(uint8_t Columns, uint8_t Lines, uint8_t Controller);
+
+#endif
+
+/** @} */
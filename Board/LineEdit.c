@@ -0,0 +1,577 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Console line editing and command history.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+#define LINEEDIT_ESC				0x1B
+
+//Escape sequence parser states
+#define LINEEDIT_STATE_NORMAL		0
+#define LINEEDIT_STATE_ESC			1		//Got ESC
+#define LINEEDIT_STATE_CSI			2		//Got ESC [
+#define LINEEDIT_STATE_CSI_NUMBER	3		//Got ESC [ and a digit, waiting for '~'
+
+static char LineEditLine[LINEEDIT_LINE_SIZE];
+static uint8_t LineEditLength;
+static uint8_t LineEditCursor;
+static uint8_t LineEditState;
+static uint8_t LineEditNumber;
+static uint8_t LineEditLastChar;
+
+static char LineEditHistoryRing[LINEEDIT_HISTORY_SIZE];
+static uint8_t LineEditHistoryHead;			//Next byte to write
+static uint8_t LineEditHistoryUsed;			//Bytes in use, ending at the head
+static uint8_t LineEditHistoryIndex;		//History line being shown, 0 for a new line
+
+//Characters from the interrupt, waiting for the main loop
+static volatile uint8_t LineEditQueue[LINEEDIT_QUEUE_SIZE];
+static volatile uint8_t LineEditQueueHead;	//Written by the interrupt only
+static volatile uint8_t LineEditQueueTail;	//Written by the main loop only
+
+/****************************************************************
+*	Terminal output
+****************************************************************/
+
+static void LineEdit_Sequence(uint8_t Count, char Command)
+{
+	Console_PutChar(LINEEDIT_ESC);
+	Console_PutChar('[');
+	if(Count > 1)
+	{
+		Format_UInt(Console_PutChar, Count, 0, ' ');
+	}
+	Console_PutChar(Command);
+	return;
+}
+
+static void LineEdit_Left(uint8_t Count)
+{
+	if(Count == 1)
+	{
+		Console_PutChar('\b');
+	}
+	else if(Count > 1)
+	{
+		LineEdit_Sequence(Count, 'D');
+	}
+	return;
+}
+
+static void LineEdit_Right(uint8_t Count)
+{
+	if(Count > 0)
+	{
+		LineEdit_Sequence(Count, 'C');
+	}
+	return;
+}
+
+//Rewrite the line from From, where the terminal cursor is, and put the cursor back
+static void LineEdit_Redraw(uint8_t From, uint8_t OldLength)
+{
+	uint8_t i;
+
+	for(i = From; i < LineEditLength; i++)
+	{
+		Console_PutChar(LineEditLine[i]);
+	}
+	if(OldLength > LineEditLength)
+	{
+		//Erase to the end of the line
+		Console_PutChar(LINEEDIT_ESC);
+		Console_PutChar('[');
+		Console_PutChar('K');
+	}
+	LineEdit_Left(LineEditLength - LineEditCursor);
+	return;
+}
+
+/****************************************************************
+*	History
+****************************************************************/
+
+//Index of the byte Back bytes before the head
+static uint8_t LineEdit_RingIndex(uint8_t Back)
+{
+	return ((uint16_t)LineEditHistoryHead + LINEEDIT_HISTORY_SIZE - Back) % LINEEDIT_HISTORY_SIZE;
+}
+
+//Find a history line, returns its length and sets Start to the index of its first byte, or -1
+static int8_t LineEdit_HistoryFind(uint8_t Back, uint8_t *Start)
+{
+	uint8_t Offset = 1;			//Bytes back from the head to the terminating 0 of the line
+	uint8_t Length;
+
+	while((Back > 0) && (Offset <= LineEditHistoryUsed))
+	{
+		Length = 0;
+		while(((Offset + Length) < LineEditHistoryUsed) && (LineEditHistoryRing[LineEdit_RingIndex(Offset + Length + 1)] != 0))
+		{
+			Length++;
+		}
+
+		Back--;
+		if(Back == 0)
+		{
+			*Start = LineEdit_RingIndex(Offset + Length);
+			return Length;
+		}
+		Offset += Length + 1;
+	}
+	return -1;
+}
+
+static uint8_t LineEdit_SameAsLast(void)
+{
+	uint8_t Start;
+	uint8_t i;
+
+	if(LineEdit_HistoryFind(1, &Start) != LineEditLength)
+	{
+		return 0;
+	}
+	for(i = 0; i < LineEditLength; i++)
+	{
+		if(LineEditHistoryRing[(Start + i) % LINEEDIT_HISTORY_SIZE] != LineEditLine[i])
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void LineEdit_HistoryAdd(void)
+{
+	uint8_t Oldest;
+	uint8_t i;
+
+	if((LineEditLength == 0) || (LineEditLength >= LINEEDIT_HISTORY_SIZE) || (LineEdit_SameAsLast() == 1))
+	{
+		return;
+	}
+
+	//Drop the oldest lines until there is room
+	while((LineEditHistoryUsed + LineEditLength + 1) > LINEEDIT_HISTORY_SIZE)
+	{
+		Oldest = LineEdit_RingIndex(LineEditHistoryUsed);
+		while(LineEditHistoryRing[Oldest] != 0)
+		{
+			Oldest = (Oldest + 1) % LINEEDIT_HISTORY_SIZE;
+			LineEditHistoryUsed--;
+		}
+		LineEditHistoryUsed--;
+	}
+
+	for(i = 0; i <= LineEditLength; i++)
+	{
+		LineEditHistoryRing[LineEditHistoryHead] = (i < LineEditLength) ? LineEditLine[i] : 0;
+		LineEditHistoryHead = (LineEditHistoryHead + 1) % LINEEDIT_HISTORY_SIZE;
+	}
+	LineEditHistoryUsed += LineEditLength + 1;
+	return;
+}
+
+//Replace the line with a history line, or an empty line if Back is 0
+static void LineEdit_Recall(uint8_t Back)
+{
+	uint8_t Start = 0;
+	int8_t Length = 0;
+	uint8_t Same = 0;
+	uint8_t OldLength = LineEditLength;
+	char c;
+	uint8_t i;
+
+	if(Back > 0)
+	{
+		Length = LineEdit_HistoryFind(Back, &Start);
+		if(Length < 0)
+		{
+			return;
+		}
+	}
+	LineEditHistoryIndex = Back;
+
+	//Keep the characters that are the same, and move the cursor to the first one that changes
+	for(i = 0; i < Length; i++)
+	{
+		c = LineEditHistoryRing[(Start + i) % LINEEDIT_HISTORY_SIZE];
+		if((Same == i) && (i < LineEditLength) && (LineEditLine[i] == c))
+		{
+			Same++;
+		}
+		LineEditLine[i] = c;
+	}
+
+	if(LineEditCursor > Same)
+	{
+		LineEdit_Left(LineEditCursor - Same);
+	}
+	else
+	{
+		LineEdit_Right(Same - LineEditCursor);
+	}
+	LineEditLength = Length;
+	LineEditCursor = Length;
+	LineEdit_Redraw(Same, OldLength);
+	return;
+}
+
+int8_t LineEdit_History(uint8_t Back, char *Line)
+{
+	uint8_t Start;
+	int8_t Length;
+	uint8_t i;
+
+	Length = LineEdit_HistoryFind(Back, &Start);
+	for(i = 0; (Length >= 0) && (i < Length); i++)
+	{
+		Line[i] = LineEditHistoryRing[(Start + i) % LINEEDIT_HISTORY_SIZE];
+	}
+	if(Length >= 0)
+	{
+		Line[Length] = 0;
+	}
+	return Length;
+}
+
+/****************************************************************
+*	Editing
+****************************************************************/
+
+static void LineEdit_Insert(const char *Text, uint8_t Count)
+{
+	if((LineEditLength + Count) > (LINEEDIT_LINE_SIZE - 1))
+	{
+		Console_PutChar('\a');
+		Count = LINEEDIT_LINE_SIZE - 1 - LineEditLength;
+		if(Count == 0)
+		{
+			return;
+		}
+	}
+	memmove(&LineEditLine[LineEditCursor + Count], &LineEditLine[LineEditCursor], LineEditLength - LineEditCursor);
+	memcpy(&LineEditLine[LineEditCursor], Text, Count);
+	LineEditLength += Count;
+	LineEditCursor += Count;
+	LineEdit_Redraw(LineEditCursor - Count, LineEditLength);
+	return;
+}
+
+//Remove the character at the cursor, the terminal cursor must already be there
+static void LineEdit_Remove(void)
+{
+	memmove(&LineEditLine[LineEditCursor], &LineEditLine[LineEditCursor + 1], LineEditLength - LineEditCursor - 1);
+	LineEditLength--;
+	LineEdit_Redraw(LineEditCursor, LineEditLength + 1);
+	return;
+}
+
+static void LineEdit_ListName(const char *Name, uint8_t Command)
+{
+	while(*Name != 0)
+	{
+		Console_PutChar(*Name++);
+	}
+	Console_PutChar(' ');
+	Console_PutChar(' ');
+	return;
+}
+
+//Complete the command name before the cursor, or the command name after 'help '
+static void LineEdit_Complete(void)
+{
+	char Completion[LINEEDIT_LINE_SIZE];
+	uint8_t Start = 0;
+	uint8_t Matches;
+	uint8_t i;
+
+	if((LineEditCursor >= 5) && (strncmp_P(LineEditLine, PSTR("help "), 5) == 0))
+	{
+		Start = 5;
+	}
+	for(i = Start; i < LineEditCursor; i++)
+	{
+		if(LineEditLine[i] == ' ')
+		{
+			//Command arguments are not completed
+			Console_PutChar('\a');
+			return;
+		}
+	}
+
+	Matches = CmdTrie_Complete(&LineEditLine[Start], LineEditCursor - Start, Completion, sizeof(Completion));
+	if(Matches == 0)
+	{
+		Console_PutChar('\a');
+		return;
+	}
+	i = strlen(Completion);
+	if((Matches == 1) && ((LineEditCursor == LineEditLength) || (LineEditLine[LineEditCursor] != ' ')))
+	{
+		Completion[i++] = ' ';
+	}
+	if(i > 0)
+	{
+		LineEdit_Insert(Completion, i);
+		return;
+	}
+
+	//Nothing to add, show the choices and the line again
+	Console_PutChar('\r');
+	Console_PutChar('\n');
+	if(Start == 0)
+	{
+		CmdTrie_ForEach(LineEditLine, LineEditCursor, LineEdit_ListName);
+		Console_PutChar('\r');
+		Console_PutChar('\n');
+	}
+	else
+	{
+		CmdTrie_Help(&LineEditLine[Start], LineEditCursor - Start);
+	}
+	Format_Puts_P(Console_PutChar, COMMAND_PROMPT);
+	LineEdit_Redraw(0, 0);
+	return;
+}
+
+static void LineEdit_Enter(void)
+{
+	uint8_t i;
+
+	Console_PutChar('\r');
+	Console_PutChar('\n');
+	LineEdit_HistoryAdd();
+
+	//The interpreter would echo the line again
+	Console_Echo(0);
+	for(i = 0; i < LineEditLength; i++)
+	{
+		CommandGetInputChar(LineEditLine[i]);
+	}
+	CommandGetInputChar('\r');
+	Console_Echo(1);
+
+	LineEditLength = 0;
+	LineEditCursor = 0;
+	LineEditHistoryIndex = 0;
+	return;
+}
+
+//Handle the last character of an escape sequence
+static void LineEdit_Key(uint8_t c)
+{
+	switch(c)
+	{
+		case 'A':		//Up
+			LineEdit_Recall(LineEditHistoryIndex + 1);
+			break;
+
+		case 'B':		//Down
+			if(LineEditHistoryIndex > 0)
+			{
+				LineEdit_Recall(LineEditHistoryIndex - 1);
+			}
+			break;
+
+		case 'C':		//Right
+			if(LineEditCursor < LineEditLength)
+			{
+				LineEditCursor++;
+				LineEdit_Right(1);
+			}
+			break;
+
+		case 'D':		//Left
+			if(LineEditCursor > 0)
+			{
+				LineEditCursor--;
+				LineEdit_Left(1);
+			}
+			break;
+
+		case 'H':		//Home
+			LineEdit_Left(LineEditCursor);
+			LineEditCursor = 0;
+			break;
+
+		case 'F':		//End
+			LineEdit_Right(LineEditLength - LineEditCursor);
+			LineEditCursor = LineEditLength;
+			break;
+
+		case 0x7F:		//Delete
+			if(LineEditCursor < LineEditLength)
+			{
+				LineEdit_Remove();
+			}
+			break;
+	}
+	return;
+}
+
+void LineEdit_Init(void)
+{
+	LineEditLength = 0;
+	LineEditCursor = 0;
+	LineEditState = LINEEDIT_STATE_NORMAL;
+	LineEditLastChar = 0;
+	LineEditHistoryHead = 0;
+	LineEditHistoryUsed = 0;
+	LineEditHistoryIndex = 0;
+	LineEditQueueHead = 0;
+	LineEditQueueTail = 0;
+	return;
+}
+
+uint8_t LineEdit_QueueFull(void)
+{
+	return (uint8_t)(LineEditQueueHead - LineEditQueueTail) >= LINEEDIT_QUEUE_SIZE;
+}
+
+void LineEdit_Queue(uint8_t c)
+{
+	if(!LineEdit_QueueFull())
+	{
+		LineEditQueue[LineEditQueueHead & (LINEEDIT_QUEUE_SIZE - 1)] = c;
+		LineEditQueueHead++;
+	}
+	return;
+}
+
+void LineEdit_Run(void)
+{
+	uint8_t c;
+
+	while(LineEditQueueTail != LineEditQueueHead)
+	{
+		c = LineEditQueue[LineEditQueueTail & (LINEEDIT_QUEUE_SIZE - 1)];
+		LineEditQueueTail++;
+		LineEdit_Input(c);
+	}
+	return;
+}
+
+void LineEdit_Input(uint8_t c)
+{
+	uint8_t LastChar = LineEditLastChar;
+
+	LineEditLastChar = c;
+
+	switch(LineEditState)
+	{
+		case LINEEDIT_STATE_ESC:
+			LineEditState = (c == '[') ? LINEEDIT_STATE_CSI : LINEEDIT_STATE_NORMAL;
+			return;
+
+		case LINEEDIT_STATE_CSI:
+			LineEditState = LINEEDIT_STATE_NORMAL;
+			if((c >= '0') && (c <= '9'))
+			{
+				LineEditNumber = c - '0';
+				LineEditState = LINEEDIT_STATE_CSI_NUMBER;
+			}
+			else
+			{
+				LineEdit_Key(c);
+			}
+			return;
+
+		case LINEEDIT_STATE_CSI_NUMBER:
+			if((c >= '0') && (c <= '9'))
+			{
+				LineEditNumber = (LineEditNumber * 10) + (c - '0');
+				return;
+			}
+			LineEditState = LINEEDIT_STATE_NORMAL;
+			if(c == '~')
+			{
+				//ESC [ 1 ~ home, 3 ~ delete, 4 ~ end
+				if(LineEditNumber == 1)
+				{
+					LineEdit_Key('H');
+				}
+				else if(LineEditNumber == 3)
+				{
+					LineEdit_Key(0x7F);
+				}
+				else if(LineEditNumber == 4)
+				{
+					LineEdit_Key('F');
+				}
+			}
+			return;
+	}
+
+	switch(c)
+	{
+		case LINEEDIT_ESC:
+			LineEditState = LINEEDIT_STATE_ESC;
+			break;
+
+		case '\r':
+			LineEdit_Enter();
+			break;
+
+		case '\n':
+			//Terminals that send "\r\n" only enter one line
+			if(LastChar != '\r')
+			{
+				LineEdit_Enter();
+			}
+			break;
+
+		case '\b':
+		case 0x7F:
+			if(LineEditCursor > 0)
+			{
+				LineEditCursor--;
+				LineEdit_Left(1);
+				LineEdit_Remove();
+			}
+			break;
+
+		case '\t':
+			LineEdit_Complete();
+			break;
+
+		case 0x01:		//Ctrl-A
+			LineEdit_Key('H');
+			break;
+
+		case 0x05:		//Ctrl-E
+			LineEdit_Key('F');
+			break;
+
+		default:
+			if((c >= ' ') && (c < 0x7F))
+			{
+				LineEdit_Insert((const char *)&c, 1);
+			}
+			break;
+	}
+	return;
+}
+
+/** @} */
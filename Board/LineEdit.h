@@ -0,0 +1,83 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Console line editing and command history header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Characters from the USB console go through the line editor before the
+*	command interpreter. The editor keeps the line, echoes it, and passes it to
+*	CommandGetInputChar() when enter is pressed.
+*
+*	The timer interrupt only queues the characters with LineEdit_Queue(). The
+*	editing, echo and tab completion are done by LineEdit_Run() from the main
+*	loop, so the interrupt never waits for the USB endpoint.
+*
+*	Keys (VT100 sequences):
+*	- Left and right move the cursor, home and end (or ctrl-A and ctrl-E) go to
+*	  the ends of the line.
+*	- Backspace and delete remove the character before and at the cursor.
+*	- Up and down step through the history.
+*	- Tab completes the command name, or the name after 'help'. If there is
+*	  more than one match and nothing to add, the matches are listed.
+*
+*	Only the changed part of the line is sent back to the terminal: characters
+*	after the cursor are rewritten when the cursor is not at the end, and
+*	recalled history lines only rewrite from the first character that differs.
+*
+*	The history is a ring of LINEEDIT_HISTORY_SIZE bytes holding 0 terminated
+*	lines. The oldest lines are dropped to make room, and a line that is the
+*	same as the last one is not added again.
+*
+*	@{
+*/
+
+#ifndef _LINEEDIT_H_
+#define _LINEEDIT_H_
+
+#include <stdint.h>
+
+#define LINEEDIT_LINE_SIZE			40		//Longest line, including the terminating 0
+#define LINEEDIT_HISTORY_SIZE		96		//Bytes of RAM for the history, up to 255
+#define LINEEDIT_QUEUE_SIZE			8		//Characters waiting for the main loop, a power of 2
+
+/** Clear the line and the history. */
+void LineEdit_Init(void);
+
+/** Handle a character from the console. */
+void LineEdit_Input(uint8_t c);
+
+/** Returns 1 if there is no room for another character. */
+uint8_t LineEdit_QueueFull(void);
+
+/** Queue a character from the interrupt, dropped if the queue is full. */
+void LineEdit_Queue(uint8_t c);
+
+/** Pass the queued characters to LineEdit_Input(). Called from the main loop. */
+void LineEdit_Run(void);
+
+/** Get a line from the history.
+*	\param[in] Back		1 for the newest line, 2 for the one before it, and so on
+*	\param[out] Line	LINEEDIT_LINE_SIZE bytes
+*	\return the length of the line, or -1 if there are not that many lines
+*/
+int8_t LineEdit_History(uint8_t Back, char *Line);
+
+#endif
+
+/** @} */
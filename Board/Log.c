@@ -0,0 +1,49 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Binary log messages decoded on the PC.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+void Log_Start(uint16_t Id, uint8_t Sizes)
+{
+	Console_PutChar(LOG_FRAME_START);
+	Console_PutChar(Id & 0xFF);
+	Console_PutChar(Id >> 8);
+	Console_PutChar(Sizes);
+	return;
+}
+
+void Log_Bytes(const void *Data, uint8_t Length)
+{
+	const uint8_t *Bytes = Data;
+
+	//AVR and x86 are both little endian, so the bytes go out in memory order
+	while(Length-- > 0)
+	{
+		Console_PutChar(*Bytes++);
+	}
+	return;
+}
+
+/** @} */
@@ -0,0 +1,134 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Binary log messages decoded on the PC header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The LOG_ macros take a printf format and up to 4 integer arguments, but
+*	the AVR does no formatting. The format string, with the level, file and
+*	line in front, is put in the 'logfmt' section. Config/logfmt.x links that
+*	section at address 0 and does not load it, so the strings are in the ELF
+*	file but not in flash, and the address of a string is its ID.
+*
+*	A message is sent to the console as one frame:
+*	- LOG_FRAME_START
+*	- The 16 bit format ID, low byte first
+*	- A size byte, 2 bits per argument starting at bit 0: 0 for 1 byte,
+*	  1 for 2 bytes, 2 for 4 bytes, 3 for no argument
+*	- The arguments, low byte first
+*
+*	tools/logdecode.py reads the strings from main.elf and prints the messages,
+*	passing other console output through. Messages can only be logged from the
+*	main loop, as the console is not safe to use from interrupts.
+*
+*	Set LOG_LEVEL to remove messages below a level at compile time, for example
+*	-DLOG_LEVEL=LOG_LEVEL_WARN in CC_FLAGS. Removed messages cost nothing.
+*
+*	@{
+*/
+
+#ifndef _LOG_H_
+#define _LOG_H_
+
+#include <stdint.h>
+
+#define LOG_LEVEL_NONE			0
+#define LOG_LEVEL_ERROR			1
+#define LOG_LEVEL_WARN			2
+#define LOG_LEVEL_INFO			3
+#define LOG_LEVEL_DEBUG			4
+
+#ifndef LOG_LEVEL
+	#define LOG_LEVEL			LOG_LEVEL_INFO
+#endif
+
+#define LOG_FRAME_START			0x1E		//ASCII record separator, not used by the console text
+
+//The host build links the strings as an ordinary section, and sets this to its start
+#ifndef LOG_SECTION_BASE
+	#define LOG_SECTION_BASE	0
+#else
+	extern const char LOG_SECTION_BASE[];
+#endif
+
+/** Start a frame. Called by the LOG_ macros. */
+void Log_Start(uint16_t Id, uint8_t Sizes);
+
+/** Send argument bytes. Called by the LOG_ macros. */
+void Log_Bytes(const void *Data, uint8_t Length);
+
+//Level, file and line in front of the format
+#define LOG_STRINGIFY(x)		#x
+#define LOG_TOSTRING(x)			LOG_STRINGIFY(x)
+#define LOG_PREFIX(Level)		Level __FILE__ ":" LOG_TOSTRING(__LINE__) ": "
+
+//Size code of one argument
+#define LOG_SIZE(x)				((sizeof(x) == 1) ? 0 : ((sizeof(x) == 2) ? 1 : 2))
+
+#define LOG_NARGS(...)			LOG_NARGS_(_, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, N, ...)	N
+#define LOG_CONCAT(a, b)		LOG_CONCAT_(a, b)
+#define LOG_CONCAT_(a, b)		a##b
+
+#define LOG_WRITE0(Id)				Log_Start(Id, 0xFF)
+#define LOG_WRITE1(Id, a)			do { __typeof__(a) _a = (a); Log_Start(Id, 0xFC | LOG_SIZE(_a)); Log_Bytes(&_a, sizeof(_a)); } while(0)
+#define LOG_WRITE2(Id, a, b)		do { __typeof__(a) _a = (a); __typeof__(b) _b = (b); Log_Start(Id, 0xF0 | LOG_SIZE(_a) | (LOG_SIZE(_b) << 2)); \
+										Log_Bytes(&_a, sizeof(_a)); Log_Bytes(&_b, sizeof(_b)); } while(0)
+#define LOG_WRITE3(Id, a, b, c)		do { __typeof__(a) _a = (a); __typeof__(b) _b = (b); __typeof__(c) _c = (c); \
+										Log_Start(Id, 0xC0 | LOG_SIZE(_a) | (LOG_SIZE(_b) << 2) | (LOG_SIZE(_c) << 4)); \
+										Log_Bytes(&_a, sizeof(_a)); Log_Bytes(&_b, sizeof(_b)); Log_Bytes(&_c, sizeof(_c)); } while(0)
+#define LOG_WRITE4(Id, a, b, c, d)	do { __typeof__(a) _a = (a); __typeof__(b) _b = (b); __typeof__(c) _c = (c); __typeof__(d) _d = (d); \
+										Log_Start(Id, LOG_SIZE(_a) | (LOG_SIZE(_b) << 2) | (LOG_SIZE(_c) << 4) | (LOG_SIZE(_d) << 6)); \
+										Log_Bytes(&_a, sizeof(_a)); Log_Bytes(&_b, sizeof(_b)); Log_Bytes(&_c, sizeof(_c)); Log_Bytes(&_d, sizeof(_d)); } while(0)
+
+/** Log a message at a level given as a letter, without a level check. Use the level macros below. */
+#define LOG_AT(Level, Format, ...)																\
+	do																							\
+	{																							\
+		static const char _LogFormat[] __attribute__((section("logfmt"))) = LOG_PREFIX(Level) Format;	\
+		LOG_CONCAT(LOG_WRITE, LOG_NARGS(__VA_ARGS__))((uint16_t)((uintptr_t)_LogFormat - (uintptr_t)LOG_SECTION_BASE), ##__VA_ARGS__);	\
+	} while(0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+	#define LOG_ERROR(Format, ...)	LOG_AT("E", Format, ##__VA_ARGS__)
+#else
+	#define LOG_ERROR(Format, ...)	do { } while(0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+	#define LOG_WARN(Format, ...)	LOG_AT("W", Format, ##__VA_ARGS__)
+#else
+	#define LOG_WARN(Format, ...)	do { } while(0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+	#define LOG_INFO(Format, ...)	LOG_AT("I", Format, ##__VA_ARGS__)
+#else
+	#define LOG_INFO(Format, ...)	do { } while(0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+	#define LOG_DEBUG(Format, ...)	LOG_AT("D", Format, ##__VA_ARGS__)
+#else
+	#define LOG_DEBUG(Format, ...)	do { } while(0)
+#endif
+
+#endif
+
+/** @} */
@@ -0,0 +1,131 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Bulk download of the dataflash.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+#include <util/crc16.h>
+
+#define LOGDUMP_HEADER_SIZE			5
+
+//Start byte, page and length. Returns the CRC of the page and length.
+static uint16_t LogDump_Header(uint8_t *Header, uint16_t Page, uint16_t Length)
+{
+	uint16_t Crc = 0;
+	uint8_t i;
+
+	Header[0] = LOGDUMP_FRAME_START;
+	Header[1] = Page;
+	Header[2] = Page >> 8;
+	Header[3] = Length;
+	Header[4] = Length >> 8;
+	for(i = 1; i < LOGDUMP_HEADER_SIZE; i++)
+	{
+		Crc = _crc_xmodem_update(Crc, Header[i]);
+	}
+	return Crc;
+}
+
+static uint8_t LogDump_Crc(uint16_t Crc)
+{
+	uint8_t Bytes[2];
+
+	Bytes[0] = Crc;
+	Bytes[1] = Crc >> 8;
+	return Console_Write(Bytes, sizeof(Bytes));
+}
+
+//Send one page. Returns 0 if it was sent.
+static uint8_t LogDump_Page(uint16_t Page)
+{
+	uint8_t Chunk[LOGDUMP_CHUNK_SIZE];
+	uint16_t Crc;
+	uint16_t Offset;
+	uint8_t Length;
+	uint8_t Error = 0;
+
+	Crc = LogDump_Header(Chunk, Page, DATAFLASH_PAGE_SIZE);
+	if(Console_Write(Chunk, LOGDUMP_HEADER_SIZE) != 0)
+	{
+		return 1;
+	}
+
+	//The chip stays selected for the whole page, the USB writes do not use the SPI bus
+	if(Dataflash_ReadStart(Page, 0) != 0)
+	{
+		return 1;
+	}
+	for(Offset = 0; Offset < DATAFLASH_PAGE_SIZE; Offset += Length)
+	{
+		Length = ((DATAFLASH_PAGE_SIZE - Offset) < LOGDUMP_CHUNK_SIZE) ? (DATAFLASH_PAGE_SIZE - Offset) : LOGDUMP_CHUNK_SIZE;
+		Crc = SPI_ReadCrc(Chunk, Length, Crc);
+		Error = Console_Write(Chunk, Length);
+		if(Error != 0)
+		{
+			break;
+		}
+	}
+	SPI_Deselect();
+
+	if(Error != 0)
+	{
+		return Error;
+	}
+	return LogDump_Crc(Crc);
+}
+
+uint16_t LogDump_Pages(uint16_t First, uint16_t Count)
+{
+	uint8_t Header[LOGDUMP_HEADER_SIZE];
+	uint16_t Crc;
+	uint16_t Sent;
+
+	if(First >= DATAFLASH_PAGES)
+	{
+		Count = 0;
+	}
+	else if(Count > (DATAFLASH_PAGES - First))
+	{
+		Count = DATAFLASH_PAGES - First;
+	}
+
+	for(Sent = 0; Sent < Count; Sent++)
+	{
+		if(LogDump_Page(First + Sent) != 0)
+		{
+			return Sent;
+		}
+
+		//The download takes a few seconds, keep storing recorded data
+		Recorder_Run();
+	}
+
+	Crc = LogDump_Header(Header, LOGDUMP_END_PAGE, 0);
+	if(Console_Write(Header, LOGDUMP_HEADER_SIZE) == 0)
+	{
+		LogDump_Crc(Crc);
+	}
+	return Sent;
+}
+
+/** @} */
@@ -0,0 +1,62 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Bulk download of the dataflash header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The logdump command sends raw dataflash pages over the USB console as
+*	binary frames, so tools/logdump.py can copy the whole chip without any
+*	text formatting on the AVR. Each page is one frame:
+*	- LOGDUMP_FRAME_START
+*	- The page number, low byte first
+*	- The number of data bytes, low byte first
+*	- The page data
+*	- CRC-16/XMODEM of the page number, length and data, low byte first
+*
+*	The last frame has page LOGDUMP_END_PAGE and no data. The page data is
+*	read and written LOGDUMP_CHUNK_SIZE bytes at a time, the size of the CDC
+*	endpoint. Console_Write() fills the endpoint before it sends, so the frames
+*	go out as full packets, apart from the last one and any the 8ms USB task
+*	flushes early. The CRC is worked out
+*	while the bytes come in from the SPI bus. If a frame is damaged, or the
+*	transfer stops, the tool asks again starting at that page, with the retry
+*	argument set so the records being filled are not stored again.
+*
+*	@{
+*/
+
+#ifndef _LOGDUMP_H_
+#define _LOGDUMP_H_
+
+#include <stdint.h>
+
+#define LOGDUMP_FRAME_START			0x1D		//ASCII group separator, not used by the console text
+#define LOGDUMP_END_PAGE			0xFFFF
+#define LOGDUMP_CHUNK_SIZE			64			//Bytes read from the dataflash at a time, one CDC packet
+
+/** Send pages as frames, then the end frame.
+*	\param[in] First	First page
+*	\param[in] Count	Number of pages, cut off at the end of the chip
+*	\return The number of pages sent, less than asked for if the host stopped reading
+*/
+uint16_t LogDump_Pages(uint16_t First, uint16_t Count);
+
+#endif
+
+/** @} */
@@ -0,0 +1,634 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Log structured record store on the dataflash.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+#include <util/crc16.h>
+
+#define LOGSTORE_MAGIC_0			'L'
+#define LOGSTORE_MAGIC_1			'G'
+#define LOGSTORE_CRC_START			0xFFFF
+#define LOGSTORE_NO_PAGE			0xFFFF
+#define LOGSTORE_NO_KEY				0xFFFFFFFF
+
+static uint8_t LogStoreReady;
+static uint16_t LogStoreHead;				//Page the buffer will be programmed to
+static uint16_t LogStoreTail;				//Oldest page
+static uint32_t LogStoreSequence;			//Sequence number of that page
+static uint8_t LogStoreBuffer;				//Dataflash SRAM buffer being filled
+static uint8_t LogStoreUsed;				//Bytes of records in the buffer
+static uint8_t LogStoreRecords;
+static uint16_t LogStoreCrc;				//CRC of the records in the buffer
+static uint32_t LogStoreKey;				//Key of the first record in the buffer
+
+//Key of the first page of every index step, LOGSTORE_NO_KEY if it was not valid at power on
+static uint32_t LogStoreIndex[LOGSTORE_INDEX_ENTRIES];
+
+//Reference sample for the recorder backend's deltas
+static SampleCodecState LogStoreEncoder;
+
+//Filter and decoder for LogStore_PrintRecords()
+static SampleCodecState LogStorePrintDecoder;
+static uint32_t LogStorePrintFrom;
+static uint32_t LogStorePrintTo;
+static uint16_t LogStorePrinted;
+
+static uint16_t LogStore_Crc(uint16_t Crc, const uint8_t *Data, uint8_t Length)
+{
+	while(Length-- > 0)
+	{
+		Crc = _crc_ccitt_update(Crc, *Data++);
+	}
+	return Crc;
+}
+
+static uint8_t LogStore_Blank(const uint8_t *Data, uint8_t Length)
+{
+	while(Length-- > 0)
+	{
+		if(*Data++ != 0xFF)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static uint32_t LogStore_Get32(const uint8_t *Bytes)
+{
+	return Bytes[0] | ((uint32_t)Bytes[1] << 8) | ((uint32_t)Bytes[2] << 16) | ((uint32_t)Bytes[3] << 24);
+}
+
+static void LogStore_Put32(uint8_t *Bytes, uint32_t Value)
+{
+	Bytes[0] = Value;
+	Bytes[1] = Value >> 8;
+	Bytes[2] = Value >> 16;
+	Bytes[3] = Value >> 24;
+	return;
+}
+
+static uint32_t LogStore_HeaderSequence(const uint8_t *Header)
+{
+	return LogStore_Get32(&Header[2]);
+}
+
+//Read a page header, returns 1 if it has been programmed or could not be read
+static uint8_t LogStore_ReadHeader(uint16_t Page, uint8_t *Header)
+{
+	if(Dataflash_Read(Page, 0, Header, LOGSTORE_HEADER_SIZE) != 0)
+	{
+		return 1;
+	}
+	return !LogStore_Blank(Header, LOGSTORE_HEADER_SIZE);
+}
+
+//Returns 1 if the whole page is erased
+static uint8_t LogStore_PageBlank(uint16_t Page)
+{
+	uint8_t Chunk[16];
+	uint16_t Offset;
+
+	for(Offset = 0; Offset < DATAFLASH_PAGE_SIZE; Offset += sizeof(Chunk))
+	{
+		if(Dataflash_Read(Page, Offset, Chunk, sizeof(Chunk)) != 0)
+		{
+			return 0;
+		}
+		if(!LogStore_Blank(Chunk, (DATAFLASH_PAGE_SIZE - Offset < sizeof(Chunk)) ? (DATAFLASH_PAGE_SIZE - Offset) : sizeof(Chunk)))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+//Erase a block unless all its page headers are erased. Returns 1 if the erase could not be started.
+static uint8_t LogStore_EraseIfUsed(uint16_t Block)
+{
+	uint8_t Header[LOGSTORE_HEADER_SIZE];
+	uint8_t i;
+
+	for(i = 0; i < DATAFLASH_BLOCK_PAGES; i++)
+	{
+		if(LogStore_ReadHeader((Block * DATAFLASH_BLOCK_PAGES) + i, Header))
+		{
+			return Dataflash_EraseBlock(Block);
+		}
+	}
+	return 0;
+}
+
+uint8_t LogStore_Init(void)
+{
+	uint8_t Header[LOGSTORE_HEADER_SIZE];
+	LogStorePage Info;
+	uint16_t Newest = LOGSTORE_NO_PAGE;
+	uint32_t NewestSequence = 0;
+	uint16_t Page;
+	uint16_t Good;
+
+	LogStoreReady = 0;
+	if(Dataflash_Init() != 0)
+	{
+		return 1;
+	}
+
+	//Pages in a block are programmed in order, so look at the first good page of each block,
+	//then at the pages in the newest block. Only a page with a good CRC is trusted, a header
+	//left half programmed by a power failure can have any sequence number.
+	for(Page = 0; Page < DATAFLASH_PAGES; Page += DATAFLASH_BLOCK_PAGES)
+	{
+		for(Good = Page; Good < (Page + DATAFLASH_BLOCK_PAGES); Good++)
+		{
+			if(LogStore_ReadPage(Good, &Info) == 0)
+			{
+				if((Newest == LOGSTORE_NO_PAGE) || (Info.Sequence > NewestSequence))
+				{
+					Newest = Good;
+					NewestSequence = Info.Sequence;
+				}
+				break;
+			}
+			if(!LogStore_ReadHeader(Good, Header))
+			{
+				//The rest of the block has not been used
+				Good = LOGSTORE_NO_PAGE;
+				break;
+			}
+		}
+		if((Page % LOGSTORE_INDEX_PAGES) == 0)
+		{
+			LogStoreIndex[Page / LOGSTORE_INDEX_PAGES] = (Good == Page) ? Info.Key : LOGSTORE_NO_KEY;
+		}
+	}
+
+	if(Newest == LOGSTORE_NO_PAGE)
+	{
+		LogStoreHead = 0;
+		LogStoreSequence = 1;
+	}
+	else
+	{
+		for(Page = Newest + 1; (Page % DATAFLASH_BLOCK_PAGES) != 0; Page++)
+		{
+			if((LogStore_ReadPage(Page, &Info) == 0) && (Info.Sequence > NewestSequence))
+			{
+				Newest = Page;
+				NewestSequence = Info.Sequence;
+			}
+		}
+		LogStoreHead = (Newest + 1) % DATAFLASH_PAGES;
+		LogStoreSequence = NewestSequence + 1;
+	}
+
+	//A page left half programmed by a power failure can't be programmed again without an erase
+	while(!LogStore_PageBlank(LogStoreHead))
+	{
+		if((LogStoreHead % DATAFLASH_BLOCK_PAGES) == 0)
+		{
+			if(Dataflash_EraseBlock(LogStoreHead / DATAFLASH_BLOCK_PAGES) != 0)
+			{
+				return 1;
+			}
+		}
+		else
+		{
+			LogStoreHead = (LogStoreHead + 1) % DATAFLASH_PAGES;
+		}
+	}
+
+	//The power may also have failed before the block ahead was erased
+	if(LogStore_EraseIfUsed(((LogStoreHead / DATAFLASH_BLOCK_PAGES) + 1) % DATAFLASH_BLOCKS) != 0)
+	{
+		return 1;
+	}
+
+	//The oldest data is after the erased block, unless the log has not been around the chip yet
+	Page = (((LogStoreHead / DATAFLASH_BLOCK_PAGES) + 2) % DATAFLASH_BLOCKS) * DATAFLASH_BLOCK_PAGES;
+	LogStoreTail = LogStore_ReadHeader(Page, Header) ? Page : 0;
+
+	LogStoreBuffer = 0;
+	LogStoreUsed = 0;
+	LogStoreRecords = 0;
+	LogStoreCrc = LOGSTORE_CRC_START;
+	SampleCodec_Reset(&LogStoreEncoder);
+	LogStoreReady = 1;
+	return 0;
+}
+
+//Program the buffer. If the chip stays busy the log is stopped, the page it was
+//working on can't be trusted and programming over it would corrupt it.
+static uint8_t LogStore_Commit(void)
+{
+	uint8_t Header[LOGSTORE_HEADER_SIZE];
+	uint16_t Crc;
+	uint16_t Block;
+
+	if(LogStoreRecords == 0)
+	{
+		return 0;
+	}
+
+	Header[0] = LOGSTORE_MAGIC_0;
+	Header[1] = LOGSTORE_MAGIC_1;
+	LogStore_Put32(&Header[2], LogStoreSequence);
+	LogStore_Put32(&Header[6], LogStoreKey);
+	Header[10] = LogStoreRecords;
+	Header[11] = LogStoreUsed;
+	Crc = LogStore_Crc(LogStoreCrc, Header, 12);
+	Header[12] = Crc;
+	Header[13] = Crc >> 8;
+
+	if((Dataflash_BufferWrite(LogStoreBuffer, 0, Header, LOGSTORE_HEADER_SIZE) != 0) || (Dataflash_BufferProgram(LogStoreBuffer, LogStoreHead) != 0))
+	{
+		LogStoreReady = 0;
+		return 1;
+	}
+
+	if((LogStoreHead % LOGSTORE_INDEX_PAGES) == 0)
+	{
+		LogStoreIndex[LogStoreHead / LOGSTORE_INDEX_PAGES] = LogStoreKey;
+	}
+
+	//Keep an erased block ahead of the head. The erase runs while the other buffer fills.
+	if((LogStoreHead % DATAFLASH_BLOCK_PAGES) == 0)
+	{
+		Block = ((LogStoreHead / DATAFLASH_BLOCK_PAGES) + 1) % DATAFLASH_BLOCKS;
+		if(Dataflash_EraseBlock(Block) != 0)
+		{
+			LogStoreReady = 0;
+			return 1;
+		}
+		if((LogStoreTail / DATAFLASH_BLOCK_PAGES) == Block)
+		{
+			LogStoreTail = ((Block + 1) % DATAFLASH_BLOCKS) * DATAFLASH_BLOCK_PAGES;
+		}
+	}
+
+	LogStoreHead = (LogStoreHead + 1) % DATAFLASH_PAGES;
+	LogStoreSequence++;
+	LogStoreBuffer ^= 1;
+	LogStoreUsed = 0;
+	LogStoreRecords = 0;
+	LogStoreCrc = LOGSTORE_CRC_START;
+	return 0;
+}
+
+uint8_t LogStore_Append(const void *Data, uint8_t Length, uint32_t Key)
+{
+	if((LogStoreReady == 0) || (Length > LOGSTORE_RECORD_MAX))
+	{
+		return 1;
+	}
+
+	if(((LogStoreUsed + 1 + Length) > LOGSTORE_DATA_SIZE) && (LogStore_Commit() != 0))
+	{
+		return 1;
+	}
+	if(LogStoreRecords == 0)
+	{
+		LogStoreKey = Key;
+	}
+
+	if((Dataflash_BufferWrite(LogStoreBuffer, LOGSTORE_HEADER_SIZE + LogStoreUsed, &Length, 1) != 0) ||
+		(Dataflash_BufferWrite(LogStoreBuffer, LOGSTORE_HEADER_SIZE + LogStoreUsed + 1, Data, Length) != 0))
+	{
+		LogStoreReady = 0;
+		return 1;
+	}
+	LogStoreCrc = LogStore_Crc(LogStoreCrc, &Length, 1);
+	LogStoreCrc = LogStore_Crc(LogStoreCrc, Data, Length);
+	LogStoreUsed += 1 + Length;
+	LogStoreRecords++;
+	return 0;
+}
+
+uint8_t LogStore_Flush(void)
+{
+	if(LogStoreReady)
+	{
+		return LogStore_Commit();
+	}
+	return 0;
+}
+
+uint8_t LogStore_ReadPage(uint16_t Page, LogStorePage *Info)
+{
+	uint8_t Header[LOGSTORE_HEADER_SIZE];
+	uint8_t Chunk[16];
+	uint16_t Crc = LOGSTORE_CRC_START;
+	uint8_t Offset;
+	uint8_t Length;
+
+	if(Dataflash_Read(Page, 0, Header, LOGSTORE_HEADER_SIZE) != 0)
+	{
+		return 1;
+	}
+	if((Header[0] != LOGSTORE_MAGIC_0) || (Header[1] != LOGSTORE_MAGIC_1) || (Header[11] > LOGSTORE_DATA_SIZE))
+	{
+		return 1;
+	}
+
+	for(Offset = 0; Offset < Header[11]; Offset += Length)
+	{
+		Length = ((Header[11] - Offset) < sizeof(Chunk)) ? (Header[11] - Offset) : sizeof(Chunk);
+		if(Dataflash_Read(Page, LOGSTORE_HEADER_SIZE + Offset, Chunk, Length) != 0)
+		{
+			return 1;
+		}
+		Crc = LogStore_Crc(Crc, Chunk, Length);
+	}
+	Crc = LogStore_Crc(Crc, Header, 12);
+	if(Crc != (Header[12] | (Header[13] << 8)))
+	{
+		return 1;
+	}
+
+	Info->Sequence = LogStore_HeaderSequence(Header);
+	Info->Key = LogStore_Get32(&Header[6]);
+	Info->Records = Header[10];
+	Info->Used = Header[11];
+	return 0;
+}
+
+uint8_t LogStore_ReadData(uint16_t Page, uint8_t Offset, void *Data, uint8_t Length)
+{
+	return Dataflash_Read(Page, LOGSTORE_HEADER_SIZE + Offset, Data, Length);
+}
+
+//Pages from the tail to a page
+static uint16_t LogStore_Distance(uint16_t Page)
+{
+	return (Page + DATAFLASH_PAGES - LogStoreTail) % DATAFLASH_PAGES;
+}
+
+//Key in a page header without checking the CRC. A header that was not fully
+//programmed has bits that are still set, so its key can only be too high.
+static uint8_t LogStore_PageKey(uint16_t Page, uint32_t *Key)
+{
+	uint8_t Header[LOGSTORE_HEADER_SIZE];
+
+	if(Dataflash_Read(Page, 0, Header, LOGSTORE_HEADER_SIZE) != 0)
+	{
+		return 1;
+	}
+	if((Header[0] != LOGSTORE_MAGIC_0) || (Header[1] != LOGSTORE_MAGIC_1))
+	{
+		return 1;
+	}
+	*Key = LogStore_Get32(&Header[6]);
+	return 0;
+}
+
+//The last page whose first key is below From, or the tail. Records with a key
+//equal to From can be at the end of the page before the first one that starts with it.
+static uint16_t LogStore_Find(uint32_t From)
+{
+	uint16_t Length = LogStore_Distance(LogStoreHead);
+	uint16_t First = ((LogStoreTail + LOGSTORE_INDEX_PAGES - 1) / LOGSTORE_INDEX_PAGES) % LOGSTORE_INDEX_ENTRIES;
+	uint16_t Entries = 0;
+	uint16_t Low = 0;
+	uint16_t High;
+	uint16_t Middle;
+	uint16_t Page;
+	uint32_t Key;
+
+	//Index entries for pages in the log, oldest first
+	Page = LogStore_Distance(First * LOGSTORE_INDEX_PAGES);
+	if(Page < Length)
+	{
+		Entries = ((Length - Page - 1) / LOGSTORE_INDEX_PAGES) + 1;
+	}
+
+	//First entry that is not below From. An entry for a damaged page reads as
+	//LOGSTORE_NO_KEY, which can only move the start back.
+	High = Entries;
+	while(Low < High)
+	{
+		Middle = (Low + High) / 2;
+		if(LogStoreIndex[(First + Middle) % LOGSTORE_INDEX_ENTRIES] >= From)
+		{
+			High = Middle;
+		}
+		else
+		{
+			Low = Middle + 1;
+		}
+	}
+
+	//Then the same for the page headers up to that entry. Damaged headers count as not below.
+	if(Low == 0)
+	{
+		Page = LogStoreTail;
+		High = LogStore_Distance(First * LOGSTORE_INDEX_PAGES);
+	}
+	else
+	{
+		Page = ((First + Low - 1) % LOGSTORE_INDEX_ENTRIES) * LOGSTORE_INDEX_PAGES;
+		High = LogStore_Distance(Page) + LOGSTORE_INDEX_PAGES;
+	}
+	High = ((High < Length) ? High : Length) - LogStore_Distance(Page);
+	Low = 1;
+	while(Low < High)
+	{
+		Middle = (Low + High) / 2;
+		if((LogStore_PageKey((Page + Middle) % DATAFLASH_PAGES, &Key) != 0) || (Key >= From))
+		{
+			High = Middle;
+		}
+		else
+		{
+			Low = Middle + 1;
+		}
+	}
+	return (Page + Low - 1) % DATAFLASH_PAGES;
+}
+
+uint16_t LogStore_Read(uint32_t From, LogStoreVisitor Visitor)
+{
+	uint8_t Record[LOGSTORE_VISIT_SIZE];
+	LogStorePage Info;
+	uint16_t Length;
+	uint16_t Page;
+	uint16_t Pages = 0;
+	uint8_t Offset;
+	uint8_t Size;
+
+	if(LogStoreReady == 0)
+	{
+		return 0;
+	}
+
+	Length = LogStore_Distance(LogStoreHead);
+	for(Page = LogStore_Find(From); LogStore_Distance(Page) < Length; Page = (Page + 1) % DATAFLASH_PAGES)
+	{
+		Pages++;
+		if(LogStore_ReadPage(Page, &Info) != 0)
+		{
+			continue;
+		}
+		for(Offset = 0; Offset < Info.Used; Offset += 1 + Size)
+		{
+			if((LogStore_ReadData(Page, Offset, &Size, 1) != 0) ||
+				(LogStore_ReadData(Page, Offset + 1, Record, (Size < sizeof(Record)) ? Size : sizeof(Record)) != 0))
+			{
+				return Pages;
+			}
+			if(Visitor(Record, Size))
+			{
+				return Pages;
+			}
+		}
+	}
+
+	//Records that are not programmed yet
+	for(Offset = 0; Offset < LogStoreUsed; Offset += 1 + Size)
+	{
+		if((Dataflash_BufferRead(LogStoreBuffer, LOGSTORE_HEADER_SIZE + Offset, &Size, 1) != 0) ||
+			(Dataflash_BufferRead(LogStoreBuffer, LOGSTORE_HEADER_SIZE + Offset + 1, Record, (Size < sizeof(Record)) ? Size : sizeof(Record)) != 0))
+		{
+			break;
+		}
+		if(Visitor(Record, Size))
+		{
+			break;
+		}
+	}
+	return Pages;
+}
+
+uint16_t LogStore_Tail(void)
+{
+	return LogStoreTail;
+}
+
+uint16_t LogStore_Head(void)
+{
+	return LogStoreHead;
+}
+
+uint32_t LogStore_Sequence(void)
+{
+	return LogStoreSequence;
+}
+
+uint8_t LogStore_RecorderBackend(const RecorderRecord *Records, uint8_t Count)
+{
+	uint8_t Encoded[SAMPLECODEC_MAX_SIZE];
+	uint8_t Errors = 0;
+	uint8_t Length;
+	uint8_t i;
+
+	if(LogStoreReady == 0)
+	{
+		return 1;
+	}
+
+	for(i = 0; i < Count; i++)
+	{
+		//Every page starts with a keyframe, so reading can start at any page
+		Length = SampleCodec_Encode(&LogStoreEncoder, &Records[i], (LogStoreRecords == 0), Encoded);
+		if((LogStoreUsed + 1 + Length) > LOGSTORE_DATA_SIZE)
+		{
+			if(LogStore_Commit() != 0)
+			{
+				return 1;
+			}
+			Length = SampleCodec_Encode(&LogStoreEncoder, &Records[i], 1, Encoded);
+		}
+
+		if(LogStore_Append(Encoded, Length, Records[i].Seconds) == 0)
+		{
+			SampleCodec_Next(&LogStoreEncoder, &Records[i]);
+		}
+		else
+		{
+			SampleCodec_Reset(&LogStoreEncoder);
+			Errors = 1;
+		}
+	}
+	return Errors;
+}
+
+static uint8_t LogStore_PrintRecord(const uint8_t *Data, uint8_t Length)
+{
+	RecorderRecord Record;
+	uint8_t i;
+
+	if((Length > LOGSTORE_VISIT_SIZE) || (SampleCodec_Decode(&LogStorePrintDecoder, Data, Length, &Record) != 0))
+	{
+		return 0;
+	}
+	if(Record.Seconds < LogStorePrintFrom)
+	{
+		return 0;
+	}
+	if(Record.Seconds > LogStorePrintTo)
+	{
+		return 1;
+	}
+
+	Format_ULong(Console_PutChar, Record.Seconds);
+	Console_PutChar('.');
+	Format_UInt(Console_PutChar, Record.Milliseconds, 3, '0');
+	for(i = 0; i < RECORDER_CHANNELS; i++)
+	{
+		Console_PutChar(',');
+		if(Record.Channels & (1 << i))
+		{
+			Format_Int(Console_PutChar, Record.Value[i]);
+		}
+	}
+	Console_PutChar('\n');
+	LogStorePrinted++;
+	return 0;
+}
+
+void LogStore_PrintRecords(uint32_t From, uint32_t To)
+{
+	uint16_t Pages;
+
+	if(LogStoreReady == 0)
+	{
+		Format_Puts_P(Console_PutChar, "No dataflash\n");
+		return;
+	}
+
+	SampleCodec_Reset(&LogStorePrintDecoder);
+	LogStorePrintFrom = From;
+	LogStorePrintTo = To;
+	LogStorePrinted = 0;
+	Format_Puts_P(Console_PutChar, "seconds,pressure,temperature,humidity\n");
+	Pages = LogStore_Read(From, LogStore_PrintRecord);
+
+	Format_Puts_P(Console_PutChar, "Records: ");
+	Format_UInt(Console_PutChar, LogStorePrinted, 0, ' ');
+	Format_Puts_P(Console_PutChar, ", pages read: ");
+	Format_UInt(Console_PutChar, Pages, 0, ' ');
+	Console_PutChar('\n');
+	return;
+}
+
+/** @} */
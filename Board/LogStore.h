@@ -0,0 +1,140 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Log structured record store on the dataflash header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Records are appended to a circular log that covers the whole chip. They
+*	are collected in one of the dataflash SRAM buffers, so nothing is
+*	programmed until a page is full. The full page is then programmed from
+*	that buffer while the next records go into the other one.
+*
+*	Pages are never programmed twice between erases. When the write head
+*	enters a block, the next block is erased, so there is always an erased
+*	block ahead of the head. Going around the chip erases every block once
+*	per lap, which spreads the wear evenly and rewrites every page in a
+*	sector as often as the data sheet asks.
+*
+*	Each page starts with a header:
+*	- 0-1: 'L' 'G'
+*	- 2-5: sequence number, one more for each page programmed
+*	- 6-9: key of the first record, the recorder uses its time in seconds
+*	- 10: number of records
+*	- 11: bytes of records after the header
+*	- 12-13: CRC-CCITT of the records and header bytes 0-11
+*
+*	Each record is a length byte followed by the data. The header is written
+*	last and only counts if the CRC matches, so a page that was being
+*	programmed when the power failed is skipped. At power on the newest page
+*	is found from the sequence numbers of the pages with a good CRC, and the
+*	log continues after it.
+*
+*	If the dataflash is still busy after the longest erase time, the write
+*	that needed it is not sent and the log stops until the next power on,
+*	so a stuck chip can not have pages programmed twice or over a block that
+*	was not erased. LogStore_Append() and LogStore_Flush() return 1 from then
+*	on, and the recorder counts it as an error.
+*
+*	Keys must not go down as records are appended. The key of every
+*	LOGSTORE_INDEX_PAGES'th page is kept in RAM, read from the flash at power
+*	on and updated as those pages are programmed. LogStore_Read() finds where
+*	to start with a binary search of this index and then of the page headers
+*	in between, so a query only reads the pages it needs. The index is kept
+*	coarse because the ATmega32U2 only has 1kB of RAM.
+*
+*	@{
+*/
+
+#ifndef _LOGSTORE_H_
+#define _LOGSTORE_H_
+
+#include <stdint.h>
+
+#define LOGSTORE_HEADER_SIZE		14
+#define LOGSTORE_DATA_SIZE			(DATAFLASH_PAGE_SIZE - LOGSTORE_HEADER_SIZE)
+#define LOGSTORE_RECORD_MAX			(LOGSTORE_DATA_SIZE - 1)		//Longest record
+
+#define LOGSTORE_INDEX_PAGES		128								//Pages for each index entry
+#define LOGSTORE_VISIT_SIZE			32								//Bytes of each record passed to a LogStoreVisitor
+#define LOGSTORE_INDEX_ENTRIES		(DATAFLASH_PAGES / LOGSTORE_INDEX_PAGES)
+
+/** Header of a programmed page. */
+typedef struct
+{
+	uint32_t Sequence;
+	uint32_t Key;						//Key of the first record
+	uint8_t Records;
+	uint8_t Used;						//Bytes of records
+} LogStorePage;
+
+/** Called by LogStore_Read() for each record, with the first LOGSTORE_VISIT_SIZE bytes
+*	of longer records. Length is the full length. Return 1 to stop.
+*/
+typedef uint8_t (*LogStoreVisitor)(const uint8_t *Record, uint8_t Length);
+
+/** Find the end of the log.
+*	\return 0 if the log is ready, 1 if there is no dataflash
+*/
+uint8_t LogStore_Init(void);
+
+/** Add a record. Records do not span pages.
+*	\param[in] Key		Sort key of the record, the same or higher than the last one
+*	\return 0 if the record was added, 1 if it is too long, there is no dataflash or it stayed busy
+*/
+uint8_t LogStore_Append(const void *Data, uint8_t Length, uint32_t Key);
+
+/** Program the records that are waiting in the SRAM buffer, even if the page is not full.
+*	\return 0 if they were programmed or there was nothing to program, 1 if the dataflash stayed busy
+*/
+uint8_t LogStore_Flush(void);
+
+/** Read the header of a page and check its CRC.
+*	\return 0 if the page holds valid records, 1 if it is erased or damaged
+*/
+uint8_t LogStore_ReadPage(uint16_t Page, LogStorePage *Info);
+
+/** Read record bytes from a page. Offset 0 is the length byte of the first record. Returns 1 if the dataflash stayed busy. */
+uint8_t LogStore_ReadData(uint16_t Page, uint8_t Offset, void *Data, uint8_t Length);
+
+/** Pass records to the visitor, oldest first, starting at the last page whose first key
+*	is below From. The records that are still in the SRAM buffer are included.
+*	\return The number of pages read
+*/
+uint16_t LogStore_Read(uint32_t From, LogStoreVisitor Visitor);
+
+/** The oldest page of the log. */
+uint16_t LogStore_Tail(void);
+
+/** The next page that will be programmed. */
+uint16_t LogStore_Head(void);
+
+/** Sequence number the next page will get. */
+uint32_t LogStore_Sequence(void);
+
+/** Storage backend for the data recorder, see Recorder_SetBackend(). Records are stored
+*	with SampleCodec_Encode(), with a keyframe at the start of each page.
+*/
+uint8_t LogStore_RecorderBackend(const RecorderRecord *Records, uint8_t Count);
+
+/** Print the recorder records with times from From to To (seconds since 1/1/2000) as CSV. */
+void LogStore_PrintRecords(uint32_t From, uint32_t To);
+
+#endif
+
+/** @} */
@@ -0,0 +1,237 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		MPL115A1 pressure sensor driver.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+//Registers
+#define MPL115A1_REG_PADC			0x00
+#define MPL115A1_REG_A0				0x04
+#define MPL115A1_REG_CONVERT		0x12
+
+//Command bytes, the register address is in bits 6-1
+#define MPL115A1_READ(Reg)			(0x80 | ((Reg) << 1))
+#define MPL115A1_WRITE(Reg)			((Reg) << 1)
+
+#define MPL115A1_NO_TADC			0xFFFF		//Readings are 10 bits, so this never matches
+
+//Queued transactions
+#define MPL115A1_CONVERT_LENGTH		2
+#define MPL115A1_RESULT_LENGTH		9			//A command and a data byte for each of the four result registers, and one more
+
+static MPL115A1Coefficients MPL115A1Coef;
+static uint8_t MPL115A1Present;
+
+//Terms that only depend on the temperature, worked out for MPL115A1TermsTadc
+static uint16_t MPL115A1TermsTadc;
+static int32_t MPL115A1PadcScale;		//b1 + c12 * Tadc, 13 fractional bits
+static int32_t MPL115A1Offset;			//a0 + b2 * Tadc, 13 fractional bits
+
+//Last reading
+static uint8_t MPL115A1Valid;
+static int16_t MPL115A1Pressure;
+static uint16_t MPL115A1Padc;
+static uint16_t MPL115A1Tadc;
+
+//The conversion or result transaction, and its bytes
+static SPITransaction MPL115A1Transfer;
+static uint8_t MPL115A1Command[MPL115A1_RESULT_LENGTH];
+static uint8_t MPL115A1Data[MPL115A1_RESULT_LENGTH];
+
+static void MPL115A1_Done(SPITransaction *Transaction);
+
+//Reads Count registers. Each register is read with its own command byte, and the data comes back during the next byte.
+static void MPL115A1_ReadRegisters(uint8_t First, uint8_t *Data, uint8_t Count)
+{
+	uint8_t i;
+
+	SPI_Select(SPI_DEVICE_PRESSURE);
+	for(i = 0; i < Count; i++)
+	{
+		SPI_Transfer(MPL115A1_READ(First + i));
+		Data[i] = SPI_Transfer(0x00);
+	}
+	SPI_Transfer(0x00);
+	SPI_Deselect();
+	return;
+}
+
+uint8_t MPL115A1_Init(void)
+{
+	uint8_t Data[8];
+	uint8_t i;
+
+	MPL115A1Present = 0;
+	MPL115A1Valid = 0;
+	MPL115A1TermsTadc = MPL115A1_NO_TADC;
+
+	MPL115A1_ReadRegisters(MPL115A1_REG_A0, Data, sizeof(Data));
+	MPL115A1Coef.A0 = (Data[0] << 8) | Data[1];
+	MPL115A1Coef.B1 = (Data[2] << 8) | Data[3];
+	MPL115A1Coef.B2 = (Data[4] << 8) | Data[5];
+	MPL115A1Coef.C12 = (Data[6] << 8) | Data[7];
+
+	//There is no ID register. Without a sensor every byte reads the same.
+	for(i = 1; i < sizeof(Data); i++)
+	{
+		if(Data[i] != Data[0])
+		{
+			MPL115A1Present = 1;
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int16_t MPL115A1_Compensate(uint16_t Padc, uint16_t Tadc)
+{
+	int16_t Pcomp;
+
+	//Pcomp = a0 + (b1 + c12 * Tadc) * Padc + b2 * Tadc, the temperature changes slowly
+	if(Tadc != MPL115A1TermsTadc)
+	{
+		MPL115A1PadcScale = MPL115A1Coef.B1 + (((int32_t)MPL115A1Coef.C12 * Tadc) >> 11);
+		MPL115A1Offset = ((int32_t)MPL115A1Coef.A0 << 10) + (((int32_t)MPL115A1Coef.B2 * Tadc) >> 1);
+		MPL115A1TermsTadc = Tadc;
+	}
+	Pcomp = (MPL115A1Offset + (MPL115A1PadcScale * Padc)) >> 9;
+
+	//Pcomp is 0 to 1023 (4 fractional bits) for 50 to 115kPa. 65/1023 is 1041/16384.
+	return (((int32_t)Pcomp * 1041) >> 14) + (50 << 4);
+}
+
+//Queue the bytes in MPL115A1Command, MPL115A1_Done() carries on when they are sent
+static void MPL115A1_Submit(uint8_t Length)
+{
+	MPL115A1Transfer.Device = SPI_DEVICE_PRESSURE;
+	MPL115A1Transfer.Write = MPL115A1Command;
+	MPL115A1Transfer.Read = MPL115A1Data;
+	MPL115A1Transfer.Length = Length;
+	MPL115A1Transfer.Callback = MPL115A1_Done;
+
+	//If the queue is full this reading is skipped, and the next conversion tries again
+	SPI_Submit(&MPL115A1Transfer);
+	return;
+}
+
+//Read the results, from the scheduler
+static void MPL115A1_Collect(void)
+{
+	uint8_t i;
+
+	if(MPL115A1Transfer.Status == SPI_STATUS_PENDING)
+	{
+		return;
+	}
+
+	for(i = 0; i < 4; i++)
+	{
+		MPL115A1Command[2 * i] = MPL115A1_READ(MPL115A1_REG_PADC + i);
+		MPL115A1Command[2 * i + 1] = 0x00;
+	}
+	MPL115A1Command[8] = 0x00;
+	MPL115A1_Submit(MPL115A1_RESULT_LENGTH);
+	return;
+}
+
+//Start a conversion, from the scheduler
+static void MPL115A1_Convert(void)
+{
+	if(MPL115A1Transfer.Status == SPI_STATUS_PENDING)
+	{
+		return;
+	}
+
+	MPL115A1Command[0] = MPL115A1_WRITE(MPL115A1_REG_CONVERT);
+	MPL115A1Command[1] = 0x00;
+	MPL115A1_Submit(MPL115A1_CONVERT_LENGTH);
+	return;
+}
+
+//A transaction is done, called from the SPI interrupt
+static void MPL115A1_Done(SPITransaction *Transaction)
+{
+	if(Transaction->Length == MPL115A1_CONVERT_LENGTH)
+	{
+		//The conversion time starts when the command is in.
+		//If the scheduler is full this reading is skipped, and the next conversion tries again.
+		Scheduler_Start(MPL115A1_Collect, MPL115A1_CONVERSION_MS, 0);
+		return;
+	}
+
+	//Each register comes back during the byte after its command
+	MPL115A1Padc = ((MPL115A1Data[1] << 8) | MPL115A1Data[3]) >> 6;
+	MPL115A1Tadc = ((MPL115A1Data[5] << 8) | MPL115A1Data[7]) >> 6;
+	MPL115A1Pressure = MPL115A1_Compensate(MPL115A1Padc, MPL115A1Tadc);
+	MPL115A1Valid = 1;
+	Recorder_SetValue(RECORDER_CHANNEL_PRESSURE, MPL115A1Pressure);
+	return;
+}
+
+uint8_t MPL115A1_SetPeriod(uint16_t Period)
+{
+	if(Period == 0)
+	{
+		Scheduler_Stop(MPL115A1_Convert);
+		Scheduler_Stop(MPL115A1_Collect);
+		return 0;
+	}
+	if((MPL115A1Present == 0) || (Period <= MPL115A1_CONVERSION_MS))
+	{
+		return 1;
+	}
+	return Scheduler_Start(MPL115A1_Convert, 0, Period);
+}
+
+uint8_t MPL115A1_GetPressure(int16_t *Pressure)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	*Pressure = MPL115A1Pressure;
+	SREG = sreg;
+	return (MPL115A1Valid == 0);
+}
+
+void MPL115A1_GetRaw(uint16_t *Padc, uint16_t *Tadc)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	*Padc = MPL115A1Padc;
+	*Tadc = MPL115A1Tadc;
+	SREG = sreg;
+	return;
+}
+
+void MPL115A1_GetCoefficients(MPL115A1Coefficients *Coefficients)
+{
+	*Coefficients = MPL115A1Coef;
+	return;
+}
+
+/** @} */
@@ -0,0 +1,90 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		MPL115A1 pressure sensor driver header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The sensor is on the SPI bus with its chip select on PB4. It returns raw
+*	10 bit pressure and temperature readings, which are corrected with four
+*	coefficients stored in the sensor. The coefficients are read once by
+*	MPL115A1_Init().
+*
+*	The compensation is the fixed point version from Freescale AN3785. The
+*	terms that only depend on the temperature are kept from the last reading
+*	and only worked out again when the temperature changes, which leaves one
+*	32x16 and one 16x16 multiply for most readings.
+*
+*	A conversion takes up to 3ms. Conversions are started by a scheduler task
+*	and read by a second task once they are done, so nothing waits for the
+*	sensor. Both queue their bytes on the SPI bus. The conversion time is
+*	counted from when the command has gone out, and the results are worked
+*	out in the SPI interrupt. Each reading is posted to the recorder's
+*	pressure channel.
+*
+*	@{
+*/
+
+#ifndef _MPL115A1_H_
+#define _MPL115A1_H_
+
+#include <stdint.h>
+
+#define MPL115A1_CONVERSION_MS		4		//3ms maximum, plus one for the resolution of the scheduler
+#define MPL115A1_PERIOD				1000	//Default time between conversions in ms
+
+/** Coefficients as stored in the sensor. */
+typedef struct
+{
+	int16_t A0;						//12 integer and 3 fractional bits
+	int16_t B1;						//2 integer and 13 fractional bits
+	int16_t B2;						//1 integer and 14 fractional bits
+	int16_t C12;					//22 fractional bits, in the top 14 bits
+} MPL115A1Coefficients;
+
+/** Read the coefficients.
+*	\return 0 if the sensor answered, 1 if not
+*/
+uint8_t MPL115A1_Init(void);
+
+/** Start a conversion every Period ms, or stop with a period of 0.
+*	\return 0 if done, 1 if there is no sensor, the period is too short or the scheduler is full
+*/
+uint8_t MPL115A1_SetPeriod(uint16_t Period);
+
+/** Get the last reading.
+*	\param[out] Pressure	kPa with 4 fractional bits
+*	\return 0 if there is a reading, 1 if not
+*/
+uint8_t MPL115A1_GetPressure(int16_t *Pressure);
+
+/** Get the raw 10 bit readings used for the last pressure. */
+void MPL115A1_GetRaw(uint16_t *Padc, uint16_t *Tadc);
+
+/** Get the coefficients read by MPL115A1_Init(). */
+void MPL115A1_GetCoefficients(MPL115A1Coefficients *Coefficients);
+
+/** Work out the pressure from raw readings with the coefficients read by MPL115A1_Init().
+*	\return kPa with 4 fractional bits
+*/
+int16_t MPL115A1_Compensate(uint16_t Padc, uint16_t Tadc);
+
+#endif
+
+/** @} */
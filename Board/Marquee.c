@@ -0,0 +1,122 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Scrolling text for LCD lines that are too long to fit.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+static const char *MarqueeText;		//Start of the scrolling line, NULL when stopped
+static uint8_t MarqueeLength;		//Length of the scrolling line
+static uint8_t MarqueeLine;
+static uint8_t MarqueeWidth;
+static uint8_t MarqueeOffset;		//Index of the character in the leftmost column
+static uint8_t MarqueeHold;			//Steps left to wait before moving
+
+uint8_t Marquee_LineLength(const char *Text)
+{
+	uint8_t Length = 0;
+	char c;
+
+	while(Length < 0xFF)
+	{
+		c = pgm_read_byte(Text + Length);
+		if((c == '\0') || (c == '\n'))
+		{
+			break;
+		}
+		Length++;
+	}
+	return Length;
+}
+
+//Scheduler task, draw the window and advance one column
+static void Marquee_Step(void)
+{
+	uint8_t i;
+	const char *Window;
+
+	if(MarqueeText == NULL)
+	{
+		return;
+	}
+
+	if(MarqueeHold > 0)
+	{
+		MarqueeHold--;
+		return;
+	}
+
+	if(MarqueeOffset >= (MarqueeLength - MarqueeWidth))
+	{
+		//At the end, go back to the start and pause there
+		MarqueeOffset = 0;
+		MarqueeHold = MARQUEE_HOLD_STEPS;
+	}
+	else
+	{
+		MarqueeOffset++;
+		if(MarqueeOffset == (MarqueeLength - MarqueeWidth))
+		{
+			MarqueeHold = MARQUEE_HOLD_STEPS;
+		}
+	}
+
+	Window = MarqueeText + MarqueeOffset;
+	SPI_LcdBegin();
+	LCDGeo_GotoXY(0, MarqueeLine);
+	for(i = 0; i < MarqueeWidth; i++)
+	{
+		lcd_data(pgm_read_byte(Window++));
+	}
+	SPI_LcdEnd();
+	return;
+}
+
+void Marquee_Start(const char *Text, uint8_t Line, uint8_t Width)
+{
+	Marquee_Stop();
+
+	MarqueeLength = Marquee_LineLength(Text);
+	if(MarqueeLength <= Width)
+	{
+		//Fits already
+		return;
+	}
+
+	MarqueeText = Text;
+	MarqueeLine = Line;
+	MarqueeWidth = Width;
+	MarqueeOffset = 0;
+	MarqueeHold = MARQUEE_HOLD_STEPS;
+	Scheduler_Start(Marquee_Step, MARQUEE_STEP_MS, MARQUEE_STEP_MS);
+	return;
+}
+
+void Marquee_Stop(void)
+{
+	Scheduler_Stop(Marquee_Step);
+	MarqueeText = NULL;
+	return;
+}
+
+/** @} */
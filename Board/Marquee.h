@@ -0,0 +1,55 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Scrolling text for LCD lines that are too long to fit header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The marquee scrolls one line of text from program memory through a window
+*	at the left of an LCD line, one column per step. Each step is a scheduler
+*	task that rewrites the window and returns, so the main loop is never held
+*	up. Only the line being scrolled is touched, the other line and anything
+*	to the right of the window stay as they are. One line can scroll at a time.
+*
+*	@{
+*/
+
+#ifndef _MARQUEE_H_
+#define _MARQUEE_H_
+
+#include <stdint.h>
+
+#define MARQUEE_STEP_MS			350		//Time between one column steps
+#define MARQUEE_HOLD_STEPS		4		//Number of steps to pause for at each end of the text
+
+/** Returns the length of a line of program memory text, up to the first '\n' or the end of the string. */
+uint8_t Marquee_LineLength(const char *Text);
+
+/** Start scrolling a line of text. Any text already scrolling is stopped.
+*	\param[in] Text		Text in program memory. The line ends at the first '\n' or the end of the string.
+*	\param[in] Line		LCD line to scroll on
+*	\param[in] Width	Number of columns to use, starting from column 0
+*/
+void Marquee_Start(const char *Text, uint8_t Line, uint8_t Width);
+
+/** Stop scrolling. The text is left where it is on the screen. */
+void Marquee_Stop(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,306 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Periodic data recorder.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+static RecorderRecord RecorderBuffer[2][RECORDER_BUFFER_RECORDS];
+static volatile uint8_t RecorderCount[2];		//Records in each buffer
+static volatile uint8_t RecorderFull[2];		//Set by the interrupt, cleared by the main loop when the buffer is stored
+static uint8_t RecorderFill;					//Buffer the interrupt writes to
+static uint8_t RecorderDrain;					//Buffer the main loop stores next
+
+static int16_t RecorderValue[RECORDER_CHANNELS];
+static uint8_t RecorderChannels;
+static uint16_t RecorderPeriod;
+static uint16_t RecorderCountdown;
+static uint32_t RecorderSeconds;
+static uint16_t RecorderMilliseconds;
+
+static RecorderStats RecorderCounters;
+static RecorderBackend RecorderStore;
+
+static const char RecorderNames[RECORDER_CHANNELS][12] PROGMEM = {"Pressure", "Temperature", "Humidity"};
+static const char RecorderUnits[RECORDER_CHANNELS][5] PROGMEM = {" kPa", " C", " %RH"};
+
+static void Recorder_Count(uint16_t *Counter)
+{
+	if(*Counter != 0xFFFF)
+	{
+		(*Counter)++;
+	}
+	return;
+}
+
+void Recorder_Init(void)
+{
+	uint8_t i;
+
+	DataRecoderActive = 0;
+	for(i = 0; i < 2; i++)
+	{
+		RecorderCount[i] = 0;
+		RecorderFull[i] = 0;
+	}
+	RecorderFill = 0;
+	RecorderDrain = 0;
+	for(i = 0; i < RECORDER_CHANNELS; i++)
+	{
+		RecorderValue[i] = 0;
+	}
+	memset(&RecorderCounters, 0, sizeof(RecorderCounters));
+	return;
+}
+
+void Recorder_SetBackend(RecorderBackend Backend)
+{
+	RecorderStore = Backend;
+	return;
+}
+
+void Recorder_SetValue(uint8_t Channel, int16_t Value)
+{
+	uint8_t sreg;
+
+	if(Channel >= RECORDER_CHANNELS)
+	{
+		return;
+	}
+
+	sreg = SREG;
+	cli();
+	Value = Filter_Apply(Channel, Value);
+	Rolling_Add(Channel, Value);
+	RecorderValue[Channel] = Value;
+	SREG = sreg;
+	return;
+}
+
+const char *Recorder_ChannelName(uint8_t Channel)
+{
+	return RecorderNames[(Channel < RECORDER_CHANNELS) ? Channel : 0];
+}
+
+const char *Recorder_ChannelUnit(uint8_t Channel)
+{
+	return RecorderUnits[(Channel < RECORDER_CHANNELS) ? Channel : 0];
+}
+
+void Recorder_PrintValue(FormatSink Sink, uint8_t Channel, int16_t Value)
+{
+	if(Channel == RECORDER_CHANNEL_PRESSURE)
+	{
+		Format_Fixed(Sink, Value, 4, 2);
+	}
+	else
+	{
+		Format_Decimal(Sink, Value, 2);
+	}
+	return;
+}
+
+uint8_t Recorder_Start(uint16_t Period, uint8_t Channels)
+{
+	TimeAndDate Now;
+	uint8_t sreg;
+
+	if((Period == 0) || (Channels == 0) || ((Channels & ~RECORDER_ALL_CHANNELS) != 0))
+	{
+		return 1;
+	}
+
+	//Read the clock in one go, so the milliseconds belong to the second
+	sreg = SREG;
+	cli();
+	GetTime(&Now);
+	RecorderMilliseconds = ElapsedMS;
+	RecorderSeconds = TimeToSeconds(&Now);
+	RecorderPeriod = Period;
+	RecorderCountdown = Period;
+	RecorderChannels = Channels;
+	DataRecoderActive = 1;
+	SREG = sreg;
+	return 0;
+}
+
+void Recorder_Stop(void)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	DataRecoderActive = 0;
+
+	//Hand over the partly filled buffer
+	if((RecorderFull[RecorderFill] == 0) && (RecorderCount[RecorderFill] > 0))
+	{
+		RecorderFull[RecorderFill] = 1;
+		RecorderFill ^= 1;
+	}
+	SREG = sreg;
+	return;
+}
+
+static void Recorder_Sample(void)
+{
+	RecorderRecord *Record;
+	uint8_t i;
+
+	if(RecorderFull[RecorderFill])
+	{
+		//The main loop has not stored this buffer yet
+		Recorder_Count(&RecorderCounters.Overruns);
+		return;
+	}
+
+	Record = &RecorderBuffer[RecorderFill][RecorderCount[RecorderFill]];
+	Record->Seconds = RecorderSeconds;
+	Record->Milliseconds = RecorderMilliseconds;
+	Record->Channels = RecorderChannels;
+	for(i = 0; i < RECORDER_CHANNELS; i++)
+	{
+		Record->Value[i] = (RecorderChannels & (1 << i)) ? RecorderValue[i] : 0;
+	}
+	Recorder_Count(&RecorderCounters.Samples);
+
+	RecorderCount[RecorderFill]++;
+	if(RecorderCount[RecorderFill] >= RECORDER_BUFFER_RECORDS)
+	{
+		RecorderFull[RecorderFill] = 1;
+		RecorderFill ^= 1;
+	}
+	return;
+}
+
+void Recorder_Tick(void)
+{
+	if(DataRecoderActive == 0)
+	{
+		return;
+	}
+
+	RecorderMilliseconds++;
+	if(RecorderMilliseconds >= 1000)
+	{
+		RecorderMilliseconds = 0;
+		RecorderSeconds++;
+	}
+
+	RecorderCountdown--;
+	if(RecorderCountdown == 0)
+	{
+		RecorderCountdown = RecorderPeriod;
+		Recorder_Sample();
+	}
+	return;
+}
+
+void Recorder_Run(void)
+{
+	uint8_t sreg;
+	uint8_t i;
+
+	//Buffers fill in turn, so storing them in turn keeps the records in order
+	while(RecorderFull[RecorderDrain])
+	{
+		if(RecorderStore != NULL)
+		{
+			if(RecorderStore(RecorderBuffer[RecorderDrain], RecorderCount[RecorderDrain]) == 0)
+			{
+				Recorder_Count(&RecorderCounters.Buffers);
+			}
+			else
+			{
+				//The backend could not store it, stop recording rather than keep giving it more
+				Recorder_Count(&RecorderCounters.Errors);
+				sreg = SREG;
+				cli();
+				DataRecoderActive = 0;
+				for(i = 0; i < 2; i++)
+				{
+					RecorderCount[i] = 0;
+					RecorderFull[i] = 0;
+				}
+				RecorderFill = 0;
+				RecorderDrain = 0;
+				SREG = sreg;
+				return;
+			}
+		}
+
+		RecorderCount[RecorderDrain] = 0;
+		RecorderFull[RecorderDrain] = 0;
+		RecorderDrain ^= 1;
+	}
+	return;
+}
+
+void Recorder_GetStats(RecorderStats *Stats)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	*Stats = RecorderCounters;
+	SREG = sreg;
+	return;
+}
+
+void Recorder_PrintStatus(void)
+{
+	RecorderStats Stats;
+
+	Recorder_GetStats(&Stats);
+
+	if(DataRecoderActive)
+	{
+		Format_Puts_P(Console_PutChar, "Recorder: on, ");
+		Format_UInt(Console_PutChar, RecorderPeriod, 0, ' ');
+		Format_Puts_P(Console_PutChar, " ms, channels 0x");
+		Format_Hex2(Console_PutChar, RecorderChannels);
+		Console_PutChar('\n');
+	}
+	else
+	{
+		Format_Puts_P(Console_PutChar, "Recorder: off\n");
+	}
+
+	Format_Puts_P(Console_PutChar, "Samples: ");
+	Format_UInt(Console_PutChar, Stats.Samples, 0, ' ');
+	Format_Puts_P(Console_PutChar, ", buffers: ");
+	Format_UInt(Console_PutChar, Stats.Buffers, 0, ' ');
+	Format_Puts_P(Console_PutChar, ", overruns: ");
+	Format_UInt(Console_PutChar, Stats.Overruns, 0, ' ');
+	Format_Puts_P(Console_PutChar, ", errors: ");
+	Format_UInt(Console_PutChar, Stats.Errors, 0, ' ');
+	Console_PutChar('\n');
+
+	if(RecorderStore == NULL)
+	{
+		Format_Puts_P(Console_PutChar, "No storage, records are dropped\n");
+	}
+	return;
+}
+
+/** @} */
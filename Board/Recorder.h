@@ -0,0 +1,119 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Periodic data recorder header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	While DataRecoderActive is set, the 1ms timer interrupt takes a sample
+*	every Period ms. A sample is a fixed size record with the time and the
+*	latest value of each channel. Sensor code posts values with
+*	Recorder_SetValue() whenever it has a new reading, so taking a sample is
+*	only a copy. The values are filtered on the way in, see Filter.h.
+*
+*	Records are collected in two RAM buffers. When one is full the interrupt
+*	switches to the other, and Recorder_Run() in the main loop passes the full
+*	one to the storage backend. If the main loop has not emptied the other
+*	buffer yet, the sample is lost and counted as an overrun. If the backend
+*	can not store a buffer, that is counted as an error and recording stops.
+*
+*	@{
+*/
+
+#ifndef _RECORDER_H_
+#define _RECORDER_H_
+
+#include <stdint.h>
+
+#define RECORDER_BUFFER_RECORDS		8		//Records in each of the two buffers
+
+//Channels
+#define RECORDER_CHANNEL_PRESSURE		0		//kPa, 4 fractional bits
+#define RECORDER_CHANNEL_TEMPERATURE	1		//0.01 C
+#define RECORDER_CHANNEL_HUMIDITY		2		//0.01 %RH
+#define RECORDER_CHANNELS				3
+#define RECORDER_ALL_CHANNELS			((1 << RECORDER_CHANNELS) - 1)
+
+/** One sample. */
+typedef struct
+{
+	uint32_t Seconds;							//Seconds since 1/1/2000, see TimeToSeconds()
+	uint16_t Milliseconds;
+	uint8_t Channels;							//Bit n is set if Value[n] was recorded
+	int16_t Value[RECORDER_CHANNELS];			//0 for channels that are not recorded
+} RecorderRecord;
+
+/** Counters shown by the recstat command. They stop at 0xFFFF. */
+typedef struct
+{
+	uint16_t Samples;							//Records taken
+	uint16_t Buffers;							//Buffers given to the backend
+	uint16_t Overruns;							//Samples lost because both buffers were full
+	uint16_t Errors;							//Buffers the backend could not store, each one stops recording
+} RecorderStats;
+
+/** Storage for full buffers, called from the main loop. Returns 0 if the records were stored. */
+typedef uint8_t (*RecorderBackend)(const RecorderRecord *Records, uint8_t Count);
+
+/** Stop recording and clear the buffers and counters. */
+void Recorder_Init(void);
+
+/** Set the storage for full buffers, or NULL to drop them. */
+void Recorder_SetBackend(RecorderBackend Backend);
+
+/** Post the latest value of a channel. Can be called from an interrupt. The value goes through the
+*	channel's filters (see Filter.h) first, and is added to its rolling statistics (see Rolling.h).
+*/
+void Recorder_SetValue(uint8_t Channel, int16_t Value);
+
+/** Returns the name of a channel, in program memory. */
+const char *Recorder_ChannelName(uint8_t Channel);
+
+/** Returns the unit of a channel with a space in front, in program memory. */
+const char *Recorder_ChannelUnit(uint8_t Channel);
+
+/** Write a value of a channel as a decimal number, e.g. 96.59 for a pressure. */
+void Recorder_PrintValue(FormatSink Sink, uint8_t Channel, int16_t Value);
+
+/** Start recording.
+*	\param[in] Period		Time between samples in ms, 1 or more
+*	\param[in] Channels		Bit mask of the channels to record
+*	\return 0 if recording was started, 1 if the period or channels are not valid
+*/
+uint8_t Recorder_Start(uint16_t Period, uint8_t Channels);
+
+/** Stop recording. The records taken so far are passed to the backend by the next Recorder_Run(). */
+void Recorder_Stop(void);
+
+/** Take the samples that are due. This is called from the 1ms timer interrupt. */
+void Recorder_Tick(void);
+
+/** Pass full buffers to the backend. This is called from the main loop. If the backend
+*	returns an error, recording stops and the records that were not stored are dropped.
+*/
+void Recorder_Run(void);
+
+/** Copy the counters. */
+void Recorder_GetStats(RecorderStats *Stats);
+
+/** Print the state and counters to the console. */
+void Recorder_PrintStatus(void);
+
+#endif
+
+/** @} */
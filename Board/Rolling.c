@@ -0,0 +1,277 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Rolling minimum, maximum and mean of the sensor channels.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+typedef struct
+{
+	int16_t Min;
+	int16_t Max;
+	int16_t Mean;				//Set when the bucket is closed
+	uint16_t Count;				//Readings, 0 for an empty bucket
+} RollingBucket;
+
+static const uint16_t RollingBucketSeconds[ROLLING_WINDOWS] PROGMEM = {ROLLING_MINUTE_BUCKET_S, ROLLING_HOUR_BUCKET_S};
+static const char RollingNames[ROLLING_WINDOWS][7] PROGMEM = {"1 min", "1 hour"};
+
+static RollingBucket RollingBuckets[RECORDER_CHANNELS][ROLLING_WINDOWS][ROLLING_BUCKETS];
+static int32_t RollingSum[RECORDER_CHANNELS][ROLLING_WINDOWS];	//Of the bucket being filled
+static uint8_t RollingCurrent[ROLLING_WINDOWS];					//Bucket being filled
+static uint8_t RollingUsed[ROLLING_WINDOWS];					//Buckets started since the init, up to ROLLING_BUCKETS
+static uint16_t RollingElapsed[ROLLING_WINDOWS];				//Seconds into the bucket being filled
+
+//Rounded to the nearest
+static int16_t Rolling_Divide(int32_t Sum, uint16_t Count)
+{
+	if(Sum < 0)
+	{
+		return -(int16_t)((-Sum + (Count >> 1)) / Count);
+	}
+	return (Sum + (Count >> 1)) / Count;
+}
+
+void Rolling_Init(void)
+{
+	uint8_t sreg;
+	uint8_t i;
+
+	sreg = SREG;
+	cli();
+	memset(RollingBuckets, 0, sizeof(RollingBuckets));
+	memset(RollingSum, 0, sizeof(RollingSum));
+	for(i = 0; i < ROLLING_WINDOWS; i++)
+	{
+		RollingCurrent[i] = 0;
+		RollingUsed[i] = 1;
+		RollingElapsed[i] = 0;
+	}
+	SREG = sreg;
+	return;
+}
+
+void Rolling_Add(uint8_t Channel, int16_t Value)
+{
+	RollingBucket *Bucket;
+	uint8_t i;
+
+	if(Channel >= RECORDER_CHANNELS)
+	{
+		return;
+	}
+
+	for(i = 0; i < ROLLING_WINDOWS; i++)
+	{
+		Bucket = &RollingBuckets[Channel][i][RollingCurrent[i]];
+		if(Bucket->Count == 0)
+		{
+			Bucket->Min = Value;
+			Bucket->Max = Value;
+		}
+		else if(Value < Bucket->Min)
+		{
+			Bucket->Min = Value;
+		}
+		else if(Value > Bucket->Max)
+		{
+			Bucket->Max = Value;
+		}
+
+		//The sum of 65535 readings still fits
+		if(Bucket->Count != 0xFFFF)
+		{
+			RollingSum[Channel][i] += Value;
+			Bucket->Count++;
+		}
+	}
+	return;
+}
+
+void Rolling_Second(void)
+{
+	RollingBucket *Bucket;
+	uint8_t Next;
+	uint8_t i;
+	uint8_t Channel;
+
+	for(i = 0; i < ROLLING_WINDOWS; i++)
+	{
+		RollingElapsed[i]++;
+		if(RollingElapsed[i] < pgm_read_word(&RollingBucketSeconds[i]))
+		{
+			continue;
+		}
+
+		//Close the bucket and start again on the oldest
+		RollingElapsed[i] = 0;
+		Next = RollingCurrent[i] + 1;
+		if(Next >= ROLLING_BUCKETS)
+		{
+			Next = 0;
+		}
+		for(Channel = 0; Channel < RECORDER_CHANNELS; Channel++)
+		{
+			Bucket = &RollingBuckets[Channel][i][RollingCurrent[i]];
+			if(Bucket->Count > 0)
+			{
+				Bucket->Mean = Rolling_Divide(RollingSum[Channel][i], Bucket->Count);
+			}
+			RollingSum[Channel][i] = 0;
+			RollingBuckets[Channel][i][Next].Count = 0;
+		}
+		RollingCurrent[i] = Next;
+		if(RollingUsed[i] < ROLLING_BUCKETS)
+		{
+			RollingUsed[i]++;
+		}
+	}
+	return;
+}
+
+uint8_t Rolling_Get(uint8_t Channel, uint8_t Window, RollingStats *Stats)
+{
+	RollingBucket Buckets[ROLLING_BUCKETS];
+	int32_t Sum;
+	uint8_t Current;
+	uint8_t Used;
+	uint16_t Elapsed;
+	uint32_t Total;
+	int32_t Weighted;
+	uint16_t Weight;
+	uint16_t Count;
+	uint8_t Shift;
+	uint8_t sreg;
+	uint8_t i;
+
+	if((Channel >= RECORDER_CHANNELS) || (Window >= ROLLING_WINDOWS))
+	{
+		return 1;
+	}
+
+	sreg = SREG;
+	cli();
+	memcpy(Buckets, RollingBuckets[Channel][Window], sizeof(Buckets));
+	Sum = RollingSum[Channel][Window];
+	Current = RollingCurrent[Window];
+	Used = RollingUsed[Window];
+	Elapsed = RollingElapsed[Window];
+	SREG = sreg;
+
+	if(Buckets[Current].Count > 0)
+	{
+		Buckets[Current].Mean = Rolling_Divide(Sum, Buckets[Current].Count);
+	}
+
+	//Buckets outside the window are empty
+	Total = 0;
+	for(i = 0; i < ROLLING_BUCKETS; i++)
+	{
+		if(Buckets[i].Count == 0)
+		{
+			continue;
+		}
+		if((Total == 0) || (Buckets[i].Min < Stats->Min))
+		{
+			Stats->Min = Buckets[i].Min;
+		}
+		if((Total == 0) || (Buckets[i].Max > Stats->Max))
+		{
+			Stats->Max = Buckets[i].Max;
+		}
+		Total += Buckets[i].Count;
+	}
+	if(Total == 0)
+	{
+		return 1;
+	}
+
+	//Weight the means by the readings, scaled down so the sum fits in 32 bits
+	Shift = 0;
+	while((Total >> Shift) > 0xFFFF)
+	{
+		Shift++;
+	}
+	Weighted = 0;
+	Weight = 0;
+	for(i = 0; i < ROLLING_BUCKETS; i++)
+	{
+		Count = Buckets[i].Count >> Shift;
+		Weighted += (int32_t)Buckets[i].Mean * Count;
+		Weight += Count;
+	}
+
+	Stats->Mean = Rolling_Divide(Weighted, Weight);
+	Stats->Samples = Total;
+	Stats->Seconds = (Used - 1) * pgm_read_word(&RollingBucketSeconds[Window]) + Elapsed;
+	return 0;
+}
+
+void Rolling_Print(void)
+{
+	RollingStats Stats;
+	int16_t Value;
+	uint8_t Channel;
+	uint8_t i;
+
+	for(Channel = 0; Channel < RECORDER_CHANNELS; Channel++)
+	{
+		Format_Puts_p(Console_PutChar, Recorder_ChannelName(Channel));
+		Format_Puts_P(Console_PutChar, ": ");
+		if(Filter_GetValue(Channel, &Value) == 0)
+		{
+			Recorder_PrintValue(Console_PutChar, Channel, Value);
+			Format_Puts_p(Console_PutChar, Recorder_ChannelUnit(Channel));
+		}
+		else
+		{
+			Format_Puts_P(Console_PutChar, "no reading");
+		}
+		Console_PutChar('\n');
+
+		for(i = 0; i < ROLLING_WINDOWS; i++)
+		{
+			Format_Puts_P(Console_PutChar, "  ");
+			Format_Puts_p(Console_PutChar, RollingNames[i]);
+			Format_Puts_P(Console_PutChar, ": ");
+			if(Rolling_Get(Channel, i, &Stats) != 0)
+			{
+				Format_Puts_P(Console_PutChar, "no readings\n");
+				continue;
+			}
+			Recorder_PrintValue(Console_PutChar, Channel, Stats.Min);
+			Format_Puts_P(Console_PutChar, " to ");
+			Recorder_PrintValue(Console_PutChar, Channel, Stats.Max);
+			Format_Puts_P(Console_PutChar, ", mean ");
+			Recorder_PrintValue(Console_PutChar, Channel, Stats.Mean);
+			Format_Puts_P(Console_PutChar, ", ");
+			Format_ULong(Console_PutChar, Stats.Samples);
+			Format_Puts_P(Console_PutChar, " readings in ");
+			Format_UInt(Console_PutChar, Stats.Seconds, 0, ' ');
+			Format_Puts_P(Console_PutChar, " s\n");
+		}
+	}
+	return;
+}
+
+/** @} */
@@ -0,0 +1,87 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Rolling minimum, maximum and mean of the sensor channels header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Every filtered reading that Recorder_SetValue() stores is also added here,
+*	to a one minute and a one hour window of each channel. A window is a ring
+*	of ROLLING_BUCKETS buckets, each with the minimum, maximum, mean and
+*	number of the readings in its part of the window:
+*
+*		window  bucket   covers
+*		minute  20 s     60 to 80 s
+*		hour    20 min   60 to 80 min
+*
+*	A reading only updates the bucket being filled, and once a bucket's time
+*	is up the 1ms timer interrupt closes it and starts the oldest one again,
+*	so both cost the same however many readings there are. The full window is
+*	put together from the buckets when it is asked for. Keeping the readings
+*	themselves for an hour would not fit in the RAM.
+*
+*	A bucket counts and averages its first 65535 readings, the minimum and
+*	maximum are of all of them.
+*
+*	@{
+*/
+
+#ifndef _ROLLING_H_
+#define _ROLLING_H_
+
+#include <stdint.h>
+
+#define ROLLING_WINDOW_MINUTE		0
+#define ROLLING_WINDOW_HOUR			1
+#define ROLLING_WINDOWS				2
+
+#define ROLLING_BUCKETS				4		//Including the one being filled
+#define ROLLING_MINUTE_BUCKET_S		20
+#define ROLLING_HOUR_BUCKET_S		1200
+
+/** Statistics of one window. */
+typedef struct
+{
+	int16_t Min;
+	int16_t Max;
+	int16_t Mean;
+	uint32_t Samples;				//Readings in the window
+	uint16_t Seconds;				//Time covered, up to ROLLING_BUCKETS bucket lengths
+} RollingStats;
+
+/** Empty every window. */
+void Rolling_Init(void);
+
+/** Add a filtered reading. Call with interrupts off. */
+void Rolling_Add(uint8_t Channel, int16_t Value);
+
+/** Move the windows on by a second. This is called from the 1ms timer interrupt. */
+void Rolling_Second(void);
+
+/** Get the statistics of a window.
+*	\param[in] Window	A ROLLING_WINDOW_ number
+*	\return 0 if they were set, 1 if the channel or window is not valid or has no readings
+*/
+uint8_t Rolling_Get(uint8_t Channel, uint8_t Window, RollingStats *Stats);
+
+/** Print the statistics of each channel to the console. */
+void Rolling_Print(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,277 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		SHT25 humidity and temperature sensor driver.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+//Commands
+#define SHT25_CMD_TEMPERATURE		0xF3		//No hold master
+#define SHT25_CMD_HUMIDITY			0xF5		//No hold master
+#define SHT25_CMD_WRITE_USER		0xE6
+#define SHT25_CMD_READ_USER			0xE7
+
+#define SHT25_CRC_POLYNOMIAL		0x31
+#define SHT25_STATUS_BITS			0x03		//Low bits of a result, bit 1 is set for humidity
+#define SHT25_STATUS_HUMIDITY		0x02
+
+//States
+#define SHT25_STATE_IDLE			0
+#define SHT25_STATE_TEMPERATURE		1			//Waiting for the temperature
+#define SHT25_STATE_HUMIDITY		2			//Waiting for the humidity
+
+static uint8_t SHT25Present;
+static volatile uint8_t SHT25State;
+static uint8_t SHT25PollsLeft;
+static int16_t SHT25Temperature;
+static int16_t SHT25Humidity;
+static uint8_t SHT25Valid;
+static SHT25Stats SHT25Counters;
+
+//The measurement transaction, its command and the result
+static SoftI2CTransaction SHT25Transfer;
+static uint8_t SHT25Command;
+static uint8_t SHT25Data[3];
+
+static void SHT25_Done(SoftI2CTransaction *Transaction);
+
+static void SHT25_Count(uint16_t *Counter)
+{
+	if(*Counter != 0xFFFF)
+	{
+		(*Counter)++;
+	}
+	return;
+}
+
+uint8_t SHT25_Crc(const uint8_t *Data, uint8_t Length)
+{
+	uint8_t Crc = 0;
+	uint8_t i;
+
+	while(Length-- > 0)
+	{
+		Crc ^= *Data++;
+		for(i = 0; i < 8; i++)
+		{
+			Crc = (Crc & 0x80) ? ((Crc << 1) ^ SHT25_CRC_POLYNOMIAL) : (Crc << 1);
+		}
+	}
+	return Crc;
+}
+
+uint8_t SHT25_ReadUserReg(uint8_t *Value)
+{
+	uint8_t Command = SHT25_CMD_READ_USER;
+
+	return SoftI2C_Transfer(SHT25_ADDRESS, &Command, 1, Value, 1);
+}
+
+uint8_t SHT25_WriteUserReg(uint8_t Value)
+{
+	uint8_t Command[2] = {SHT25_CMD_WRITE_USER, Value};
+
+	return SoftI2C_Transfer(SHT25_ADDRESS, Command, 2, NULL, 0);
+}
+
+uint8_t SHT25_Init(void)
+{
+	uint8_t User;
+
+	SHT25_SetPeriod(0);
+	SHT25Valid = 0;
+	memset(&SHT25Counters, 0, sizeof(SHT25Counters));
+
+	SHT25Present = (SHT25_ReadUserReg(&User) == SOFTI2C_STATUS_OK);
+	return !SHT25Present;
+}
+
+//Queue a transfer, SHT25_Done() carries on when it is over
+static void SHT25_Submit(uint8_t WriteLength, uint8_t ReadLength)
+{
+	SHT25Transfer.Address = SHT25_ADDRESS;
+	SHT25Transfer.Write = &SHT25Command;
+	SHT25Transfer.WriteLength = WriteLength;
+	SHT25Transfer.Read = SHT25Data;
+	SHT25Transfer.ReadLength = ReadLength;
+	SHT25Transfer.Callback = SHT25_Done;
+	if(SoftI2C_Submit(&SHT25Transfer) != 0)
+	{
+		SHT25_Count(&SHT25Counters.BusErrors);
+		SHT25State = SHT25_STATE_IDLE;
+	}
+	return;
+}
+
+//Send a measurement command
+static void SHT25_Trigger(uint8_t Command, uint8_t State)
+{
+	SHT25Command = Command;
+	SHT25State = State;
+	SHT25PollsLeft = SHT25_POLLS;
+	SHT25_Submit(1, 0);
+	return;
+}
+
+//Read the result, from the scheduler
+static void SHT25_Read(void)
+{
+	if((SHT25State != SHT25_STATE_IDLE) && (SHT25Transfer.Status != SOFTI2C_STATUS_PENDING))
+	{
+		SHT25_Submit(0, sizeof(SHT25Data));
+	}
+	return;
+}
+
+//Check a result. Returns 0 with the raw value, 1 if the sensor is still busy or the measurement failed.
+static uint8_t SHT25_Collect(uint8_t Status, uint16_t *Raw)
+{
+	if(Status == SOFTI2C_STATUS_ADDRESS_NACK)
+	{
+		//Not done yet
+		if(SHT25PollsLeft > 0)
+		{
+			SHT25PollsLeft--;
+			SHT25_Count(&SHT25Counters.Polls);
+			Scheduler_Start(SHT25_Read, SHT25_POLL_MS, 0);
+			return 1;
+		}
+		SHT25_Count(&SHT25Counters.Timeouts);
+	}
+	else if(Status != SOFTI2C_STATUS_OK)
+	{
+		SHT25_Count(&SHT25Counters.BusErrors);
+	}
+	else if((SHT25_Crc(SHT25Data, 2) != SHT25Data[2]) ||
+		(((SHT25Data[1] & SHT25_STATUS_HUMIDITY) != 0) != (SHT25State == SHT25_STATE_HUMIDITY)))
+	{
+		SHT25_Count(&SHT25Counters.CrcErrors);
+	}
+	else
+	{
+		*Raw = ((SHT25Data[0] << 8) | SHT25Data[1]) & ~SHT25_STATUS_BITS;
+		return 0;
+	}
+
+	SHT25State = SHT25_STATE_IDLE;
+	return 1;
+}
+
+//Called from the I2C interrupt when a transfer is over
+static void SHT25_Done(SoftI2CTransaction *Transaction)
+{
+	uint16_t Raw;
+
+	//Stopped while the transfer ran
+	if(SHT25State == SHT25_STATE_IDLE)
+	{
+		return;
+	}
+
+	//A command was sent, come back when the measurement should be done
+	if(Transaction->ReadLength == 0)
+	{
+		if(Transaction->Status != SOFTI2C_STATUS_OK)
+		{
+			SHT25_Count(&SHT25Counters.BusErrors);
+			SHT25State = SHT25_STATE_IDLE;
+			return;
+		}
+		Scheduler_Start(SHT25_Read, (SHT25State == SHT25_STATE_HUMIDITY) ? SHT25_HUMIDITY_MS : SHT25_TEMPERATURE_MS, 0);
+		return;
+	}
+
+	if(SHT25_Collect(Transaction->Status, &Raw) != 0)
+	{
+		return;
+	}
+	if(SHT25State == SHT25_STATE_TEMPERATURE)
+	{
+		//T = -46.85 + 175.72 * Raw / 2^16
+		SHT25Temperature = (((int32_t)17572 * Raw) >> 16) - 4685;
+		SHT25_Trigger(SHT25_CMD_HUMIDITY, SHT25_STATE_HUMIDITY);
+	}
+	else
+	{
+		//RH = -6 + 125 * Raw / 2^16
+		SHT25Humidity = (((int32_t)12500 * Raw) >> 16) - 600;
+		SHT25Valid = 1;
+		SHT25State = SHT25_STATE_IDLE;
+		SHT25_Count(&SHT25Counters.Measurements);
+		Recorder_SetValue(RECORDER_CHANNEL_TEMPERATURE, SHT25Temperature);
+		Recorder_SetValue(RECORDER_CHANNEL_HUMIDITY, SHT25Humidity);
+	}
+	return;
+}
+
+//Periodic task, a measurement that is still running is left to finish
+static void SHT25_Start(void)
+{
+	if((SHT25State == SHT25_STATE_IDLE) && (SHT25Transfer.Status != SOFTI2C_STATUS_PENDING))
+	{
+		SHT25_Trigger(SHT25_CMD_TEMPERATURE, SHT25_STATE_TEMPERATURE);
+	}
+	return;
+}
+
+uint8_t SHT25_SetPeriod(uint16_t Period)
+{
+	if(Period == 0)
+	{
+		Scheduler_Stop(SHT25_Start);
+		Scheduler_Stop(SHT25_Read);
+		SHT25State = SHT25_STATE_IDLE;
+		return 0;
+	}
+	if((SHT25Present == 0) || (Period <= (SHT25_TEMPERATURE_MS + SHT25_HUMIDITY_MS)))
+	{
+		return 1;
+	}
+	return Scheduler_Start(SHT25_Start, 0, Period);
+}
+
+uint8_t SHT25_GetReading(int16_t *Temperature, int16_t *Humidity)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	*Temperature = SHT25Temperature;
+	*Humidity = SHT25Humidity;
+	SREG = sreg;
+	return (SHT25Valid == 0);
+}
+
+void SHT25_GetStats(SHT25Stats *Stats)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	*Stats = SHT25Counters;
+	SREG = sreg;
+	return;
+}
+
+/** @} */
@@ -0,0 +1,96 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		SHT25 humidity and temperature sensor driver header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The sensor is on the I2C bus at address 0x40. Measurements use the no
+*	hold master commands: the sensor lets go of the bus while it measures and
+*	does not answer its address until it is done. A temperature measurement
+*	takes up to 85ms and a humidity one up to 29ms.
+*
+*	A measurement runs as a state machine on the I2C transaction queue and
+*	the scheduler. The command is queued, and when it has been sent a task
+*	comes back after the maximum measurement time to queue the read, polling a
+*	few more times if the sensor is still busy. Each result is checked with
+*	its CRC before it is posted to the recorder, from the transfer callback,
+*	so the main loop carries on while the bus and the sensor work.
+*
+*	@{
+*/
+
+#ifndef _SHT25_H_
+#define _SHT25_H_
+
+#include <stdint.h>
+
+#define SHT25_ADDRESS			0x40
+#define SHT25_TEMPERATURE_MS	85		//Longest measurement, 14 bit temperature
+#define SHT25_HUMIDITY_MS		29		//Longest measurement, 12 bit humidity
+#define SHT25_POLL_MS			5		//Time between reads while the sensor is still busy
+#define SHT25_POLLS				4		//Extra reads before giving up
+#define SHT25_PERIOD			2000	//Default time between measurements in ms, keeps self heating low
+
+/** Counters shown by the rh command. They stop at 0xFFFF. */
+typedef struct
+{
+	uint16_t Measurements;			//Temperature and humidity pairs read
+	uint16_t Polls;					//Reads that found the sensor still busy
+	uint16_t CrcErrors;
+	uint16_t Timeouts;				//Measurements that were not done after all the polls
+	uint16_t BusErrors;				//Transfers that failed for other reasons
+} SHT25Stats;
+
+/** Check that the sensor answers and stop any measurement.
+*	\return 0 if the sensor answered, 1 if not
+*/
+uint8_t SHT25_Init(void);
+
+/** Measure every Period ms, or stop with a period of 0.
+*	\return 0 if done, 1 if there is no sensor, the period is too short or the scheduler is full
+*/
+uint8_t SHT25_SetPeriod(uint16_t Period);
+
+/** Get the last results.
+*	\param[out] Temperature		0.01 C
+*	\param[out] Humidity		0.01 %RH
+*	\return 0 if there are results, 1 if not
+*/
+uint8_t SHT25_GetReading(int16_t *Temperature, int16_t *Humidity);
+
+/** Copy the counters. */
+void SHT25_GetStats(SHT25Stats *Stats);
+
+/** Read the user register, blocking for the transfer.
+*	\return A SOFTI2C_STATUS_ value
+*/
+uint8_t SHT25_ReadUserReg(uint8_t *Value);
+
+/** Write the user register, blocking for the transfer.
+*	\return A SOFTI2C_STATUS_ value
+*/
+uint8_t SHT25_WriteUserReg(uint8_t Value);
+
+/** CRC-8 used by the sensor, polynomial 0x31 starting at 0. */
+uint8_t SHT25_Crc(const uint8_t *Data, uint8_t Length);
+
+#endif
+
+/** @} */
@@ -0,0 +1,378 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		SPI bus.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+#include <util/crc16.h>
+
+//Port B pins
+#define SPI_PIN_SCK			1
+#define SPI_PIN_MOSI		2
+#define SPI_PIN_MISO		3
+
+#define SPI_CHIP_SELECTS	((1<<0) | (1<<4))
+
+//Parts of the device settings
+#define SPI_SETTINGS_SPCR	0x0F		//CPOL, CPHA and SPR
+#define SPI_SETTINGS_2X		0x80
+
+//What holds the queue
+#define SPI_HELD_LCD		0x01		//The LCD has port B
+#define SPI_HELD_SELECT		0x02		//A device is selected with SPI_Select()
+
+//Bytes are started through these. The host build sets them to functions that run
+//its device models: the first clocks a byte and sets SPIF, the second looks at the
+//chip selects after they change.
+#ifndef SPI_WRITE
+	#define SPI_WRITE(Data)			(SPDR = (Data))
+#else
+	void SPI_WRITE(uint8_t Data);
+#endif
+#ifndef SPI_PINS_CHANGED
+	#define SPI_PINS_CHANGED()
+#else
+	void SPI_PINS_CHANGED(void);
+#endif
+
+//Chip select of each device
+static const uint8_t SPIChipSelect[SPI_DEVICES] PROGMEM = {(1<<0), (1<<4)};
+
+//The dataflash is read and written a page at a time with polling, so it gets the fastest clock.
+//The sensor's bytes go through the interrupt, and at 1MHz a byte takes about as long as the
+//interrupt that handles it.
+static const uint8_t SPIDefaultSettings[SPI_DEVICES] PROGMEM =
+{
+	SPI_MODE_0 | SPI_CLOCK_DIV2,
+	SPI_MODE_0 | SPI_CLOCK_DIV8
+};
+
+static uint8_t SPISettings[SPI_DEVICES];
+
+static SPITransaction *SPIQueue[SPI_QUEUE_LENGTH];
+static volatile uint8_t SPIHead;				//Transaction on the bus or next
+static volatile uint8_t SPICount;				//Transactions in the queue, including the one on the bus
+static volatile uint8_t SPIActive;				//The transaction at the head is on the bus
+static volatile uint8_t SPIHeld;				//SPI_HELD_ bits
+static uint8_t SPIIndex;						//Byte on the bus
+static uint8_t SPILcdDepth;					//SPI_LcdBegin() calls not yet ended
+
+//Raise both chip selects and make the SPI pins outputs again, after the LCD. Call with interrupts off.
+static void SPI_Pins(void)
+{
+	PORTB |= SPI_CHIP_SELECTS;
+	DDRB |= SPI_CHIP_SELECTS | (1<<SPI_PIN_SCK) | (1<<SPI_PIN_MOSI);
+	DDRB &= ~(1<<SPI_PIN_MISO);
+	SPI_PINS_CHANGED();
+	return;
+}
+
+//Set up the SPI for a device and pull its chip select low. Call with interrupts off.
+static void SPI_Setup(uint8_t Device, uint8_t Interrupt)
+{
+	uint8_t Settings = SPISettings[Device];
+
+	//The clock has to be at its idle level before the chip select goes low
+	SPI_Pins();
+	SPCR = (1<<SPE) | (1<<MSTR) | (Settings & SPI_SETTINGS_SPCR) | (Interrupt ? (1<<SPIE) : 0);
+	SPSR = (Settings & SPI_SETTINGS_2X) ? (1<<SPI2X) : 0;
+	PORTB &= ~pgm_read_byte(&SPIChipSelect[Device]);
+	SPI_PINS_CHANGED();
+	return;
+}
+
+void SPI_Init(void)
+{
+	uint8_t i;
+
+	SPCR = 0x00;
+	for(i = 0; i < SPI_DEVICES; i++)
+	{
+		SPISettings[i] = pgm_read_byte(&SPIDefaultSettings[i]);
+	}
+	SPIHead = 0;
+	SPICount = 0;
+	SPIActive = 0;
+	SPIHeld = 0;
+	SPILcdDepth = 0;
+	SPI_Pins();
+	return;
+}
+
+void SPI_Configure(uint8_t Device, uint8_t Settings)
+{
+	if(Device < SPI_DEVICES)
+	{
+		SPISettings[Device] = Settings;
+	}
+	return;
+}
+
+//Put the transaction at the head of the queue on the bus. Call with interrupts off.
+static void SPI_Begin(void)
+{
+	SPITransaction *Transaction = SPIQueue[SPIHead];
+
+	SPIActive = 1;
+	SPIIndex = 0;
+	SPI_Setup(Transaction->Device, 1);
+
+	//Reading SPSR before the data register is written clears an old SPIF
+	(void)SPSR;
+	SPI_WRITE((Transaction->Write != NULL) ? Transaction->Write[0] : 0x00);
+	return;
+}
+
+//Start the next transaction if the bus is free, or stop the interrupt. Call with interrupts off.
+static void SPI_Next(void)
+{
+	if((SPICount > 0) && (SPIHeld == 0))
+	{
+		SPI_Begin();
+	}
+	else
+	{
+		SPCR &= ~(1<<SPIE);
+	}
+	return;
+}
+
+uint8_t SPI_Submit(SPITransaction *Transaction)
+{
+	uint8_t sreg;
+
+	if(Transaction->Length == 0)
+	{
+		return 1;
+	}
+
+	sreg = SREG;
+	cli();
+	if(SPICount >= SPI_QUEUE_LENGTH)
+	{
+		SREG = sreg;
+		return 1;
+	}
+
+	Transaction->Status = SPI_STATUS_PENDING;
+	SPIQueue[(SPIHead + SPICount) % SPI_QUEUE_LENGTH] = Transaction;
+	SPICount++;
+	if(!SPIActive)
+	{
+		SPI_Next();
+	}
+	SREG = sreg;
+	return 0;
+}
+
+//The last byte is done. Raise the chip select, start the next transaction and call the callback.
+static void SPI_Complete(void)
+{
+	SPITransaction *Transaction;
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	Transaction = SPIQueue[SPIHead];
+	PORTB |= SPI_CHIP_SELECTS;
+	SPI_PINS_CHANGED();
+	SPIHead = (SPIHead + 1) % SPI_QUEUE_LENGTH;
+	SPICount--;
+	SPIActive = 0;
+	SPI_Next();
+	SREG = sreg;
+
+	Transaction->Status = SPI_STATUS_OK;
+	if(Transaction->Callback != NULL)
+	{
+		Transaction->Callback(Transaction);
+	}
+	return;
+}
+
+//A byte of the transaction on the bus is done
+static void SPI_Step(void)
+{
+	SPITransaction *Transaction = SPIQueue[SPIHead];
+	uint8_t Data = SPDR;
+
+	if(Transaction->Read != NULL)
+	{
+		Transaction->Read[SPIIndex] = Data;
+	}
+	SPIIndex++;
+	if(SPIIndex < Transaction->Length)
+	{
+		SPI_WRITE((Transaction->Write != NULL) ? Transaction->Write[SPIIndex] : 0x00);
+		return;
+	}
+	SPI_Complete();
+	return;
+}
+
+ISR(SPI_STC_vect)
+{
+	ISRStats_Enter(ISRSTATS_SPI_STC);
+	if(SPIActive)
+	{
+		SPI_Step();
+	}
+	ISRStats_Exit(ISRSTATS_SPI_STC);
+}
+
+//Hold the queue, and run the transaction on the bus to the end by polling. Its callback is called from here.
+static void SPI_Hold(uint8_t Holder)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	SPIHeld |= Holder;
+	SPCR &= ~(1<<SPIE);
+	SREG = sreg;
+
+	while(SPIActive)
+	{
+		if(SPSR & (1<<SPIF))
+		{
+			SPI_Step();
+		}
+	}
+	return;
+}
+
+void SPI_Select(uint8_t Device)
+{
+	uint8_t sreg;
+
+	SPI_Hold(SPI_HELD_SELECT);
+	sreg = SREG;
+	cli();
+	SPI_Setup(Device, 0);
+	SREG = sreg;
+	return;
+}
+
+void SPI_Deselect(void)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+
+	//Without a select the chip select may belong to a queued transaction
+	if((SPIHeld & SPI_HELD_SELECT) == 0)
+	{
+		SREG = sreg;
+		return;
+	}
+	PORTB |= SPI_CHIP_SELECTS;
+	SPI_PINS_CHANGED();
+	SPIHeld &= ~SPI_HELD_SELECT;
+	if(SPIHeld & SPI_HELD_LCD)
+	{
+		SPCR = 0x00;
+	}
+	else
+	{
+		SPI_Next();
+	}
+	SREG = sreg;
+	return;
+}
+
+uint8_t SPI_Transfer(uint8_t Data)
+{
+	SPI_WRITE(Data);
+	while((SPSR & (1<<SPIF)) == 0)
+	{
+	}
+	return SPDR;
+}
+
+uint16_t SPI_ReadCrc(uint8_t *Data, uint8_t Length, uint16_t Crc)
+{
+	uint8_t Byte;
+
+	if(Length == 0)
+	{
+		return Crc;
+	}
+
+	SPI_WRITE(0x00);
+	while(1)
+	{
+		while((SPSR & (1<<SPIF)) == 0)
+		{
+		}
+		Byte = SPDR;
+		*Data++ = Byte;
+		if(--Length == 0)
+		{
+			break;
+		}
+
+		//A byte takes 16 cycles at Fcpu/2, about as long as the CRC update
+		SPI_WRITE(0x00);
+		Crc = _crc_xmodem_update(Crc, Byte);
+	}
+	return _crc_xmodem_update(Crc, Byte);
+}
+
+void SPI_LcdBegin(void)
+{
+	//Only the outermost section hands the bus over
+	if(SPILcdDepth++ != 0)
+	{
+		return;
+	}
+
+	SPI_Hold(SPI_HELD_LCD);
+	SoftI2C_Hold(1);
+
+	//SCK and MOSI go back to the port bits
+	SPCR = 0x00;
+	return;
+}
+
+void SPI_LcdEnd(void)
+{
+	uint8_t sreg;
+
+	if(--SPILcdDepth != 0)
+	{
+		return;
+	}
+
+	sreg = SREG;
+	cli();
+	SPIHeld &= ~SPI_HELD_LCD;
+	SPI_Pins();
+	SPI_Next();
+	SREG = sreg;
+	SoftI2C_Hold(0);
+	return;
+}
+
+/** @} */
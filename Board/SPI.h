@@ -0,0 +1,138 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		SPI bus header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The SPI master on port B, shared by the dataflash (chip select on PB0) and
+*	the pressure sensor (chip select on PB4). Each device has its own mode and
+*	clock, which are set up when it is selected.
+*
+*	The LCD data lines are on PB0-PB3 and its RS and RW lines on PB4 and PB5,
+*	so the LCD and the SPI can not use port B at the same time: with the SPI
+*	on, SCK and MOSI override the port bits, and an LCD write leaves the chip
+*	selects wherever its data put them. Code that writes the LCD (the menu and
+*	clock redraws, the marquee step and the LCD commands) gives port B to it
+*	between SPI_LcdBegin() and SPI_LcdEnd(), which nest, so the queue keeps
+*	moving through the rest of the main loop. While the LCD has it the SPI is
+*	off, and so are the I2C ticks, because SCL is on PB7. When it is given
+*	back both chip selects are raised and the SPI pins are set up again before
+*	any device is selected.
+*
+*	There are two ways to use the bus:
+*	- Transactions are queued with SPI_Submit() and clocked out a byte at a
+*	  time by the SPI interrupt, so sensor reads carry on while the main loop
+*	  does something else. The queue only moves while the LCD does not have
+*	  port B. When a transaction is done its callback is called from the
+*	  interrupt.
+*	- SPI_Select(), SPI_Transfer() and SPI_Deselect() hold the bus for longer
+*	  transfers like dataflash pages, and poll each byte, which is faster than
+*	  an interrupt per byte at Fcpu/2. SPI_Select() finishes the transaction
+*	  on the bus first and holds the queue until SPI_Deselect(). It can be
+*	  used while the LCD has port B, which gets it back at SPI_Deselect().
+*
+*	@{
+*/
+
+#ifndef _SPI_H_
+#define _SPI_H_
+
+#include <stdint.h>
+
+//Devices
+#define SPI_DEVICE_DATAFLASH		0
+#define SPI_DEVICE_PRESSURE			1
+#define SPI_DEVICES					2
+
+//Device settings are a mode and a clock ORed together. They are the CPOL,
+//CPHA and SPR bits of SPCR, with SPI2X in bit 7.
+#define SPI_MODE_0					0x00
+#define SPI_MODE_1					0x04
+#define SPI_MODE_2					0x08
+#define SPI_MODE_3					0x0C
+#define SPI_CLOCK_DIV2				0x80	//4MHz
+#define SPI_CLOCK_DIV4				0x00
+#define SPI_CLOCK_DIV8				0x81
+#define SPI_CLOCK_DIV16				0x01
+#define SPI_CLOCK_DIV32				0x82
+#define SPI_CLOCK_DIV64				0x02
+#define SPI_CLOCK_DIV128			0x03
+
+#define SPI_QUEUE_LENGTH			4		//Transactions waiting or running
+
+//Transaction status
+#define SPI_STATUS_OK				0
+#define SPI_STATUS_PENDING			0xFF	//Waiting in the queue or running
+
+struct SPITransaction;
+
+/** Called from the interrupt when a transaction is done. */
+typedef void (*SPICallback)(struct SPITransaction *Transaction);
+
+/** Length bytes to and from one device with its chip select held low. The transaction and its
+*	buffers belong to the caller and must be kept until the status is no longer pending.
+*/
+typedef struct SPITransaction
+{
+	uint8_t Device;					//An SPI_DEVICE_ number
+	const uint8_t *Write;			//NULL sends 0x00
+	uint8_t *Read;					//NULL drops the bytes received
+	uint8_t Length;					//At least 1
+	SPICallback Callback;			//NULL for none
+	volatile uint8_t Status;		//An SPI_STATUS_ value, set by the engine
+} SPITransaction;
+
+/** Set up the SPI pins and the SPI master, with both chip selects high and the default device settings. */
+void SPI_Init(void);
+
+/** Change the mode and clock of a device, used from its next transaction. */
+void SPI_Configure(uint8_t Device, uint8_t Settings);
+
+/** Queue a transaction. Can be called from an interrupt or a callback.
+*	\return 0 if it was queued, 1 if the queue is full or the transaction is empty
+*/
+uint8_t SPI_Submit(SPITransaction *Transaction);
+
+/** Finish the transaction on the bus, hold the queue and pull the chip select of a device low. */
+void SPI_Select(uint8_t Device);
+
+/** Release the chip select of the selected device, and give the bus back to the LCD or the queue. */
+void SPI_Deselect(void);
+
+/** Send a byte and return the byte received at the same time. */
+uint8_t SPI_Transfer(uint8_t Data);
+
+/** Read bytes, sending 0x00, and add them to a CRC-16/XMODEM. The CRC of
+*	each byte is worked out while the next one is shifted in.
+*	\return The updated CRC
+*/
+uint16_t SPI_ReadCrc(uint8_t *Data, uint8_t Length, uint16_t Crc);
+
+/** Finish the transaction on the bus and give port B to the LCD, with the SPI off.
+*	Calls nest, only the outermost pair hands the bus over.
+*/
+void SPI_LcdBegin(void);
+
+/** Take port B back from the LCD and start the queued transactions, at the outermost call. */
+void SPI_LcdEnd(void);
+
+#endif
+
+/** @} */
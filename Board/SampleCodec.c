@@ -0,0 +1,222 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Compressed encoding of recorder samples.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+#define SAMPLECODEC_CHANNELS		0x07		//Flags bits for the channel mask
+#define SAMPLECODEC_VARINT_MAX		5			//Bytes for 32 bits
+
+static uint8_t SampleCodec_PutVarint(uint8_t *Out, uint32_t Value)
+{
+	uint8_t Length = 0;
+
+	while(Value >= 0x80)
+	{
+		Out[Length++] = Value | 0x80;
+		Value >>= 7;
+	}
+	Out[Length++] = Value;
+	return Length;
+}
+
+//16 bit values are never longer than 3 bytes, so a shorter loop than PutVarint
+static uint8_t SampleCodec_PutZigzag(uint8_t *Out, int16_t Value)
+{
+	uint16_t Zigzag = ((uint16_t)Value << 1) ^ (uint16_t)(Value >> 15);
+	uint8_t Length = 0;
+
+	while(Zigzag >= 0x80)
+	{
+		Out[Length++] = Zigzag | 0x80;
+		Zigzag >>= 7;
+	}
+	Out[Length++] = Zigzag;
+	return Length;
+}
+
+//Returns the number of bytes used, or 0 if the varint is cut off or too long
+static uint8_t SampleCodec_GetVarint(const uint8_t *In, uint8_t Length, uint32_t *Value)
+{
+	uint8_t i;
+
+	*Value = 0;
+	for(i = 0; (i < Length) && (i < SAMPLECODEC_VARINT_MAX); i++)
+	{
+		*Value |= (uint32_t)(In[i] & 0x7F) << (7 * i);
+		if((In[i] & 0x80) == 0)
+		{
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+static int16_t SampleCodec_Unzigzag(uint32_t Value)
+{
+	return (int16_t)((uint16_t)(Value >> 1) ^ (uint16_t)-(int16_t)(Value & 1));
+}
+
+void SampleCodec_Reset(SampleCodecState *State)
+{
+	State->Valid = 0;
+	return;
+}
+
+uint8_t SampleCodec_Encode(const SampleCodecState *State, const RecorderRecord *Record, uint8_t Keyframe, uint8_t *Out)
+{
+	const RecorderRecord *Last = &State->Last;
+	uint32_t Elapsed;
+	uint16_t Seconds = Record->Seconds - Last->Seconds;
+	uint8_t Length = 1;
+	uint8_t i;
+
+	//A delta needs the same channels, and time that went forward by less than the maximum gap
+	if((State->Valid == 0) || (Record->Channels != Last->Channels) || (Record->Seconds < Last->Seconds) ||
+		((Record->Seconds - Last->Seconds) > SAMPLECODEC_MAX_GAP) ||
+		((Record->Seconds == Last->Seconds) && (Record->Milliseconds < Last->Milliseconds)))
+	{
+		Keyframe = 1;
+	}
+
+	if(Keyframe)
+	{
+		Out[0] = SAMPLECODEC_KEYFRAME | (Record->Channels & SAMPLECODEC_CHANNELS);
+		Length += SampleCodec_PutVarint(&Out[Length], Record->Seconds);
+		Length += SampleCodec_PutVarint(&Out[Length], Record->Milliseconds);
+		for(i = 0; i < RECORDER_CHANNELS; i++)
+		{
+			if(Record->Channels & (1 << i))
+			{
+				Length += SampleCodec_PutZigzag(&Out[Length], Record->Value[i]);
+			}
+		}
+		return Length;
+	}
+
+	Out[0] = Record->Channels & SAMPLECODEC_CHANNELS;
+	Elapsed = ((uint32_t)Seconds * 1000) + Record->Milliseconds - Last->Milliseconds;
+	Length += SampleCodec_PutVarint(&Out[Length], Elapsed);
+	for(i = 0; i < RECORDER_CHANNELS; i++)
+	{
+		if(Record->Channels & (1 << i))
+		{
+			//Wraps around, so any change fits in 16 bits
+			Length += SampleCodec_PutZigzag(&Out[Length], (int16_t)(Record->Value[i] - Last->Value[i]));
+		}
+	}
+	return Length;
+}
+
+void SampleCodec_Next(SampleCodecState *State, const RecorderRecord *Record)
+{
+	State->Last = *Record;
+	State->Valid = 1;
+	return;
+}
+
+uint8_t SampleCodec_Decode(SampleCodecState *State, const uint8_t *In, uint8_t Length, RecorderRecord *Record)
+{
+	RecorderRecord *Last = &State->Last;
+	uint32_t Value;
+	uint32_t Milliseconds = 0;
+	uint8_t Used;
+	uint8_t Position = 1;
+	uint8_t Flags;
+	uint8_t i;
+
+	if(Length == 0)
+	{
+		return 1;
+	}
+	Flags = In[0];
+	if((Flags & ~(SAMPLECODEC_KEYFRAME | SAMPLECODEC_CHANNELS)) != 0)
+	{
+		return 1;
+	}
+	if(((Flags & SAMPLECODEC_KEYFRAME) == 0) && ((State->Valid == 0) || (Last->Channels != Flags)))
+	{
+		return 1;
+	}
+
+	Record->Channels = Flags & SAMPLECODEC_CHANNELS;
+	if(Flags & SAMPLECODEC_KEYFRAME)
+	{
+		Used = SampleCodec_GetVarint(&In[Position], Length - Position, &Value);
+		Record->Seconds = Value;
+		Position += Used;
+		if(Used != 0)
+		{
+			Used = SampleCodec_GetVarint(&In[Position], Length - Position, &Milliseconds);
+			Position += Used;
+		}
+		if((Used == 0) || (Milliseconds > 999))
+		{
+			return 1;
+		}
+		Record->Milliseconds = Milliseconds;
+	}
+	else
+	{
+		Used = SampleCodec_GetVarint(&In[Position], Length - Position, &Value);
+		if(Used == 0)
+		{
+			return 1;
+		}
+		Position += Used;
+
+		//Only the decoder on the ATmega does a 32 bit divide, and only for logread
+		Milliseconds = Last->Milliseconds + Value;
+		Record->Seconds = Last->Seconds + (Milliseconds / 1000);
+		Record->Milliseconds = Milliseconds % 1000;
+	}
+
+	for(i = 0; i < RECORDER_CHANNELS; i++)
+	{
+		Record->Value[i] = 0;
+		if(Record->Channels & (1 << i))
+		{
+			Used = SampleCodec_GetVarint(&In[Position], Length - Position, &Value);
+			if((Used == 0) || (Value > 0xFFFF))
+			{
+				return 1;
+			}
+			Position += Used;
+			Record->Value[i] = SampleCodec_Unzigzag(Value);
+			if((Flags & SAMPLECODEC_KEYFRAME) == 0)
+			{
+				Record->Value[i] += Last->Value[i];
+			}
+		}
+	}
+	if(Position != Length)
+	{
+		return 1;
+	}
+
+	SampleCodec_Next(State, Record);
+	return 0;
+}
+
+/** @} */
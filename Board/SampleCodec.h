@@ -0,0 +1,80 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Compressed encoding of recorder samples header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Samples change slowly, so most are stored as the change from the one
+*	before. Each encoded sample starts with a flags byte: bit 7 is set for a
+*	keyframe and bits 0-2 are the channel mask. The rest is varints, 7 bits
+*	to a byte, low bits first, with bit 7 set on all but the last byte:
+*	- Keyframe: seconds, milliseconds, then each recorded value
+*	- Delta: milliseconds since the last sample, then the change of each
+*	  recorded value
+*	Values and changes are zigzag coded (0, -1, 1, -2 ... become 0, 1, 2, 3 ...)
+*	so small negative numbers are short too.
+*
+*	A keyframe does not depend on anything before it, so decoding can start
+*	at any keyframe. The log store backend writes one at the start of every
+*	page. A keyframe is also written when the channels change or the time goes
+*	backwards or jumps.
+*
+*	Encoding is a few shifts and compares for each byte, with a single 16x16
+*	multiply for the time.
+*
+*	@{
+*/
+
+#ifndef _SAMPLECODEC_H_
+#define _SAMPLECODEC_H_
+
+#include <stdint.h>
+
+#define SAMPLECODEC_MAX_SIZE		(1 + 5 + 2 + (3 * RECORDER_CHANNELS))	//Longest encoded sample
+#define SAMPLECODEC_KEYFRAME		0x80									//Flags bit for a keyframe
+#define SAMPLECODEC_MAX_GAP			65535									//Longest time between samples in a delta, seconds
+
+/** The last sample, the reference for the next delta. */
+typedef struct
+{
+	RecorderRecord Last;
+	uint8_t Valid;						//0 until the first keyframe
+} SampleCodecState;
+
+/** Forget the last sample, so the next one is encoded as a keyframe or a delta is not decoded. */
+void SampleCodec_Reset(SampleCodecState *State);
+
+/** Encode a sample without changing the state. A keyframe is used if Keyframe is set or a
+*	delta is not possible.
+*	\param[out] Out		SAMPLECODEC_MAX_SIZE bytes
+*	\return The number of bytes
+*/
+uint8_t SampleCodec_Encode(const SampleCodecState *State, const RecorderRecord *Record, uint8_t Keyframe, uint8_t *Out);
+
+/** Make a sample the reference for the next one, after it has been stored. */
+void SampleCodec_Next(SampleCodecState *State, const RecorderRecord *Record);
+
+/** Decode a sample and make it the reference for the next one.
+*	\return 0 if the sample was decoded, 1 if the bytes are not a valid sample or a delta has no reference
+*/
+uint8_t SampleCodec_Decode(SampleCodecState *State, const uint8_t *In, uint8_t Length, RecorderRecord *Record);
+
+#endif
+
+/** @} */
@@ -0,0 +1,176 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Millisecond task scheduler.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+typedef struct
+{
+	SchedulerTask Task;			//NULL if the slot is free
+	uint16_t Countdown;			//ms until the next run, 0 if the task is not counting
+	uint16_t Period;			//ms between runs, 0 for a single run
+} SchedulerSlot;
+
+static SchedulerSlot SchedulerSlots[SCHEDULER_MAX_TASKS];
+
+//One bit per slot, set by the timer interrupt when the task is due
+static volatile uint8_t SchedulerReady;
+
+void Scheduler_Init(void)
+{
+	uint8_t i;
+
+	for(i = 0; i < SCHEDULER_MAX_TASKS; i++)
+	{
+		SchedulerSlots[i].Task = NULL;
+		SchedulerSlots[i].Countdown = 0;
+		SchedulerSlots[i].Period = 0;
+	}
+	SchedulerReady = 0;
+	return;
+}
+
+uint8_t Scheduler_Start(SchedulerTask Task, uint16_t Delay, uint16_t Period)
+{
+	uint8_t i;
+	uint8_t Slot = SCHEDULER_MAX_TASKS;
+	uint8_t sreg;
+
+	if(Delay == 0)
+	{
+		Delay = 1;
+	}
+
+	sreg = SREG;
+	cli();
+
+	for(i = 0; i < SCHEDULER_MAX_TASKS; i++)
+	{
+		if(SchedulerSlots[i].Task == Task)
+		{
+			Slot = i;
+			break;
+		}
+		if((SchedulerSlots[i].Task == NULL) && (Slot == SCHEDULER_MAX_TASKS))
+		{
+			Slot = i;
+		}
+	}
+
+	if(Slot < SCHEDULER_MAX_TASKS)
+	{
+		SchedulerSlots[Slot].Task = Task;
+		SchedulerSlots[Slot].Countdown = Delay;
+		SchedulerSlots[Slot].Period = Period;
+		SchedulerReady &= ~(1 << Slot);
+	}
+
+	SREG = sreg;
+
+	if(Slot >= SCHEDULER_MAX_TASKS)
+	{
+		LOG_ERROR("No free scheduler slot, %u tasks running", SCHEDULER_MAX_TASKS);
+		return 1;
+	}
+	return 0;
+}
+
+void Scheduler_Stop(SchedulerTask Task)
+{
+	uint8_t i;
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	for(i = 0; i < SCHEDULER_MAX_TASKS; i++)
+	{
+		if(SchedulerSlots[i].Task == Task)
+		{
+			SchedulerSlots[i].Task = NULL;
+			SchedulerSlots[i].Countdown = 0;
+			SchedulerReady &= ~(1 << i);
+		}
+	}
+	SREG = sreg;
+	return;
+}
+
+void Scheduler_Tick(void)
+{
+	uint8_t i;
+	uint8_t Mask = 0x01;
+
+	for(i = 0; i < SCHEDULER_MAX_TASKS; i++)
+	{
+		if(SchedulerSlots[i].Countdown != 0)
+		{
+			SchedulerSlots[i].Countdown--;
+			if(SchedulerSlots[i].Countdown == 0)
+			{
+				SchedulerReady |= Mask;
+				SchedulerSlots[i].Countdown = SchedulerSlots[i].Period;
+			}
+		}
+		Mask <<= 1;
+	}
+	return;
+}
+
+void Scheduler_Run(void)
+{
+	uint8_t i;
+	uint8_t Ready;
+	uint8_t Mask = 0x01;
+	SchedulerTask Task;
+
+	if(SchedulerReady == 0)
+	{
+		return;
+	}
+
+	for(i = 0; i < SCHEDULER_MAX_TASKS; i++)
+	{
+		cli();
+		Ready = SchedulerReady & Mask;
+		SchedulerReady &= ~Mask;
+		Task = SchedulerSlots[i].Task;
+
+		//Single run tasks free their slot before running, so the task can schedule itself again
+		if((Ready != 0) && (SchedulerSlots[i].Period == 0))
+		{
+			SchedulerSlots[i].Task = NULL;
+		}
+		sei();
+
+		if((Ready != 0) && (Task != NULL))
+		{
+			Trace_Event(TRACE_EVENT_TASK, i, 0);
+			Task();
+		}
+		Mask <<= 1;
+	}
+	return;
+}
+
+/** @} */
@@ -0,0 +1,62 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Millisecond task scheduler header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Tasks are timed by the 1ms timer 0 interrupt but always run from the main
+*	loop, so a task can take as long as it needs without delaying the clock or
+*	USB. A task is identified by its function, starting a task that is already
+*	scheduled just changes its timing.
+*
+*	@{
+*/
+
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include <stdint.h>
+
+#define SCHEDULER_MAX_TASKS		8		//Maximum number of tasks that can be scheduled at once, 8 max.
+
+typedef void (*SchedulerTask)(void);
+
+/** Remove all tasks. */
+void Scheduler_Init(void);
+
+/** Schedule a task.
+*	\param[in] Task		Function to run
+*	\param[in] Delay	Time in ms until the first run
+*	\param[in] Period	Time in ms between runs after that, 0 to run only once
+*	\return 0 if the task was scheduled, 1 if there are no free task slots
+*/
+uint8_t Scheduler_Start(SchedulerTask Task, uint16_t Delay, uint16_t Period);
+
+/** Remove a task. A run that is already due is also cancelled. */
+void Scheduler_Stop(SchedulerTask Task);
+
+/** Count down the task timers. This is called from the 1ms timer interrupt. */
+void Scheduler_Tick(void);
+
+/** Run the tasks that are due. This is called from the main loop. */
+void Scheduler_Run(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,64 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Device settings stored in EEPROM.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+DeviceSettings Settings;
+
+static DeviceSettings SettingsEEPROM EEMEM;
+
+static const DeviceSettings SettingsDefault PROGMEM =
+{
+	.Magic			= SETTINGS_MAGIC,
+	.LCDColumns		= LCD_DISP_LENGTH,
+	.LCDLines		= LCD_LINES,
+	.LCDController	= LCDGEO_CONTROLLER_HD44780,
+	.BacklightLevel		= BACKLIGHT_MAX_LEVEL,
+	.BacklightIdleLevel	= 8,
+	.BacklightAuto		= 0,
+	.FilterMedian		= {1, 1, 1},
+	.FilterShift		= {0, 0, 0},
+};
+
+void Settings_Load(void)
+{
+	eeprom_read_block(&Settings, &SettingsEEPROM, sizeof(DeviceSettings));
+
+	if(Settings.Magic != SETTINGS_MAGIC)
+	{
+		LOG_WARN("Settings not saved (magic 0x%02X), using defaults", Settings.Magic);
+		memcpy_P(&Settings, &SettingsDefault, sizeof(DeviceSettings));
+	}
+	return;
+}
+
+void Settings_Save(void)
+{
+	Settings.Magic = SETTINGS_MAGIC;
+	eeprom_update_block(&Settings, &SettingsEEPROM, sizeof(DeviceSettings));
+	return;
+}
+
+/** @} */
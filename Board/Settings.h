@@ -0,0 +1,62 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Device settings stored in EEPROM header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	The settings are copied from EEPROM to RAM at power up. Code reads the RAM
+*	copy directly, and calls Settings_Save() after changing it.
+*
+*	@{
+*/
+
+#ifndef _SETTINGS_H_
+#define _SETTINGS_H_
+
+#include <stdint.h>
+
+//Change this if the layout of DeviceSettings changes, so old EEPROM contents are replaced by the defaults
+#define SETTINGS_MAGIC				0xA3
+
+#define SETTINGS_FILTER_CHANNELS	3		//RECORDER_CHANNELS, checked in Filter.c
+
+typedef struct
+{
+	uint8_t Magic;				//SETTINGS_MAGIC if the EEPROM has been written
+	uint8_t LCDColumns;			//Visible characters per line
+	uint8_t LCDLines;			//Visible lines
+	uint8_t LCDController;		//LCDGEO_CONTROLLER_HD44780 or LCDGEO_CONTROLLER_KS0073
+	uint8_t BacklightLevel;		//Backlight level while the panel is in use
+	uint8_t BacklightIdleLevel;	//Backlight level after the menu times out
+	uint8_t BacklightAuto;		//1 to dim the backlight in a dark room
+	uint8_t FilterMedian[SETTINGS_FILTER_CHANNELS];	//Readings in the median of each recorder channel, 1 for none
+	uint8_t FilterShift[SETTINGS_FILTER_CHANNELS];	//Moving average weight 1/2^n of each recorder channel, 0 for none
+} DeviceSettings;
+
+extern DeviceSettings Settings;
+
+/** Read the settings from EEPROM, or load the defaults if the EEPROM has not been written. */
+void Settings_Load(void);
+
+/** Write the settings to EEPROM. Only bytes that changed are written. */
+void Settings_Save(void);
+
+#endif
+
+/** @} */
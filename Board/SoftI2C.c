@@ -0,0 +1,569 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Interrupt driven bit banged I2C master.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+#include "config.h"
+
+#define SOFTI2C_COUNTS_PER_US		8		//Timer 1 runs at Fcpu, 8MHz
+
+//A line is pulled low by making it an output, the port bit is 0 then. Released it floats high.
+#if I2C_SOFT_USE_INTERNAL_PULLUPS == 1
+	#define SOFTI2C_SDA_LOW()		do { I2C_SDA_PORT &= ~(1<<I2C_SDA_PIN_NUM); I2C_SDA_DDR |= (1<<I2C_SDA_PIN_NUM); } while(0)
+	#define SOFTI2C_SDA_RELEASE()	do { I2C_SDA_DDR &= ~(1<<I2C_SDA_PIN_NUM); I2C_SDA_PORT |= (1<<I2C_SDA_PIN_NUM); } while(0)
+	#define SOFTI2C_SCL_LOW()		do { I2C_SCL_PORT &= ~(1<<I2C_SCL_PIN_NUM); I2C_SCL_DDR |= (1<<I2C_SCL_PIN_NUM); } while(0)
+	#define SOFTI2C_SCL_RELEASE()	do { I2C_SCL_DDR &= ~(1<<I2C_SCL_PIN_NUM); I2C_SCL_PORT |= (1<<I2C_SCL_PIN_NUM); } while(0)
+#else
+	#define SOFTI2C_SDA_LOW()		(I2C_SDA_DDR |= (1<<I2C_SDA_PIN_NUM))
+	#define SOFTI2C_SDA_RELEASE()	(I2C_SDA_DDR &= ~(1<<I2C_SDA_PIN_NUM))
+	#define SOFTI2C_SCL_LOW()		(I2C_SCL_DDR |= (1<<I2C_SCL_PIN_NUM))
+	#define SOFTI2C_SCL_RELEASE()	(I2C_SCL_DDR &= ~(1<<I2C_SCL_PIN_NUM))
+#endif
+
+#define SOFTI2C_SDA_IS_HIGH()		((I2C_SDA_PIN & (1<<I2C_SDA_PIN_NUM)) != 0)
+#define SOFTI2C_SCL_IS_HIGH()		((I2C_SCL_PIN & (1<<I2C_SCL_PIN_NUM)) != 0)
+
+//A blocking transfer runs the engine itself when the compare flag says a tick is due.
+//The host build sets this to a function that runs its bus model and returns 1.
+#ifndef SOFTI2C_BIT_DUE
+	#define SOFTI2C_BIT_DUE()		((TIFR1 & (1<<OCF1A)) != 0)
+#else
+	uint8_t SOFTI2C_BIT_DUE(void);
+#endif
+
+//What the next tick does
+#define SOFTI2C_PHASE_IDLE			0		//Nothing queued, the timer is stopped
+#define SOFTI2C_PHASE_START			1		//Release SCL for a start, SDA is released
+#define SOFTI2C_PHASE_START_HIGH	2		//Pull SDA low while SCL is high
+#define SOFTI2C_PHASE_START_LOW		3		//Pull SCL low and put out the first bit of the address
+#define SOFTI2C_PHASE_HIGH			4		//Release SCL for a bit
+#define SOFTI2C_PHASE_LOW			5		//Read SDA, pull SCL low and put out the next bit
+#define SOFTI2C_PHASE_STOP			6		//Release SCL for a stop, SDA is low
+#define SOFTI2C_PHASE_STOP_HIGH		7		//Release SDA while SCL is high
+
+//Part of the transaction on the bus
+#define SOFTI2C_SECTION_WRITE_ADDRESS	0
+#define SOFTI2C_SECTION_WRITE			1
+#define SOFTI2C_SECTION_READ_ADDRESS	2
+#define SOFTI2C_SECTION_READ			3
+
+static SoftI2CTransaction *SoftI2CQueue[SOFTI2C_QUEUE_LENGTH];
+static volatile uint8_t SoftI2CHead;			//Transaction on the bus
+static volatile uint8_t SoftI2CCount;			//Transactions in the queue, including the one on the bus
+static uint8_t SoftI2CHalfBit;
+
+static volatile uint8_t SoftI2CPhase;
+static uint8_t SoftI2CSection;
+static uint8_t SoftI2CIndex;					//Byte of the write or read buffer
+static uint8_t SoftI2CByte;						//Shift register
+static uint8_t SoftI2CBit;						//Bits of the byte done, the ack is bit 8
+static uint8_t SoftI2CStatus;					//Result so far
+static uint16_t SoftI2CStretch;					//Ticks SCL has been held low
+static uint8_t SoftI2CHeld;						//The LCD has port B, no ticks from the interrupt
+static SoftI2CStats SoftI2CCounters;
+
+static void SoftI2C_Count(uint16_t *Counter)
+{
+	if(*Counter != 0xFFFF)
+	{
+		(*Counter)++;
+	}
+	return;
+}
+
+void SoftI2C_Init(void)
+{
+	//Stop the timer before the queue is emptied
+	TCCR1B = 0x00;
+	TCCR1A = 0x00;
+	TIMSK1 = (1<<OCIE1A);
+	SoftI2CHeld = 0;
+	SoftI2C_SetHalfBit(SOFTI2C_HALF_BIT_US);
+
+	SoftI2CHead = 0;
+	SoftI2CCount = 0;
+	SoftI2CPhase = SOFTI2C_PHASE_IDLE;
+	memset(&SoftI2CCounters, 0, sizeof(SoftI2CCounters));
+
+	I2C_SDA_PORT &= ~(1<<I2C_SDA_PIN_NUM);
+	I2C_SCL_PORT &= ~(1<<I2C_SCL_PIN_NUM);
+	SOFTI2C_SDA_RELEASE();
+	SOFTI2C_SCL_RELEASE();
+	return;
+}
+
+uint8_t SoftI2C_SetHalfBit(uint8_t Microseconds)
+{
+	uint8_t sreg;
+
+	if(Microseconds < SOFTI2C_MIN_HALF_BIT_US)
+	{
+		return 1;
+	}
+
+	sreg = SREG;
+	cli();
+	SoftI2CHalfBit = Microseconds;
+	OCR1A = (uint16_t)Microseconds * SOFTI2C_COUNTS_PER_US - 1;
+	SREG = sreg;
+	return 0;
+}
+
+uint8_t SoftI2C_GetHalfBit(void)
+{
+	return SoftI2CHalfBit;
+}
+
+void SoftI2C_GetStats(SoftI2CStats *Stats)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	*Stats = SoftI2CCounters;
+	SREG = sreg;
+	return;
+}
+
+//Set up the transaction at the head of the queue, the lines are released
+static void SoftI2C_Begin(void)
+{
+	SoftI2CTransaction *Transaction = SoftI2CQueue[SoftI2CHead];
+
+	SoftI2CStatus = SOFTI2C_STATUS_OK;
+	SoftI2CStretch = 0;
+	if((Transaction->WriteLength > 0) || (Transaction->ReadLength == 0))
+	{
+		SoftI2CSection = SOFTI2C_SECTION_WRITE_ADDRESS;
+	}
+	else
+	{
+		SoftI2CSection = SOFTI2C_SECTION_READ_ADDRESS;
+	}
+	SoftI2CPhase = SOFTI2C_PHASE_START;
+	return;
+}
+
+uint8_t SoftI2C_Submit(SoftI2CTransaction *Transaction)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	if(SoftI2CCount >= SOFTI2C_QUEUE_LENGTH)
+	{
+		SREG = sreg;
+		return 1;
+	}
+
+	Transaction->Status = SOFTI2C_STATUS_PENDING;
+	SoftI2CQueue[(SoftI2CHead + SoftI2CCount) % SOFTI2C_QUEUE_LENGTH] = Transaction;
+	SoftI2CCount++;
+
+	//Start the timer for the first one
+	if(SoftI2CPhase == SOFTI2C_PHASE_IDLE)
+	{
+		SoftI2C_Begin();
+		TCNT1 = 0;
+		TIFR1 = (1<<OCF1A);
+		TCCR1B = (1<<WGM12) | (1<<CS10);		//CTC mode, Fcpu
+	}
+	SREG = sreg;
+	return 0;
+}
+
+//The transaction on the bus is over, the lines are released. Start the next one and call the callback.
+static void SoftI2C_Complete(void)
+{
+	SoftI2CTransaction *Transaction;
+	uint8_t Status = SoftI2CStatus;
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	Transaction = SoftI2CQueue[SoftI2CHead];
+	SoftI2C_Count(&SoftI2CCounters.Transactions);
+	SoftI2CHead = (SoftI2CHead + 1) % SOFTI2C_QUEUE_LENGTH;
+	SoftI2CCount--;
+	if(SoftI2CCount > 0)
+	{
+		SoftI2C_Begin();
+	}
+	else
+	{
+		TCCR1B = 0x00;
+		SoftI2CPhase = SOFTI2C_PHASE_IDLE;
+	}
+	SREG = sreg;
+
+	Transaction->Status = Status;
+	if(Transaction->Callback != NULL)
+	{
+		Transaction->Callback(Transaction);
+	}
+	return;
+}
+
+//End without a stop, another master or a device has the bus
+static void SoftI2C_Abort(uint8_t Status)
+{
+	SOFTI2C_SDA_RELEASE();
+	SOFTI2C_SCL_RELEASE();
+	SoftI2CStatus = Status;
+	SoftI2C_Complete();
+	return;
+}
+
+//Returns 1 while a device holds SCL low. When it lets go the high time starts from the next tick.
+static uint8_t SoftI2C_Stretched(void)
+{
+#if I2C_SOFT_USE_CLOCK_STRETCH == 1
+	if(!SOFTI2C_SCL_IS_HIGH())
+	{
+		SoftI2C_Count(&SoftI2CCounters.StretchTicks);
+		if(++SoftI2CStretch > I2C_SOFT_CLOCK_STRETCH_TIMEOUT)
+		{
+			SoftI2C_Abort(SOFTI2C_STATUS_TIMEOUT);
+		}
+		return 1;
+	}
+	if(SoftI2CStretch != 0)
+	{
+		SoftI2CStretch = 0;
+		return 1;
+	}
+#endif
+	return 0;
+}
+
+//The next four are called with SCL low
+
+static void SoftI2C_SendByte(uint8_t Data)
+{
+	SoftI2CByte = Data;
+	SoftI2CBit = 0;
+	if(Data & 0x80)
+	{
+		SOFTI2C_SDA_RELEASE();
+	}
+	else
+	{
+		SOFTI2C_SDA_LOW();
+	}
+	SoftI2CPhase = SOFTI2C_PHASE_HIGH;
+	return;
+}
+
+static void SoftI2C_ReceiveByte(void)
+{
+	SoftI2CByte = 0;
+	SoftI2CBit = 0;
+	SOFTI2C_SDA_RELEASE();
+	SoftI2CPhase = SOFTI2C_PHASE_HIGH;
+	return;
+}
+
+static void SoftI2C_RepeatedStart(void)
+{
+	SoftI2CSection = SOFTI2C_SECTION_READ_ADDRESS;
+	SOFTI2C_SDA_RELEASE();
+	SoftI2CPhase = SOFTI2C_PHASE_START;
+	return;
+}
+
+static void SoftI2C_Stop(uint8_t Status)
+{
+	SoftI2CStatus = Status;
+	SOFTI2C_SDA_LOW();
+	SoftI2CPhase = SOFTI2C_PHASE_STOP;
+	return;
+}
+
+//The ack bit of a byte has been clocked, Ack is 0 if SDA was low
+static void SoftI2C_ByteDone(uint8_t Ack)
+{
+	SoftI2CTransaction *Transaction = SoftI2CQueue[SoftI2CHead];
+
+	switch(SoftI2CSection)
+	{
+		case SOFTI2C_SECTION_WRITE_ADDRESS:
+		case SOFTI2C_SECTION_READ_ADDRESS:
+			if(Ack != 0)
+			{
+				SoftI2C_Stop(SOFTI2C_STATUS_ADDRESS_NACK);
+				return;
+			}
+			SoftI2CIndex = 0;
+			SoftI2CSection++;
+			break;
+
+		case SOFTI2C_SECTION_WRITE:
+			if(Ack != 0)
+			{
+				SoftI2C_Stop(SOFTI2C_STATUS_DATA_NACK);
+				return;
+			}
+			SoftI2CIndex++;
+			break;
+
+		case SOFTI2C_SECTION_READ:
+			SoftI2CIndex++;
+			break;
+	}
+
+	if(SoftI2CSection == SOFTI2C_SECTION_WRITE)
+	{
+		if(SoftI2CIndex < Transaction->WriteLength)
+		{
+			SoftI2C_SendByte(Transaction->Write[SoftI2CIndex]);
+		}
+		else if(Transaction->ReadLength > 0)
+		{
+			SoftI2C_RepeatedStart();
+		}
+		else
+		{
+			SoftI2C_Stop(SOFTI2C_STATUS_OK);
+		}
+	}
+	else
+	{
+		if(SoftI2CIndex < Transaction->ReadLength)
+		{
+			SoftI2C_ReceiveByte();
+		}
+		else
+		{
+			SoftI2C_Stop(SOFTI2C_STATUS_OK);
+		}
+	}
+	return;
+}
+
+//SCL was high for a tick: read the bit, pull SCL low and put out the next one
+static void SoftI2C_Low(void)
+{
+	SoftI2CTransaction *Transaction = SoftI2CQueue[SoftI2CHead];
+	uint8_t Sda;
+
+	Sda = SOFTI2C_SDA_IS_HIGH();
+	SOFTI2C_SCL_LOW();
+
+	if(SoftI2CBit == 8)
+	{
+		SoftI2C_ByteDone(Sda);
+		return;
+	}
+
+	if(SoftI2CSection != SOFTI2C_SECTION_READ)
+	{
+#if I2C_SOFT_USE_ARBITRATION == 1
+		//Another master pulled SDA low while this one sent a 1
+		if((SoftI2CByte & 0x80) && !Sda)
+		{
+			SoftI2C_Abort(SOFTI2C_STATUS_ARBITRATION);
+			return;
+		}
+#endif
+		SoftI2CByte <<= 1;
+	}
+	else
+	{
+		SoftI2CByte = (SoftI2CByte << 1) | Sda;
+	}
+	SoftI2CBit++;
+	SoftI2CPhase = SOFTI2C_PHASE_HIGH;
+
+	if(SoftI2CBit < 8)
+	{
+		if((SoftI2CSection == SOFTI2C_SECTION_READ) || (SoftI2CByte & 0x80))
+		{
+			SOFTI2C_SDA_RELEASE();
+		}
+		else
+		{
+			SOFTI2C_SDA_LOW();
+		}
+	}
+	else if(SoftI2CSection != SOFTI2C_SECTION_READ)
+	{
+		//The device acks by pulling SDA low, which is not arbitration
+		SOFTI2C_SDA_RELEASE();
+	}
+	else
+	{
+		//Ack every byte read but the last
+		Transaction->Read[SoftI2CIndex] = SoftI2CByte;
+		if((SoftI2CIndex + 1) < Transaction->ReadLength)
+		{
+			SOFTI2C_SDA_LOW();
+		}
+		else
+		{
+			SOFTI2C_SDA_RELEASE();
+		}
+	}
+	return;
+}
+
+static void SoftI2C_Tick(void)
+{
+	SoftI2CTransaction *Transaction;
+
+	switch(SoftI2CPhase)
+	{
+		case SOFTI2C_PHASE_START:
+			SOFTI2C_SCL_RELEASE();
+			SoftI2CPhase = SOFTI2C_PHASE_START_HIGH;
+			break;
+
+		case SOFTI2C_PHASE_START_HIGH:
+			if(SoftI2C_Stretched())
+			{
+				break;
+			}
+#if I2C_SOFT_USE_ARBITRATION == 1
+			if(!SOFTI2C_SDA_IS_HIGH())
+			{
+				SoftI2C_Abort(SOFTI2C_STATUS_ARBITRATION);
+				break;
+			}
+#endif
+			SOFTI2C_SDA_LOW();
+			SoftI2CPhase = SOFTI2C_PHASE_START_LOW;
+			break;
+
+		case SOFTI2C_PHASE_START_LOW:
+			Transaction = SoftI2CQueue[SoftI2CHead];
+			SOFTI2C_SCL_LOW();
+			SoftI2C_SendByte((Transaction->Address << 1) | (SoftI2CSection == SOFTI2C_SECTION_READ_ADDRESS));
+			break;
+
+		case SOFTI2C_PHASE_HIGH:
+			SOFTI2C_SCL_RELEASE();
+			SoftI2CPhase = SOFTI2C_PHASE_LOW;
+			break;
+
+		case SOFTI2C_PHASE_LOW:
+			if(!SoftI2C_Stretched())
+			{
+				SoftI2C_Low();
+			}
+			break;
+
+		case SOFTI2C_PHASE_STOP:
+			SOFTI2C_SCL_RELEASE();
+			SoftI2CPhase = SOFTI2C_PHASE_STOP_HIGH;
+			break;
+
+		case SOFTI2C_PHASE_STOP_HIGH:
+			if(SoftI2C_Stretched())
+			{
+				break;
+			}
+			SOFTI2C_SDA_RELEASE();
+			SoftI2C_Complete();
+			break;
+	}
+	return;
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+	ISRStats_Enter(ISRSTATS_TIMER1_COMPA);
+	SoftI2C_Tick();
+	ISRStats_Exit(ISRSTATS_TIMER1_COMPA);
+}
+
+//Run a tick if one is due, with the interrupt masked
+static void SoftI2C_Poll(void)
+{
+	if(SOFTI2C_BIT_DUE())
+	{
+		TIFR1 = (1<<OCF1A);
+		SoftI2C_Tick();
+	}
+	return;
+}
+
+uint8_t SoftI2C_Transfer(uint8_t Address, const uint8_t *Write, uint8_t WriteLength, uint8_t *Read, uint8_t ReadLength)
+{
+	SoftI2CTransaction Transaction;
+	uint8_t sreg;
+
+	Transaction.Address = Address;
+	Transaction.Write = Write;
+	Transaction.WriteLength = WriteLength;
+	Transaction.Read = Read;
+	Transaction.ReadLength = ReadLength;
+	Transaction.Callback = NULL;
+
+	//The interrupt and this loop must not both run ticks
+	sreg = SREG;
+	cli();
+	TIMSK1 &= ~(1<<OCIE1A);
+	SREG = sreg;
+
+	while(SoftI2C_Submit(&Transaction) != 0)
+	{
+		SoftI2C_Poll();
+	}
+	while(Transaction.Status == SOFTI2C_STATUS_PENDING)
+	{
+		SoftI2C_Poll();
+	}
+
+	sreg = SREG;
+	cli();
+	if(SoftI2CHeld == 0)
+	{
+		TIMSK1 |= (1<<OCIE1A);
+	}
+	SREG = sreg;
+	return Transaction.Status;
+}
+
+void SoftI2C_Hold(uint8_t Held)
+{
+	uint8_t sreg;
+
+	//A masked tick stays pending in the compare flag and runs as soon as the
+	//mask is lifted. Ticks missed meanwhile only make that half bit longer.
+	sreg = SREG;
+	cli();
+	SoftI2CHeld = Held;
+	if(Held)
+	{
+		TIMSK1 &= ~(1<<OCIE1A);
+	}
+	else
+	{
+		TIMSK1 |= (1<<OCIE1A);
+	}
+	SREG = sreg;
+	return;
+}
+
+/** @} */
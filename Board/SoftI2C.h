@@ -0,0 +1,126 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Interrupt driven bit banged I2C master header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	SDA is on PC6 and SCL on PB7, set up in config.h. The lines are driven
+*	open drain by switching the pin between a low output and an input, so a
+*	device can hold SCL low to stretch the clock.
+*
+*	Transactions are queued with SoftI2C_Submit() and clocked out by the timer
+*	1 compare interrupt, one line change every half bit, so the main loop and
+*	the other interrupts carry on while the bus is in use. A bit takes two
+*	ticks. When a transaction is done its status is set and its callback is
+*	called from the interrupt, which can submit the next transaction.
+*
+*	A device that stretches the clock is waited for up to
+*	I2C_SOFT_CLOCK_STRETCH_TIMEOUT ticks at a time. After that the transaction
+*	ends with SOFTI2C_STATUS_TIMEOUT and the lines are let go.
+*
+*	SCL shares port B with the LCD, whose writes change the port with a read,
+*	modify and write. An interrupt tick in the middle of one would be undone,
+*	or would let SCL go high while a device holds it low, so the engine is
+*	held with SoftI2C_Hold() while the LCD has the port.
+*
+*	SoftI2C_Transfer() is the blocking version for code that needs the answer
+*	straight away. It runs the engine itself from the compare flag, so it also
+*	works with interrupts off.
+*
+*	@{
+*/
+
+#ifndef _SOFTI2C_H_
+#define _SOFTI2C_H_
+
+#include <stdint.h>
+
+#define SOFTI2C_QUEUE_LENGTH			4		//Transactions waiting or running
+#define SOFTI2C_HALF_BIT_US				25		//Default tick, 20kHz clock
+#define SOFTI2C_MIN_HALF_BIT_US			20		//The interrupt needs most of this at 8MHz
+
+//Transaction status
+#define SOFTI2C_STATUS_OK				0
+#define SOFTI2C_STATUS_ADDRESS_NACK		1		//No device, or the device is busy
+#define SOFTI2C_STATUS_DATA_NACK		2		//The device did not take a byte
+#define SOFTI2C_STATUS_TIMEOUT			3		//SCL was held low too long
+#define SOFTI2C_STATUS_ARBITRATION		4		//SDA was low when it should have been high
+#define SOFTI2C_STATUS_PENDING			0xFF	//Waiting in the queue or running
+
+struct SoftI2CTransaction;
+
+/** Called from the interrupt when a transaction is done. */
+typedef void (*SoftI2CCallback)(struct SoftI2CTransaction *Transaction);
+
+/** A write and then a read of one device, with a repeated start in between. Either length can be 0.
+*	With both 0 the device is only addressed, to see if it answers. The transaction and its
+*	buffers belong to the caller and must be kept until the status is no longer pending.
+*/
+typedef struct SoftI2CTransaction
+{
+	uint8_t Address;				//7 bit address
+	const uint8_t *Write;
+	uint8_t WriteLength;
+	uint8_t *Read;
+	uint8_t ReadLength;
+	SoftI2CCallback Callback;		//NULL for none
+	volatile uint8_t Status;		//A SOFTI2C_STATUS_ value, set by the engine
+} SoftI2CTransaction;
+
+/** Counters kept by the engine. */
+typedef struct
+{
+	uint16_t Transactions;			//Finished, whatever the status
+	uint16_t StretchTicks;			//Ticks SCL stayed low after it was let go, from stretching or a slow rise
+} SoftI2CStats;
+
+/** Release both lines, empty the queue and set up timer 1 at the default speed. */
+void SoftI2C_Init(void);
+
+/** Queue a transaction. Can be called from an interrupt or a callback.
+*	\return 0 if it was queued, 1 if the queue is full
+*/
+uint8_t SoftI2C_Submit(SoftI2CTransaction *Transaction);
+
+/** Queue a transaction and wait for it, running the ones ahead of it too. Not for use in a callback.
+*	\param[in] Address	7 bit address
+*	\return One of the SOFTI2C_STATUS_ values
+*/
+uint8_t SoftI2C_Transfer(uint8_t Address, const uint8_t *Write, uint8_t WriteLength, uint8_t *Read, uint8_t ReadLength);
+
+/** Set the time between line changes, half a clock period.
+*	\return 0 if it was set, 1 if it is shorter than SOFTI2C_MIN_HALF_BIT_US
+*/
+uint8_t SoftI2C_SetHalfBit(uint8_t Microseconds);
+
+/** Get the time between line changes in us. */
+uint8_t SoftI2C_GetHalfBit(void);
+
+/** Stop or restart the ticks from the interrupt. A held transaction carries on where it stopped.
+*	\param[in] Held	1 while the LCD has port B, 0 to let the engine run again
+*/
+void SoftI2C_Hold(uint8_t Held);
+
+/** Copy the counters. */
+void SoftI2C_GetStats(SoftI2CStats *Stats);
+
+#endif
+
+/** @} */
@@ -0,0 +1,96 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		In RAM event trace.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	@{
+*/
+
+#include "main.h"
+
+TraceRecord TraceRing[TRACE_SIZE];
+uint8_t TraceHead;				//Next record to write
+uint8_t TraceCount;				//Records in the ring
+uint8_t TraceEnabled = 1;
+volatile uint16_t TraceTime;
+
+void Trace_Clear(void)
+{
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	TraceHead = 0;
+	TraceCount = 0;
+	SREG = sreg;
+	return;
+}
+
+void Trace_Enable(uint8_t Enable)
+{
+	TraceEnabled = (Enable != 0);
+	return;
+}
+
+uint8_t Trace_Read(uint8_t Index, TraceRecord *Record)
+{
+	uint8_t sreg;
+	uint8_t Status = 1;
+
+	sreg = SREG;
+	cli();
+	if(Index < TraceCount)
+	{
+		memcpy(Record, &TraceRing[(TraceHead - TraceCount + Index) & (TRACE_SIZE - 1)], sizeof(TraceRecord));
+		Status = 0;
+	}
+	SREG = sreg;
+	return Status;
+}
+
+void Trace_Dump(void)
+{
+	TraceRecord Record;
+	uint8_t Enabled = TraceEnabled;
+	uint8_t i;
+
+	//Stop recording so the oldest records are not overwritten while they are printed
+	Trace_Enable(0);
+
+	Format_Puts_P(Console_PutChar, "TRACE ");
+	Format_UInt(Console_PutChar, TraceCount, 0, ' ');
+	Console_PutChar('\n');
+	for(i = 0; Trace_Read(i, &Record) == 0; i++)
+	{
+		//Event, time, data: EETTTTDDDD
+		Format_Hex2(Console_PutChar, Record.Event);
+		Format_Hex2(Console_PutChar, Record.Time >> 8);
+		Format_Hex2(Console_PutChar, Record.Time & 0xFF);
+		Format_Hex2(Console_PutChar, Record.Data[0]);
+		Format_Hex2(Console_PutChar, Record.Data[1]);
+		Console_PutChar('\n');
+	}
+	Format_Puts_P(Console_PutChar, "END\n");
+
+	Trace_Enable(Enabled);
+	return;
+}
+
+/** @} */
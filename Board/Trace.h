@@ -0,0 +1,111 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		In RAM event trace header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	hardware
+*
+*	Trace_Event() stores a 5 byte record in a ring buffer: the event number, a
+*	16 bit ms timestamp and two bytes of data. It is inline and does no
+*	formatting, so it can be left in interrupts and other time sensitive code.
+*	When the ring is full the oldest record is overwritten.
+*
+*	The 'trace' command prints the ring as hex, oldest first, between a
+*	"TRACE <count>" line and an "END" line. tools/tracedecode.py turns a
+*	capture of that into a timeline, using the event names below.
+*
+*	@{
+*/
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+
+#define TRACE_SIZE					32		//Records in the ring, must be a power of 2
+
+//Events, data bytes are listed after the name. tools/tracedecode.py reads these lines.
+#define TRACE_EVENT_MARK			0		//Marker from the 'trace' command: value, 0
+#define TRACE_EVENT_BUTTON			1		//Button pressed: button, menu state
+#define TRACE_EVENT_TIME_EDIT		2		//Time edit cursor: DDRAM address, field value
+#define TRACE_EVENT_MENU_TIMEOUT	3		//Menu timed out to the clock: 0, 0
+#define TRACE_EVENT_TASK			4		//Scheduler task run: slot, 0
+
+typedef struct
+{
+	uint8_t Event;
+	uint16_t Time;				//ms, wraps every 65.5s
+	uint8_t Data[2];
+} TraceRecord;
+
+extern TraceRecord TraceRing[TRACE_SIZE];
+extern uint8_t TraceHead;
+extern uint8_t TraceCount;
+extern uint8_t TraceEnabled;
+extern volatile uint16_t TraceTime;
+
+/** Add a record to the ring. Safe to call from interrupts. */
+static inline void Trace_Event(uint8_t Event, uint8_t Data0, uint8_t Data1)
+{
+	TraceRecord *Record;
+	uint8_t sreg;
+
+	sreg = SREG;
+	cli();
+	if(TraceEnabled != 0)
+	{
+		Record = &TraceRing[TraceHead];
+		TraceHead = (TraceHead + 1) & (TRACE_SIZE - 1);
+		if(TraceCount < TRACE_SIZE)
+		{
+			TraceCount++;
+		}
+		Record->Event = Event;
+		Record->Time = TraceTime;
+		Record->Data[0] = Data0;
+		Record->Data[1] = Data1;
+	}
+	SREG = sreg;
+	return;
+}
+
+/** Advance the timestamp. Called from the 1ms timer interrupt. */
+static inline void Trace_Tick(void)
+{
+	TraceTime++;
+	return;
+}
+
+/** Empty the ring. */
+void Trace_Clear(void);
+
+/** Stop or restart recording. Recording is on at power up. */
+void Trace_Enable(uint8_t Enable);
+
+/** Copy a record from the ring.
+*	\param[in] Index	0 for the oldest record
+*	\return 0 if the record was copied, 1 if Index is past the newest record
+*/
+uint8_t Trace_Read(uint8_t Index, TraceRecord *Record);
+
+/** Print the ring to the console for tools/tracedecode.py. Recording is stopped while printing. */
+void Trace_Dump(void);
+
+#endif
+
+/** @} */
@@ -28,7 +28,7 @@
 
 
 //The number of commands
-const uint8_t NumCommands = 11;
+const uint8_t NumCommands = 21;
 
 //Handler function declerations
 
@@ -71,8 +71,8 @@ const char _F6_HELPTEXT[] PROGMEM 		= "lcdwrite <data>";
 //Get a set of data from the devices
 static int _F8_Handler (void);
 const char _F8_NAME[] PROGMEM 			= "bkl";
-const char _F8_DESCRIPTION[] PROGMEM 	= "Turn the backlight on/off";
-const char _F8_HELPTEXT[] PROGMEM 		= "bkl <state>";
+const char _F8_DESCRIPTION[] PROGMEM 	= "Control the backlight";
+const char _F8_HELPTEXT[] PROGMEM 		= "bkl <state (0: off, 1: on, 2: level, 3: idle level, 4: auto)> [value]";
 
 //Read a register from the memory
 static int _F9_Handler (void);
@@ -84,19 +84,75 @@ const char _F9_HELPTEXT[] PROGMEM 		= "nothing yet";
 static int _F10_Handler (void);
 const char _F10_NAME[] PROGMEM 			= "pres";
 const char _F10_DESCRIPTION[] PROGMEM 	= "Pressure sensor functions";
-const char _F10_HELPTEXT[] PROGMEM 		= "pres <function>";
+const char _F10_HELPTEXT[] PROGMEM 		= "pres <function>: 0 reading, 1 coefficients, 2 <ms> conversion period (0 stops)";
 
 //Humidity sensor functions
 static int _F11_Handler (void);
 const char _F11_NAME[] PROGMEM 			= "rh";
 const char _F11_DESCRIPTION[] PROGMEM 	= "Humidity sensor functions";
-const char _F11_HELPTEXT[] PROGMEM 		= "rh <cnd> <val>";
+const char _F11_HELPTEXT[] PROGMEM 		= "rh <function>: 0 reading, 1 user register, 2 <value> write user register, 3 <ms> measurement period (0 stops)";
 
 //Scan the TWI bus for devices
 static int _F12_Handler (void);
 const char _F12_NAME[] PROGMEM 			= "twiscan";
 const char _F12_DESCRIPTION[] PROGMEM 	= "Scan for TWI devices";
-const char _F12_HELPTEXT[] PROGMEM 		= "'twiscan' has no parameters";
+const char _F12_HELPTEXT[] PROGMEM 		= "twiscan <clock in kHz, 2 to 25>";
+
+//Set the LCD size and controller type
+static int _F13_Handler (void);
+const char _F13_NAME[] PROGMEM 			= "lcdgeo";
+const char _F13_DESCRIPTION[] PROGMEM 	= "Get/set the LCD size";
+const char _F13_HELPTEXT[] PROGMEM 		= "lcdgeo <columns> <lines> <controller (0: HD44780, 1: KS0073)>";
+
+//Interrupt latency and run time statistics
+static int _F14_Handler (void);
+const char _F14_NAME[] PROGMEM 			= "isrstat";
+const char _F14_DESCRIPTION[] PROGMEM 	= "Interrupt timing statistics";
+const char _F14_HELPTEXT[] PROGMEM 		= "isrstat <0: show, 1: clear, 2: strobe LED during ISR, 3: strobe off> <ISR number>";
+
+//Event trace
+static int _F15_Handler (void);
+const char _F15_NAME[] PROGMEM 			= "trace";
+const char _F15_DESCRIPTION[] PROGMEM 	= "Dump the event trace";
+const char _F15_HELPTEXT[] PROGMEM 		= "trace <0: dump, 1: clear, 2: add marker, 3: enable> <value>";
+
+//Data recorder
+static int _F16_Handler (void);
+const char _F16_NAME[] PROGMEM 			= "recstart";
+const char _F16_DESCRIPTION[] PROGMEM 	= "Start the data recorder";
+const char _F16_HELPTEXT[] PROGMEM 		= "recstart <period in ms> <channel mask>";
+
+static int _F17_Handler (void);
+const char _F17_NAME[] PROGMEM 			= "recstop";
+const char _F17_DESCRIPTION[] PROGMEM 	= "Stop the data recorder";
+const char _F17_HELPTEXT[] PROGMEM 		= "'recstop' has no parameters";
+
+static int _F18_Handler (void);
+const char _F18_NAME[] PROGMEM 			= "recstat";
+const char _F18_DESCRIPTION[] PROGMEM 	= "Data recorder status";
+const char _F18_HELPTEXT[] PROGMEM 		= "'recstat' has no parameters";
+
+//Recorded data
+static int _F19_Handler (void);
+const char _F19_NAME[] PROGMEM 			= "logread";
+const char _F19_DESCRIPTION[] PROGMEM 	= "Print recorded data";
+const char _F19_HELPTEXT[] PROGMEM 		= "logread <from> <to>, in seconds since 2000, or seconds ago if 0 or less";
+
+static int _F20_Handler (void);
+const char _F20_NAME[] PROGMEM 			= "logdump";
+const char _F20_DESCRIPTION[] PROGMEM 	= "Binary dump of the dataflash";
+const char _F20_HELPTEXT[] PROGMEM 		= "logdump <first page> <pages> <1 on a retry>, use tools/logdump.py";
+
+//Sensor filters and rolling statistics
+static int _F21_Handler (void);
+const char _F21_NAME[] PROGMEM 			= "filter";
+const char _F21_DESCRIPTION[] PROGMEM 	= "Get/set the sensor filters";
+const char _F21_HELPTEXT[] PROGMEM 		= "filter <channel (0: pressure, 1: temperature, 2: humidity)> <median of 1, 3 or 5> <average 1/2^n, 0 to 7>";
+
+static int _F22_Handler (void);
+const char _F22_NAME[] PROGMEM 			= "stats";
+const char _F22_DESCRIPTION[] PROGMEM 	= "Sensor statistics";
+const char _F22_HELPTEXT[] PROGMEM 		= "stats <0: show, 1: clear>";
 
 //Command list
 const CommandListItem AppCommandList[] PROGMEM =
@@ -107,11 +163,21 @@ const CommandListItem AppCommandList[] PROGMEM =
 	{ _F4_NAME, 	7,  7,	_F4_Handler,	_F4_DESCRIPTION,	_F4_HELPTEXT	},		//settime
 	{ _F5_NAME, 	0,  0,	_F5_Handler,	_F5_DESCRIPTION,	_F5_HELPTEXT	},		//gettime
 	{ _F6_NAME, 	1,  1,	_F6_Handler,	_F6_DESCRIPTION,	_F6_HELPTEXT	},		//lcdwrite	
-	{ _F8_NAME,		1,  1,	_F8_Handler,	_F8_DESCRIPTION,	_F8_HELPTEXT	},		//bkl
+	{ _F8_NAME,		1,  2,	_F8_Handler,	_F8_DESCRIPTION,	_F8_HELPTEXT	},		//bkl
 	{ _F9_NAME,		0,  3,	_F9_Handler,	_F9_DESCRIPTION,	_F9_HELPTEXT	},		//test
-	{ _F10_NAME,	0,  0,	_F10_Handler,	_F10_DESCRIPTION,	_F10_HELPTEXT	},		//pres
-	{ _F11_NAME,	1,  2,	_F11_Handler,	_F11_DESCRIPTION,	_F11_HELPTEXT	},		//rh
-	{ _F12_NAME,	0,  0,	_F12_Handler,	_F12_DESCRIPTION,	_F12_HELPTEXT	},		//twiscan
+	{ _F10_NAME,	0,  2,	_F10_Handler,	_F10_DESCRIPTION,	_F10_HELPTEXT	},		//pres
+	{ _F11_NAME,	0,  2,	_F11_Handler,	_F11_DESCRIPTION,	_F11_HELPTEXT	},		//rh
+	{ _F12_NAME,	0,  1,	_F12_Handler,	_F12_DESCRIPTION,	_F12_HELPTEXT	},		//twiscan
+	{ _F13_NAME,	0,  3,	_F13_Handler,	_F13_DESCRIPTION,	_F13_HELPTEXT	},		//lcdgeo
+	{ _F14_NAME,	0,  2,	_F14_Handler,	_F14_DESCRIPTION,	_F14_HELPTEXT	},		//isrstat
+	{ _F15_NAME,	0,  2,	_F15_Handler,	_F15_DESCRIPTION,	_F15_HELPTEXT	},		//trace
+	{ _F16_NAME,	1,  2,	_F16_Handler,	_F16_DESCRIPTION,	_F16_HELPTEXT	},		//recstart
+	{ _F17_NAME,	0,  0,	_F17_Handler,	_F17_DESCRIPTION,	_F17_HELPTEXT	},		//recstop
+	{ _F18_NAME,	0,  0,	_F18_Handler,	_F18_DESCRIPTION,	_F18_HELPTEXT	},		//recstat
+	{ _F19_NAME,	1,  2,	_F19_Handler,	_F19_DESCRIPTION,	_F19_HELPTEXT	},		//logread
+	{ _F20_NAME,	0,  3,	_F20_Handler,	_F20_DESCRIPTION,	_F20_HELPTEXT	},		//logdump
+	{ _F21_NAME,	0,  3,	_F21_Handler,	_F21_DESCRIPTION,	_F21_HELPTEXT	},		//filter
+	{ _F22_NAME,	0,  1,	_F22_Handler,	_F22_DESCRIPTION,	_F22_HELPTEXT	},		//stats
 };
 
 //Command functions
@@ -119,23 +185,25 @@ const CommandListItem AppCommandList[] PROGMEM =
 //Clear LCD screen
 static int _F1_Handler (void)
 {
+	SPI_LcdBegin();
 	lcd_clrscr();
+	SPI_LcdEnd();
 	return 0;
 }
 
 //Jump to DFU bootloader
 static int _F2_Handler (void)
 {
-	printf_P(PSTR("Jumping to bootloader. A manual reset will be required\nPress 'y' to continue..."));
+	Format_Puts_P(Console_PutChar, "Jumping to bootloader. A manual reset will be required\nPress 'y' to continue...");
 	
 	if(WaitForAnyKey() == 'y')
 	{
-		printf_P(PSTR("Jump\n"));
+		Format_Puts_P(Console_PutChar, "Jump\n");
 		DelayMS(100);
 		Jump_To_Bootloader();
 	}
 	
-	printf_P(PSTR("Canceled\n"));
+	Format_Puts_P(Console_PutChar, "Canceled\n");
 	return 0;
 }
 
@@ -169,9 +237,12 @@ static int _F4_Handler (void)
 	CurrentTime.min		= argAsInt(6);
 	CurrentTime.sec		= argAsInt(7);
 	SetTime(CurrentTime);
-	printf_P(PSTR("Setting %02u/%02u/%04u %02u:%02u:%02u"), CurrentTime.month, CurrentTime.day, CurrentTime.year, CurrentTime.hour, CurrentTime.min, CurrentTime.sec);
+	Format_Puts_P(Console_PutChar, "Setting ");
+	Format_Date(Console_PutChar, CurrentTime.month, CurrentTime.day, CurrentTime.year);
+	Console_PutChar(' ');
+	Format_Time(Console_PutChar, CurrentTime.hour, CurrentTime.min, CurrentTime.sec);
 	
-	printf_P(PSTR("......Done\n"));
+	Format_Puts_P(Console_PutChar, "......Done\n");
 	return 0;
 }
 
@@ -180,7 +251,10 @@ static int _F5_Handler (void)
 {
 	TimeAndDate CurrentTime;
 	GetTime(&CurrentTime);
-	printf_P(PSTR("%02u/%02u/%04u %02u:%02u:%02u\n"), CurrentTime.month, CurrentTime.day, CurrentTime.year, CurrentTime.hour, CurrentTime.min, CurrentTime.sec);
+	Format_Date(Console_PutChar, CurrentTime.month, CurrentTime.day, CurrentTime.year);
+	Console_PutChar(' ');
+	Format_Time(Console_PutChar, CurrentTime.hour, CurrentTime.min, CurrentTime.sec);
+	Console_PutChar('\n');
 	return 0;
 }
 
@@ -190,8 +264,10 @@ static int _F6_Handler (void)
 	char DataToWrite[16];
 	argAsChar(1, DataToWrite);
 	
+	SPI_LcdBegin();
 	lcd_puts(DataToWrite);
 	lcd_puts("\n");
+	SPI_LcdEnd();
 	/*if(tcs3414_WriteReg(RegToWrite, DataToWrite) == 0)
 	{
 		printf_P(PSTR("OK\n"));
@@ -208,15 +284,41 @@ static int _F6_Handler (void)
 static int _F8_Handler (void)
 {
 	uint8_t NewState = argAsInt(1);
+	uint8_t Value = argAsInt(2);
 	
-	if(NewState == 1)
+	switch(NewState)
 	{
-		PORTB |= (1<<6);
-	}
-	else
-	{
-		PORTB &= ~(1<<6);
+		case 0:
+			Backlight_Enable(0);
+			break;
+		
+		case 1:
+			Backlight_Enable(1);
+			break;
+		
+		case 2:
+			Backlight_SetLevel(Value);
+			Settings_Save();
+			break;
+		
+		case 3:
+			Backlight_SetIdleLevel(Value);
+			Settings_Save();
+			break;
+		
+		case 4:
+			Backlight_SetAuto(Value);
+			Settings_Save();
+			break;
 	}
+	
+	Format_Puts_P(Console_PutChar, "Level: ");
+	Format_UInt(Console_PutChar, Settings.BacklightLevel, 0, ' ');
+	Format_Puts_P(Console_PutChar, ", idle: ");
+	Format_UInt(Console_PutChar, Settings.BacklightIdleLevel, 0, ' ');
+	Format_Puts_P(Console_PutChar, ", auto: ");
+	Format_UInt(Console_PutChar, Settings.BacklightAuto, 0, ' ');
+	Console_PutChar('\n');
 	return 0;
 }
 
@@ -227,6 +329,7 @@ static int _F9_Handler (void)
 	TimeAndDate CurrentTime;
 	uint8_t i;
 
+	SPI_LcdBegin();
 	switch(CmdState)
 	{
 		case 1:
@@ -234,28 +337,35 @@ static int _F9_Handler (void)
 			break;
 			
 		case 2:
-			fprintf(&LCDStream, "test1");
+			lcd_puts_P("test1");
 			break;
 			
 		case 3:
-			lcd_gotoxy(0, 1);
-			fprintf(&LCDStream, "test2");
+			LCDGeo_GotoXY(0, 1);
+			lcd_puts_P("test2");
 			break;
 	
 		case 4:
 			GetTime(&CurrentTime);
 			lcd_init(LCD_DISP_ON_CURSOR);
-			fprintf(&LCDStream, "Set Time\n %02u:%02u:%02u\n", CurrentTime.hour, CurrentTime.min, CurrentTime.sec);
-			lcd_gotoxy(2, 1);
+			LCDGeo_Init();
+			lcd_puts_P("Set Time");
+			LCDGeo_GotoXY(1, 1);
+			Format_Time(lcd_putc, CurrentTime.hour, CurrentTime.min, CurrentTime.sec);
+			LCDGeo_GotoXY(2, 1);
 			break;
 			
 		case 5:
-			lcd_gotoxy(0, 1);
-			fprintf(&LCDStream, "abcdeABCDE");
+			LCDGeo_GotoXY(0, 1);
+			lcd_puts_P("abcdeABCDE");
 		
 			for(i=1;i<10;i++)
 			{
-				printf("DDRAM(%u): 0x%02X\n", i, lcd_getxy(i, 1));
+				Format_Puts_P(Console_PutChar, "DDRAM(");
+				Format_UInt(Console_PutChar, i, 0, ' ');
+				Format_Puts_P(Console_PutChar, "): 0x");
+				Format_Hex2(Console_PutChar, lcd_getcharacterataddress(LCD_ADDRESS(i, 1)));
+				Console_PutChar('\n');
 			}
 			
 			/*
@@ -290,6 +400,7 @@ static int _F9_Handler (void)
 			break;
 	
 	}
+	SPI_LcdEnd();
 
 	return 0;
 }
@@ -297,107 +408,415 @@ static int _F9_Handler (void)
 //Pressure sensor functions
 static int _F10_Handler (void)
 {
-	//int16_t Pressure_kPa;
-	/*MPL115A1_GetPressure(&Pressure_kPa);
-	printf_P(PSTR("Pressure: %u.%u kPa\n"), ((int16_t)Pressure_kPa)>>4, ((((int16_t)Pressure_kPa)&0x000F)*1000)/(16) );*/
+	MPL115A1Coefficients Coef;
+	int16_t Pressure_kPa;
+	uint16_t Padc;
+	uint16_t Tadc;
+
+	switch(argAsInt(1))
+	{
+		case 1:
+			MPL115A1_GetCoefficients(&Coef);
+			Format_Puts_P(Console_PutChar, "a0 0x");
+			Format_Hex2(Console_PutChar, Coef.A0 >> 8);
+			Format_Hex2(Console_PutChar, Coef.A0);
+			Format_Puts_P(Console_PutChar, ", b1 0x");
+			Format_Hex2(Console_PutChar, Coef.B1 >> 8);
+			Format_Hex2(Console_PutChar, Coef.B1);
+			Format_Puts_P(Console_PutChar, ", b2 0x");
+			Format_Hex2(Console_PutChar, Coef.B2 >> 8);
+			Format_Hex2(Console_PutChar, Coef.B2);
+			Format_Puts_P(Console_PutChar, ", c12 0x");
+			Format_Hex2(Console_PutChar, Coef.C12 >> 8);
+			Format_Hex2(Console_PutChar, Coef.C12);
+			Console_PutChar('\n');
+			return 0;
+
+		case 2:
+			if(MPL115A1_SetPeriod(argAsInt(2)) != 0)
+			{
+				Format_Puts_P(Console_PutChar, "Invalid period or no sensor\n");
+			}
+			return 0;
+	}
+
+	if(MPL115A1_GetPressure(&Pressure_kPa) != 0)
+	{
+		Format_Puts_P(Console_PutChar, "No reading\n");
+		return 0;
+	}
+	MPL115A1_GetRaw(&Padc, &Tadc);
+	Format_Puts_P(Console_PutChar, "Pressure: ");
+	Format_Fixed(Console_PutChar, Pressure_kPa, 4, 2);
+	Format_Puts_P(Console_PutChar, " kPa, Padc ");
+	Format_UInt(Console_PutChar, Padc, 0, ' ');
+	Format_Puts_P(Console_PutChar, ", Tadc ");
+	Format_UInt(Console_PutChar, Tadc, 0, ' ');
+	Console_PutChar('\n');
 	return 0;
 }
 
 //Humidity sensor functions
 static int _F11_Handler (void)
 {
-	/*uint8_t temp;
-	uint8_t stat;
-	uint8_t InputCmd	= argAsInt(1);
-	uint8_t InputVal	= argAsInt(2);
-	int16_t RecievedData;
-	
-	uint16_t SNA;
-	uint32_t SNB;
-	uint16_t SNC;*/
-	
-	/*if(InputCmd == 1)
+	uint8_t Function	= argAsInt(1);
+	uint16_t Value		= argAsInt(2);
+	int16_t Temperature;
+	int16_t Humidity;
+	SHT25Stats Stats;
+	uint8_t Status;
+	uint8_t User;
+
+	switch(Function)
+	{
+		case 1:
+			Status = SHT25_ReadUserReg(&User);
+			break;
+
+		case 2:
+			User = Value;
+			Status = SHT25_WriteUserReg(User);
+			break;
+
+		case 3:
+			if(SHT25_SetPeriod(Value) != 0)
+			{
+				Format_Puts_P(Console_PutChar, "Invalid period or no sensor\n");
+			}
+			return 0;
+
+		default:
+			if(SHT25_GetReading(&Temperature, &Humidity) != 0)
+			{
+				Format_Puts_P(Console_PutChar, "No reading\n");
+			}
+			else
+			{
+				Format_Puts_P(Console_PutChar, "Temperature: ");
+				Format_Decimal(Console_PutChar, Temperature, 2);
+				Format_Puts_P(Console_PutChar, " C, humidity: ");
+				Format_Decimal(Console_PutChar, Humidity, 2);
+				Format_Puts_P(Console_PutChar, " %RH\n");
+			}
+			SHT25_GetStats(&Stats);
+			Format_Puts_P(Console_PutChar, "Measurements: ");
+			Format_UInt(Console_PutChar, Stats.Measurements, 0, ' ');
+			Format_Puts_P(Console_PutChar, ", polls: ");
+			Format_UInt(Console_PutChar, Stats.Polls, 0, ' ');
+			Format_Puts_P(Console_PutChar, ", CRC errors: ");
+			Format_UInt(Console_PutChar, Stats.CrcErrors, 0, ' ');
+			Format_Puts_P(Console_PutChar, ", timeouts: ");
+			Format_UInt(Console_PutChar, Stats.Timeouts, 0, ' ');
+			Format_Puts_P(Console_PutChar, ", bus errors: ");
+			Format_UInt(Console_PutChar, Stats.BusErrors, 0, ' ');
+			Console_PutChar('\n');
+			return 0;
+	}
+
+	if(Status != SOFTI2C_STATUS_OK)
 	{
-		stat = SHT25_ReadUserReg(&temp);
-		if(stat != SOFT_I2C_STAT_OK)
+		Format_Puts_P(Console_PutChar, "I2C error ");
+		Format_UInt(Console_PutChar, Status, 0, ' ');
+		Console_PutChar('\n');
+		return 0;
+	}
+	Format_Puts_P(Console_PutChar, "User register: 0x");
+	Format_Hex2(Console_PutChar, User);
+	Console_PutChar('\n');
+	return 0;
+}
+
+//Scan the TWI bus for devices
+static int _F12_Handler (void)
+{
+	uint16_t Clock		= argAsInt(1);
+	uint8_t HalfBit		= SoftI2C_GetHalfBit();
+	I2CScanResult Result;
+
+	//No clock scans at the current speed
+	if(Clock != 0)
+	{
+		if((Clock < I2CSCAN_MIN_KHZ) || (Clock > I2CSCAN_MAX_KHZ))
 		{
-			printf_P(PSTR("ERROR: 0x%02X\n"), stat);
+			Format_Puts_P(Console_PutChar, "Invalid clock\n");
+			return 0;
 		}
-		else
+		HalfBit = 500 / Clock;
+	}
+
+	I2CScan_Run(HalfBit, &Result);
+	I2CScan_Print(&Result);
+	return 0;
+}
+
+//Set the LCD size and controller type
+static int _F13_Handler (void)
+{
+	uint8_t Columns		= argAsInt(1);
+	uint8_t Lines		= argAsInt(2);
+	uint8_t Controller	= argAsInt(3);
+
+	if(Columns != 0)
+	{
+		if(LCDGeo_Valid(Columns, Lines, Controller) == 0)
 		{
-			printf_P(PSTR("REG: 0x%02X\n"), temp);
+			Format_Puts_P(Console_PutChar, "Invalid LCD size\n");
+			return 0;
 		}
-		return 0;
+
+		Settings.LCDColumns		= Columns;
+		Settings.LCDLines		= Lines;
+		Settings.LCDController	= Controller;
+		Settings_Save();
+
+		SPI_LcdBegin();
+		lcd_init(LCD_DISP_ON);
+		LCDGeo_Init();
+		lcd_clrscr();
+		SPI_LcdEnd();
 	}
-	else if(InputCmd == 2)
+
+	Format_Puts_P(Console_PutChar, "LCD: ");
+	Format_UInt(Console_PutChar, LCDColumns, 0, ' ');
+	Console_PutChar('x');
+	Format_UInt(Console_PutChar, LCDLines, 0, ' ');
+	if(Settings.LCDController == LCDGEO_CONTROLLER_KS0073)
 	{
-		printf_P(PSTR("Writing 0x%02X..."), InputVal);
-		stat = SHT25_WriteUserReg(InputVal);
-		printf_P(PSTR("0x%02X\n"), stat);
-		return 0;
+		Format_Puts_P(Console_PutChar, " KS0073\n");
 	}
-	else if(InputCmd == 3)
+	else
 	{
-		printf_P(PSTR("Device reset\n"));
-		SHT25_Reset();
+		Format_Puts_P(Console_PutChar, " HD44780\n");
 	}
-	else if(InputCmd == 4)
+	return 0;
+}
+
+//Print one histogram line, each bucket right aligned to 6 characters
+static void PrintISRHistogram(uint16_t *Histogram)
+{
+	uint8_t i;
+
+	for(i = 0; i < ISRSTATS_BUCKETS; i++)
 	{
-		stat = SHT25_ReadTemp(&RecievedData);
-		if(stat == SHT25_RETURN_STATUS_OK)
-		{
-			printf_P(PSTR("Temp %d.%02u C\n"), RecievedData/100, RecievedData%100);
-		}
-		else if(stat == SHT25_RETURN_STATUS_CRC_ERROR)
-		{
-			printf_P(PSTR("CRC Error\n"));
-		}
-		else
-		{
-			printf_P(PSTR("Timeout\n"));
-		}
+		Format_UInt(Console_PutChar, Histogram[i], 6, ' ');
 	}
-	else if(InputCmd == 5)
+	Console_PutChar('\n');
+	return;
+}
+
+//Interrupt latency and run time statistics
+static int _F14_Handler (void)
+{
+	uint8_t Mode	= argAsInt(1);
+	uint8_t Id		= argAsInt(2);
+	ISRStat Stat;
+	uint16_t Latency[ISRSTATS_BUCKETS];
+	uint8_t MaxLatency;
+	uint8_t i;
+
+	switch(Mode)
 	{
-		stat = SHT25_ReadRH(&RecievedData);
-		if(stat == SHT25_RETURN_STATUS_OK)
-		{
-			printf_P(PSTR("RH: %u.%02u%%\n"), RecievedData/100, RecievedData%100);
-		}
-		else if(stat == SHT25_RETURN_STATUS_CRC_ERROR)
-		{
-			printf_P(PSTR("CRC Error\n"));
-		}
-		else
-		{
-			printf_P(PSTR("Timeout\n"));
-		}
+		case 1:
+			ISRStats_Clear();
+			return 0;
+
+		case 2:
+			if(Id >= ISRSTATS_COUNT)
+			{
+				Format_Puts_P(Console_PutChar, "Invalid ISR\n");
+				return 0;
+			}
+			ISRStats_SetStrobe(Id);
+			Format_Puts_P(Console_PutChar, "Strobing ");
+			Format_Puts_p(Console_PutChar, ISRStats_Name(Id));
+			Console_PutChar('\n');
+			return 0;
+
+		case 3:
+			ISRStats_SetStrobe(ISRSTATS_STROBE_OFF);
+			return 0;
 	}
-	else if(InputCmd == 6)
+
+	//Times are in us, histogram columns are the lower bound of each bucket
+	Format_Puts_P(Console_PutChar, "#  ISR           Count  Max Delay |     0     8    16    32    64   128   256 1000+\n");
+	for(Id = 0; Id < ISRSTATS_COUNT; Id++)
 	{
-		stat = SHT25_ReadID(&SNA, &SNB, &SNC);
-		if(stat == SHT25_RETURN_STATUS_OK)
+		ISRStats_Get(Id, &Stat);
+		Format_UInt(Console_PutChar, Id, 1, ' ');
+		Format_Puts_P(Console_PutChar, "  ");
+		Format_Puts_p(Console_PutChar, ISRStats_Name(Id));
+		for(i = strlen_P(ISRStats_Name(Id)); i < 12; i++)
 		{
-			printf_P(PSTR("SN: 0x%04X%08lX%04X\n"), SNA, SNB, SNC);
+			Console_PutChar(' ');
 		}
-		else if(stat == SHT25_RETURN_STATUS_CRC_ERROR)
+		Format_UInt(Console_PutChar, Stat.Count, 6, ' ');
+		Format_UInt(Console_PutChar, (uint16_t)Stat.MaxLength * 8, 5, ' ');
+		Format_UInt(Console_PutChar, Stat.DelayedTicks, 6, ' ');
+		Format_Puts_P(Console_PutChar, " |");
+		PrintISRHistogram(Stat.Histogram);
+	}
+
+	MaxLatency = ISRStats_GetLatency(Latency);
+	Format_Puts_P(Console_PutChar, "   TIMER0 latency     Max ");
+	Format_UInt(Console_PutChar, (uint16_t)MaxLatency * 8, 5, ' ');
+	Format_Puts_P(Console_PutChar, "       |");
+	PrintISRHistogram(Latency);
+	return 0;
+}
+
+//Event trace
+static int _F15_Handler (void)
+{
+	uint8_t Mode	= argAsInt(1);
+	uint8_t Value	= argAsInt(2);
+
+	switch(Mode)
+	{
+		case 1:
+			Trace_Clear();
+			break;
+
+		case 2:
+			Trace_Event(TRACE_EVENT_MARK, Value, 0);
+			break;
+
+		case 3:
+			Trace_Enable(Value);
+			break;
+
+		default:
+			Trace_Dump();
+			break;
+	}
+	return 0;
+}
+
+static int _F16_Handler (void)
+{
+	uint16_t Period		= argAsInt(1);
+	uint8_t Channels	= RECORDER_ALL_CHANNELS;
+
+	if(argAsInt(2) > 0)
+	{
+		Channels = argAsInt(2);
+	}
+
+	if(Recorder_Start(Period, Channels) != 0)
+	{
+		Format_Puts_P(Console_PutChar, "Invalid period or channels\n");
+		return 0;
+	}
+	Recorder_PrintStatus();
+	return 0;
+}
+
+static int _F17_Handler (void)
+{
+	//Store the last records now instead of waiting for the main loop and a full page
+	Recorder_Stop();
+	Recorder_Run();
+	if(LogStore_Flush() != 0)
+	{
+		Format_Puts_P(Console_PutChar, "Dataflash busy, log stopped\n");
+	}
+	Recorder_PrintStatus();
+	return 0;
+}
+
+static int _F18_Handler (void)
+{
+	Recorder_PrintStatus();
+	return 0;
+}
+
+//Read a time argument. Values of 0 or less are seconds before Now.
+static uint32_t argAsTime(uint8_t ArgNumber, uint32_t Now)
+{
+	char Arg[LINEEDIT_LINE_SIZE];		//An argument is never longer than the line
+	int32_t Value;
+	uint32_t Ago;
+
+	argAsChar(ArgNumber, Arg);
+	Value = strtol(Arg, NULL, 10);
+	if(Value > 0)
+	{
+		return Value;
+	}
+
+	//Negated in unsigned arithmetic, so the most negative value works too
+	Ago = (uint32_t)0 - (uint32_t)Value;
+	return (Ago > Now) ? 0 : (Now - Ago);
+}
+
+static int _F19_Handler (void)
+{
+	TimeAndDate Now;
+	uint32_t Seconds;
+
+	GetTime(&Now);
+	Seconds = TimeToSeconds(&Now);
+	LogStore_PrintRecords(argAsTime(1, Seconds), argAsTime(2, Seconds));
+	return 0;
+}
+
+static int _F20_Handler (void)
+{
+	uint16_t First	= argAsInt(1);
+	uint16_t Count	= argAsInt(2);
+	uint8_t Retry	= argAsInt(3);
+
+	if(Count == 0)
+	{
+		Count = DATAFLASH_PAGES;
+	}
+
+	//Pages that are still being filled are only in the SRAM buffer. A retry does not
+	//store them again, that would program a part filled page each time.
+	//logdump.py skips anything before a frame, so a note that the flush failed does not get in the way
+	if((Retry == 0) && (LogStore_Flush() != 0))
+	{
+		Format_Puts_P(Console_PutChar, "Dataflash busy, log stopped\n");
+	}
+	LogDump_Pages(First, Count);
+	return 0;
+}
+
+static int _F21_Handler (void)
+{
+	char Arg[LINEEDIT_LINE_SIZE];		//An argument is never longer than the line
+
+	//With no arguments the filters are only shown, otherwise all three are needed
+	argAsChar(1, Arg);
+	if(Arg[0] != 0)
+	{
+		argAsChar(3, Arg);
+		if(Arg[0] == 0)
 		{
-			printf_P(PSTR("CRC Error\n"));
+			Format_Puts_p(Console_PutChar, _F21_HELPTEXT);
+			Console_PutChar('\n');
+			return 0;
 		}
-		else
+		if(Filter_Configure(argAsInt(1), argAsInt(2), argAsInt(3)) != 0)
 		{
-			printf_P(PSTR("I2C error\n"));
+			Format_Puts_P(Console_PutChar, "Invalid channel or filter\n");
+			return 0;
 		}
-	}*/
-	
+		Settings_Save();
+	}
+
+	Filter_Print();
 	return 0;
 }
 
-//Scan the TWI bus for devices
-static int _F12_Handler (void)
+static int _F22_Handler (void)
 {
-	//I2CSoft_Scan();
-	return  0;
+	if(argAsInt(1) == 1)
+	{
+		Rolling_Init();
+	}
+
+	Rolling_Print();
+	return 0;
 }
 
 /** @} */
@@ -27,7 +27,7 @@
 
 //Command setup
 #define COMMAND_PROMPT	">"							//Define the character(s) to use for the command prompt
-#define COMMAND_USE_ARROWS							//If this is defined, arrow keys will be identified by the command interpreter
+#undef COMMAND_USE_ARROWS							//Arrow keys are handled by Board/LineEdit.c before the command interpreter sees them
 #undef COMMAND_EX_COMMAND_IN_INPUT					//If this is defined, the command will be executed in the CommandGetInput function. If not, the RunCommand function must be called to run the command. Further characters recieved on CommandGetInput will be ignored untill RunCommand is complete.
 
 #define MAX_COMMAND_DESCRIPTION_LENGTH		32		//The maximum length of the description and help strings
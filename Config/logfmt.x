@@ -0,0 +1,16 @@
+/*
+ *  Linker script fragment for the log format strings, see Board/Log.h.
+ *
+ *  The strings are linked at address 0 and marked INFO, so they are kept in
+ *  the ELF file for tools/logdecode.py but are not loaded into flash. The
+ *  address of each string is its ID. The default linker script is still used.
+ */
+
+SECTIONS
+{
+	logfmt 0 (INFO) :
+	{
+		KEEP(*(logfmt))
+	}
+}
+INSERT AFTER .comment;
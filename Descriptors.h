@@ -54,8 +54,11 @@
 		/** Size in bytes of the CDC device-to-host notification IN endpoint. */
 		#define CDC_NOTIFICATION_EPSIZE        8
 
-		/** Size in bytes of the CDC data IN and OUT endpoints. */
-		#define CDC_TXRX_EPSIZE                16
+		/** Size in bytes of the CDC data IN and OUT endpoints, the largest the ATmega32U2 allows.
+		 *  With the control and notification endpoints this uses 144 of the 176 bytes of endpoint
+		 *  RAM, so the data endpoints stay single bank.
+		 */
+		#define CDC_TXRX_EPSIZE                64
 
 	/* Type Defines: */
 		/** Type define for the device configuration descriptor structure. This must be defined in the
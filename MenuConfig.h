@@ -27,6 +27,10 @@
 	 *
 	 *  \param[in] Addr  Address of the pointer to read
 	 */
-	#define MENU_ITEM_READ_POINTER(Addr)   (void*)pgm_read_word(Addr)
+	#if defined(pgm_read_ptr)
+		#define MENU_ITEM_READ_POINTER(Addr)   pgm_read_ptr(Addr)
+	#else
+		#define MENU_ITEM_READ_POINTER(Addr)   (void*)pgm_read_word(Addr)
+	#endif
 
 #endif
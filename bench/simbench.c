@@ -0,0 +1,504 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Cycle count benchmark of the firmware image under simavr.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	bench
+*
+*	Runs main.elf one instruction at a time and counts the cycles spent in the
+*	functions listed in the budgets file. The cycles for a call are counted from
+*	the first instruction of the function until the stack pointer shows it has
+*	returned. Interrupts that run during a call are not counted against it.
+*
+*	simavr has no ATmega32U2 core. The AT90USB162 has the same IO registers and
+*	interrupt vectors, so its core is used with the memory sizes changed.
+*
+*	Stand-ins for the hardware that simavr does not have:
+*	- Buttons: the scenario file drives the button pins.
+*	- LCD: nothing is connected, so the busy flag always reads clear and LCD
+*	  calls are counted without the time spent waiting on the display (see the
+*	  host LCD model for that).
+*	- USB: the LUFA CDC functions are replaced at their entry points. Receive
+*	  returns the characters typed in the scenario, send copies to stdout, and
+*	  the USB tasks return straight away.
+*
+*	Usage: simbench <firmware.elf> <symbols> <scenario> <budgets>
+*	The symbols file is the output of avr-nm for the image. The exit code is 1
+*	if any function goes over its budget.
+*
+*	@{
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <sim_avr.h>
+#include <sim_elf.h>
+#include <sim_irq.h>
+#include <avr_ioport.h>
+
+#define BENCH_F_CPU				8000000UL
+#define BENCH_CYCLES_PER_MS		(BENCH_F_CPU / 1000)
+#define BENCH_MAX_FUNCTIONS		32
+#define BENCH_MAX_DEPTH			32
+#define BENCH_MAX_EVENTS		128
+#define BENCH_NAME_LENGTH		40
+
+//ATmega32U2 memory sizes
+#define BENCH_FLASHEND			0x7FFF
+#define BENCH_RAMEND			0x04FF
+#define BENCH_E2END				0x03FF
+
+typedef struct
+{
+	char Name[BENCH_NAME_LENGTH];		//Name in the report
+	char Symbol[BENCH_NAME_LENGTH];		//Symbol in the image, __vector_N for interrupts
+	uint32_t Address;					//Byte address
+	uint8_t IsInterrupt;
+	uint32_t Budget;					//Maximum cycles for one call
+	uint32_t Calls;
+	uint64_t Total;
+	uint32_t Min;
+	uint32_t Max;
+} BenchFunction;
+
+typedef struct
+{
+	BenchFunction *Function;
+	uint16_t SP;						//Stack pointer just after the call
+	uint64_t Start;
+	uint64_t InterruptsAtStart;
+} BenchFrame;
+
+typedef struct
+{
+	uint32_t TimeMS;
+	char Action;						//'p' press, 'r' release, 't' type
+	char Argument[64];
+} BenchEvent;
+
+//Interrupt vector numbers on the ATmega32U2
+static const struct
+{
+	const char *Name;
+	uint8_t Vector;
+} BenchVectors[] =
+{
+	{"INT0_vect", 1},			{"INT1_vect", 2},			{"INT4_vect", 5},
+	{"INT5_vect", 6},			{"PCINT1_vect", 10},		{"TIMER1_COMPA_vect", 15},
+	{"TIMER1_OVF_vect", 18},	{"TIMER0_COMPA_vect", 19},	{"TIMER0_COMPB_vect", 20},
+	{"SPI_STC_vect", 22},
+};
+
+//Button pins: port, bit
+static const struct
+{
+	char Button;
+	char Port;
+	uint8_t Pin;
+} BenchButtons[] =
+{
+	{'L', 'D', 0},		//INT0
+	{'U', 'D', 1},		//INT1
+	{'C', 'D', 4},		//INT5
+	{'D', 'C', 2},		//PCINT11
+	{'R', 'D', 5},		//PCINT12
+};
+
+static avr_t *Avr;
+
+static BenchFunction Functions[BENCH_MAX_FUNCTIONS];
+static uint8_t FunctionCount;
+static BenchFrame Frames[BENCH_MAX_DEPTH];
+static uint8_t Depth;
+static uint64_t InterruptCycles;		//Cycles spent in finished interrupt handlers
+
+static BenchEvent Events[BENCH_MAX_EVENTS];
+static uint8_t EventCount;
+static uint32_t EndMS;
+
+static char TypeBuffer[256];
+static uint16_t TypeHead;
+static uint16_t TypeTail;
+
+//Stubbed LUFA functions
+static uint32_t StubReceive;
+static uint32_t StubSend;
+static uint32_t StubCDCTask;
+static uint32_t StubUSBTask;
+
+static uint16_t Bench_SP(void)
+{
+	return Avr->data[R_SPL] | (Avr->data[R_SPH] << 8);
+}
+
+//Return from the current function, the way 'ret' does
+static void Bench_Return(void)
+{
+	uint16_t SP = Bench_SP();
+	uint16_t ReturnAddress;
+
+	ReturnAddress = (Avr->data[SP + 1] << 8) | Avr->data[SP + 2];
+	SP += 2;
+	Avr->data[R_SPL] = SP & 0xFF;
+	Avr->data[R_SPH] = SP >> 8;
+	Avr->pc = ReturnAddress << 1;
+	Avr->cycle += 4;
+	return;
+}
+
+//Returns 1 if the stub ran in place of the instruction at PC
+static int Bench_Stub(void)
+{
+	int16_t c;
+
+	if(Avr->pc == StubReceive)
+	{
+		c = (TypeHead != TypeTail) ? TypeBuffer[TypeTail++] : -1;
+		Avr->data[24] = c & 0xFF;
+		Avr->data[25] = (c >> 8) & 0xFF;
+		Bench_Return();
+		return 1;
+	}
+	if(Avr->pc == StubSend)
+	{
+		//CDC_Device_SendByte(Interface, Data), Data is in r22
+		putchar(Avr->data[22]);
+		Avr->data[24] = 0;
+		Bench_Return();
+		return 1;
+	}
+	if((Avr->pc == StubCDCTask) || (Avr->pc == StubUSBTask))
+	{
+		Bench_Return();
+		return 1;
+	}
+	return 0;
+}
+
+static void Bench_Enter(BenchFunction *Function)
+{
+	if(Depth >= BENCH_MAX_DEPTH)
+	{
+		return;
+	}
+	Frames[Depth].Function = Function;
+	Frames[Depth].SP = Bench_SP();
+	Frames[Depth].Start = Avr->cycle;
+	Frames[Depth].InterruptsAtStart = InterruptCycles;
+	Depth++;
+	return;
+}
+
+static void Bench_CheckReturns(void)
+{
+	BenchFrame *Frame;
+	uint64_t Cycles;
+
+	while((Depth > 0) && (Bench_SP() > Frames[Depth - 1].SP))
+	{
+		Depth--;
+		Frame = &Frames[Depth];
+		Cycles = Avr->cycle - Frame->Start;
+		if(Frame->Function->IsInterrupt)
+		{
+			InterruptCycles += Cycles;
+		}
+		else
+		{
+			Cycles -= InterruptCycles - Frame->InterruptsAtStart;
+		}
+
+		Frame->Function->Calls++;
+		Frame->Function->Total += Cycles;
+		if((Frame->Function->Calls == 1) || (Cycles < Frame->Function->Min))
+		{
+			Frame->Function->Min = Cycles;
+		}
+		if(Cycles > Frame->Function->Max)
+		{
+			Frame->Function->Max = Cycles;
+		}
+	}
+	return;
+}
+
+static void Bench_SetButton(char Button, uint8_t Level)
+{
+	uint8_t i;
+
+	for(i = 0; i < (sizeof(BenchButtons) / sizeof(BenchButtons[0])); i++)
+	{
+		if(BenchButtons[i].Button == Button)
+		{
+			avr_raise_irq(avr_io_getirq(Avr, AVR_IOCTL_IOPORT_GETIRQ(BenchButtons[i].Port), BenchButtons[i].Pin), Level);
+		}
+	}
+	return;
+}
+
+static void Bench_RunEvent(const BenchEvent *Event)
+{
+	const char *s;
+
+	switch(Event->Action)
+	{
+		case 'p':
+			Bench_SetButton(Event->Argument[0], 0);
+			break;
+
+		case 'r':
+			Bench_SetButton(Event->Argument[0], 1);
+			break;
+
+		case 't':
+			//'\r' ends each line, like a terminal
+			for(s = Event->Argument; (*s != 0) && (TypeHead < sizeof(TypeBuffer) - 1); s++)
+			{
+				TypeBuffer[TypeHead++] = *s;
+			}
+			TypeBuffer[TypeHead++] = '\r';
+			break;
+	}
+	return;
+}
+
+/****************************************************************
+*	Input files
+****************************************************************/
+
+//Symbol file lines are "<address> <type> <name>", from avr-nm
+static uint32_t Bench_FindSymbol(FILE *Symbols, const char *Name)
+{
+	char Line[128];
+	char Symbol[BENCH_NAME_LENGTH];
+	unsigned long Address;
+	char Type;
+
+	rewind(Symbols);
+	while(fgets(Line, sizeof(Line), Symbols) != NULL)
+	{
+		if((sscanf(Line, "%lx %c %39s", &Address, &Type, Symbol) == 3) && (strcmp(Symbol, Name) == 0))
+		{
+			return (uint32_t)Address;
+		}
+	}
+	return 0;
+}
+
+static int Bench_LoadBudgets(const char *FileName, FILE *Symbols)
+{
+	FILE *File;
+	char Line[128];
+	char Name[BENCH_NAME_LENGTH];
+	unsigned long Budget;
+	BenchFunction *Function;
+	uint8_t i;
+
+	File = fopen(FileName, "r");
+	if(File == NULL)
+	{
+		perror(FileName);
+		return 1;
+	}
+
+	while((fgets(Line, sizeof(Line), File) != NULL) && (FunctionCount < BENCH_MAX_FUNCTIONS))
+	{
+		if((Line[0] == '#') || (sscanf(Line, "%39s %lu", Name, &Budget) != 2))
+		{
+			continue;
+		}
+
+		Function = &Functions[FunctionCount];
+		strcpy(Function->Name, Name);
+		strcpy(Function->Symbol, Name);
+		for(i = 0; i < (sizeof(BenchVectors) / sizeof(BenchVectors[0])); i++)
+		{
+			if(strcmp(BenchVectors[i].Name, Name) == 0)
+			{
+				snprintf(Function->Symbol, sizeof(Function->Symbol), "__vector_%u", BenchVectors[i].Vector);
+				Function->IsInterrupt = 1;
+			}
+		}
+
+		Function->Address = Bench_FindSymbol(Symbols, Function->Symbol);
+		if(Function->Address == 0)
+		{
+			fprintf(stderr, "%s: %s not found in the image, skipped\n", FileName, Function->Symbol);
+			continue;
+		}
+		Function->Budget = Budget;
+		FunctionCount++;
+	}
+	fclose(File);
+	return 0;
+}
+
+//Scenario lines are "<time ms> press|release <button>", "<time ms> type <text>" or "<time ms> end"
+static int Bench_LoadScenario(const char *FileName)
+{
+	FILE *File;
+	char Line[128];
+	char Action[16];
+	unsigned long Time;
+	int Used;
+	BenchEvent *Event;
+
+	File = fopen(FileName, "r");
+	if(File == NULL)
+	{
+		perror(FileName);
+		return 1;
+	}
+
+	while((fgets(Line, sizeof(Line), File) != NULL) && (EventCount < BENCH_MAX_EVENTS))
+	{
+		Line[strcspn(Line, "\r\n")] = 0;
+		if((Line[0] == '#') || (sscanf(Line, "%lu %15s %n", &Time, Action, &Used) < 2))
+		{
+			continue;
+		}
+
+		if(strcmp(Action, "end") == 0)
+		{
+			EndMS = Time;
+			continue;
+		}
+
+		Event = &Events[EventCount++];
+		Event->TimeMS = Time;
+		Event->Action = Action[0];
+		strncpy(Event->Argument, &Line[Used], sizeof(Event->Argument) - 1);
+	}
+	fclose(File);
+	return 0;
+}
+
+/****************************************************************
+*	Main
+****************************************************************/
+
+int main(int argc, char *argv[])
+{
+	elf_firmware_t Firmware;
+	FILE *Symbols;
+	uint8_t NextEvent = 0;
+	uint8_t i;
+	uint8_t j;
+	int State;
+	int Failed = 0;
+
+	if(argc != 5)
+	{
+		fprintf(stderr, "Usage: %s <firmware.elf> <symbols> <scenario> <budgets>\n", argv[0]);
+		return 2;
+	}
+
+	Symbols = fopen(argv[2], "r");
+	if(Symbols == NULL)
+	{
+		perror(argv[2]);
+		return 2;
+	}
+	if(Bench_LoadBudgets(argv[4], Symbols) || Bench_LoadScenario(argv[3]))
+	{
+		return 2;
+	}
+	StubReceive = Bench_FindSymbol(Symbols, "CDC_Device_ReceiveByte");
+	StubSend = Bench_FindSymbol(Symbols, "CDC_Device_SendByte");
+	StubCDCTask = Bench_FindSymbol(Symbols, "CDC_Device_USBTask");
+	StubUSBTask = Bench_FindSymbol(Symbols, "USB_USBTask");
+	fclose(Symbols);
+
+	memset(&Firmware, 0, sizeof(Firmware));
+	if(elf_read_firmware(argv[1], &Firmware) != 0)
+	{
+		fprintf(stderr, "%s: could not read the image\n", argv[1]);
+		return 2;
+	}
+
+	Avr = avr_make_mcu_by_name("at90usb162");
+	if(Avr == NULL)
+	{
+		fprintf(stderr, "simavr has no at90usb162 core\n");
+		return 2;
+	}
+	Avr->flashend = BENCH_FLASHEND;
+	Avr->ramend = BENCH_RAMEND;
+	Avr->e2end = BENCH_E2END;
+	avr_init(Avr);
+	Avr->frequency = BENCH_F_CPU;
+	avr_load_firmware(Avr, &Firmware);
+
+	//Buttons are pulled up
+	for(i = 0; i < (sizeof(BenchButtons) / sizeof(BenchButtons[0])); i++)
+	{
+		Bench_SetButton(BenchButtons[i].Button, 1);
+	}
+
+	while(Avr->cycle < ((uint64_t)EndMS * BENCH_CYCLES_PER_MS))
+	{
+		while((NextEvent < EventCount) && (Avr->cycle >= ((uint64_t)Events[NextEvent].TimeMS * BENCH_CYCLES_PER_MS)))
+		{
+			Bench_RunEvent(&Events[NextEvent++]);
+		}
+
+		if(Bench_Stub())
+		{
+			Bench_CheckReturns();
+			continue;
+		}
+
+		for(j = 0; j < FunctionCount; j++)
+		{
+			if(Avr->pc == Functions[j].Address)
+			{
+				Bench_Enter(&Functions[j]);
+				break;
+			}
+		}
+
+		State = avr_run(Avr);
+		if((State == cpu_Done) || (State == cpu_Crashed))
+		{
+			fprintf(stderr, "Simulation stopped at %llu cycles\n", (unsigned long long)Avr->cycle);
+			return 2;
+		}
+		Bench_CheckReturns();
+	}
+
+	printf("\n%-20s %8s %8s %8s %8s %8s\n", "function", "calls", "min", "mean", "max", "budget");
+	for(j = 0; j < FunctionCount; j++)
+	{
+		BenchFunction *Function = &Functions[j];
+
+		printf("%-20s %8lu %8lu %8lu %8lu %8lu", Function->Name, (unsigned long)Function->Calls, (unsigned long)Function->Min,
+			(unsigned long)(Function->Calls ? (Function->Total / Function->Calls) : 0), (unsigned long)Function->Max, (unsigned long)Function->Budget);
+		if(Function->Max > Function->Budget)
+		{
+			printf("  OVER BUDGET");
+			Failed = 1;
+		}
+		printf("\n");
+	}
+	return Failed;
+}
+
+/** @} */
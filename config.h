@@ -51,7 +51,7 @@
 #define I2C_SOFT_USE_INTERNAL_PULLUPS		1		//Set to 1 to use internal pullups on the pins
 #define I2C_SOFT_USE_ARBITRATION			1		//Set to 1 to enable arbitration
 #define I2C_SOFT_USE_CLOCK_STRETCH			1		//Set to 1 to enable clock stretching detection
-#define I2C_SOFT_CLOCK_STRETCH_TIMEOUT		1000	//The timeout for the clock stretching, this is a 16-bit number
+#define I2C_SOFT_CLOCK_STRETCH_TIMEOUT		1000	//The timeout for the clock stretching in half bit ticks, this is a 16-bit number
 
 #define I2C_SDA_PORT			PORTC
 #define I2C_SDA_DDR				DDRC
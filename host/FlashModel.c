@@ -0,0 +1,261 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Model of the AT45DB041D dataflash for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "FlashModel.h"
+
+//Commands
+#define FLASHMODEL_CMD_READ				0x03
+#define FLASHMODEL_CMD_BUFFER1_WRITE	0x84
+#define FLASHMODEL_CMD_BUFFER2_WRITE	0x87
+#define FLASHMODEL_CMD_BUFFER1_READ		0xD1
+#define FLASHMODEL_CMD_BUFFER2_READ		0xD3
+#define FLASHMODEL_CMD_BUFFER1_PROGRAM	0x88
+#define FLASHMODEL_CMD_BUFFER2_PROGRAM	0x89
+#define FLASHMODEL_CMD_BLOCK_ERASE		0x50
+#define FLASHMODEL_CMD_STATUS			0xD7
+#define FLASHMODEL_CMD_ID				0x9F
+
+#define FLASHMODEL_STATUS_READY			0x80
+#define FLASHMODEL_STATUS_DENSITY		0x1C	//0111 in bits 5-2 for 4Mbit
+
+//What the chip is busy with
+#define FLASHMODEL_BUSY_NONE			0xFF
+#define FLASHMODEL_BUSY_ERASE			2		//0 and 1 are programs from that buffer
+
+static const uint8_t FlashModelID[] = {0x1F, 0x24, 0x00, 0x01, 0x00};
+
+static uint8_t FlashModelMemory[FLASHMODEL_PAGES][FLASHMODEL_PAGE_SIZE];
+static uint8_t FlashModelBuffer[2][FLASHMODEL_PAGE_SIZE];
+static uint8_t FlashModelPresent = 1;
+static uint8_t FlashModelStarted;
+static FlashModelStats FlashModelCounters;
+
+static uint64_t FlashModelClock;
+static uint64_t FlashModelBusyUntil;
+static uint8_t FlashModelBusy;
+
+//Command being received
+static uint16_t FlashModelPosition;
+static uint8_t FlashModelOpcode;
+static uint32_t FlashModelAddress;
+static uint8_t FlashModelIgnore;
+
+void FlashModel_Reset(uint8_t Value)
+{
+	FlashModelStarted = 1;
+	memset(FlashModelMemory, Value, sizeof(FlashModelMemory));
+	memset(FlashModelBuffer, 0, sizeof(FlashModelBuffer));
+	FlashModelPresent = 1;
+	FlashModelBusyUntil = FlashModelClock;
+	FlashModelBusy = FLASHMODEL_BUSY_NONE;
+	FlashModel_ClearStats();
+	return;
+}
+
+void FlashModel_ClearStats(void)
+{
+	memset(&FlashModelCounters, 0, sizeof(FlashModelCounters));
+	return;
+}
+
+const FlashModelStats *FlashModel_Stats(void)
+{
+	return &FlashModelCounters;
+}
+
+void FlashModel_SetPresent(uint8_t Present)
+{
+	FlashModelPresent = Present;
+	return;
+}
+
+//A new chip comes erased
+static void FlashModel_Start(void)
+{
+	if(!FlashModelStarted)
+	{
+		FlashModel_Reset(0xFF);
+	}
+	return;
+}
+
+uint8_t *FlashModel_Page(uint16_t Page)
+{
+	FlashModel_Start();
+	return FlashModelMemory[Page % FLASHMODEL_PAGES];
+}
+
+static uint8_t FlashModel_IsBusy(void)
+{
+	if(FlashModelClock >= FlashModelBusyUntil)
+	{
+		FlashModelBusy = FLASHMODEL_BUSY_NONE;
+	}
+	return FlashModelBusy != FLASHMODEL_BUSY_NONE;
+}
+
+//Returns 1 if the chip takes the command in its current state
+static uint8_t FlashModel_Accepts(uint8_t Opcode)
+{
+	if(!FlashModel_IsBusy() || (Opcode == FLASHMODEL_CMD_STATUS))
+	{
+		return 1;
+	}
+	if((Opcode == FLASHMODEL_CMD_BUFFER1_WRITE) || (Opcode == FLASHMODEL_CMD_BUFFER1_READ))
+	{
+		return FlashModelBusy != 0;
+	}
+	if((Opcode == FLASHMODEL_CMD_BUFFER2_WRITE) || (Opcode == FLASHMODEL_CMD_BUFFER2_READ))
+	{
+		return FlashModelBusy != 1;
+	}
+	return 0;
+}
+
+void FlashModel_Select(void)
+{
+	FlashModel_Start();
+	FlashModelPosition = 0;
+	FlashModelAddress = 0;
+	FlashModelIgnore = 0;
+	return;
+}
+
+uint8_t FlashModel_Transfer(uint8_t Data)
+{
+	uint16_t Position = FlashModelPosition++;
+	uint32_t Linear;
+	uint16_t Offset;
+
+	FlashModelClock += FLASHMODEL_BYTE_NS;
+	FlashModelCounters.TimeNS += FLASHMODEL_BYTE_NS;
+	FlashModelCounters.Bytes++;
+
+	//MISO reads low without the chip
+	if(!FlashModelPresent)
+	{
+		return 0x00;
+	}
+
+	if(Position == 0)
+	{
+		FlashModelOpcode = Data;
+		if(!FlashModel_Accepts(Data))
+		{
+			FlashModelCounters.BusyErrors++;
+			FlashModelIgnore = 1;
+		}
+		return 0xFF;
+	}
+	if(FlashModelIgnore)
+	{
+		return 0xFF;
+	}
+
+	switch(FlashModelOpcode)
+	{
+		case FLASHMODEL_CMD_STATUS:
+			return (FlashModel_IsBusy() ? 0 : FLASHMODEL_STATUS_READY) | FLASHMODEL_STATUS_DENSITY;
+
+		case FLASHMODEL_CMD_ID:
+			return (Position <= sizeof(FlashModelID)) ? FlashModelID[Position - 1] : 0x00;
+	}
+
+	//Three address bytes
+	if(Position <= 3)
+	{
+		FlashModelAddress = (FlashModelAddress << 8) | Data;
+		return 0xFF;
+	}
+
+	Offset = FlashModelAddress & 0x1FF;
+	switch(FlashModelOpcode)
+	{
+		case FLASHMODEL_CMD_BUFFER1_WRITE:
+		case FLASHMODEL_CMD_BUFFER2_WRITE:
+			FlashModelBuffer[FlashModelOpcode == FLASHMODEL_CMD_BUFFER2_WRITE][(Offset + Position - 4) % FLASHMODEL_PAGE_SIZE] = Data;
+			break;
+
+		case FLASHMODEL_CMD_BUFFER1_READ:
+		case FLASHMODEL_CMD_BUFFER2_READ:
+			return FlashModelBuffer[FlashModelOpcode == FLASHMODEL_CMD_BUFFER2_READ][(Offset + Position - 4) % FLASHMODEL_PAGE_SIZE];
+
+		case FLASHMODEL_CMD_READ:
+			//Continues over the pages and wraps at the end of the memory
+			Linear = ((FlashModelAddress >> 9) & 0x7FF) * FLASHMODEL_PAGE_SIZE + Offset + Position - 4;
+			Linear %= (uint32_t)FLASHMODEL_PAGES * FLASHMODEL_PAGE_SIZE;
+			return FlashModelMemory[Linear / FLASHMODEL_PAGE_SIZE][Linear % FLASHMODEL_PAGE_SIZE];
+	}
+	return 0xFF;
+}
+
+void FlashModel_Deselect(void)
+{
+	uint8_t *Page;
+	uint8_t *Buffer;
+	uint16_t Block;
+	uint16_t i;
+	uint8_t NotErased = 0;
+
+	if(FlashModelIgnore || (FlashModelPosition < 4))
+	{
+		return;
+	}
+
+	//Program and erase start when the chip select goes high
+	switch(FlashModelOpcode)
+	{
+		case FLASHMODEL_CMD_BUFFER1_PROGRAM:
+		case FLASHMODEL_CMD_BUFFER2_PROGRAM:
+			Page = FlashModelMemory[(FlashModelAddress >> 9) & 0x7FF];
+			Buffer = FlashModelBuffer[FlashModelOpcode == FLASHMODEL_CMD_BUFFER2_PROGRAM];
+			for(i = 0; i < FLASHMODEL_PAGE_SIZE; i++)
+			{
+				if(~Page[i] & Buffer[i])
+				{
+					NotErased = 1;
+				}
+				Page[i] &= Buffer[i];
+			}
+			FlashModelCounters.Programs++;
+			FlashModelCounters.NotErased += NotErased;
+			FlashModelBusy = (FlashModelOpcode == FLASHMODEL_CMD_BUFFER2_PROGRAM);
+			FlashModelBusyUntil = FlashModelClock + FLASHMODEL_PROGRAM_NS;
+			break;
+
+		case FLASHMODEL_CMD_BLOCK_ERASE:
+			Block = (FlashModelAddress >> 12) & 0xFF;
+			memset(FlashModelMemory[Block * FLASHMODEL_BLOCK_PAGES], 0xFF, FLASHMODEL_BLOCK_PAGES * FLASHMODEL_PAGE_SIZE);
+			FlashModelCounters.Erases++;
+			FlashModelCounters.BlockErases[Block]++;
+			FlashModelBusy = FLASHMODEL_BUSY_ERASE;
+			FlashModelBusyUntil = FlashModelClock + FLASHMODEL_BLOCK_ERASE_NS;
+			break;
+	}
+	return;
+}
+
+/** @} */
@@ -0,0 +1,88 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Model of the AT45DB041D dataflash for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	The model runs the commands used by Board/Dataflash.c on a copy of the
+*	chip in RAM. Programming works like the real flash: bits can only be
+*	cleared, so a page that was not erased first ends up with the AND of the
+*	old and new data. Commands that the chip would not accept while busy are
+*	ignored and counted.
+*
+*	The model also keeps a clock. Each SPI byte is charged the time the AVR
+*	takes to send it, and program and erase commands keep the chip busy for
+*	their typical time from the data sheet. The firmware polls the status
+*	while it waits, so the wait shows up in the clock.
+*
+*	The memory is kept over a Device_PowerOn(), like the real chip.
+*
+*	@{
+*/
+
+#ifndef _FLASHMODEL_H_
+#define _FLASHMODEL_H_
+
+#include <stdint.h>
+
+#define FLASHMODEL_PAGE_SIZE		264
+#define FLASHMODEL_PAGES			2048
+#define FLASHMODEL_BLOCK_PAGES		8
+#define FLASHMODEL_BLOCKS			(FLASHMODEL_PAGES / FLASHMODEL_BLOCK_PAGES)
+
+//Times in ns. One byte at 4MHz plus the AVR's loop around SPDR.
+#define FLASHMODEL_BYTE_NS			2500UL
+#define FLASHMODEL_PROGRAM_NS		2000000UL	//tP, page program from a buffer
+#define FLASHMODEL_BLOCK_ERASE_NS	45000000UL	//tBE, block erase
+
+/** Counters kept by the model. */
+typedef struct
+{
+	uint64_t TimeNS;				//Time spent talking to the chip
+	uint32_t Bytes;					//SPI bytes
+	uint32_t Programs;				//Pages programmed
+	uint32_t Erases;				//Blocks erased
+	uint32_t NotErased;				//Pages programmed that had bits that needed to be set
+	uint32_t BusyErrors;			//Commands sent while the chip could not take them
+	uint16_t BlockErases[FLASHMODEL_BLOCKS];
+} FlashModelStats;
+
+/** Fill the memory with Value (0xFF for an erased chip) and clear the buffers and counters. */
+void FlashModel_Reset(uint8_t Value);
+
+/** Clear the counters without changing the memory. */
+void FlashModel_ClearStats(void);
+
+/** Get the counters. */
+const FlashModelStats *FlashModel_Stats(void);
+
+/** Make the chip answer with a different ID, or 0 to remove it. */
+void FlashModel_SetPresent(uint8_t Present);
+
+/** Direct access to the memory, without any bus time. */
+uint8_t *FlashModel_Page(uint16_t Page);
+
+/** SPI bus, called by the host SPI functions. */
+void FlashModel_Select(void);
+uint8_t FlashModel_Transfer(uint8_t Data);
+void FlashModel_Deselect(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,105 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Host hardware layer, registers and EEPROM.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include "HAL.h"
+
+#define HOST_DEFINE_REGISTER(Name)		volatile uint8_t Name;
+#define HOST_DEFINE_REGISTER16(Name)	volatile uint16_t Name;
+HOST_REGISTERS(HOST_DEFINE_REGISTER)
+HOST_REGISTERS16(HOST_DEFINE_REGISTER16)
+
+uint32_t HAL_EEPROMWrites;
+
+void HAL_Reset(void)
+{
+#define HOST_CLEAR_REGISTER(Name)		Name = 0;
+	HOST_REGISTERS(HOST_CLEAR_REGISTER)
+	HOST_REGISTERS16(HOST_CLEAR_REGISTER)
+
+	HAL_EEPROMWrites = 0;
+	Stubs_Reset();
+	return;
+}
+
+/****************************************************************
+*	EEPROM, EEMEM variables are normal variables on the host
+****************************************************************/
+
+void eeprom_read_block(void *Destination, const void *Source, size_t Length)
+{
+	memcpy(Destination, Source, Length);
+	return;
+}
+
+void eeprom_write_block(const void *Source, void *Destination, size_t Length)
+{
+	memcpy(Destination, Source, Length);
+	HAL_EEPROMWrites += Length;
+	return;
+}
+
+void eeprom_update_block(const void *Source, void *Destination, size_t Length)
+{
+	const uint8_t *From = Source;
+	uint8_t *To = Destination;
+
+	while(Length-- > 0)
+	{
+		if(*To != *From)
+		{
+			*To = *From;
+			HAL_EEPROMWrites++;
+		}
+		To++;
+		From++;
+	}
+	return;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *Address)
+{
+	return *Address;
+}
+
+void eeprom_write_byte(uint8_t *Address, uint8_t Value)
+{
+	*Address = Value;
+	HAL_EEPROMWrites++;
+	return;
+}
+
+void eeprom_update_byte(uint8_t *Address, uint8_t Value)
+{
+	if(*Address != Value)
+	{
+		eeprom_write_byte(Address, Value);
+	}
+	return;
+}
+
+/** @} */
@@ -0,0 +1,80 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Host hardware layer header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	The firmware talks to the hardware through the avr-libc register names.
+*	For host builds, host/include replaces the avr-libc headers so the
+*	registers are variables (HAL.c), interrupt handlers are functions that
+*	tests call, and the LUFA and common module functions are replaced by
+*	Stubs.c. This file has the test side of that: resetting the hardware,
+*	feeding the USB console and reading what the firmware sent back.
+*
+*	@{
+*/
+
+#ifndef _HAL_H_
+#define _HAL_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+//Interrupt handlers in the firmware
+void TIMER0_COMPA_vect(void);
+void TIMER0_COMPB_vect(void);
+void TIMER1_COMPA_vect(void);
+void INT0_vect(void);
+void INT1_vect(void);
+void INT4_vect(void);
+void INT5_vect(void);
+void PCINT1_vect(void);
+void SPI_STC_vect(void);
+
+//Bytes written to the EEPROM since the last reset, eeprom_update_* only counts bytes that changed
+extern uint32_t HAL_EEPROMWrites;
+
+/** Set all registers to 0 and clear the console and counters. EEPROM contents are kept, like a power cycle. */
+void HAL_Reset(void);
+
+/** Queue characters to be received on the USB console. */
+void HAL_ConsoleInput(const char *Text);
+
+/** Everything sent to the USB console since the last HAL_ConsoleClear(). */
+const char *HAL_ConsoleOutput(void);
+
+/** The last line given to the command interpreter by CommandGetInputChar(). */
+const char *HAL_CommandLine(void);
+
+/** Number of bytes in HAL_ConsoleOutput(), which can hold 0 bytes from binary output. */
+uint16_t HAL_ConsoleOutputLength(void);
+void HAL_ConsoleClear(void);
+
+/** Run a command through the command table the way the interpreter would. Returns the handler's return value, or -1 if the command is not found or has the wrong number of arguments. */
+int HAL_RunCommandLine(const char *Line);
+
+/** Number of times Jump_To_Bootloader() has been called. */
+extern uint8_t HAL_BootloaderJumps;
+
+/** Clear the state kept by Stubs.c, called by HAL_Reset(). */
+void Stubs_Reset(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,688 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Host model of the HD44780 LCD controller.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "lcd.h"
+#include "LCDModel.h"
+
+//Glass
+static uint8_t ModelController;
+static uint8_t ModelColumns;
+static uint8_t ModelLines;
+
+//Controller state
+static uint8_t DDRAM[LCDMODEL_DDRAM_SIZE];
+static uint8_t CGRAM[LCDMODEL_CGRAM_SIZE];
+static uint8_t AddressCounter;
+static uint8_t AddressIsCGRAM;		//1 after a set CGRAM address instruction, 0 after a set DDRAM address
+static uint8_t EntryMode;
+static uint8_t DisplayControl;
+static uint8_t TwoLines;			//N bit of the function set
+static uint8_t ExtendedRegister;	//KS0073 RE bit
+static uint8_t FourLines;			//KS0073 NW bit
+static uint8_t DisplayShift;
+
+//Timing
+static uint64_t Now;				//Time the firmware has spent in the library
+static uint64_t BusyUntil;			//Time the last instruction finishes
+static LCDModelStats Stats;
+static LCDModelBusHook BusHook;
+
+//Let the hook see the port pins change
+static void Model_Bus(uint8_t Value, uint8_t RS, uint8_t Read)
+{
+	if(BusHook != NULL)
+	{
+		BusHook(Value, RS, Read);
+	}
+	return;
+}
+
+static void Model_Advance(uint64_t Time)
+{
+	Now += Time;
+	Stats.BusTimeNS += Time;
+	return;
+}
+
+//Length of a DDRAM line, which is how far the display shift wraps
+static uint8_t Model_LineLength(void)
+{
+	if(FourLines)
+	{
+		return 20;
+	}
+	if(TwoLines)
+	{
+		return 40;
+	}
+	return 80;
+}
+
+static void Model_StepAddress(void)
+{
+	uint8_t Increment = ((EntryMode & (1<<LCD_ENTRY_INC)) != 0);
+
+	if(AddressIsCGRAM)
+	{
+		AddressCounter = (AddressCounter + (Increment ? 1 : -1)) & (LCDMODEL_CGRAM_SIZE - 1);
+	}
+	else if(FourLines)
+	{
+		//Lines are 0x00-0x13, 0x20-0x33, 0x40-0x53 and 0x60-0x73
+		if(Increment)
+		{
+			AddressCounter++;
+			if((AddressCounter & 0x1F) == 20)
+			{
+				AddressCounter += 0x0C;
+			}
+		}
+		else if((AddressCounter & 0x1F) == 0)
+		{
+			AddressCounter -= 0x0D;
+		}
+		else
+		{
+			AddressCounter--;
+		}
+		AddressCounter &= 0x7F;
+	}
+	else if(TwoLines)
+	{
+		//Lines are 0x00-0x27 and 0x40-0x67
+		if(Increment)
+		{
+			if(AddressCounter == 0x27)
+			{
+				AddressCounter = 0x40;
+			}
+			else if(AddressCounter >= 0x67)
+			{
+				AddressCounter = 0x00;
+			}
+			else
+			{
+				AddressCounter++;
+			}
+		}
+		else
+		{
+			if(AddressCounter == 0x40)
+			{
+				AddressCounter = 0x27;
+			}
+			else if(AddressCounter == 0x00)
+			{
+				AddressCounter = 0x67;
+			}
+			else
+			{
+				AddressCounter--;
+			}
+		}
+	}
+	else
+	{
+		//One line, 0x00-0x4F
+		if(Increment)
+		{
+			AddressCounter = (AddressCounter >= 0x4F) ? 0x00 : (AddressCounter + 1);
+		}
+		else
+		{
+			AddressCounter = (AddressCounter == 0x00) ? 0x4F : (AddressCounter - 1);
+		}
+	}
+	return;
+}
+
+static void Model_ShiftDisplay(uint8_t Left)
+{
+	uint8_t Length = Model_LineLength();
+
+	if(Left)
+	{
+		DisplayShift = (DisplayShift + 1) % Length;
+	}
+	else
+	{
+		DisplayShift = (DisplayShift + Length - 1) % Length;
+	}
+	return;
+}
+
+//Carry out an instruction, returns its execution time
+static uint32_t Model_Instruction(uint8_t Cmd)
+{
+	Stats.Instructions++;
+
+	if(Cmd & (1<<LCD_DDRAM))
+	{
+		AddressCounter = Cmd & 0x7F;
+		AddressIsCGRAM = 0;
+	}
+	else if(Cmd & (1<<LCD_CGRAM))
+	{
+		//With RE set, the KS0073 uses this for the segment RAM, which is not modeled
+		if(!ExtendedRegister)
+		{
+			AddressCounter = Cmd & (LCDMODEL_CGRAM_SIZE - 1);
+			AddressIsCGRAM = 1;
+		}
+	}
+	else if(Cmd & (1<<LCD_FUNCTION))
+	{
+		if(ModelController == LCDMODEL_CONTROLLER_KS0073)
+		{
+			ExtendedRegister = ((Cmd & 0x04) != 0);
+		}
+		if(!ExtendedRegister)
+		{
+			TwoLines = ((Cmd & (1<<LCD_FUNCTION_2LINES)) != 0);
+		}
+	}
+	else if(Cmd & (1<<LCD_MOVE))
+	{
+		if(!ExtendedRegister)
+		{
+			if(Cmd & (1<<LCD_MOVE_DISP))
+			{
+				Model_ShiftDisplay((Cmd & (1<<LCD_MOVE_RIGHT)) == 0);
+			}
+			else
+			{
+				uint8_t SavedEntryMode = EntryMode;
+
+				EntryMode = (Cmd & (1<<LCD_MOVE_RIGHT)) ? (1<<LCD_ENTRY_INC) : 0;
+				Model_StepAddress();
+				EntryMode = SavedEntryMode;
+			}
+		}
+	}
+	else if(Cmd & (1<<LCD_ON))
+	{
+		if(ExtendedRegister)
+		{
+			//KS0073 extended function set, NW selects 4 line mode
+			FourLines = ((Cmd & 0x01) != 0);
+		}
+		else
+		{
+			DisplayControl = Cmd;
+		}
+	}
+	else if(Cmd & (1<<LCD_ENTRY_MODE))
+	{
+		EntryMode = Cmd;
+	}
+	else if(Cmd & (1<<LCD_HOME))
+	{
+		AddressCounter = 0;
+		AddressIsCGRAM = 0;
+		DisplayShift = 0;
+		return LCDMODEL_EXEC_CLEAR_NS;
+	}
+	else if(Cmd & (1<<LCD_CLR))
+	{
+		memset(DDRAM, ' ', sizeof(DDRAM));
+		AddressCounter = 0;
+		AddressIsCGRAM = 0;
+		DisplayShift = 0;
+		EntryMode |= (1<<LCD_ENTRY_INC);
+		return LCDMODEL_EXEC_CLEAR_NS;
+	}
+	return LCDMODEL_EXEC_NS;
+}
+
+static void Model_WriteData(uint8_t Data)
+{
+	Stats.DataWrites++;
+
+	if(AddressIsCGRAM)
+	{
+		CGRAM[AddressCounter & (LCDMODEL_CGRAM_SIZE - 1)] = Data;
+	}
+	else
+	{
+		DDRAM[AddressCounter & (LCDMODEL_DDRAM_SIZE - 1)] = Data;
+		if(EntryMode & (1<<LCD_ENTRY_SHIFT))
+		{
+			Model_ShiftDisplay((EntryMode & (1<<LCD_ENTRY_INC)) != 0);
+		}
+	}
+	Model_StepAddress();
+	return;
+}
+
+//Same as lcd_waitbusy(): poll the busy flag, wait 2us, then read the address counter
+static uint8_t Model_WaitBusy(void)
+{
+	uint64_t Polls = 1;
+
+	if(BusyUntil > (Now + LCDMODEL_READ_NS))
+	{
+		Polls = (BusyUntil - Now + LCDMODEL_READ_NS - 1) / LCDMODEL_READ_NS;
+		Stats.BusyWaitNS += (Polls - 1) * LCDMODEL_READ_NS;
+	}
+	Stats.Reads += Polls + 1;
+	Model_Bus(0, 0, 1);
+	Model_Advance((Polls * LCDMODEL_READ_NS) + LCDMODEL_BUSY_DELAY_NS + LCDMODEL_READ_NS);
+	return AddressCounter;
+}
+
+//Write a byte to the controller, the caller has already waited for busy to clear
+static void Model_Write(uint8_t Value, uint8_t RS)
+{
+	Model_Advance(LCDMODEL_WRITE_NS);
+	Model_Bus(Value, RS, 0);
+	if(RS)
+	{
+		Model_WriteData(Value);
+		BusyUntil = Now + LCDMODEL_EXEC_NS + LCDMODEL_EXEC_ADD_NS;
+	}
+	else
+	{
+		BusyUntil = Now + Model_Instruction(Value);
+	}
+	return;
+}
+
+static uint8_t Model_ReadData(void)
+{
+	uint8_t Data;
+
+	Stats.Reads++;
+	Model_Advance(LCDMODEL_READ_NS);
+	Model_Bus(0, 1, 1);
+	if(AddressIsCGRAM)
+	{
+		Data = CGRAM[AddressCounter & (LCDMODEL_CGRAM_SIZE - 1)];
+	}
+	else
+	{
+		Data = DDRAM[AddressCounter & (LCDMODEL_DDRAM_SIZE - 1)];
+	}
+	Model_StepAddress();
+	BusyUntil = Now + LCDMODEL_EXEC_ADD_NS;
+	return Data;
+}
+
+/****************************************************************
+*	Model interface
+****************************************************************/
+
+void LCDModel_Reset(uint8_t Controller, uint8_t Columns, uint8_t Lines)
+{
+	ModelController = Controller;
+	ModelColumns = (Columns > LCDMODEL_MAX_COLUMNS) ? LCDMODEL_MAX_COLUMNS : Columns;
+	ModelLines = (Lines > LCDMODEL_MAX_LINES) ? LCDMODEL_MAX_LINES : Lines;
+
+	//Power on state, the data sheet calls for 8-bit, one line, display off, increment
+	memset(DDRAM, ' ', sizeof(DDRAM));
+	memset(CGRAM, 0, sizeof(CGRAM));
+	AddressCounter = 0;
+	AddressIsCGRAM = 0;
+	EntryMode = LCD_ENTRY_INC_;
+	DisplayControl = LCD_DISP_OFF;
+	TwoLines = 0;
+	ExtendedRegister = 0;
+	FourLines = 0;
+	DisplayShift = 0;
+
+	Now = 0;
+	BusyUntil = 0;
+	LCDModel_ClearStats();
+	return;
+}
+
+void LCDModel_SetBusHook(LCDModelBusHook Hook)
+{
+	BusHook = Hook;
+	return;
+}
+
+void LCDModel_ClearStats(void)
+{
+	memset(&Stats, 0, sizeof(Stats));
+	return;
+}
+
+const LCDModelStats *LCDModel_Stats(void)
+{
+	return &Stats;
+}
+
+uint32_t LCDModel_BusTimeUS(void)
+{
+	return (uint32_t)(Stats.BusTimeNS / 1000);
+}
+
+void LCDModel_GetLine(uint8_t Line, char *Buffer)
+{
+	uint8_t x;
+	uint8_t Base;
+	uint8_t Start;
+	uint8_t Length = Model_LineLength();
+
+	if(FourLines)
+	{
+		Base = Line << 5;
+		Start = 0;
+	}
+	else if(TwoLines)
+	{
+		//Lines 3 and 4 are the right half of lines 1 and 2
+		Base = (Line & 0x01) ? 0x40 : 0x00;
+		Start = (Line >> 1) * ModelColumns;
+	}
+	else
+	{
+		Base = 0;
+		Start = Line * ModelColumns;
+	}
+
+	for(x = 0; x < ModelColumns; x++)
+	{
+		if(((DisplayControl & (1<<LCD_ON_DISPLAY)) == 0) || (Line >= ModelLines))
+		{
+			Buffer[x] = ' ';
+		}
+		else
+		{
+			Buffer[x] = DDRAM[(Base + ((Start + x + DisplayShift) % Length)) & (LCDMODEL_DDRAM_SIZE - 1)];
+		}
+	}
+	Buffer[x] = 0;
+	return;
+}
+
+uint8_t LCDModel_LineIs(uint8_t Line, const char *Text)
+{
+	char Buffer[LCDMODEL_MAX_COLUMNS+1];
+	uint8_t x;
+
+	LCDModel_GetLine(Line, Buffer);
+	for(x = 0; x < ModelColumns; x++)
+	{
+		if(*Text != 0)
+		{
+			if(Buffer[x] != *Text++)
+			{
+				return 0;
+			}
+		}
+		else if(Buffer[x] != ' ')
+		{
+			return 0;
+		}
+	}
+	return (*Text == 0);
+}
+
+void LCDModel_Print(FILE *Stream)
+{
+	char Buffer[LCDMODEL_MAX_COLUMNS+1];
+	uint8_t Line;
+	uint8_t x;
+	uint8_t c;
+
+	fputc('+', Stream);
+	for(x = 0; x < ModelColumns; x++)
+	{
+		fputc('-', Stream);
+	}
+	fputs("+\n", Stream);
+
+	for(Line = 0; Line < ModelLines; Line++)
+	{
+		LCDModel_GetLine(Line, Buffer);
+		fputc('|', Stream);
+		for(x = 0; x < ModelColumns; x++)
+		{
+			c = Buffer[x];
+			if(c < 0x10)
+			{
+				c = '0' + (c & 0x07);
+			}
+			else if((c < 0x20) || (c > 0x7E))
+			{
+				c = '?';
+			}
+			fputc(c, Stream);
+		}
+		fputs("|\n", Stream);
+	}
+
+	fputc('+', Stream);
+	for(x = 0; x < ModelColumns; x++)
+	{
+		fputc('-', Stream);
+	}
+	fputs("+\n", Stream);
+	return;
+}
+
+uint8_t LCDModel_DDRAM(uint8_t Address)
+{
+	return DDRAM[Address & (LCDMODEL_DDRAM_SIZE - 1)];
+}
+
+uint8_t LCDModel_CGRAM(uint8_t Address)
+{
+	return CGRAM[Address & (LCDMODEL_CGRAM_SIZE - 1)];
+}
+
+uint8_t LCDModel_AddressCounter(void)
+{
+	return AddressCounter;
+}
+
+uint8_t LCDModel_DisplayControl(void)
+{
+	return DisplayControl;
+}
+
+uint8_t LCDModel_EntryMode(void)
+{
+	return EntryMode;
+}
+
+uint8_t LCDModel_DisplayShift(void)
+{
+	return DisplayShift;
+}
+
+/****************************************************************
+*	lcd.h interface, follows the LCD library
+****************************************************************/
+
+void lcd_command(uint8_t cmd)
+{
+	Model_WaitBusy();
+	Model_Write(cmd, 0);
+	return;
+}
+
+void lcd_data(uint8_t data)
+{
+	Model_WaitBusy();
+	Model_Write(data, 1);
+	return;
+}
+
+void lcd_gotoaddress(uint8_t addr)
+{
+	lcd_command((1<<LCD_DDRAM) | addr);
+	return;
+}
+
+void lcd_gotoxy(uint8_t x, uint8_t y)
+{
+#if LCD_LINES==1
+	lcd_command((1<<LCD_DDRAM) + LCD_START_LINE1 + x);
+#elif LCD_LINES==2
+	if(y == 0)
+	{
+		lcd_command((1<<LCD_DDRAM) + LCD_START_LINE1 + x);
+	}
+	else
+	{
+		lcd_command((1<<LCD_DDRAM) + LCD_START_LINE2 + x);
+	}
+#else
+	if(y == 0)
+	{
+		lcd_command((1<<LCD_DDRAM) + LCD_START_LINE1 + x);
+	}
+	else if(y == 1)
+	{
+		lcd_command((1<<LCD_DDRAM) + LCD_START_LINE2 + x);
+	}
+	else if(y == 2)
+	{
+		lcd_command((1<<LCD_DDRAM) + LCD_START_LINE3 + x);
+	}
+	else
+	{
+		lcd_command((1<<LCD_DDRAM) + LCD_START_LINE4 + x);
+	}
+#endif
+	return;
+}
+
+uint8_t lcd_getcurrentaddress(void)
+{
+	return Model_WaitBusy();
+}
+
+uint8_t lcd_getcharacterataddress(uint8_t addr)
+{
+	lcd_gotoaddress(addr);
+	Model_WaitBusy();
+	return Model_ReadData();
+}
+
+uint8_t lcd_getxy(uint8_t x, uint8_t y)
+{
+	lcd_gotoxy(x, y);
+	Model_WaitBusy();
+	return Model_ReadData();
+}
+
+void lcd_clrscr(void)
+{
+	lcd_command(1<<LCD_CLR);
+	return;
+}
+
+void lcd_home(void)
+{
+	lcd_command(1<<LCD_HOME);
+	return;
+}
+
+void lcd_putc(char c)
+{
+	uint8_t Position;
+
+	Position = Model_WaitBusy();
+	if(c == '\n')
+	{
+		//Move to the start of the next line
+#if LCD_LINES==1
+		Position = LCD_START_LINE1;
+#elif LCD_LINES==2
+		Position = (Position < LCD_START_LINE2) ? LCD_START_LINE2 : LCD_START_LINE1;
+#else
+		if(Position < LCD_START_LINE3)
+		{
+			Position = LCD_START_LINE2;
+		}
+		else if((Position >= LCD_START_LINE2) && (Position < LCD_START_LINE4))
+		{
+			Position = LCD_START_LINE3;
+		}
+		else if((Position >= LCD_START_LINE3) && (Position < LCD_START_LINE2))
+		{
+			Position = LCD_START_LINE4;
+		}
+		else
+		{
+			Position = LCD_START_LINE1;
+		}
+#endif
+		lcd_command((1<<LCD_DDRAM) + Position);
+	}
+	else
+	{
+		Model_Write((uint8_t)c, 1);
+	}
+	return;
+}
+
+void lcd_puts(const char *s)
+{
+	while(*s)
+	{
+		lcd_putc(*s++);
+	}
+	return;
+}
+
+void lcd_puts_p(const char *progmem_s)
+{
+	char c;
+
+	while((c = pgm_read_byte(progmem_s++)) != 0)
+	{
+		lcd_putc(c);
+	}
+	return;
+}
+
+void lcd_init(uint8_t dispAttr)
+{
+	//Power on delays and the three 8-bit function sets used to get into a known state
+	Model_Advance(LCDMODEL_INIT_NS);
+	Model_Instruction(LCD_FUNCTION_8BIT_1LINE);
+	Model_Instruction(LCD_FUNCTION_8BIT_1LINE);
+	Model_Instruction(LCD_FUNCTION_8BIT_1LINE);
+	Model_Instruction(LCD_FUNCTION_4BIT_1LINE);
+	BusyUntil = Now;
+
+#if LCD_LINES==1
+	lcd_command(LCD_FUNCTION_4BIT_1LINE);
+#else
+	lcd_command(LCD_FUNCTION_4BIT_2LINES);
+#endif
+	lcd_command(LCD_DISP_OFF);
+	lcd_clrscr();
+	lcd_command(LCD_MODE_DEFAULT);
+	lcd_command(dispAttr);
+	return;
+}
+
+/** @} */
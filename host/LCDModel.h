@@ -0,0 +1,116 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Host model of the HD44780 LCD controller header file.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	LCDModel.c implements the functions in lcd.h for host builds. Instead of
+*	driving port pins, each instruction and data byte is fed to a model of the
+*	controller that keeps the DDRAM, CGRAM, address counter, entry mode, display
+*	shift and display control state the same way the HD44780 does.
+*
+*	The model also keeps a clock. Each call into the LCD library is charged the
+*	time the firmware would spend in it: waiting on the busy flag for the
+*	previous instruction, the 4-bit bus transfers, and the execution time of
+*	the instruction from the HD44780U data sheet (fosc = 270kHz). Tests read
+*	the clock to check how much LCD time a screen update costs.
+*
+*	The KS0073 4 line mode is also modeled, so the 20x4 line addressing can be
+*	tested.
+*
+*	@{
+*/
+
+#ifndef _LCDMODEL_H_
+#define _LCDMODEL_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define LCDMODEL_CONTROLLER_HD44780		0
+#define LCDMODEL_CONTROLLER_KS0073		1
+
+#define LCDMODEL_DDRAM_SIZE				0x80
+#define LCDMODEL_CGRAM_SIZE				0x40
+#define LCDMODEL_MAX_LINES				4
+#define LCDMODEL_MAX_COLUMNS			40
+
+//Instruction execution times in ns, from the HD44780U data sheet
+#define LCDMODEL_EXEC_CLEAR_NS			1520000UL	//Clear display and return home
+#define LCDMODEL_EXEC_NS				37000UL		//All other instructions and data writes
+#define LCDMODEL_EXEC_ADD_NS			4000UL		//tADD, address counter update after a data access
+
+//Time the AVR takes for one transfer over the 4-bit bus (two nibbles) at 8MHz, and the delay lcd_waitbusy() adds after busy clears
+#define LCDMODEL_WRITE_NS				2000UL
+#define LCDMODEL_READ_NS				3000UL
+#define LCDMODEL_BUSY_DELAY_NS			2000UL
+
+//Time taken by lcd_init(), mostly the power on delays
+#define LCDMODEL_INIT_NS				21000000UL
+
+/** Counters kept by the model. */
+typedef struct
+{
+	uint64_t BusTimeNS;			//Total time spent in the LCD library
+	uint64_t BusyWaitNS;		//Part of BusTimeNS spent waiting for the busy flag
+	uint32_t Instructions;		//Instructions written
+	uint32_t DataWrites;		//Data bytes written to DDRAM or CGRAM
+	uint32_t Reads;				//Busy flag and data reads
+} LCDModelStats;
+
+/** Called for each access to the 4-bit bus, with the byte written (0 for a read) and the RS line. */
+typedef void (*LCDModelBusHook)(uint8_t Value, uint8_t Rs, uint8_t Read);
+
+/** Power on the model with a display of the given size. All RAM is filled with spaces and the counters are cleared. */
+void LCDModel_Reset(uint8_t Controller, uint8_t Columns, uint8_t Lines);
+
+/** Set the function called for each bus access, or NULL. It is kept over a reset, like the wiring. */
+void LCDModel_SetBusHook(LCDModelBusHook Hook);
+
+/** Clear the counters without changing the display. */
+void LCDModel_ClearStats(void);
+
+/** Get the counters. */
+const LCDModelStats *LCDModel_Stats(void);
+
+/** Total time spent in the LCD library since the last reset, in us. */
+uint32_t LCDModel_BusTimeUS(void);
+
+/** Copy line Line of the visible screen to Buffer, as raw character codes with a terminating 0. Buffer must hold Columns+1 bytes. */
+void LCDModel_GetLine(uint8_t Line, char *Buffer);
+
+/** Returns 1 if the visible line matches Text. Text is padded with spaces to the display width. */
+uint8_t LCDModel_LineIs(uint8_t Line, const char *Text);
+
+/** Print the visible screen in a box. CGRAM characters are shown as their number and non ASCII characters as '?'. */
+void LCDModel_Print(FILE *Stream);
+
+/** Read the DDRAM and CGRAM directly, without any bus time. */
+uint8_t LCDModel_DDRAM(uint8_t Address);
+uint8_t LCDModel_CGRAM(uint8_t Address);
+
+/** Controller state. */
+uint8_t LCDModel_AddressCounter(void);
+uint8_t LCDModel_DisplayControl(void);		//Last display on/off control instruction, LCD_DISP_*
+uint8_t LCDModel_EntryMode(void);			//Last entry mode instruction, LCD_ENTRY_*
+uint8_t LCDModel_DisplayShift(void);		//Display shift in characters, 0 to 39
+
+#endif
+
+/** @} */
@@ -0,0 +1,171 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Model of the MPL115A1 pressure sensor for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "PressureModel.h"
+
+#define PRESSUREMODEL_REG_PADC			0x00
+#define PRESSUREMODEL_REG_TADC_LSB		0x03
+#define PRESSUREMODEL_REG_A0			0x04
+#define PRESSUREMODEL_REG_CONVERT		0x12
+#define PRESSUREMODEL_REGS				0x12
+
+static uint8_t PressureModelRegs[PRESSUREMODEL_REGS];
+static uint16_t PressureModelPadc;
+static uint16_t PressureModelTadc;
+static uint8_t PressureModelPresent = 1;
+static uint8_t PressureModelStarted;
+static uint8_t PressureModelBusyMS;			//Time left in the conversion
+static PressureModelStats PressureModelCounters;
+
+//Command being received
+static uint8_t PressureModelNext;			//Byte sent back during the next transfer
+static uint8_t PressureModelConvert;		//The start conversion command was received
+
+static void PressureModel_Put16(uint8_t Reg, uint16_t Value)
+{
+	PressureModelRegs[Reg] = Value >> 8;
+	PressureModelRegs[Reg + 1] = Value;
+	return;
+}
+
+void PressureModel_Reset(void)
+{
+	PressureModelStarted = 1;
+	memset(PressureModelRegs, 0, sizeof(PressureModelRegs));
+	PressureModel_SetCoefficients(PRESSUREMODEL_A0, PRESSUREMODEL_B1, PRESSUREMODEL_B2, PRESSUREMODEL_C12);
+	PressureModel_SetAdc(PRESSUREMODEL_PADC, PRESSUREMODEL_TADC);
+	PressureModelPresent = 1;
+	PressureModelBusyMS = 0;
+	memset(&PressureModelCounters, 0, sizeof(PressureModelCounters));
+	return;
+}
+
+static void PressureModel_Start(void)
+{
+	if(!PressureModelStarted)
+	{
+		PressureModel_Reset();
+	}
+	return;
+}
+
+void PressureModel_SetAdc(uint16_t Padc, uint16_t Tadc)
+{
+	PressureModelPadc = Padc;
+	PressureModelTadc = Tadc;
+	return;
+}
+
+void PressureModel_SetCoefficients(uint16_t A0, uint16_t B1, uint16_t B2, uint16_t C12)
+{
+	PressureModelStarted = 1;
+	PressureModel_Put16(PRESSUREMODEL_REG_A0, A0);
+	PressureModel_Put16(PRESSUREMODEL_REG_A0 + 2, B1);
+	PressureModel_Put16(PRESSUREMODEL_REG_A0 + 4, B2);
+	PressureModel_Put16(PRESSUREMODEL_REG_A0 + 6, C12);
+	return;
+}
+
+void PressureModel_SetPresent(uint8_t Present)
+{
+	PressureModelPresent = Present;
+	return;
+}
+
+const PressureModelStats *PressureModel_Stats(void)
+{
+	return &PressureModelCounters;
+}
+
+void PressureModel_Tick(void)
+{
+	if(PressureModelBusyMS > 0)
+	{
+		PressureModelBusyMS--;
+		if(PressureModelBusyMS == 0)
+		{
+			//Results are left justified
+			PressureModel_Put16(PRESSUREMODEL_REG_PADC, PressureModelPadc << 6);
+			PressureModel_Put16(PRESSUREMODEL_REG_PADC + 2, PressureModelTadc << 6);
+		}
+	}
+	return;
+}
+
+void PressureModel_Select(void)
+{
+	PressureModel_Start();
+	PressureModelNext = 0xFF;
+	PressureModelConvert = 0;
+	return;
+}
+
+uint8_t PressureModel_Transfer(uint8_t Data)
+{
+	uint8_t Reg = (Data >> 1) & 0x3F;
+	uint8_t Out = PressureModelNext;
+
+	if(!PressureModelPresent)
+	{
+		return 0xFF;
+	}
+
+	//Each command byte is answered during the next byte
+	PressureModelNext = 0x00;
+	if((Data & 0x80) && (Reg < PRESSUREMODEL_REGS))
+	{
+		PressureModelNext = PressureModelRegs[Reg];
+		if(Reg <= PRESSUREMODEL_REG_TADC_LSB)
+		{
+			if(PressureModelBusyMS > 0)
+			{
+				PressureModelCounters.EarlyReads++;
+			}
+			else if(Reg == PRESSUREMODEL_REG_TADC_LSB)
+			{
+				PressureModelCounters.Reads++;
+			}
+		}
+	}
+	else if(Data == (PRESSUREMODEL_REG_CONVERT << 1))
+	{
+		PressureModelConvert = 1;
+	}
+	return Out;
+}
+
+void PressureModel_Deselect(void)
+{
+	if(PressureModelPresent && PressureModelConvert)
+	{
+		PressureModelCounters.Conversions++;
+		PressureModelBusyMS = PRESSUREMODEL_CONVERSION_MS;
+	}
+	return;
+}
+
+/** @} */
@@ -0,0 +1,82 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Model of the MPL115A1 pressure sensor for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	The model answers register reads and the start conversion command on the
+*	SPI bus. The coefficients start as the example from Freescale AN3785 and
+*	the readings are set by the test. A conversion is only finished after
+*	PRESSUREMODEL_CONVERSION_MS calls to PressureModel_Tick(), which
+*	Device_RunMS() makes once a millisecond. Reading the results before
+*	that returns the old ones and is counted as an early read.
+*
+*	@{
+*/
+
+#ifndef _PRESSUREMODEL_H_
+#define _PRESSUREMODEL_H_
+
+#include <stdint.h>
+
+#define PRESSUREMODEL_CONVERSION_MS		3		//tc, maximum conversion time
+
+//Coefficients and readings of the AN3785 example, 96.59kPa
+#define PRESSUREMODEL_A0				0x3ECE
+#define PRESSUREMODEL_B1				0xB3F9
+#define PRESSUREMODEL_B2				0xC517
+#define PRESSUREMODEL_C12				0x33C8
+#define PRESSUREMODEL_PADC				410
+#define PRESSUREMODEL_TADC				507
+
+/** Counters kept by the model. */
+typedef struct
+{
+	uint32_t Conversions;			//Conversions started
+	uint32_t Reads;					//Result registers read after a conversion finished
+	uint32_t EarlyReads;			//Result registers read while a conversion was running
+} PressureModelStats;
+
+/** Put back the example coefficients and readings, finish any conversion and clear the counters. */
+void PressureModel_Reset(void);
+
+/** Set the 10 bit readings the next conversion returns. */
+void PressureModel_SetAdc(uint16_t Padc, uint16_t Tadc);
+
+/** Set the coefficients. */
+void PressureModel_SetCoefficients(uint16_t A0, uint16_t B1, uint16_t B2, uint16_t C12);
+
+/** Remove the sensor from the bus, or put it back. */
+void PressureModel_SetPresent(uint8_t Present);
+
+/** Get the counters. */
+const PressureModelStats *PressureModel_Stats(void);
+
+/** One millisecond passes. */
+void PressureModel_Tick(void);
+
+/** Bus interface, used by SPIModel.c. */
+void PressureModel_Select(void);
+uint8_t PressureModel_Transfer(uint8_t Data);
+void PressureModel_Deselect(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,221 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Model of the SHT25 humidity sensor for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "SHT25Model.h"
+
+#define SHT25MODEL_CMD_TEMPERATURE		0xF3
+#define SHT25MODEL_CMD_HUMIDITY			0xF5
+#define SHT25MODEL_CMD_WRITE_USER		0xE6
+#define SHT25MODEL_CMD_READ_USER		0xE7
+#define SHT25MODEL_CMD_RESET			0xFE
+
+#define SHT25MODEL_STATUS_HUMIDITY		0x02
+
+//What the next read returns
+#define SHT25MODEL_READ_NOTHING			0
+#define SHT25MODEL_READ_USER			1
+#define SHT25MODEL_READ_RESULT			2
+
+static uint8_t SHT25ModelPresent = 1;
+static uint8_t SHT25ModelStarted;
+static uint16_t SHT25ModelRaw[2];
+static uint16_t SHT25ModelTimes[2];
+static uint8_t SHT25ModelUser;
+static uint8_t SHT25ModelCorrupt;
+static SHT25ModelStats SHT25ModelCounters;
+
+static uint8_t SHT25ModelNext;				//SHT25MODEL_READ_ value
+static uint8_t SHT25ModelHumidity;			//The measurement is humidity
+static uint16_t SHT25ModelBusyMS;
+
+void SHT25Model_Reset(void)
+{
+	SHT25ModelStarted = 1;
+	SHT25ModelPresent = 1;
+	SHT25Model_SetRaw(SHT25MODEL_TEMPERATURE, SHT25MODEL_HUMIDITY);
+	SHT25Model_SetTimes(SHT25MODEL_TEMPERATURE_MS, SHT25MODEL_HUMIDITY_MS);
+	SHT25ModelUser = SHT25MODEL_USER_REG;
+	SHT25ModelCorrupt = 0;
+	SHT25ModelNext = SHT25MODEL_READ_NOTHING;
+	SHT25ModelBusyMS = 0;
+	memset(&SHT25ModelCounters, 0, sizeof(SHT25ModelCounters));
+	return;
+}
+
+static void SHT25Model_Start(void)
+{
+	if(!SHT25ModelStarted)
+	{
+		SHT25Model_Reset();
+	}
+	return;
+}
+
+void SHT25Model_SetRaw(uint16_t Temperature, uint16_t Humidity)
+{
+	SHT25ModelRaw[0] = Temperature;
+	SHT25ModelRaw[1] = Humidity;
+	return;
+}
+
+void SHT25Model_SetTimes(uint16_t Temperature, uint16_t Humidity)
+{
+	SHT25ModelTimes[0] = Temperature;
+	SHT25ModelTimes[1] = Humidity;
+	return;
+}
+
+void SHT25Model_CorruptCrc(uint8_t Count)
+{
+	SHT25ModelCorrupt = Count;
+	return;
+}
+
+void SHT25Model_SetPresent(uint8_t Present)
+{
+	SHT25ModelPresent = Present;
+	return;
+}
+
+const SHT25ModelStats *SHT25Model_Stats(void)
+{
+	return &SHT25ModelCounters;
+}
+
+void SHT25Model_Tick(void)
+{
+	if(SHT25ModelBusyMS > 0)
+	{
+		SHT25ModelBusyMS--;
+	}
+	return;
+}
+
+static uint8_t SHT25Model_Crc(const uint8_t *Data, uint8_t Length)
+{
+	uint8_t Crc = 0;
+	uint8_t i;
+
+	while(Length-- > 0)
+	{
+		Crc ^= *Data++;
+		for(i = 0; i < 8; i++)
+		{
+			Crc = (Crc & 0x80) ? ((Crc << 1) ^ 0x31) : (Crc << 1);
+		}
+	}
+	return Crc;
+}
+
+uint8_t SHT25Model_Write(const uint8_t *Data, uint8_t Length)
+{
+	SHT25Model_Start();
+	if(!SHT25ModelPresent || (SHT25ModelBusyMS > 0))
+	{
+		return 1;
+	}
+	if(Length == 0)
+	{
+		return 0;
+	}
+
+	SHT25ModelNext = SHT25MODEL_READ_NOTHING;
+	switch(Data[0])
+	{
+		case SHT25MODEL_CMD_TEMPERATURE:
+		case SHT25MODEL_CMD_HUMIDITY:
+			SHT25ModelHumidity = (Data[0] == SHT25MODEL_CMD_HUMIDITY);
+			SHT25ModelBusyMS = SHT25ModelTimes[SHT25ModelHumidity];
+			SHT25ModelNext = SHT25MODEL_READ_RESULT;
+			SHT25ModelCounters.Measurements++;
+			break;
+
+		case SHT25MODEL_CMD_READ_USER:
+			SHT25ModelNext = SHT25MODEL_READ_USER;
+			break;
+
+		case SHT25MODEL_CMD_WRITE_USER:
+			if(Length > 1)
+			{
+				SHT25ModelUser = Data[1];
+			}
+			break;
+
+		case SHT25MODEL_CMD_RESET:
+			SHT25ModelUser = SHT25MODEL_USER_REG;
+			break;
+	}
+	return 0;
+}
+
+uint8_t SHT25Model_Read(uint8_t *Data, uint8_t Length)
+{
+	uint8_t Result[3];
+	uint8_t i;
+
+	SHT25Model_Start();
+	if(!SHT25ModelPresent)
+	{
+		return 1;
+	}
+	if(SHT25ModelBusyMS > 0)
+	{
+		SHT25ModelCounters.BusyReads++;
+		return 1;
+	}
+
+	memset(Result, 0xFF, sizeof(Result));
+	if(SHT25ModelNext == SHT25MODEL_READ_USER)
+	{
+		Result[0] = SHT25ModelUser;
+	}
+	else if(SHT25ModelNext == SHT25MODEL_READ_RESULT)
+	{
+		Result[0] = SHT25ModelRaw[SHT25ModelHumidity] >> 8;
+		Result[1] = (SHT25ModelRaw[SHT25ModelHumidity] & 0xFC) | (SHT25ModelHumidity ? SHT25MODEL_STATUS_HUMIDITY : 0);
+		Result[2] = SHT25Model_Crc(Result, 2);
+		if(SHT25ModelCorrupt > 0)
+		{
+			SHT25ModelCorrupt--;
+			Result[2] ^= 0x01;
+		}
+		SHT25ModelCounters.Results++;
+	}
+	else
+	{
+		return 1;
+	}
+
+	for(i = 0; i < Length; i++)
+	{
+		Data[i] = (i < sizeof(Result)) ? Result[i] : 0xFF;
+	}
+	SHT25ModelNext = SHT25MODEL_READ_NOTHING;
+	return 0;
+}
+
+/** @} */
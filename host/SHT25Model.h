@@ -0,0 +1,83 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Model of the SHT25 humidity sensor for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	The model answers the no hold master measurement commands and the user
+*	register on the I2C bus model. A measurement takes its time in calls to
+*	SHT25Model_Tick(), which Device_RunMS() makes once a millisecond, and the
+*	sensor does not answer reads until it is done. The raw results and the
+*	measurement times are set by the test, and results can be sent with a
+*	bad CRC.
+*
+*	@{
+*/
+
+#ifndef _SHT25MODEL_H_
+#define _SHT25MODEL_H_
+
+#include <stdint.h>
+
+#define SHT25MODEL_ADDRESS				0x40
+#define SHT25MODEL_TEMPERATURE_MS		66		//Typical times from the data sheet
+#define SHT25MODEL_HUMIDITY_MS			22
+#define SHT25MODEL_USER_REG				0x3A	//Value after a reset
+
+//Default raw results, 22.99 C and 44.99 %RH
+#define SHT25MODEL_TEMPERATURE			0x65C3
+#define SHT25MODEL_HUMIDITY				0x6873
+
+/** Counters kept by the model. */
+typedef struct
+{
+	uint32_t Measurements;			//Measurements started
+	uint32_t BusyReads;				//Reads that were not answered because a measurement was running
+	uint32_t Results;				//Results read
+} SHT25ModelStats;
+
+/** Put back the defaults, end any measurement and clear the counters. */
+void SHT25Model_Reset(void);
+
+/** Set the raw results, the status bits are added by the model. */
+void SHT25Model_SetRaw(uint16_t Temperature, uint16_t Humidity);
+
+/** Set how long measurements take in ms. */
+void SHT25Model_SetTimes(uint16_t Temperature, uint16_t Humidity);
+
+/** Send the next Count results with a bad CRC. */
+void SHT25Model_CorruptCrc(uint8_t Count);
+
+/** Remove the sensor from the bus, or put it back. */
+void SHT25Model_SetPresent(uint8_t Present);
+
+/** Get the counters. */
+const SHT25ModelStats *SHT25Model_Stats(void);
+
+/** One millisecond passes. */
+void SHT25Model_Tick(void);
+
+/** Bus interface, used by SoftI2CModel.c. They return 0 if the sensor acks. */
+uint8_t SHT25Model_Write(const uint8_t *Data, uint8_t Length);
+uint8_t SHT25Model_Read(uint8_t *Data, uint8_t Length);
+
+#endif
+
+/** @} */
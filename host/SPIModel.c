@@ -0,0 +1,170 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Model of the SPI bus on port B for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "main.h"
+#include "HAL.h"
+#include "SPIModel.h"
+#include "FlashModel.h"
+#include "PressureModel.h"
+
+//Port B pins
+#define SPIMODEL_PIN_FLASH_CS		0
+#define SPIMODEL_PIN_SCK			1
+#define SPIMODEL_PIN_MOSI			2
+#define SPIMODEL_PIN_MISO			3
+#define SPIMODEL_PIN_PRESSURE_CS	4
+#define SPIMODEL_PIN_RS				5
+#define SPIMODEL_LCD_PINS			0x3F	//PB0-PB3 data, PB4 RW, PB5 RS
+
+#define SPIMODEL_MODE_BITS			((1<<CPOL) | (1<<CPHA))
+
+static uint8_t SPIModelFlash;					//Chip selects seen at the last update
+static uint8_t SPIModelPressure;
+static SPIModelStats SPIModelCounters;
+
+void SPIModel_Reset(void)
+{
+	SPIModelFlash = 0;
+	SPIModelPressure = 0;
+	memset(&SPIModelCounters, 0, sizeof(SPIModelCounters));
+	return;
+}
+
+const SPIModelStats *SPIModel_Stats(void)
+{
+	return &SPIModelCounters;
+}
+
+//Returns 1 if the pin is an output driven low
+static uint8_t SPIModel_Low(uint8_t Pin)
+{
+	return ((DDRB & (1<<Pin)) != 0) && ((PORTB & (1<<Pin)) == 0);
+}
+
+void SPIModel_Update(void)
+{
+	uint8_t Flash = SPIModel_Low(SPIMODEL_PIN_FLASH_CS);
+	uint8_t Pressure = SPIModel_Low(SPIMODEL_PIN_PRESSURE_CS);
+
+	if(Flash != SPIModelFlash)
+	{
+		if(Flash)
+		{
+			FlashModel_Select();
+		}
+		else
+		{
+			FlashModel_Deselect();
+		}
+		SPIModelFlash = Flash;
+	}
+	if(Pressure != SPIModelPressure)
+	{
+		if(Pressure)
+		{
+			PressureModel_Select();
+		}
+		else
+		{
+			PressureModel_Deselect();
+		}
+		SPIModelPressure = Pressure;
+	}
+	return;
+}
+
+void SPIModel_Write(uint8_t Data)
+{
+	uint8_t Mode = SPCR & SPIMODEL_MODE_BITS;
+	uint8_t Answer = 0xFF;
+
+	SPIModel_Update();
+	SPIModelCounters.Bytes++;
+
+	if(((SPCR & ((1<<SPE) | (1<<MSTR))) != ((1<<SPE) | (1<<MSTR)))
+		|| ((DDRB & ((1<<SPIMODEL_PIN_SCK) | (1<<SPIMODEL_PIN_MOSI))) != ((1<<SPIMODEL_PIN_SCK) | (1<<SPIMODEL_PIN_MOSI)))
+		|| (SPIModelFlash && SPIModelPressure))
+	{
+		SPIModelCounters.Conflicts++;
+	}
+
+	//The dataflash takes modes 0 and 3, the sensor only mode 0. With both selected they fight over MISO.
+	if(SPIModelFlash)
+	{
+		SPIModelCounters.WrongMode += (Mode != 0) && (Mode != SPIMODEL_MODE_BITS);
+		Answer &= FlashModel_Transfer(Data);
+	}
+	if(SPIModelPressure)
+	{
+		SPIModelCounters.WrongMode += (Mode != 0);
+		Answer &= PressureModel_Transfer(Data);
+	}
+
+	SPDR = Answer;
+	SPSR |= (1<<SPIF);
+	return;
+}
+
+void SPIModel_Tick(void)
+{
+	uint8_t Bytes = SPIMODEL_BYTES_PER_MS;
+
+	while(((SPCR & (1<<SPIE)) != 0) && ((SPSR & (1<<SPIF)) != 0) && (Bytes-- > 0))
+	{
+		//SPIF is cleared when the interrupt is taken
+		SPSR &= ~(1<<SPIF);
+		SPIModelCounters.Interrupts++;
+		SPI_STC_vect();
+	}
+	return;
+}
+
+void SPIModel_LcdBus(uint8_t Value, uint8_t Rs, uint8_t Read)
+{
+	if(SPCR & (1<<SPE))
+	{
+		SPIModelCounters.LcdConflicts++;
+	}
+
+	//The library leaves RS and RW set, and the data lines as outputs with the
+	//last nibble written, or as inputs with RW high after a read
+	PORTB &= ~SPIMODEL_LCD_PINS;
+	PORTB |= (Rs << SPIMODEL_PIN_RS);
+	if(Read)
+	{
+		PORTB |= (1<<SPIMODEL_PIN_PRESSURE_CS);
+		DDRB = (DDRB & ~0x0F) | (SPIMODEL_LCD_PINS & ~0x0F);
+	}
+	else
+	{
+		PORTB |= (Value & 0x0F);
+		DDRB |= SPIMODEL_LCD_PINS;
+	}
+	return;
+}
+
+/** @} */
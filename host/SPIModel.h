@@ -0,0 +1,80 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Model of the SPI bus on port B for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	Board/SPI.c runs unchanged on the host. The host build sends each byte
+*	written to SPDR to SPIModel_Write(), which clocks it through the models of
+*	the devices whose chip selects are low, puts the answer in SPDR and sets
+*	SPIF. SPIModel_Update() is called when the chip selects change, and
+*	selects and deselects the device models on the edges.
+*
+*	The SPI interrupt is run by SPIModel_Tick() from Device_RunMS(), for up to
+*	SPIMODEL_BYTES_PER_MS bytes each millisecond.
+*
+*	The model also checks that the bus is shared properly. A byte that is
+*	sent with the SPI pins not set up, with both chip selects low or in a
+*	mode the device does not take is counted as a conflict, and so is an LCD
+*	access while the SPI has port B. The LCD model reports its accesses
+*	through SPIModel_LcdBus(), which also leaves port B the way the LCD
+*	library does.
+*
+*	@{
+*/
+
+#ifndef _SPIMODEL_H_
+#define _SPIMODEL_H_
+
+#include <stdint.h>
+
+#define SPIMODEL_BYTES_PER_MS		125		//8us for the interrupt and a byte at 1MHz
+
+/** Counters kept by the model. */
+typedef struct
+{
+	uint32_t Bytes;
+	uint32_t Interrupts;			//SPI interrupts run
+	uint32_t Conflicts;				//Bytes sent with the pins wrong or two devices selected
+	uint32_t WrongMode;				//Bytes sent to a device in a mode it does not take
+	uint32_t LcdConflicts;			//LCD accesses while the SPI was on
+} SPIModelStats;
+
+/** Deselect the devices and clear the counters. */
+void SPIModel_Reset(void);
+
+/** Get the counters. */
+const SPIModelStats *SPIModel_Stats(void);
+
+/** Look at the chip selects after port B changed. */
+void SPIModel_Update(void);
+
+/** A byte was written to SPDR. */
+void SPIModel_Write(uint8_t Data);
+
+/** One millisecond passes: run the SPI interrupt while it is on and a byte is done. */
+void SPIModel_Tick(void);
+
+/** The LCD library wrote or read a nibble on port B. */
+void SPIModel_LcdBus(uint8_t Value, uint8_t Rs, uint8_t Read);
+
+#endif
+
+/** @} */
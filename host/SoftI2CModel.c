@@ -0,0 +1,417 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Model of the I2C bus wires for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "main.h"
+#include "config.h"
+#include "HAL.h"
+#include "SoftI2CModel.h"
+#include "SHT25Model.h"
+
+//Where the bus is in a transfer
+#define SOFTI2CMODEL_STATE_IDLE			0		//Waiting for a start
+#define SOFTI2CMODEL_STATE_ADDRESS		1		//Receiving the address
+#define SOFTI2CMODEL_STATE_WRITE		2		//Receiving bytes for a device
+#define SOFTI2CMODEL_STATE_READ			3		//Sending bytes from a device
+#define SOFTI2CMODEL_STATE_IGNORE		4		//Not addressed, waiting for a start or stop
+
+#define SOFTI2CMODEL_SHT25				0xFF	//Device number of the SHT25 model
+
+//A device with one ID register
+typedef struct
+{
+	uint8_t Address;
+	uint8_t Register;
+	uint8_t Value;
+	uint8_t Pointer;				//Register picked by the last write
+} SoftI2CModelDevice;
+
+static uint8_t SoftI2CModelScl = 1;
+static uint8_t SoftI2CModelSda = 1;
+static uint8_t SoftI2CModelState;
+static uint8_t SoftI2CModelNext;				//State after the ack
+static uint8_t SoftI2CModelBit;					//Rising edges in this byte, the ack is the ninth
+static uint8_t SoftI2CModelByte;
+static uint8_t SoftI2CModelPull;				//The device pulls SDA low
+static uint8_t SoftI2CModelMasterNack;
+static uint8_t SoftI2CModelAddressed;			//Device number being written or read
+
+static SoftI2CModelDevice SoftI2CModelDevices[SOFTI2CMODEL_DEVICES];
+static uint8_t SoftI2CModelDeviceCount;
+
+static uint8_t SoftI2CModelBuffer[8];
+static uint8_t SoftI2CModelLength;				//Bytes written
+static uint8_t SoftI2CModelIndex;				//Byte being read
+
+static uint16_t SoftI2CModelStretchNext;
+static uint16_t SoftI2CModelStretchLeft;
+static uint8_t SoftI2CModelHold;
+static uint32_t SoftI2CModelCounts;				//Timer 1 counts not yet used
+static SoftI2CModelStats SoftI2CModelCounters;
+
+void SoftI2CModel_Reset(void)
+{
+	SoftI2CModelScl = 1;
+	SoftI2CModelSda = 1;
+	SoftI2CModelState = SOFTI2CMODEL_STATE_IDLE;
+	SoftI2CModelPull = 0;
+	SoftI2CModelLength = 0;
+	SoftI2CModelStretchNext = 0;
+	SoftI2CModelStretchLeft = 0;
+	SoftI2CModelHold = 0;
+	SoftI2CModelCounts = 0;
+	SoftI2CModelDeviceCount = 0;
+	memset(&SoftI2CModelCounters, 0, sizeof(SoftI2CModelCounters));
+	return;
+}
+
+const SoftI2CModelStats *SoftI2CModel_Stats(void)
+{
+	return &SoftI2CModelCounters;
+}
+
+void SoftI2CModel_Stretch(uint16_t Ticks)
+{
+	SoftI2CModelStretchNext = Ticks;
+	return;
+}
+
+uint8_t SoftI2CModel_AddDevice(uint8_t Address, uint8_t Register, uint8_t Value)
+{
+	SoftI2CModelDevice *Device;
+
+	if(SoftI2CModelDeviceCount >= SOFTI2CMODEL_DEVICES)
+	{
+		return 1;
+	}
+	Device = &SoftI2CModelDevices[SoftI2CModelDeviceCount++];
+	Device->Address = Address;
+	Device->Register = Register;
+	Device->Value = Value;
+	Device->Pointer = 0;
+	return 0;
+}
+
+void SoftI2CModel_HoldSda(uint8_t Hold)
+{
+	SoftI2CModelHold = Hold;
+	return;
+}
+
+//Level the master leaves on a line, released lines are pulled up
+static uint8_t SoftI2CModel_Master(uint8_t Ddr, uint8_t Port, uint8_t Pin)
+{
+	if((Ddr & (1<<Pin)) == 0)
+	{
+		return 1;
+	}
+	if(Port & (1<<Pin))
+	{
+		SoftI2CModelCounters.DrivenHigh++;
+		return 1;
+	}
+	return 0;
+}
+
+//Bytes written to the device are given to it in one go
+static void SoftI2CModel_Deliver(void)
+{
+	if((SoftI2CModelState == SOFTI2CMODEL_STATE_WRITE) && (SoftI2CModelLength > 0))
+	{
+		if(SoftI2CModelAddressed == SOFTI2CMODEL_SHT25)
+		{
+			SHT25Model_Write(SoftI2CModelBuffer, SoftI2CModelLength);
+		}
+		else
+		{
+			SoftI2CModelDevices[SoftI2CModelAddressed].Pointer = SoftI2CModelBuffer[0];
+		}
+	}
+	SoftI2CModelLength = 0;
+	return;
+}
+
+static void SoftI2CModel_Start(void)
+{
+	SoftI2CModel_Deliver();
+	SoftI2CModelCounters.Starts++;
+	SoftI2CModelState = SOFTI2CMODEL_STATE_ADDRESS;
+	SoftI2CModelBit = 0;
+	SoftI2CModelByte = 0;
+	SoftI2CModelPull = 0;
+	return;
+}
+
+static void SoftI2CModel_Stop(void)
+{
+	SoftI2CModel_Deliver();
+	SoftI2CModelCounters.Stops++;
+	SoftI2CModelState = SOFTI2CMODEL_STATE_IDLE;
+	SoftI2CModelPull = 0;
+	return;
+}
+
+//The address is not the SHT25's, look for an added device. Returns 1 to ack it.
+static uint8_t SoftI2CModel_ReceivedAddress(uint8_t Data)
+{
+	SoftI2CModelDevice *Device;
+	uint8_t i;
+
+	for(i = 0; i < SoftI2CModelDeviceCount; i++)
+	{
+		Device = &SoftI2CModelDevices[i];
+		if(Device->Address != (Data >> 1))
+		{
+			continue;
+		}
+
+		SoftI2CModelAddressed = i;
+		if(Data & 0x01)
+		{
+			SoftI2CModelIndex = 0;
+			memset(SoftI2CModelBuffer, (Device->Pointer == Device->Register) ? Device->Value : 0x00, sizeof(SoftI2CModelBuffer));
+			SoftI2CModelNext = SOFTI2CMODEL_STATE_READ;
+		}
+		else
+		{
+			SoftI2CModelNext = SOFTI2CMODEL_STATE_WRITE;
+		}
+		return 1;
+	}
+	SoftI2CModelNext = SOFTI2CMODEL_STATE_IGNORE;
+	return 0;
+}
+
+//A byte came from the master. Returns 1 to ack it.
+static uint8_t SoftI2CModel_Received(uint8_t Data)
+{
+	uint8_t Ack;
+
+	if(SoftI2CModelState == SOFTI2CMODEL_STATE_WRITE)
+	{
+		if(SoftI2CModelLength < sizeof(SoftI2CModelBuffer))
+		{
+			SoftI2CModelBuffer[SoftI2CModelLength++] = Data;
+		}
+		SoftI2CModelNext = SOFTI2CMODEL_STATE_WRITE;
+		return 1;
+	}
+
+	if((Data >> 1) != SHT25MODEL_ADDRESS)
+	{
+		return SoftI2CModel_ReceivedAddress(Data);
+	}
+	SoftI2CModelAddressed = SOFTI2CMODEL_SHT25;
+	if(Data & 0x01)
+	{
+		SoftI2CModelIndex = 0;
+		Ack = (SHT25Model_Read(SoftI2CModelBuffer, sizeof(SoftI2CModelBuffer)) == 0);
+		SoftI2CModelNext = Ack ? SOFTI2CMODEL_STATE_READ : SOFTI2CMODEL_STATE_IGNORE;
+	}
+	else
+	{
+		Ack = (SHT25Model_Write(NULL, 0) == 0);
+		SoftI2CModelNext = Ack ? SOFTI2CMODEL_STATE_WRITE : SOFTI2CMODEL_STATE_IGNORE;
+	}
+	return Ack;
+}
+
+//Put bit n of the byte being read on SDA
+static void SoftI2CModel_Send(uint8_t Bit)
+{
+	SoftI2CModelPull = ((SoftI2CModelBuffer[SoftI2CModelIndex % sizeof(SoftI2CModelBuffer)] << Bit) & 0x80) == 0;
+	return;
+}
+
+static void SoftI2CModel_Rising(uint8_t Sda)
+{
+	switch(SoftI2CModelState)
+	{
+		case SOFTI2CMODEL_STATE_ADDRESS:
+		case SOFTI2CMODEL_STATE_WRITE:
+			if(SoftI2CModelBit < 8)
+			{
+				SoftI2CModelByte = (SoftI2CModelByte << 1) | Sda;
+			}
+			SoftI2CModelBit++;
+			break;
+
+		case SOFTI2CMODEL_STATE_READ:
+			if(SoftI2CModelBit == 8)
+			{
+				SoftI2CModelMasterNack = Sda;
+			}
+			SoftI2CModelBit++;
+			break;
+	}
+	return;
+}
+
+static void SoftI2CModel_Falling(void)
+{
+	if(SoftI2CModelStretchNext > 0)
+	{
+		SoftI2CModelStretchLeft = SoftI2CModelStretchNext;
+		SoftI2CModelStretchNext = 0;
+	}
+
+	switch(SoftI2CModelState)
+	{
+		case SOFTI2CMODEL_STATE_ADDRESS:
+		case SOFTI2CMODEL_STATE_WRITE:
+			if(SoftI2CModelBit == 8)
+			{
+				SoftI2CModelCounters.Bytes++;
+				SoftI2CModelPull = SoftI2CModel_Received(SoftI2CModelByte);
+				SoftI2CModelCounters.Nacks += !SoftI2CModelPull;
+			}
+			else if(SoftI2CModelBit == 9)
+			{
+				SoftI2CModelPull = 0;
+				SoftI2CModelBit = 0;
+				SoftI2CModelByte = 0;
+				SoftI2CModelState = SoftI2CModelNext;
+				if(SoftI2CModelState == SOFTI2CMODEL_STATE_READ)
+				{
+					SoftI2CModel_Send(0);
+				}
+			}
+			break;
+
+		case SOFTI2CMODEL_STATE_READ:
+			if(SoftI2CModelBit < 8)
+			{
+				SoftI2CModel_Send(SoftI2CModelBit);
+			}
+			else if(SoftI2CModelBit == 8)
+			{
+				//The master acks
+				SoftI2CModelCounters.Bytes++;
+				SoftI2CModelPull = 0;
+			}
+			else
+			{
+				SoftI2CModelBit = 0;
+				if(SoftI2CModelMasterNack)
+				{
+					SoftI2CModelCounters.Nacks++;
+					SoftI2CModelState = SOFTI2CMODEL_STATE_IGNORE;
+				}
+				else
+				{
+					SoftI2CModelIndex++;
+					SoftI2CModel_Send(0);
+				}
+			}
+			break;
+	}
+	return;
+}
+
+void SoftI2CModel_Update(void)
+{
+	uint8_t Scl;
+	uint8_t Sda;
+	uint8_t MasterSda;
+
+	Scl = SoftI2CModel_Master(I2C_SCL_DDR, I2C_SCL_PORT, I2C_SCL_PIN_NUM) && (SoftI2CModelStretchLeft == 0);
+	MasterSda = SoftI2CModel_Master(I2C_SDA_DDR, I2C_SDA_PORT, I2C_SDA_PIN_NUM) && !SoftI2CModelHold;
+	Sda = MasterSda && !SoftI2CModelPull;
+
+	//SDA only changes while SCL is low, except for a start or a stop
+	if(Scl != SoftI2CModelScl)
+	{
+		SoftI2CModelScl = Scl;
+		if(Scl)
+		{
+			SoftI2CModel_Rising(Sda);
+		}
+		else
+		{
+			SoftI2CModel_Falling();
+			Sda = MasterSda && !SoftI2CModelPull;
+		}
+	}
+	else if(Scl && (Sda != SoftI2CModelSda))
+	{
+		if(Sda)
+		{
+			SoftI2CModel_Stop();
+		}
+		else
+		{
+			SoftI2CModel_Start();
+		}
+	}
+	SoftI2CModelSda = Sda;
+
+	I2C_SCL_PIN = (I2C_SCL_PIN & ~(1<<I2C_SCL_PIN_NUM)) | (Scl << I2C_SCL_PIN_NUM);
+	I2C_SDA_PIN = (I2C_SDA_PIN & ~(1<<I2C_SDA_PIN_NUM)) | (Sda << I2C_SDA_PIN_NUM);
+	return;
+}
+
+//Half a bit time passes
+static void SoftI2CModel_Pass(void)
+{
+	SoftI2CModelCounters.Ticks++;
+	if(SoftI2CModelStretchLeft > 0)
+	{
+		SoftI2CModelStretchLeft--;
+		SoftI2CModelCounters.StretchTicks++;
+	}
+	SoftI2CModel_Update();
+	return;
+}
+
+void SoftI2CModel_Tick(void)
+{
+	SoftI2CModelCounts += SOFTI2CMODEL_COUNTS_PER_MS;
+	while(((TCCR1B & 0x07) != 0) && ((TIMSK1 & (1<<OCIE1A)) != 0) && (SoftI2CModelCounts > OCR1A))
+	{
+		SoftI2CModelCounts -= (uint32_t)OCR1A + 1;
+		SoftI2CModel_Pass();
+		TIMER1_COMPA_vect();
+	}
+	if((TCCR1B & 0x07) == 0)
+	{
+		SoftI2CModelCounts = 0;
+	}
+	else if(((TIMSK1 & (1<<OCIE1A)) == 0) && (SoftI2CModelCounts > OCR1A))
+	{
+		//The compare flag only holds one tick while the interrupt is masked
+		SoftI2CModelCounts = (uint32_t)OCR1A + 1;
+	}
+	SoftI2CModel_Update();
+	return;
+}
+
+uint8_t SoftI2CModel_BitDue(void)
+{
+	SoftI2CModel_Pass();
+	return 1;
+}
+
+/** @} */
@@ -0,0 +1,89 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Model of the I2C bus wires for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	Board/SoftI2C.c runs unchanged on the host. After each of its ticks the
+*	model works out the levels of SCL (PB7) and SDA (PC6) from the port
+*	registers and the devices, puts them in PINB and PINC, and follows the
+*	protocol on the edges. A device that is addressed gets the bytes written
+*	at the stop or repeated start, and the bytes it sends are asked for when
+*	its address is read. The SHT25 model is always on the bus, and simple
+*	devices with an ID register can be added for the scan tests. Other
+*	addresses are not acked, like an empty bus.
+*
+*	Timer 1 is run by SoftI2CModel_Tick() from Device_RunMS(): each
+*	millisecond the compare interrupt is called as many times as the timer
+*	would fire. A blocking SoftI2C_Transfer() gets its ticks from
+*	SoftI2CModel_BitDue(), which the host build uses for the compare flag.
+*
+*	@{
+*/
+
+#ifndef _SOFTI2CMODEL_H_
+#define _SOFTI2CMODEL_H_
+
+#include <stdint.h>
+
+#define SOFTI2CMODEL_COUNTS_PER_MS		8000	//Timer 1 at 8MHz with no prescaler
+#define SOFTI2CMODEL_DEVICES			4		//Devices that can be added
+
+/** Counters kept by the model. */
+typedef struct
+{
+	uint32_t Ticks;					//Half bit times that have passed
+	uint32_t Starts;				//Including repeated starts
+	uint32_t Stops;
+	uint32_t Bytes;					//Bytes sent either way, with the address
+	uint32_t Nacks;					//Bytes that were not acked, by either side
+	uint32_t DrivenHigh;			//Updates where the master drove a line high instead of letting it go
+	uint32_t StretchTicks;			//Ticks SCL was held low by the model
+} SoftI2CModelStats;
+
+/** Let go of the lines, forget any transfer and clear the counters. */
+void SoftI2CModel_Reset(void);
+
+/** Get the counters. */
+const SoftI2CModelStats *SoftI2CModel_Stats(void);
+
+/** Add a device at Address. The first byte written to it picks a register, and reading it sends
+*	Value if that was Register and 0x00 if not. Returns 1 if there is no room.
+*/
+uint8_t SoftI2CModel_AddDevice(uint8_t Address, uint8_t Register, uint8_t Value);
+
+/** Hold SCL low for Ticks half bits after the next falling edge, like a device stretching the clock. */
+void SoftI2CModel_Stretch(uint16_t Ticks);
+
+/** Hold SDA low, like another master or a stuck device, or let it go. */
+void SoftI2CModel_HoldSda(uint8_t Hold);
+
+/** Work out the line levels after the port registers changed. */
+void SoftI2CModel_Update(void);
+
+/** One millisecond passes: run the timer 1 compare interrupt while the timer runs. */
+void SoftI2CModel_Tick(void);
+
+/** One half bit passes for a blocking transfer. Always returns 1, the compare flag is set. */
+uint8_t SoftI2CModel_BitDue(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,328 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Host replacements for LUFA, main.c and the common modules.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <stdlib.h>
+#include "main.h"
+#include "HAL.h"
+
+#define STUBS_OUTPUT_SIZE			8192
+#define STUBS_INPUT_SIZE			256
+#define STUBS_MAX_ARGS				10
+
+//Defined in main.c on the device
+USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface;
+uint8_t DataRecoderActive;
+
+uint8_t HAL_BootloaderJumps;
+
+static char ConsoleOutput[STUBS_OUTPUT_SIZE];
+static uint16_t ConsoleOutputLength;
+static char ConsoleInput[STUBS_INPUT_SIZE];
+static uint16_t ConsoleInputHead;
+static uint16_t ConsoleInputTail;
+
+//Command interpreter state
+static char CommandLine[STUBS_INPUT_SIZE];
+static uint16_t CommandLineLength;
+static uint8_t CommandLineReady;
+static char *CommandArgs[STUBS_MAX_ARGS];
+static uint8_t CommandArgCount;
+static uint8_t CommandEcho;
+
+void Stubs_Reset(void)
+{
+	ConsoleOutputLength = 0;
+	ConsoleOutput[0] = 0;
+	ConsoleInputHead = 0;
+	ConsoleInputTail = 0;
+	CommandLineLength = 0;
+	CommandLineReady = 0;
+	CommandArgCount = 0;
+	CommandEcho = 1;
+	HAL_BootloaderJumps = 0;
+	DataRecoderActive = 0;
+	return;
+}
+
+/****************************************************************
+*	Console
+****************************************************************/
+
+static int16_t Console_GetChar(void)
+{
+	if(ConsoleInputHead == ConsoleInputTail)
+	{
+		return -1;
+	}
+	return (uint8_t)ConsoleInput[ConsoleInputTail++];
+}
+
+void Console_PutChar(char c)
+{
+	if(ConsoleOutputLength < (STUBS_OUTPUT_SIZE - 1))
+	{
+		ConsoleOutput[ConsoleOutputLength++] = c;
+		ConsoleOutput[ConsoleOutputLength] = 0;
+	}
+	return;
+}
+
+//Fails like a USB timeout when the output buffer is full
+uint8_t Console_Write(const void *Data, uint16_t Length)
+{
+	const char *Bytes = Data;
+
+	if((ConsoleOutputLength + Length) >= STUBS_OUTPUT_SIZE)
+	{
+		return 1;
+	}
+	while(Length-- > 0)
+	{
+		Console_PutChar(*Bytes++);
+	}
+	return 0;
+}
+
+void HAL_ConsoleInput(const char *Text)
+{
+	//Move what is left to the start so the buffer does not run out
+	memmove(ConsoleInput, &ConsoleInput[ConsoleInputTail], ConsoleInputHead - ConsoleInputTail);
+	ConsoleInputHead -= ConsoleInputTail;
+	ConsoleInputTail = 0;
+
+	while((*Text != 0) && (ConsoleInputHead < STUBS_INPUT_SIZE))
+	{
+		ConsoleInput[ConsoleInputHead++] = *Text++;
+	}
+	return;
+}
+
+const char *HAL_ConsoleOutput(void)
+{
+	return ConsoleOutput;
+}
+
+uint16_t HAL_ConsoleOutputLength(void)
+{
+	return ConsoleOutputLength;
+}
+
+void HAL_ConsoleClear(void)
+{
+	ConsoleOutputLength = 0;
+	ConsoleOutput[0] = 0;
+	return;
+}
+
+/****************************************************************
+*	LUFA
+****************************************************************/
+
+void USB_Init(void)
+{
+	return;
+}
+
+void USB_USBTask(void)
+{
+	return;
+}
+
+int16_t CDC_Device_ReceiveByte(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo)
+{
+	return Console_GetChar();
+}
+
+uint8_t CDC_Device_SendByte(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo, uint8_t Data)
+{
+	Console_PutChar(Data);
+	return 0;
+}
+
+uint8_t CDC_Device_SendData(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo, const void *Buffer, uint16_t Length)
+{
+	const char *Data = Buffer;
+
+	while(Length-- > 0)
+	{
+		Console_PutChar(*Data++);
+	}
+	return 0;
+}
+
+uint8_t CDC_Device_Flush(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo)
+{
+	return 0;
+}
+
+void CDC_Device_USBTask(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo)
+{
+	return;
+}
+
+void CDC_Device_CreateStream(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo, FILE *Stream)
+{
+	return;
+}
+
+bool CDC_Device_ConfigureEndpoints(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo)
+{
+	return true;
+}
+
+void CDC_Device_ProcessControlRequest(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo)
+{
+	return;
+}
+
+/****************************************************************
+*	Common modules
+****************************************************************/
+
+void Jump_To_Bootloader(void)
+{
+	HAL_BootloaderJumps++;
+	return;
+}
+
+uint16_t StackCount(void)
+{
+	return 0;
+}
+
+int HAL_RunCommandLine(const char *Line)
+{
+	static char Buffer[STUBS_INPUT_SIZE];
+	const char *Prefix;
+	char *Token;
+	int16_t i;
+
+	strncpy(Buffer, Line, sizeof(Buffer) - 1);
+	Buffer[sizeof(Buffer) - 1] = 0;
+
+	CommandArgCount = 0;
+	for(Token = strtok(Buffer, " \r\n"); (Token != NULL) && (CommandArgCount < STUBS_MAX_ARGS); Token = strtok(NULL, " \r\n"))
+	{
+		CommandArgs[CommandArgCount++] = Token;
+	}
+	if(CommandArgCount == 0)
+	{
+		return -1;
+	}
+
+	i = CmdTrie_Find(CommandArgs[0], strlen(CommandArgs[0]));
+	if(i == CMDTRIE_BUILTIN)
+	{
+		//help lists the commands, or the ones starting with the argument
+		Prefix = (CommandArgCount > 1) ? CommandArgs[1] : "";
+		return (CmdTrie_Help(Prefix, strlen(Prefix)) > 0) ? 0 : -1;
+	}
+	if((i >= 0) && (i < NumCommands))
+	{
+		if(((CommandArgCount - 1) < AppCommandList[i].MinArgs) || ((CommandArgCount - 1) > AppCommandList[i].MaxArgs))
+		{
+			return -1;
+		}
+		return AppCommandList[i].Function();
+	}
+	return -1;
+}
+
+void Console_Echo(uint8_t Enable)
+{
+	CommandEcho = (Enable != 0);
+	return;
+}
+
+void CommandGetInputChar(uint8_t c)
+{
+	if(CommandLineReady)
+	{
+		//Ignored until RunCommand() has run the last line
+		return;
+	}
+
+	//The interpreter in common/ echoes what it gets unless Console_Echo() turned it off
+	if(CommandEcho)
+	{
+		Console_PutChar(((c == '\r') || (c == '\n')) ? '\n' : c);
+	}
+
+	if((c == '\r') || (c == '\n'))
+	{
+		CommandLine[CommandLineLength] = 0;
+		CommandLineReady = 1;
+	}
+	else if(CommandLineLength < (STUBS_INPUT_SIZE - 1))
+	{
+		CommandLine[CommandLineLength++] = c;
+	}
+	return;
+}
+
+const char *HAL_CommandLine(void)
+{
+	return CommandLine;
+}
+
+void RunCommand(void)
+{
+	if(CommandLineReady)
+	{
+		HAL_RunCommandLine(CommandLine);
+		CommandLineLength = 0;
+		CommandLineReady = 0;
+	}
+	return;
+}
+
+int argAsInt(uint8_t ArgNumber)
+{
+	if(ArgNumber >= CommandArgCount)
+	{
+		return 0;
+	}
+	return atoi(CommandArgs[ArgNumber]);
+}
+
+void argAsChar(uint8_t ArgNumber, char *ArgString)
+{
+	if(ArgNumber >= CommandArgCount)
+	{
+		ArgString[0] = 0;
+		return;
+	}
+	strcpy(ArgString, CommandArgs[ArgNumber]);
+	return;
+}
+
+char WaitForAnyKey(void)
+{
+	int16_t c = Console_GetChar();
+
+	return (c < 0) ? 0 : (char)c;
+}
+
+/** @} */
@@ -0,0 +1,43 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		LUFA board LED driver replacement for host builds.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#ifndef _HOST_LUFA_LEDS_H_
+#define _HOST_LUFA_LEDS_H_
+
+#include <stdint.h>
+
+#define LEDS_LED1				0x01
+#define LEDS_LED2				0x02
+#define LEDS_LED3				0x04
+#define LEDS_LED4				0x08
+#define LEDS_ALL_LEDS			0x0F
+#define LEDS_NO_LEDS			0x00
+
+#define LEDs_Init()
+#define LEDs_SetAllLEDs(Mask)
+
+#endif
+
+/** @} */
@@ -0,0 +1,82 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		LUFA USB stack replacement for host builds.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	Only the parts the application uses are here. The CDC functions read from
+*	and write to the host console in host/Stubs.c.
+*
+*	@{
+*/
+
+#ifndef _HOST_LUFA_USB_H_
+#define _HOST_LUFA_USB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define ENDPOINT_DIR_IN					0x80
+#define ENDPOINT_DIR_OUT				0x00
+
+#define ATTR_WARN_UNUSED_RESULT
+#define ATTR_NON_NULL_PTR_ARG(...)
+
+//Descriptor types are only used as members of the configuration descriptor
+typedef struct { uint8_t Unused; } USB_Descriptor_Configuration_Header_t;
+typedef struct { uint8_t Unused; } USB_Descriptor_Interface_t;
+typedef struct { uint8_t Unused; } USB_CDC_Descriptor_FunctionalHeader_t;
+typedef struct { uint8_t Unused; } USB_CDC_Descriptor_FunctionalACM_t;
+typedef struct { uint8_t Unused; } USB_CDC_Descriptor_FunctionalUnion_t;
+typedef struct { uint8_t Unused; } USB_Descriptor_Endpoint_t;
+
+typedef struct
+{
+	uint8_t  Address;
+	uint16_t Size;
+	uint8_t  Banks;
+} USB_Endpoint_Table_t;
+
+typedef struct
+{
+	struct
+	{
+		uint8_t ControlInterfaceNumber;
+		USB_Endpoint_Table_t DataINEndpoint;
+		USB_Endpoint_Table_t DataOUTEndpoint;
+		USB_Endpoint_Table_t NotificationEndpoint;
+	} Config;
+} USB_ClassInfo_CDC_Device_t;
+
+void USB_Init(void);
+void USB_USBTask(void);
+
+int16_t CDC_Device_ReceiveByte(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo);
+uint8_t CDC_Device_SendByte(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo, uint8_t Data);
+uint8_t CDC_Device_SendData(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo, const void *Buffer, uint16_t Length);
+uint8_t CDC_Device_Flush(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo);
+void CDC_Device_USBTask(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo);
+void CDC_Device_CreateStream(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo, FILE *Stream);
+bool CDC_Device_ConfigureEndpoints(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo);
+void CDC_Device_ProcessControlRequest(USB_ClassInfo_CDC_Device_t *CDCInterfaceInfo);
+
+#endif
+
+/** @} */
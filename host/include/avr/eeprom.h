@@ -0,0 +1,47 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		EEPROM access for host builds.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	EEMEM variables are normal variables on the host, so the EEPROM functions
+*	copy to and from them. HAL_EEPROMWrites counts the bytes that would have
+*	been written, so tests can check the wear caused by a change.
+*
+*	@{
+*/
+
+#ifndef _HOST_AVR_EEPROM_H_
+#define _HOST_AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define EEMEM
+
+void eeprom_read_block(void *Destination, const void *Source, size_t Length);
+void eeprom_write_block(const void *Source, void *Destination, size_t Length);
+void eeprom_update_block(const void *Source, void *Destination, size_t Length);
+uint8_t eeprom_read_byte(const uint8_t *Address);
+void eeprom_write_byte(uint8_t *Address, uint8_t Value);
+void eeprom_update_byte(uint8_t *Address, uint8_t Value);
+
+#endif
+
+/** @} */
@@ -0,0 +1,46 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Interrupt handling for host builds.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	ISR() defines a normal function with the vector name, so tests call
+*	TIMER0_COMPA_vect() to run the handler. cli() and sei() change the I bit of
+*	the host SREG, so critical sections can be checked.
+*
+*	@{
+*/
+
+#ifndef _HOST_AVR_INTERRUPT_H_
+#define _HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR(Vector, ...)		void Vector(void); void Vector(void)
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+
+#define sei()					do { SREG |= (1<<SREG_I); } while(0)
+#define cli()					do { SREG &= ~(1<<SREG_I); } while(0)
+#define reti()
+
+#endif
+
+/** @} */
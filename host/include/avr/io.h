@@ -0,0 +1,221 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		ATmega32U2 registers for host builds.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	Every IO register is a variable in host/HAL.c, so code that reads and writes
+*	registers compiles and runs unchanged. Nothing happens when a register is
+*	written, tests set and check the values themselves. The 16-bit timer
+*	registers are stored as one word, with the high and low halves mapped on
+*	to it the way the AVR does.
+*
+*	@{
+*/
+
+#ifndef _HOST_AVR_IO_H_
+#define _HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+#define _BV(bit)				(1 << (bit))
+
+//8-bit IO registers, HOST_REGISTER is defined by the includer
+#define HOST_REGISTERS(HOST_REGISTER)										\
+	HOST_REGISTER(PINB)		HOST_REGISTER(DDRB)		HOST_REGISTER(PORTB)	\
+	HOST_REGISTER(PINC)		HOST_REGISTER(DDRC)		HOST_REGISTER(PORTC)	\
+	HOST_REGISTER(PIND)		HOST_REGISTER(DDRD)		HOST_REGISTER(PORTD)	\
+	HOST_REGISTER(TIFR0)	HOST_REGISTER(TIFR1)	HOST_REGISTER(PCIFR)	\
+	HOST_REGISTER(EIFR)		HOST_REGISTER(EIMSK)	HOST_REGISTER(GPIOR0)	\
+	HOST_REGISTER(GPIOR1)	HOST_REGISTER(GPIOR2)	HOST_REGISTER(GTCCR)	\
+	HOST_REGISTER(TCCR0A)	HOST_REGISTER(TCCR0B)	HOST_REGISTER(TCNT0)	\
+	HOST_REGISTER(OCR0A)	HOST_REGISTER(OCR0B)	HOST_REGISTER(SPCR)		\
+	HOST_REGISTER(SPSR)		HOST_REGISTER(SPDR)		HOST_REGISTER(ACSR)		\
+	HOST_REGISTER(MCUSR)	HOST_REGISTER(MCUCR)	HOST_REGISTER(SMCR)		\
+	HOST_REGISTER(WDTCSR)	HOST_REGISTER(CLKPR)	HOST_REGISTER(PRR0)		\
+	HOST_REGISTER(PRR1)		HOST_REGISTER(OSCCAL)	HOST_REGISTER(PCICR)	\
+	HOST_REGISTER(EICRA)	HOST_REGISTER(EICRB)	HOST_REGISTER(PCMSK0)	\
+	HOST_REGISTER(PCMSK1)	HOST_REGISTER(TIMSK0)	HOST_REGISTER(TIMSK1)	\
+	HOST_REGISTER(TCCR1A)	HOST_REGISTER(TCCR1B)	HOST_REGISTER(TCCR1C)	\
+	HOST_REGISTER(UCSR1A)	HOST_REGISTER(UCSR1B)	HOST_REGISTER(UCSR1C)	\
+	HOST_REGISTER(UDR1)		HOST_REGISTER(SREG)
+
+//16-bit IO registers
+#define HOST_REGISTERS16(HOST_REGISTER)										\
+	HOST_REGISTER(TCNT1)	HOST_REGISTER(ICR1)		HOST_REGISTER(OCR1A)	\
+	HOST_REGISTER(OCR1B)	HOST_REGISTER(OCR1C)	HOST_REGISTER(UBRR1)
+
+#define HOST_DECLARE_REGISTER(Name)		extern volatile uint8_t Name;
+#define HOST_DECLARE_REGISTER16(Name)	extern volatile uint16_t Name;
+HOST_REGISTERS(HOST_DECLARE_REGISTER)
+HOST_REGISTERS16(HOST_DECLARE_REGISTER16)
+
+#define HOST_LOW_BYTE(Reg)		(((volatile uint8_t *)&(Reg))[0])
+#define HOST_HIGH_BYTE(Reg)		(((volatile uint8_t *)&(Reg))[1])
+
+#define TCNT1L		HOST_LOW_BYTE(TCNT1)
+#define TCNT1H		HOST_HIGH_BYTE(TCNT1)
+#define ICR1L		HOST_LOW_BYTE(ICR1)
+#define ICR1H		HOST_HIGH_BYTE(ICR1)
+#define OCR1AL		HOST_LOW_BYTE(OCR1A)
+#define OCR1AH		HOST_HIGH_BYTE(OCR1A)
+#define OCR1BL		HOST_LOW_BYTE(OCR1B)
+#define OCR1BH		HOST_HIGH_BYTE(OCR1B)
+#define OCR1CL		HOST_LOW_BYTE(OCR1C)
+#define OCR1CH		HOST_HIGH_BYTE(OCR1C)
+
+//Port pins
+#define PB0		0
+#define PB1		1
+#define PB2		2
+#define PB3		3
+#define PB4		4
+#define PB5		5
+#define PB6		6
+#define PB7		7
+#define PC0		0
+#define PC1		1
+#define PC2		2
+#define PC4		4
+#define PC5		5
+#define PC6		6
+#define PC7		7
+#define PD0		0
+#define PD1		1
+#define PD2		2
+#define PD3		3
+#define PD4		4
+#define PD5		5
+#define PD6		6
+#define PD7		7
+
+//TIFR0, TIMSK0, TCCR0A, TCCR0B
+#define TOV0	0
+#define OCF0A	1
+#define OCF0B	2
+#define TOIE0	0
+#define OCIE0A	1
+#define OCIE0B	2
+#define WGM00	0
+#define WGM01	1
+#define COM0B0	4
+#define COM0B1	5
+#define COM0A0	6
+#define COM0A1	7
+#define CS00	0
+#define CS01	1
+#define CS02	2
+#define WGM02	3
+#define FOC0B	6
+#define FOC0A	7
+
+//TIFR1, TIMSK1, TCCR1A, TCCR1B
+#define TOV1	0
+#define OCF1A	1
+#define OCF1B	2
+#define OCF1C	3
+#define ICF1	5
+#define TOIE1	0
+#define OCIE1A	1
+#define OCIE1B	2
+#define OCIE1C	3
+#define ICIE1	5
+#define WGM10	0
+#define WGM11	1
+#define COM1C0	2
+#define COM1C1	3
+#define COM1B0	4
+#define COM1B1	5
+#define COM1A0	6
+#define COM1A1	7
+#define CS10	0
+#define CS11	1
+#define CS12	2
+#define WGM12	3
+#define WGM13	4
+#define ICES1	6
+#define ICNC1	7
+
+//External and pin change interrupts
+#define INT0	0
+#define INT1	1
+#define INT2	2
+#define INT3	3
+#define INT4	4
+#define INT5	5
+#define INT6	6
+#define INT7	7
+#define INTF0	0
+#define INTF1	1
+#define INTF2	2
+#define INTF3	3
+#define INTF4	4
+#define INTF5	5
+#define INTF6	6
+#define INTF7	7
+#define ISC00	0
+#define ISC01	1
+#define ISC10	2
+#define ISC11	3
+#define ISC20	4
+#define ISC21	5
+#define ISC30	6
+#define ISC31	7
+#define ISC40	0
+#define ISC41	1
+#define ISC50	2
+#define ISC51	3
+#define ISC60	4
+#define ISC61	5
+#define ISC70	6
+#define ISC71	7
+#define PCIE0	0
+#define PCIE1	1
+#define PCIF0	0
+#define PCIF1	1
+
+//SPI
+#define SPR0	0
+#define SPR1	1
+#define CPHA	2
+#define CPOL	3
+#define MSTR	4
+#define DORD	5
+#define SPE		6
+#define SPIE	7
+#define SPI2X	0
+#define WCOL	6
+#define SPIF	7
+
+//MCUSR, MCUCR
+#define PORF	0
+#define EXTRF	1
+#define BORF	2
+#define WDRF	3
+#define USBRF	5
+#define IVCE	0
+#define IVSEL	1
+#define PUD		4
+
+//SREG
+#define SREG_I	7
+
+#endif
+
+/** @} */
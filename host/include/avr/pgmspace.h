@@ -0,0 +1,50 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Program memory access for host builds.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	On the host there is only one address space, so program memory is normal
+*	memory and the read functions are plain loads.
+*
+*	@{
+*/
+
+#ifndef _HOST_AVR_PGMSPACE_H_
+#define _HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)						(s)
+
+#define pgm_read_byte(Addr)			(*(const uint8_t *)(Addr))
+#define pgm_read_word(Addr)			(*(const uint16_t *)(Addr))
+#define pgm_read_dword(Addr)		(*(const uint32_t *)(Addr))
+#define pgm_read_ptr(Addr)			(*(void * const *)(Addr))
+
+#define memcpy_P					memcpy
+#define strlen_P					strlen
+#define strcmp_P					strcmp
+#define strncmp_P					strncmp
+
+#endif
+
+/** @} */
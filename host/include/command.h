@@ -0,0 +1,53 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Command interpreter interface, for host builds.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	The interpreter itself is in the common modules. host/Stubs.c has a simple
+*	version that splits a line into arguments and calls the handler from
+*	AppCommandList.
+*
+*	@{
+*/
+
+#ifndef _HOST_COMMAND_H_
+#define _HOST_COMMAND_H_
+
+#include <stdint.h>
+
+typedef struct
+{
+	const char *CommandString;
+	uint8_t MinArgs;
+	uint8_t MaxArgs;
+	int (*Function)(void);
+	const char *DescriptionString;
+	const char *HelpString;
+} CommandListItem;
+
+void CommandGetInputChar(uint8_t c);
+void RunCommand(void);
+int argAsInt(uint8_t ArgNumber);
+void argAsChar(uint8_t ArgNumber, char *ArgString);
+char WaitForAnyKey(void);
+
+#endif
+
+/** @} */
@@ -0,0 +1,64 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Host version of avr-libc util/crc16.h.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	These are the C equivalents given in the avr-libc documentation for the
+*	inline assembly versions.
+*
+*	@{
+*/
+
+#ifndef _HOST_UTIL_CRC16_H_
+#define _HOST_UTIL_CRC16_H_
+
+#include <stdint.h>
+
+//CRC-CCITT, polynomial 0x8408 (0x1021 reflected), usually started with 0xFFFF
+static inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data)
+{
+	data ^= crc & 0xFF;
+	data ^= data << 4;
+	return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+//XMODEM CRC, polynomial 0x1021, usually started with 0
+static inline uint16_t _crc_xmodem_update(uint16_t crc, uint8_t data)
+{
+	uint8_t i;
+
+	crc = crc ^ ((uint16_t)data << 8);
+	for(i = 0; i < 8; i++)
+	{
+		if(crc & 0x8000)
+		{
+			crc = (crc << 1) ^ 0x1021;
+		}
+		else
+		{
+			crc <<= 1;
+		}
+	}
+	return crc;
+}
+
+#endif
+
+/** @} */
@@ -0,0 +1,208 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Microbenchmarks for the host build.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	Two numbers are reported for each case. Host time is the PC time per call,
+*	which only means something compared to other runs on the same PC. LCD time
+*	comes from the HD44780 model and is the time the AVR spends in the LCD
+*	library per call, which is the same on every PC.
+*
+*	The log store case instead reports the SPI and busy time from the
+*	dataflash model, as the sustained rate records can be stored at. The
+*	sample codec case also reports the average encoded size of a sample.
+*
+*	@{
+*/
+
+#include <time.h>
+#include "Device.h"
+
+#define BENCH_RUNS			20000
+
+extern TimeAndDate TheTime;
+extern volatile uint16_t ElapsedMS;
+
+static void NullSink(char c)
+{
+	return;
+}
+
+static uint64_t Bench_Now(void)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return ((uint64_t)Now.tv_sec * 1000000000ULL) + Now.tv_nsec;
+}
+
+static void Bench_Report(const char *Name, uint64_t HostNS, uint32_t Runs)
+{
+	printf("%-28s %10.1f ns %10.1f us LCD\n", Name, (double)HostNS / Runs, (double)LCDModel_Stats()->BusTimeNS / 1000.0 / Runs);
+	return;
+}
+
+#define BENCH(Name, Runs, Setup, Code)								\
+	do																\
+	{																\
+		uint32_t _i;												\
+		uint64_t _Start;											\
+		uint64_t _Total = 0;										\
+		for(_i = 0; _i < (Runs); _i++)								\
+		{															\
+			Setup;													\
+			if(_i == 0)												\
+			{														\
+				LCDModel_ClearStats();								\
+			}														\
+			_Start = Bench_Now();									\
+			Code;													\
+			_Total += Bench_Now() - _Start;							\
+		}															\
+		Bench_Report((Name), _Total, (Runs));						\
+	} while(0)
+
+static uint32_t BenchTo;
+
+static uint8_t Bench_Visit(const uint8_t *Data, uint8_t Length)
+{
+	RecorderRecord Record;
+
+	memcpy(&Record, Data, sizeof(Record));
+	return Record.Seconds >= BenchTo;
+}
+
+//Recorder records appended over several laps of the chip, so erases are included
+static void Bench_LogStore(void)
+{
+	RecorderRecord Record;
+	const FlashModelStats *Stats = FlashModel_Stats();
+	uint32_t Records = 0;
+	double Seconds;
+
+	memset(&Record, 0, sizeof(Record));
+	FlashModel_Reset(0xFF);
+	LogStore_Init();
+	FlashModel_ClearStats();
+	while(Stats->Programs < (DATAFLASH_PAGES * 3))
+	{
+		Record.Seconds++;
+		LogStore_Append(&Record, sizeof(Record), Record.Seconds);
+		Records++;
+	}
+
+	Seconds = (double)Stats->TimeNS / 1e9;
+	printf("%-28s %10.1f us %10.0f B/s flash\n", "LogStore_Append", Seconds * 1e6 / Records, (Records * sizeof(Record)) / Seconds);
+
+	//100 records from the middle of the log
+	FlashModel_ClearStats();
+	BenchTo = Record.Seconds - 10000;
+	LogStore_Read(BenchTo - 100, Bench_Visit);
+	printf("%-28s %10.1f us flash\n", "LogStore_Read, 100 records", (double)Stats->TimeNS / 1000.0);
+
+	//Download, the console buffer only holds a few frames
+	FlashModel_ClearStats();
+	for(Records = 0; Records < 256; Records++)
+	{
+		HAL_ConsoleClear();
+		LogDump_Pages(Records, 1);
+	}
+	Seconds = (double)Stats->TimeNS / 1e9;
+	printf("%-28s %10.1f us %10.0f B/s flash\n", "LogDump_Pages, per page", Seconds * 1e6 / 256, (256.0 * DATAFLASH_PAGE_SIZE) / Seconds);
+	return;
+}
+
+//A slow walk on all channels every 250ms, like the recorder writes
+static void Bench_SampleCodec(void)
+{
+	RecorderRecord Record = {413202038, 0, RECORDER_ALL_CHANNELS, {1616, 2150, 4500}};
+	SampleCodecState Encoder;
+	uint8_t Out[SAMPLECODEC_MAX_SIZE];
+	uint32_t Bytes = 0;
+	uint32_t i;
+	uint64_t Start;
+	uint64_t Total = 0;
+
+	SampleCodec_Reset(&Encoder);
+	for(i = 0; i < BENCH_RUNS; i++)
+	{
+		Record.Milliseconds += 250;
+		if(Record.Milliseconds >= 1000)
+		{
+			Record.Milliseconds = 0;
+			Record.Seconds++;
+		}
+		Record.Value[i % RECORDER_CHANNELS] += (int16_t)(i % 5) - 2;
+
+		Start = Bench_Now();
+		Bytes += SampleCodec_Encode(&Encoder, &Record, (i % 40) == 0, Out);
+		SampleCodec_Next(&Encoder, &Record);
+		Total += Bench_Now() - Start;
+	}
+
+	//The AVR stores the record packed, without the host's padding
+	printf("%-28s %10.1f ns %10.2f B/sample, %d raw\n", "SampleCodec_Encode", (double)Total / BENCH_RUNS,
+		(double)Bytes / BENCH_RUNS, (int)(4 + 2 + 1 + 2 * RECORDER_CHANNELS));
+	return;
+}
+
+int main(void)
+{
+	RollingStats Stats;
+	uint16_t Value = 0;
+
+	Device_PowerOn(16, 2);
+	Device_RunMS(1000);
+
+	printf("%-28s %13s %16s\n", "case", "host", "device LCD");
+
+	BENCH("Format_UInt", BENCH_RUNS, Value += 7, Format_UInt(NullSink, Value, 5, ' '));
+	BENCH("Format_Fixed", BENCH_RUNS, Value += 7, Format_Fixed(NullSink, (int32_t)Value << 4, 4, 2));
+
+	//1ms interrupt when nothing else is due
+	BENCH("Timer 0 tick", BENCH_RUNS, ElapsedMS = 1, TIMER0_COMPA_vect());
+
+	//1ms interrupt that rolls the second and moves the rolling statistics on
+	BENCH("Timer 0 tick, new second", 1000, ElapsedMS = 999, TIMER0_COMPA_vect());
+
+	BENCH("BigClock_Start", 1000, , BigClock_Start(&TheTime));
+
+	//Drawing a menu item
+	INT5_vect();
+	Device_MainLoop();
+	BENCH("Menu draw", 1000, , Menu_Navigate(Menu_GetCurrentMenu()));
+
+	BENCH("Scheduler_Tick", BENCH_RUNS, , Scheduler_Tick());
+
+	//Pressure compensation, with the temperature terms cached and worked out each time
+	BENCH("MPL115A1_Compensate", BENCH_RUNS, Value += 7, MPL115A1_Compensate(Value & 0x3FF, 500));
+	BENCH("MPL115A1_Compensate, new T", BENCH_RUNS, Value += 7, MPL115A1_Compensate(Value & 0x3FF, 300 + (Value & 0xFF)));
+
+	//A reading through a median of 5 and an average into the rolling statistics, and the hour window put together
+	Filter_Configure(RECORDER_CHANNEL_PRESSURE, 5, 3);
+	BENCH("Recorder_SetValue, filtered", BENCH_RUNS, Value += 7, Recorder_SetValue(RECORDER_CHANNEL_PRESSURE, Value & 0x3FF));
+	BENCH("Rolling_Get", BENCH_RUNS, , Rolling_Get(RECORDER_CHANNEL_PRESSURE, ROLLING_WINDOW_HOUR, &Stats));
+
+	Bench_SampleCodec();
+	Bench_LogStore();
+	return 0;
+}
+
+/** @} */
@@ -0,0 +1,106 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Helpers for tests that run the firmware.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	Device_RunMS() runs the 1ms timer interrupt followed by one pass of the main
+*	loop for each millisecond, which is close enough to the device for the
+*	application logic. Interrupts only run when a test calls them, so code
+*	that waits for the timer, like DelayMS(), never returns. Models that keep
+*	time, like the sensors, are ticked with the timer, the I2C bus model
+*	runs the timer 1 interrupt for the bits of that millisecond and the SPI
+*	bus model runs the SPI interrupt for the bytes.
+*
+*	@{
+*/
+
+#ifndef _DEVICE_H_
+#define _DEVICE_H_
+
+#include "main.h"
+#include "HAL.h"
+#include "LCDModel.h"
+#include "FlashModel.h"
+#include "PressureModel.h"
+#include "SHT25Model.h"
+#include "SoftI2CModel.h"
+#include "SPIModel.h"
+
+/** Reset the registers and LCD and run HardwareInit(), like a power cycle. The EEPROM and dataflash are kept. */
+static inline void Device_PowerOn(uint8_t Columns, uint8_t Lines)
+{
+	HAL_Reset();
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, Columns, Lines);
+	LCDModel_SetBusHook(SPIModel_LcdBus);
+	SoftI2CModel_Reset();
+	SPIModel_Reset();
+	HardwareInit();
+	return;
+}
+
+/** One pass of the main loop in main.c. */
+static inline void Device_MainLoop(void)
+{
+	LineEdit_Run();
+	RunCommand();
+	HandleButtonPress();
+	Scheduler_Run();
+	Recorder_Run();
+	return;
+}
+
+static inline void Device_RunMS(uint32_t ms)
+{
+	while(ms-- > 0)
+	{
+		TIMER0_COMPA_vect();
+		SoftI2CModel_Tick();
+		SPIModel_Tick();
+		PressureModel_Tick();
+		SHT25Model_Tick();
+		Device_MainLoop();
+	}
+	return;
+}
+
+//Output of the Format_ functions for tests
+static char FormatBuffer[128];
+static uint8_t FormatLength;
+
+static inline void Format_ToBuffer(char c)
+{
+	if(FormatLength < (sizeof(FormatBuffer) - 1))
+	{
+		FormatBuffer[FormatLength++] = c;
+		FormatBuffer[FormatLength] = 0;
+	}
+	return;
+}
+
+static inline void Format_ClearBuffer(void)
+{
+	FormatLength = 0;
+	FormatBuffer[0] = 0;
+	return;
+}
+
+#endif
+
+/** @} */
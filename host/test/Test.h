@@ -0,0 +1,66 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Minimal test helpers for the host tests.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	Each test program includes this file once. CHECK() prints the failing
+*	expression and keeps going, TEST_DONE() returns the exit code for main().
+*
+*	@{
+*/
+
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include <stdio.h>
+
+static unsigned int TestChecks;
+static unsigned int TestFailures;
+
+#define CHECK(Expr)																	\
+	do																				\
+	{																				\
+		TestChecks++;																\
+		if(!(Expr))																	\
+		{																			\
+			TestFailures++;															\
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #Expr);			\
+		}																			\
+	} while(0)
+
+#define CHECK_EQ(Actual, Expected)													\
+	do																				\
+	{																				\
+		long _Actual = (long)(Actual);												\
+		long _Expected = (long)(Expected);											\
+		TestChecks++;																\
+		if(_Actual != _Expected)													\
+		{																			\
+			TestFailures++;															\
+			printf("%s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__, #Actual, _Actual, _Expected);	\
+		}																			\
+	} while(0)
+
+#define TEST_DONE()																	\
+	(printf("%s: %u checks, %u failed\n", __FILE__, TestChecks, TestFailures), (TestFailures != 0))
+
+#endif
+
+/** @} */
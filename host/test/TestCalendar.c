@@ -0,0 +1,179 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the calendar and the 1ms timer interrupt.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include "Device.h"
+#include "Test.h"
+
+extern TimeAndDate TheTime;
+
+static void TestLeapYear(void)
+{
+	CHECK_EQ(IsLeapYear(2012), 1);
+	CHECK_EQ(IsLeapYear(2013), 0);
+	CHECK_EQ(IsLeapYear(2000), 1);
+	CHECK_EQ(IsLeapYear(1900), 0);
+
+	CHECK_EQ(DaysPerMonth(1), 31);
+	CHECK_EQ(DaysPerMonth(2), 28);
+	CHECK_EQ(DaysPerMonth(4), 30);
+	CHECK_EQ(DaysPerMonth(11), 30);
+	CHECK_EQ(DaysPerMonth(12), 31);
+	return;
+}
+
+static void TestSetTime(void)
+{
+	TimeAndDate Time = {2013, 2, 3, 1, 10, 20, 30};
+	TimeAndDate Result;
+
+	SetTime(Time);
+	GetTime(&Result);
+	CHECK_EQ(Result.year, 2013);
+	CHECK_EQ(Result.month, 2);
+	CHECK_EQ(Result.day, 3);
+	CHECK_EQ(Result.hour, 10);
+	CHECK_EQ(Result.min, 20);
+	CHECK_EQ(Result.sec, 30);
+
+	//Out of range fields are ignored
+	Time.hour = 24;
+	Time.min = 60;
+	Time.month = 13;
+	SetTime(Time);
+	GetTime(&Result);
+	CHECK_EQ(Result.hour, 10);
+	CHECK_EQ(Result.min, 20);
+	CHECK_EQ(Result.month, 2);
+
+	//Day is checked against the month, with leap years
+	Time.year = 2012;
+	Time.month = 2;
+	Time.day = 29;
+	SetTime(Time);
+	GetTime(&Result);
+	CHECK_EQ(Result.day, 29);
+	Time.month = 4;
+	Time.day = 31;
+	SetTime(Time);
+	GetTime(&Result);
+	CHECK_EQ(Result.month, 4);
+	CHECK_EQ(Result.day, 29);
+	return;
+}
+
+static void TestTick(void)
+{
+	TimeAndDate Time = {2013, 2, 3, 1, 10, 59, 58};
+	TimeAndDate Result;
+
+	SetTime(Time);
+	Device_RunMS(999);
+	GetTime(&Result);
+	CHECK_EQ(Result.sec, 58);
+
+	Device_RunMS(1001);
+	GetTime(&Result);
+	CHECK_EQ(Result.sec, 0);
+	CHECK_EQ(Result.min, 0);
+	CHECK_EQ(Result.hour, 11);
+
+	//The idle screen shows the time
+	CHECK(LCDModel_LineIs(1, "") == 0);
+	return;
+}
+
+//Two seconds from 23:59:59 on a day, checks the date after
+static void CheckRollover(uint16_t Year, uint8_t Month, uint8_t Day, uint16_t NextYear, uint8_t NextMonth, uint8_t NextDay)
+{
+	TimeAndDate Time = {Year, Month, Day, 0, 23, 59, 59};
+	TimeAndDate Result;
+	uint32_t Seconds;
+
+	SetTime(Time);
+	GetTime(&Time);
+	Seconds = TimeToSeconds(&Time);
+	Device_RunMS(2000);
+	GetTime(&Result);
+	CHECK_EQ(Result.year, NextYear);
+	CHECK_EQ(Result.month, NextMonth);
+	CHECK_EQ(Result.day, NextDay);
+	CHECK_EQ(Result.hour, 0);
+	CHECK_EQ(Result.min, 0);
+	CHECK_EQ(Result.sec, 1);
+	CHECK_EQ(TimeToSeconds(&Result), Seconds + 2);
+	return;
+}
+
+static void TestRollover(void)
+{
+	//Hour 23 goes to 0 of the next day
+	CheckRollover(2013, 2, 3, 2013, 2, 4);
+
+	//Past the last day of the month is the 1st of the next
+	CheckRollover(2013, 4, 30, 2013, 5, 1);
+	CheckRollover(2013, 1, 31, 2013, 2, 1);
+	CheckRollover(2013, 2, 28, 2013, 3, 1);
+	CheckRollover(2012, 2, 28, 2012, 2, 29);
+	CheckRollover(2012, 2, 29, 2012, 3, 1);
+
+	//December goes to January of the next year
+	CheckRollover(2013, 12, 31, 2014, 1, 1);
+	return;
+}
+
+static void TestSeconds(void)
+{
+	TimeAndDate Time = {2000, 1, 1, 6, 0, 0, 0};
+
+	CHECK_EQ(TimeToSeconds(&Time), 0);
+	Time.sec = 59;
+	CHECK_EQ(TimeToSeconds(&Time), 59);
+
+	//2012 is a leap year
+	Time = (TimeAndDate){2012, 3, 1, 4, 0, 0, 0};
+	CHECK_EQ(TimeToSeconds(&Time), 383875200UL);
+	Time = (TimeAndDate){2013, 2, 3, 0, 10, 20, 30};
+	CHECK_EQ(TimeToSeconds(&Time), 413202030UL);
+
+	//The clock starts out cleared
+	Time = (TimeAndDate){0, 0, 0, 0, 0, 0, 0};
+	CHECK_EQ(TimeToSeconds(&Time), 0);
+	return;
+}
+
+int main(void)
+{
+	Device_PowerOn(16, 2);
+
+	TestLeapYear();
+	TestSetTime();
+	TestTick();
+	TestRollover();
+	TestSeconds();
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,165 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the command name trie and tab completion.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include "Device.h"
+#include "Test.h"
+
+static char Names[256];
+static uint8_t NameCount;
+
+static void Collect(const char *Name, uint8_t Command)
+{
+	strcat(Names, Name);
+	strcat(Names, " ");
+	NameCount++;
+	return;
+}
+
+static int16_t Find(const char *Name)
+{
+	return CmdTrie_Find(Name, strlen(Name));
+}
+
+static uint8_t Complete(const char *Prefix, char *Completion)
+{
+	return CmdTrie_Complete(Prefix, strlen(Prefix), Completion, LINEEDIT_LINE_SIZE);
+}
+
+static void Type(const char *Text)
+{
+	while(*Text != 0)
+	{
+		LineEdit_Input(*Text++);
+	}
+	return;
+}
+
+#define OUTPUT_IS(Text)		CHECK(strcmp(HAL_ConsoleOutput(), (Text)) == 0)
+
+int main(void)
+{
+	char Completion[LINEEDIT_LINE_SIZE];
+	uint8_t i;
+
+	Device_PowerOn(16, 2);
+
+	//Every command in the list is found at its own index
+	for(i = 0; i < NumCommands; i++)
+	{
+		CHECK_EQ(Find(AppCommandList[i].CommandString), i);
+	}
+	CHECK_EQ(Find("help"), CMDTRIE_BUILTIN);
+	CHECK_EQ(Find("lcd"), -1);
+	CHECK_EQ(Find("lcdclrx"), -1);
+	CHECK_EQ(Find("x"), -1);
+	CHECK_EQ(Find(""), -1);
+	CHECK_EQ(CmdTrie_Find("gettime now", 7), 4);
+
+	//Completion stops where names split
+	CHECK_EQ(Complete("lc", Completion), 3);
+	CHECK(strcmp(Completion, "d") == 0);
+	CHECK_EQ(Complete("lcdw", Completion), 1);
+	CHECK(strcmp(Completion, "rite") == 0);
+	CHECK_EQ(Complete("t", Completion), 3);
+	CHECK(strcmp(Completion, "") == 0);
+	CHECK_EQ(Complete("", Completion), NumCommands + 1);
+	CHECK_EQ(Complete("q", Completion), 0);
+	CHECK_EQ(Complete("bkl", Completion), 1);
+	CHECK(strcmp(Completion, "") == 0);
+	CHECK_EQ(CmdTrie_Complete("dfu", 1, Completion, 2), 1);
+	CHECK(strcmp(Completion, "f") == 0);
+
+	//Names come out in order
+	CmdTrie_ForEach("t", 1, Collect);
+	CHECK(strcmp(Names, "test trace twiscan ") == 0);
+	Names[0] = 0;
+	NameCount = 0;
+	CmdTrie_ForEach("lcdc", 4, Collect);
+	CHECK(strcmp(Names, "lcdclr ") == 0);
+	NameCount = 0;
+	CmdTrie_ForEach("", 0, Collect);
+	CHECK_EQ(NameCount, NumCommands + 1);
+
+	//Help with a prefix
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("help lcd"), 0);
+	CHECK(strstr(HAL_ConsoleOutput(), "lcdclr      clear the LCD\n") != NULL);
+	CHECK(strstr(HAL_ConsoleOutput(), "lcdgeo") != NULL);
+	CHECK(strstr(HAL_ConsoleOutput(), "lcdwrite") != NULL);
+	CHECK(strstr(HAL_ConsoleOutput(), "gettime") == NULL);
+	CHECK_EQ(HAL_RunCommandLine("help zz"), -1);
+
+	//Tab completes in the line editor
+	LineEdit_Init();
+	HAL_ConsoleClear();
+	Type("get\t");
+	OUTPUT_IS("gettime ");
+	Type("\r");
+	CHECK(strcmp(HAL_CommandLine(), "gettime ") == 0);
+	RunCommand();
+
+	HAL_ConsoleClear();
+	Type("lc\t");
+	OUTPUT_IS("lcd");
+	HAL_ConsoleClear();
+	Type("\t");
+	OUTPUT_IS("\r\nlcdclr  lcdgeo  lcdwrite  \r\n>lcd");
+	HAL_ConsoleClear();
+	Type("g\t");
+	OUTPUT_IS("geo ");
+
+	//Completing in the middle of a line keeps the rest
+	HAL_ConsoleClear();
+	Type("\x1B[H" "\x1B[C\x1B[C\x1B[C" "\x1B[3~\x1B[3~\x1B[3~" "w\t");
+	Type("\r");
+	CHECK(strcmp(HAL_CommandLine(), "lcdwrite ") == 0);
+	RunCommand();
+
+	//Arguments and unknown names ring the bell
+	HAL_ConsoleClear();
+	Type("bkl 2\t");
+	OUTPUT_IS("bkl 2\a");
+	Type("\x1B[H\x1B[F");
+	Type("\b\b\b\b\bzz\t");
+	CHECK(strchr(HAL_ConsoleOutput() + 6, '\a') != NULL);
+	Type("\r");
+	RunCommand();
+
+	//Help shows the descriptions of the matches
+	HAL_ConsoleClear();
+	Type("help t\t");
+	CHECK(strncmp(HAL_ConsoleOutput(), "help t\r\n", 8) == 0);
+	CHECK(strstr(HAL_ConsoleOutput(), "trace       Dump the event trace\n") != NULL);
+	CHECK(strstr(HAL_ConsoleOutput(), ">help t") != NULL);
+	HAL_ConsoleClear();
+	Type("w\t");
+	OUTPUT_IS("wiscan ");
+	Type("\r");
+	RunCommand();
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,141 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the console command handlers.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+#define OUTPUT_HAS(Text)		CHECK(strstr(HAL_ConsoleOutput(), (Text)) != NULL)
+
+static void TestTime(void)
+{
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("settime 2013 2 3 1 13 45 10"), 0);
+	OUTPUT_HAS("Setting 02/03/2013 13:45:10");
+
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("gettime"), 0);
+	OUTPUT_HAS("02/03/2013 13:45:10\n");
+
+	//Argument counts are checked
+	CHECK_EQ(HAL_RunCommandLine("settime 2013"), -1);
+	CHECK_EQ(HAL_RunCommandLine("nosuchcommand"), -1);
+	return;
+}
+
+static void TestConsoleInput(void)
+{
+	//Characters arrive from USB in the 1ms interrupt, one every 8ms
+	HAL_ConsoleClear();
+	HAL_ConsoleInput("gettime\r");
+	Device_RunMS(8 * 9);
+	OUTPUT_HAS("02/03/2013");
+	return;
+}
+
+static void TestLCDGeometry(void)
+{
+	uint32_t Writes;
+
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("lcdgeo"), 0);
+	OUTPUT_HAS("LCD: 16x2 HD44780");
+
+	//Invalid sizes are not saved
+	Writes = HAL_EEPROMWrites;
+	HAL_RunCommandLine("lcdgeo 41 2 0");
+	OUTPUT_HAS("Invalid LCD size");
+	CHECK_EQ(HAL_EEPROMWrites, Writes);
+
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("lcdgeo 20 4 0"), 0);
+	OUTPUT_HAS("LCD: 20x4 HD44780");
+	CHECK(HAL_EEPROMWrites > Writes);
+	CHECK_EQ(LCD_ADDRESS(0, 2), 0x14);
+	CHECK_EQ(LCD_ADDRESS(0, 3), 0x54);
+
+	//The new size is kept over a power cycle
+	Device_PowerOn(20, 4);
+	CHECK_EQ(LCDColumns, 20);
+	CHECK_EQ(LCDLines, 4);
+
+	HAL_RunCommandLine("lcdgeo 16 2 0");
+	Device_PowerOn(16, 2);
+	return;
+}
+
+static void TestBacklight(void)
+{
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("bkl 2 10"), 0);
+	OUTPUT_HAS("Level: 10, idle: 8, auto: 0");
+	Device_RunMS(BACKLIGHT_FADE_STEP_MS * (BACKLIGHT_MAX_LEVEL + 1));
+	CHECK_EQ(Backlight_Level(), 10);
+	CHECK((TIMSK0 & (1<<OCIE0B)) != 0);
+
+	//On from compare B to the end of the period, 11 of the 125 counts
+	CHECK_EQ(OCR0B, HARDWARE_TIMER_0_TOP_VALUE - 11);
+	TIMER0_COMPB_vect();
+	CHECK((PORTB & (1<<6)) != 0);
+	Device_RunMS(1);
+	CHECK_EQ(PORTB & (1<<6), 0);
+
+	HAL_RunCommandLine("bkl 0");
+	Device_RunMS(BACKLIGHT_FADE_STEP_MS * (BACKLIGHT_MAX_LEVEL + 1));
+	CHECK_EQ(Backlight_Level(), 0);
+	CHECK_EQ(PORTB & (1<<6), 0);
+	CHECK_EQ(TIMSK0 & (1<<OCIE0B), 0);
+
+	//Out of range levels are limited
+	HAL_RunCommandLine("bkl 2 200");
+	CHECK_EQ(Settings.BacklightLevel, BACKLIGHT_MAX_LEVEL);
+	return;
+}
+
+//Only the cancel path, the jump waits in DelayMS() for timer interrupts that do not run during a command here
+static void TestBootloader(void)
+{
+	HAL_ConsoleClear();
+	HAL_ConsoleInput("n");
+	HAL_RunCommandLine("dfu");
+	OUTPUT_HAS("Canceled");
+	CHECK_EQ(HAL_BootloaderJumps, 0);
+	return;
+}
+
+int main(void)
+{
+	Device_PowerOn(16, 2);
+
+	TestTime();
+	TestConsoleInput();
+	TestLCDGeometry();
+	TestBacklight();
+	TestBootloader();
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,232 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+/** \file
+*	\brief		Tests for the sensor channel filters.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+#define OUTPUT_HAS(Text)	CHECK(strstr(HAL_ConsoleOutput(), (Text)) != NULL)
+
+#define CHANNEL		RECORDER_CHANNEL_TEMPERATURE
+
+static void TestMedian(void)
+{
+	static const int16_t In[] =		{100, 100, 5000, 100, -3000, 100, 200, 200, 200, 200};
+	static const int16_t Out[] =	{100, 100,  100, 100,   100, 100, 100, 100, 200, 200};
+	int16_t Value;
+	uint8_t i;
+
+	Filter_Init();
+	CHECK_EQ(Filter_GetValue(CHANNEL, &Value), 1);
+
+	//Single spikes are removed and a step comes through whole, three readings late
+	CHECK_EQ(Filter_Configure(CHANNEL, 5, 0), 0);
+	for(i = 0; i < sizeof(In) / sizeof(In[0]); i++)
+	{
+		CHECK_EQ(Filter_Apply(CHANNEL, In[i]), Out[i]);
+	}
+	CHECK_EQ(Filter_GetValue(CHANNEL, &Value), 0);
+	CHECK_EQ(Value, 200);
+
+	//Until there are three readings the lower middle one is used
+	CHECK_EQ(Filter_Configure(CHANNEL, 3, 0), 0);
+	CHECK_EQ(Filter_GetValue(CHANNEL, &Value), 1);
+	CHECK_EQ(Filter_Apply(CHANNEL, 30), 30);
+	CHECK_EQ(Filter_Apply(CHANNEL, 10), 10);
+	CHECK_EQ(Filter_Apply(CHANNEL, 20), 20);
+	CHECK_EQ(Filter_Apply(CHANNEL, -5), 10);
+
+	//The other channels are not touched
+	CHECK_EQ(Filter_Apply(RECORDER_CHANNEL_HUMIDITY, 5000), 5000);
+	CHECK_EQ(Filter_Apply(RECORDER_CHANNEL_HUMIDITY, 100), 100);
+	return;
+}
+
+static void TestAverage(void)
+{
+	double Reference;
+	double Error;
+	double MaxError = 0;
+	int16_t Value = 0;
+	uint16_t j;
+	uint8_t i;
+
+	//Starts at the first reading
+	Filter_Init();
+	CHECK_EQ(Filter_Configure(CHANNEL, 1, 2), 0);
+	CHECK_EQ(Filter_Apply(CHANNEL, 1000), 1000);
+
+	//A quarter of the change each reading, close to the floating point version
+	Reference = 1000;
+	for(i = 0; i < 20; i++)
+	{
+		Value = Filter_Apply(CHANNEL, 2000);
+		Reference += (2000 - Reference) / 4;
+		Error = Value - Reference;
+		if(Error < 0)
+		{
+			Error = -Error;
+		}
+		if(Error > MaxError)
+		{
+			MaxError = Error;
+		}
+	}
+	CHECK(MaxError <= 1.0);
+
+	//and ends on the input exactly, up and down, at the slowest setting too
+	for(i = 0; i < 40; i++)
+	{
+		Value = Filter_Apply(CHANNEL, 2000);
+	}
+	CHECK_EQ(Value, 2000);
+	for(i = 0; i < 60; i++)
+	{
+		Value = Filter_Apply(CHANNEL, -2000);
+	}
+	CHECK_EQ(Value, -2000);
+
+	CHECK_EQ(Filter_Configure(CHANNEL, 1, FILTER_SHIFT_MAX), 0);
+	Filter_Apply(CHANNEL, 0);
+	Value = Filter_Apply(CHANNEL, 1280);
+	CHECK_EQ(Value, 10);
+	for(j = 0; j < 2000; j++)
+	{
+		Value = Filter_Apply(CHANNEL, 1281);
+	}
+	CHECK_EQ(Value, 1281);
+
+	//The median goes first, so a spike never reaches the average
+	CHECK_EQ(Filter_Configure(CHANNEL, 3, 3), 0);
+	for(i = 0; i < 5; i++)
+	{
+		Filter_Apply(CHANNEL, 500);
+	}
+	CHECK_EQ(Filter_Apply(CHANNEL, 30000), 500);
+	CHECK_EQ(Filter_Apply(CHANNEL, 500), 500);
+	return;
+}
+
+static void TestSettings(void)
+{
+	int16_t Value;
+
+	CHECK_EQ(Filter_Configure(RECORDER_CHANNELS, 1, 0), 1);
+	CHECK_EQ(Filter_Configure(CHANNEL, 2, 0), 1);
+	CHECK_EQ(Filter_Configure(CHANNEL, 4, 0), 1);
+	CHECK_EQ(Filter_Configure(CHANNEL, 7, 0), 1);
+	CHECK_EQ(Filter_Configure(CHANNEL, 3, FILTER_SHIFT_MAX + 1), 1);
+
+	//Set from the console and kept over a power cycle
+	Device_PowerOn(16, 2);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("filter");
+	OUTPUT_HAS("Pressure: none\nTemperature: none\nHumidity: none\n");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("filter 0 5 3");
+	OUTPUT_HAS("Pressure: median of 5, average 1/8\n");
+	HAL_RunCommandLine("filter 2 0 4");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("filter 1 4 0");
+	OUTPUT_HAS("Invalid channel or filter\n");
+
+	//A missing setting is not taken as 0, and a long argument is not a problem
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("filter 0");
+	OUTPUT_HAS("filter <channel");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("filter 0 3");
+	OUTPUT_HAS("filter <channel");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("filter 12345678901234567890123456789012");
+	OUTPUT_HAS("filter <channel");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("filter");
+	OUTPUT_HAS("Pressure: median of 5, average 1/8\n");
+
+	Device_PowerOn(16, 2);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("filter");
+	OUTPUT_HAS("Pressure: median of 5, average 1/8\nTemperature: none\nHumidity: average 1/16\n");
+
+	//Readings posted to the recorder are filtered
+	Recorder_SetValue(RECORDER_CHANNEL_HUMIDITY, 4000);
+	Recorder_SetValue(RECORDER_CHANNEL_HUMIDITY, 5600);
+	CHECK_EQ(Filter_GetValue(RECORDER_CHANNEL_HUMIDITY, &Value), 0);
+	CHECK_EQ(Value, 4100);
+
+	HAL_RunCommandLine("filter 0 1 0");
+	HAL_RunCommandLine("filter 2 1 0");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("filter");
+	OUTPUT_HAS("Pressure: none\nTemperature: none\nHumidity: none\n");
+	return;
+}
+
+//The pressure sensor through a slow average
+static void TestSensor(void)
+{
+	int16_t Pressure;
+	int16_t Step;
+
+	PressureModel_Reset();
+	Device_PowerOn(16, 2);
+	HAL_RunCommandLine("filter 0 3 2");
+	Device_RunMS(3000);
+	CHECK_EQ(MPL115A1_GetPressure(&Pressure), 0);
+	CHECK_EQ(Filter_GetValue(RECORDER_CHANNEL_PRESSURE, &Pressure), 0);
+	CHECK_EQ(Pressure, 1545);
+
+	//A step down takes two readings to get through the median, then comes a quarter at a time
+	PressureModel_SetAdc(600, PRESSUREMODEL_TADC);
+	Step = MPL115A1_Compensate(600, PRESSUREMODEL_TADC);
+	Device_RunMS(MPL115A1_PERIOD);
+	Filter_GetValue(RECORDER_CHANNEL_PRESSURE, &Pressure);
+	CHECK_EQ(Pressure, 1545);
+	Device_RunMS(MPL115A1_PERIOD);
+	Filter_GetValue(RECORDER_CHANNEL_PRESSURE, &Pressure);
+	CHECK(Pressure < 1545);
+	CHECK(Pressure > Step);
+	Device_RunMS(30 * MPL115A1_PERIOD);
+	Filter_GetValue(RECORDER_CHANNEL_PRESSURE, &Pressure);
+	CHECK_EQ(Pressure, Step);
+
+	HAL_RunCommandLine("filter 0 1 0");
+	return;
+}
+
+int main(void)
+{
+	TestMedian();
+	TestAverage();
+	TestSettings();
+	TestSensor();
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,80 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the formatting functions.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+#define FORMAT_IS(Call, Expected)						\
+	do													\
+	{													\
+		Format_ClearBuffer();							\
+		Call;											\
+		CHECK(strcmp(FormatBuffer, (Expected)) == 0);	\
+	} while(0)
+
+int main(void)
+{
+	FORMAT_IS(Format_Puts_P(Format_ToBuffer, "abc"), "abc");
+	FORMAT_IS(Format_Dec2(Format_ToBuffer, 7), "07");
+	FORMAT_IS(Format_Dec2(Format_ToBuffer, 59), "59");
+	FORMAT_IS(Format_BCD(Format_ToBuffer, 0x42), "42");
+	FORMAT_IS(Format_Hex2(Format_ToBuffer, 0xA5), "A5");
+	FORMAT_IS(Format_Hex2(Format_ToBuffer, 0x0F), "0F");
+
+	FORMAT_IS(Format_UInt(Format_ToBuffer, 0, 0, ' '), "0");
+	FORMAT_IS(Format_UInt(Format_ToBuffer, 65535, 0, ' '), "65535");
+	FORMAT_IS(Format_UInt(Format_ToBuffer, 42, 4, '0'), "0042");
+	FORMAT_IS(Format_UInt(Format_ToBuffer, 42, 4, ' '), "  42");
+	FORMAT_IS(Format_UInt(Format_ToBuffer, 12345, 3, '0'), "12345");
+	FORMAT_IS(Format_ULong(Format_ToBuffer, 0), "0");
+	FORMAT_IS(Format_ULong(Format_ToBuffer, 65536), "65536");
+	FORMAT_IS(Format_ULong(Format_ToBuffer, 100000), "100000");
+	FORMAT_IS(Format_ULong(Format_ToBuffer, 415000042), "415000042");
+	FORMAT_IS(Format_ULong(Format_ToBuffer, 4294967295UL), "4294967295");
+
+	FORMAT_IS(Format_Int(Format_ToBuffer, -32768), "-32768");
+	FORMAT_IS(Format_Int(Format_ToBuffer, 100), "100");
+
+	FORMAT_IS(Format_Decimal(Format_ToBuffer, 1234, 2), "12.34");
+	FORMAT_IS(Format_Decimal(Format_ToBuffer, -5, 2), "-0.05");
+	FORMAT_IS(Format_Decimal(Format_ToBuffer, -32768, 2), "-327.68");
+
+	//101.5 in 4 fractional bits
+	FORMAT_IS(Format_Fixed(Format_ToBuffer, (1015L << 4) / 10, 4, 1), "101.5");
+	FORMAT_IS(Format_Fixed(Format_ToBuffer, -(3L << 3), 4, 2), "-1.50");
+
+	//Whole parts past 16 bits, and the most negative value
+	FORMAT_IS(Format_Fixed(Format_ToBuffer, 65536L << 4, 4, 1), "65536.0");
+	FORMAT_IS(Format_Fixed(Format_ToBuffer, 2147483647L, 4, 4), "134217727.9375");
+	FORMAT_IS(Format_Fixed(Format_ToBuffer, -2147483647L - 1, 4, 4), "-134217728.0000");
+
+	FORMAT_IS(Format_Time(Format_ToBuffer, 9, 5, 0), "09:05:00");
+	FORMAT_IS(Format_Date(Format_ToBuffer, 2, 3, 2013), "02/03/2013");
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,158 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Tests for the I2C bus scan, on the bus model.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+#define OUTPUT_HAS(Text)		CHECK(strstr(HAL_ConsoleOutput(), (Text)) != NULL)
+
+#define ADDRESSES				(I2CSCAN_LAST_ADDRESS - I2CSCAN_FIRST_ADDRESS + 1)
+
+static void TestEmptyBus(void)
+{
+	I2CScanResult Result;
+	uint32_t Ticks;
+
+	Device_PowerOn(16, 2);
+	Ticks = SoftI2CModel_Stats()->Ticks;
+	CHECK_EQ(I2CScan_Run(SOFTI2C_HALF_BIT_US, &Result), 0);
+	CHECK_EQ(Result.Status, SOFTI2C_STATUS_OK);
+	CHECK_EQ(Result.Probes, ADDRESSES);
+	CHECK_EQ(Result.StretchTicks, 0);
+
+	//Only the SHT25 is there, and every other address ends after its nack
+	CHECK_EQ(Result.Devices, 1);
+	CHECK(I2CScan_Found(&Result, SHT25MODEL_ADDRESS));
+	CHECK(!I2CScan_Found(&Result, SHT25MODEL_ADDRESS + 1));
+	CHECK_EQ(SoftI2CModel_Stats()->Ticks - Ticks, (uint32_t)ADDRESSES * I2CSCAN_PROBE_TICKS);
+
+	CHECK(I2CScan_Identify(SHT25MODEL_ADDRESS) != NULL);
+	CHECK(strcmp(I2CScan_Identify(SHT25MODEL_ADDRESS), "SHT2x") == 0);
+	CHECK(I2CScan_Identify(0x50) == NULL);
+	return;
+}
+
+static void TestDevices(void)
+{
+	I2CScanResult Result;
+
+	Device_PowerOn(16, 2);
+	SoftI2CModel_AddDevice(0x39, 0x8A, 0x50);		//TSL2561 rev 0
+	SoftI2CModel_AddDevice(0x77, 0xD0, 0x58);		//BMP280
+	SoftI2CModel_AddDevice(0x50, 0x00, 0x00);		//EEPROM, no ID
+	SoftI2CModel_AddDevice(0x1E, 0x0A, 0x00);		//Not the ID a HMC5883 has
+
+	CHECK_EQ(I2CScan_Run(SOFTI2C_HALF_BIT_US, &Result), 0);
+	CHECK_EQ(Result.Devices, 5);
+	CHECK(I2CScan_Found(&Result, 0x1E));
+	CHECK(I2CScan_Found(&Result, 0x77));
+
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("twiscan"), 0);
+	OUTPUT_HAS("0x1E ?\n0x39 TSL2561\n0x40 SHT2x\n0x50 ?\n0x77 BMP280\n");
+	OUTPUT_HAS("5 found, 112 addresses at 20 kHz in ");
+	OUTPUT_HAS(" us, 64400 us with no stretching, stretched 0 ticks\n");
+	return;
+}
+
+static void TestSpeed(void)
+{
+	I2CScanResult Result;
+	uint32_t Ticks;
+
+	Device_PowerOn(16, 2);
+
+	//The speed is only changed for the scan
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("twiscan 10"), 0);
+	OUTPUT_HAS("1 found, 112 addresses at 10 kHz in ");
+	OUTPUT_HAS(" 128800 us with no stretching");
+	CHECK_EQ(SoftI2C_GetHalfBit(), SOFTI2C_HALF_BIT_US);
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("twiscan 2");
+	OUTPUT_HAS(" at 2 kHz in ");
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("twiscan 26");
+	OUTPUT_HAS("Invalid clock\n");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("twiscan 1");
+	OUTPUT_HAS("Invalid clock\n");
+
+	Ticks = SoftI2CModel_Stats()->Ticks;
+	CHECK_EQ(I2CScan_Run(SOFTI2C_MIN_HALF_BIT_US - 1, &Result), 1);
+	CHECK_EQ(SoftI2CModel_Stats()->Ticks, Ticks);
+	CHECK_EQ(SoftI2C_GetHalfBit(), SOFTI2C_HALF_BIT_US);
+	return;
+}
+
+static void TestBusErrors(void)
+{
+	I2CScanResult Result;
+
+	Device_PowerOn(16, 2);
+
+	//A slow device shows up as stretching
+	SoftI2CModel_Stretch(10);
+	CHECK_EQ(I2CScan_Run(SOFTI2C_HALF_BIT_US, &Result), 0);
+	CHECK_EQ(Result.Status, SOFTI2C_STATUS_OK);
+	CHECK_EQ(Result.Devices, 1);
+	//The first tick it holds SCL is one where the master has it low anyway
+	CHECK_EQ(SoftI2CModel_Stats()->StretchTicks, 10);
+	CHECK_EQ(Result.StretchTicks, 9);
+
+	//SDA stuck low stops the scan at the first address
+	SoftI2CModel_HoldSda(1);
+	CHECK_EQ(I2CScan_Run(SOFTI2C_HALF_BIT_US, &Result), 0);
+	CHECK_EQ(Result.Status, SOFTI2C_STATUS_ARBITRATION);
+	CHECK_EQ(Result.Probes, 1);
+	CHECK_EQ(Result.Devices, 0);
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("twiscan");
+	OUTPUT_HAS("Bus error 4 at 0x08, scan stopped\n0 found, 1 addresses");
+	SoftI2CModel_HoldSda(0);
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("twiscan");
+	OUTPUT_HAS("0x40 SHT2x\n1 found, 112 addresses");
+	return;
+}
+
+int main(void)
+{
+	TestEmptyBus();
+	TestDevices();
+	TestSpeed();
+	TestBusErrors();
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,142 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the interrupt timing statistics.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	TCNT0 and TIFR0 are set by hand around ISRStats_Enter() and ISRStats_Exit()
+*	to stand in for the timer running while the interrupt does.
+*
+*	@{
+*/
+
+#include "Device.h"
+#include "Test.h"
+
+static void Run(uint8_t Id, uint8_t Start, uint8_t End, uint8_t TickDuring)
+{
+	TIFR0 = 0;
+	TCNT0 = Start;
+	ISRStats_Enter(Id);
+	TCNT0 = End;
+	if(TickDuring != 0)
+	{
+		TIFR0 |= (1<<OCF0A);
+	}
+	ISRStats_Exit(Id);
+	TIFR0 = 0;
+	return;
+}
+
+int main(void)
+{
+	ISRStat Stat;
+	uint16_t Latency[ISRSTATS_BUCKETS];
+	uint16_t i;
+
+	Device_PowerOn(16, 2);
+	ISRStats_Clear();
+
+	//Timer 0 interrupt entered 3 counts after the compare, runs for 10 counts
+	Run(ISRSTATS_TIMER0_COMPA, 3, 13, 0);
+	ISRStats_Get(ISRSTATS_TIMER0_COMPA, &Stat);
+	CHECK_EQ(Stat.Count, 1);
+	CHECK_EQ(Stat.MaxLength, 10);
+	CHECK_EQ(Stat.Histogram[4], 1);
+	CHECK_EQ(Stat.DelayedTicks, 0);
+	CHECK_EQ(ISRStats_GetLatency(Latency), 3);
+	CHECK_EQ(Latency[2], 1);
+
+	//Latency is only measured for the timer 0 interrupt
+	Run(ISRSTATS_INT0, 50, 51, 0);
+	CHECK_EQ(ISRStats_GetLatency(Latency), 3);
+	ISRStats_Get(ISRSTATS_INT0, &Stat);
+	CHECK_EQ(Stat.Count, 1);
+	CHECK_EQ(Stat.Histogram[1], 1);
+
+	//Running across a compare: the length includes the wrap and the tick was delayed
+	Run(ISRSTATS_TIMER1_COMPA, 100, 20, 1);
+	ISRStats_Get(ISRSTATS_TIMER1_COMPA, &Stat);
+	CHECK_EQ(Stat.MaxLength, 45);
+	CHECK_EQ(Stat.DelayedTicks, 1);
+	CHECK_EQ(Stat.Histogram[6], 1);
+
+	//Over 1ms goes in the last bucket
+	Run(ISRSTATS_TIMER0_COMPA, 0, 30, 1);
+	ISRStats_Get(ISRSTATS_TIMER0_COMPA, &Stat);
+	CHECK_EQ(Stat.MaxLength, 155);
+	CHECK_EQ(Stat.Histogram[ISRSTATS_BUCKETS - 1], 1);
+	CHECK_EQ(Stat.DelayedTicks, 1);
+
+	//A tick that was already pending on entry is not counted as delayed by this interrupt
+	TIFR0 = (1<<OCF0A);
+	TCNT0 = 120;
+	ISRStats_Enter(ISRSTATS_PCINT1);
+	TCNT0 = 2;
+	ISRStats_Exit(ISRSTATS_PCINT1);
+	TIFR0 = 0;
+	ISRStats_Get(ISRSTATS_PCINT1, &Stat);
+	CHECK_EQ(Stat.MaxLength, 7);
+	CHECK_EQ(Stat.DelayedTicks, 0);
+
+	//Counts are halved before they overflow
+	ISRStats_Clear();
+	for(i = 0; i < 0xFFFF; i++)
+	{
+		Run(ISRSTATS_INT1, 0, 0, 0);
+	}
+	ISRStats_Get(ISRSTATS_INT1, &Stat);
+	CHECK_EQ(Stat.Count, 0x7FFF);
+	CHECK_EQ(Stat.Histogram[0], 0x7FFF);
+
+	//Strobe drives the LED pin only during the chosen interrupt
+	ISRStats_SetStrobe(ISRSTATS_INT5);
+	CHECK((DDRD & (1<<2)) != 0);
+	TCNT0 = 0;
+	ISRStats_Enter(ISRSTATS_INT5);
+	CHECK((PORTD & (1<<2)) != 0);
+	ISRStats_Exit(ISRSTATS_INT5);
+	CHECK((PORTD & (1<<2)) == 0);
+	ISRStats_Enter(ISRSTATS_INT0);
+	CHECK((PORTD & (1<<2)) == 0);
+	ISRStats_Exit(ISRSTATS_INT0);
+	ISRStats_SetStrobe(ISRSTATS_STROBE_OFF);
+
+	//The tick interrupt is instrumented
+	ISRStats_Clear();
+	Device_RunMS(5);
+	ISRStats_Get(ISRSTATS_TIMER0_COMPA, &Stat);
+	CHECK_EQ(Stat.Count, 5);
+
+	//Command output
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("isrstat"), 0);
+	CHECK(strstr(HAL_ConsoleOutput(), "TIMER0_COMPA") != NULL);
+	CHECK(strstr(HAL_ConsoleOutput(), "TIMER0 latency") != NULL);
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("isrstat 2 9"), 0);
+	CHECK(strstr(HAL_ConsoleOutput(), "Invalid ISR") != NULL);
+	CHECK_EQ(HAL_RunCommandLine("isrstat 1"), 0);
+	ISRStats_Get(ISRSTATS_TIMER0_COMPA, &Stat);
+	CHECK_EQ(Stat.Count, 0);
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,252 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the HD44780 model.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include "lcd.h"
+#include "LCDModel.h"
+#include "Test.h"
+
+static void TestInit(void)
+{
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, 16, 2);
+	lcd_init(LCD_DISP_ON);
+
+	CHECK_EQ(LCDModel_DisplayControl(), LCD_DISP_ON);
+	CHECK_EQ(LCDModel_EntryMode(), LCD_MODE_DEFAULT);
+	CHECK_EQ(LCDModel_AddressCounter(), 0);
+	CHECK(LCDModel_LineIs(0, ""));
+	CHECK(LCDModel_LineIs(1, ""));
+	CHECK(LCDModel_BusTimeUS() >= (LCDMODEL_INIT_NS / 1000));
+	return;
+}
+
+static void TestText(void)
+{
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, 16, 2);
+	lcd_init(LCD_DISP_ON);
+
+	lcd_puts_P("Menu\nItem 1");
+	CHECK(LCDModel_LineIs(0, "Menu"));
+	CHECK(LCDModel_LineIs(1, "Item 1"));
+	CHECK_EQ(LCDModel_AddressCounter(), 0x46);
+
+	//'\n' on the second line goes back to the first
+	lcd_puts_P("\nX");
+	CHECK(LCDModel_LineIs(0, "Xenu"));
+
+	lcd_gotoxy(14, 1);
+	lcd_putc('!');
+	CHECK(LCDModel_LineIs(1, "Item 1        !"));
+
+	//Display off hides the text, but keeps it in DDRAM
+	lcd_command(LCD_DISP_OFF);
+	CHECK(LCDModel_LineIs(0, ""));
+	CHECK_EQ(LCDModel_DDRAM(0x00), 'X');
+	lcd_command(LCD_DISP_ON);
+	CHECK(LCDModel_LineIs(0, "Xenu"));
+
+	lcd_clrscr();
+	CHECK(LCDModel_LineIs(0, ""));
+	CHECK(LCDModel_LineIs(1, ""));
+	return;
+}
+
+static void TestAddressCounter(void)
+{
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, 16, 2);
+	lcd_init(LCD_DISP_ON);
+
+	//The end of the first DDRAM line runs on to the second
+	lcd_gotoaddress(0x27);
+	lcd_data('a');
+	CHECK_EQ(LCDModel_AddressCounter(), 0x40);
+	lcd_data('b');
+	CHECK(LCDModel_LineIs(1, "b"));
+
+	lcd_gotoaddress(0x67);
+	lcd_data('c');
+	CHECK_EQ(LCDModel_AddressCounter(), 0x00);
+
+	//Decrement
+	lcd_command(LCD_ENTRY_DEC);
+	lcd_gotoaddress(0x40);
+	lcd_data('d');
+	CHECK_EQ(LCDModel_AddressCounter(), 0x27);
+	lcd_command(LCD_MODE_DEFAULT);
+
+	//Cursor moves
+	lcd_gotoaddress(0x05);
+	lcd_command(LCD_MOVE_CURSOR_RIGHT);
+	CHECK_EQ(lcd_getcurrentaddress(), 0x06);
+	lcd_command(LCD_MOVE_CURSOR_LEFT);
+	lcd_command(LCD_MOVE_CURSOR_LEFT);
+	CHECK_EQ(lcd_getcurrentaddress(), 0x04);
+
+	//Reads return DDRAM and move the address counter
+	lcd_gotoaddress(0x00);
+	lcd_puts_P("xyz");
+	CHECK_EQ(lcd_getcharacterataddress(0x01), 'y');
+	CHECK_EQ(lcd_getcurrentaddress(), 0x02);
+	CHECK_EQ(lcd_getxy(0, 1), 'd');
+	return;
+}
+
+static void TestCGRAM(void)
+{
+	static const uint8_t Arrow[8] = {0x00, 0x04, 0x06, 0x1F, 0x06, 0x04, 0x00, 0x00};
+	uint8_t i;
+
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, 16, 2);
+	lcd_init(LCD_DISP_ON);
+
+	lcd_command((1<<LCD_CGRAM) | (3 << 3));
+	for(i = 0; i < 8; i++)
+	{
+		lcd_data(Arrow[i]);
+	}
+	for(i = 0; i < 8; i++)
+	{
+		CHECK_EQ(LCDModel_CGRAM((3 << 3) + i), Arrow[i]);
+	}
+	CHECK_EQ(LCDModel_AddressCounter(), 32);
+
+	//Data goes to DDRAM again after an address set
+	lcd_gotoaddress(0x00);
+	lcd_data(3);
+	CHECK_EQ(LCDModel_DDRAM(0x00), 3);
+	CHECK_EQ(LCDModel_CGRAM(32), 0);
+	return;
+}
+
+static void TestShift(void)
+{
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, 16, 2);
+	lcd_init(LCD_DISP_ON);
+
+	lcd_puts_P("0123456789abcdefghij");
+	lcd_command(LCD_MOVE_DISP_LEFT);
+	lcd_command(LCD_MOVE_DISP_LEFT);
+	CHECK_EQ(LCDModel_DisplayShift(), 2);
+	CHECK(LCDModel_LineIs(0, "23456789abcdefgh"));
+
+	lcd_command(LCD_MOVE_DISP_RIGHT);
+	lcd_command(LCD_MOVE_DISP_RIGHT);
+	lcd_command(LCD_MOVE_DISP_RIGHT);
+	CHECK_EQ(LCDModel_DisplayShift(), 39);
+
+	lcd_home();
+	CHECK_EQ(LCDModel_DisplayShift(), 0);
+
+	//Entry mode shift moves the display with each character
+	lcd_command(LCD_ENTRY_INC_SHIFT);
+	lcd_data('!');
+	CHECK_EQ(LCDModel_DisplayShift(), 1);
+	return;
+}
+
+static void TestFourLines(void)
+{
+	//HD44780: lines 3 and 4 follow on from lines 1 and 2
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, 20, 4);
+	lcd_init(LCD_DISP_ON);
+	lcd_gotoaddress(0x14);
+	lcd_puts_P("line 3");
+	lcd_gotoaddress(0x54);
+	lcd_puts_P("line 4");
+	CHECK(LCDModel_LineIs(2, "line 3"));
+	CHECK(LCDModel_LineIs(3, "line 4"));
+
+	//KS0073: lines start every 0x20 once 4 line mode is on
+	LCDModel_Reset(LCDMODEL_CONTROLLER_KS0073, 20, 4);
+	lcd_init(LCD_DISP_ON);
+	lcd_command(0x24);
+	lcd_command(0x09);
+	lcd_command(0x20);
+	lcd_command(LCD_FUNCTION_4BIT_2LINES);
+	lcd_gotoaddress(0x40);
+	lcd_puts_P("line 3");
+	lcd_gotoaddress(0x73);
+	lcd_puts_P("xy");
+	CHECK(LCDModel_LineIs(2, "line 3"));
+	CHECK(LCDModel_LineIs(3, "                   x"));
+	CHECK(LCDModel_LineIs(0, "y"));
+	return;
+}
+
+static void TestTiming(void)
+{
+	uint32_t Time;
+	uint8_t i;
+
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, 16, 2);
+	lcd_init(LCD_DISP_ON);
+
+	//Back to back characters are limited by the 37us + 4us execution time
+	lcd_data(' ');
+	LCDModel_ClearStats();
+	for(i = 0; i < 16; i++)
+	{
+		lcd_data('a' + i);
+	}
+	Time = LCDModel_BusTimeUS();
+	CHECK(Time >= 16 * 41);
+	CHECK(Time <= 16 * 50);
+	CHECK_EQ(LCDModel_Stats()->DataWrites, 16);
+	CHECK(LCDModel_Stats()->BusyWaitNS > 0);
+
+	//The access after a clear waits 1.52ms
+	lcd_clrscr();
+	LCDModel_ClearStats();
+	lcd_data('a');
+	CHECK(LCDModel_BusTimeUS() >= 1500);
+	CHECK_EQ(LCDModel_Stats()->Instructions, 0);
+
+	//Without anything to wait for, an access only costs the bus transfers
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, 16, 2);
+	lcd_data('a');
+	CHECK_EQ(LCDModel_Stats()->BusTimeNS, (2 * LCDMODEL_READ_NS) + LCDMODEL_BUSY_DELAY_NS + LCDMODEL_WRITE_NS);
+	return;
+}
+
+int main(void)
+{
+	TestInit();
+	TestText();
+	TestAddressCounter();
+	TestCGRAM();
+	TestShift();
+	TestFourLines();
+	TestTiming();
+
+	LCDModel_Reset(LCDMODEL_CONTROLLER_HD44780, 16, 2);
+	lcd_init(LCD_DISP_ON);
+	lcd_puts_P("Host LCD model\n");
+	lcd_putc(3);
+	lcd_puts_P(" rendered");
+	LCDModel_Print(stdout);
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,218 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the console line editor.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include "Device.h"
+#include "Test.h"
+
+#define UP			"\x1B[A"
+#define DOWN		"\x1B[B"
+#define RIGHT		"\x1B[C"
+#define LEFT		"\x1B[D"
+#define HOME		"\x1B[1~"
+#define END			"\x1B[F"
+#define DELETE		"\x1B[3~"
+
+static void Type(const char *Text)
+{
+	while(*Text != 0)
+	{
+		LineEdit_Input(*Text++);
+	}
+	return;
+}
+
+//Type and run a line, and clear the output
+static void Enter(const char *Text)
+{
+	Type(Text);
+	Type("\r");
+	RunCommand();
+	HAL_ConsoleClear();
+	return;
+}
+
+#define OUTPUT_IS(Text)		CHECK(strcmp(HAL_ConsoleOutput(), (Text)) == 0)
+
+int main(void)
+{
+	char Line[LINEEDIT_LINE_SIZE];
+	uint8_t i;
+
+	Device_PowerOn(16, 2);
+	HAL_ConsoleClear();
+
+	//Typing at the end echoes each character
+	Type("gettim");
+	OUTPUT_IS("gettim");
+	HAL_ConsoleClear();
+	Type("e\r");
+	OUTPUT_IS("e\r\n");
+	CHECK(strcmp(HAL_CommandLine(), "gettime") == 0);
+	RunCommand();
+
+	//Inserting in the middle rewrites the rest of the line and moves back
+	HAL_ConsoleClear();
+	Type("lcdwrte" LEFT LEFT);
+	HAL_ConsoleClear();
+	Type("i");
+	OUTPUT_IS("ite\x1B[2D");
+	Type("\r");
+	CHECK(strcmp(HAL_CommandLine(), "lcdwrite") == 0);
+	RunCommand();
+
+	//Backspace at the end and in the middle, delete at the cursor
+	HAL_ConsoleClear();
+	Type("abcd\b");
+	OUTPUT_IS("abcd\b\x1B[K");
+	HAL_ConsoleClear();
+	Type(LEFT "\x7F");
+	OUTPUT_IS("\b\bc\x1B[K\b");
+	HAL_ConsoleClear();
+	Type(HOME DELETE);
+	OUTPUT_IS("\b" "c\x1B[K\b");
+	Type(END "x\r");
+	CHECK(strcmp(HAL_CommandLine(), "cx") == 0);
+	RunCommand();
+	HAL_ConsoleClear();
+
+	//Cursor keys stop at the ends of the line
+	Type("ab" RIGHT LEFT LEFT LEFT "x\r");
+	CHECK(strcmp(HAL_CommandLine(), "xab") == 0);
+	RunCommand();
+
+	//History, newest first
+	LineEdit_Init();
+	Enter("settime 2013 2 3 0 12 30 0");
+	Enter("gettime");
+	Enter("gettime");
+	CHECK_EQ(LineEdit_History(1, Line), 7);
+	CHECK(strcmp(Line, "gettime") == 0);
+	CHECK_EQ(LineEdit_History(2, Line), 26);
+	CHECK(strcmp(Line, "settime 2013 2 3 0 12 30 0") == 0);
+	CHECK_EQ(LineEdit_History(3, Line), -1);
+
+	//Up recalls, down goes back to an empty line
+	Type(UP);
+	OUTPUT_IS("gettime");
+	HAL_ConsoleClear();
+	Type(UP);
+	OUTPUT_IS("\x1B[7D" "settime 2013 2 3 0 12 30 0");
+	HAL_ConsoleClear();
+	Type(UP);
+	OUTPUT_IS("");
+	Type(DOWN);
+	OUTPUT_IS("\x1B[26D" "gettime\x1B[K");
+	HAL_ConsoleClear();
+	Type(DOWN);
+	OUTPUT_IS("\x1B[7D\x1B[K");
+
+	//Only the changed end of a recalled line is redrawn
+	Enter("bkl 2 10");
+	Enter("bkl 2 20");
+	Type(UP);
+	HAL_ConsoleClear();
+	Type(UP);
+	OUTPUT_IS("\x1B[2D" "10");
+
+	//Edit a recalled line and run it
+	Type("\b5\r");
+	CHECK(strcmp(HAL_CommandLine(), "bkl 2 15") == 0);
+	RunCommand();
+	CHECK_EQ(Settings.BacklightLevel, 15);
+
+	//Old lines are dropped when the ring is full
+	LineEdit_Init();
+	for(i = 0; i < 20; i++)
+	{
+		snprintf(Line, sizeof(Line), "line %u", i);
+		Enter(Line);
+	}
+	CHECK_EQ(LineEdit_History(1, Line), 7);
+	CHECK(strcmp(Line, "line 19") == 0);
+	for(i = 1; LineEdit_History(i, Line) >= 0; i++)
+	{
+	}
+	CHECK_EQ(i - 1, 12);
+	CHECK(strcmp(Line, "line 8") == 0);
+
+	//Lines longer than the buffer are cut off with a bell
+	HAL_ConsoleClear();
+	for(i = 0; i < LINEEDIT_LINE_SIZE + 5; i++)
+	{
+		Type("a");
+	}
+	CHECK(strchr(HAL_ConsoleOutput(), '\a') != NULL);
+	Type("\r");
+	CHECK_EQ(strlen(HAL_CommandLine()), LINEEDIT_LINE_SIZE - 1);
+	RunCommand();
+
+	//"\r\n" only enters one line
+	HAL_ConsoleClear();
+	Type("x\r\n");
+	OUTPUT_IS("x\r\n");
+	RunCommand();
+
+	//Input from the USB console goes through the editor
+	HAL_ConsoleClear();
+	HAL_ConsoleInput("gettime\r");
+	Device_RunMS(8 * 9);
+	CHECK(strncmp(HAL_ConsoleOutput(), "gettime\r\n02/03/2013", 19) == 0);
+	CHECK_EQ(LineEdit_History(1, Line), 7);
+
+	//Each character goes back once, the interpreter's own echo is off
+	HAL_ConsoleClear();
+	HAL_ConsoleInput("lcdclx\x7F\r");
+	Device_RunMS(8 * 9);
+	OUTPUT_IS("lcdclx\b\x1B[K\r\n");
+	CHECK_EQ(LineEdit_History(1, Line), 5);
+
+	//The interrupt only queues them, the main loop echoes and edits
+	HAL_ConsoleClear();
+	HAL_ConsoleInput("ge\t");
+	for(i = 0; i < 8 * 3; i++)
+	{
+		TIMER0_COMPA_vect();
+	}
+	OUTPUT_IS("");
+	Device_MainLoop();
+	OUTPUT_IS("gettime ");
+
+	//Characters stay in the endpoint while the queue is full
+	HAL_ConsoleClear();
+	HAL_ConsoleInput("\b\b\b\b\b\b\b\bdate\r");
+	for(i = 0; i < 8 * 13; i++)
+	{
+		TIMER0_COMPA_vect();
+	}
+	CHECK(LineEdit_QueueFull());
+	Device_MainLoop();
+	CHECK(!LineEdit_QueueFull());
+	Device_RunMS(8 * 6);
+	CHECK_EQ(LineEdit_History(1, Line), 4);
+
+	return TEST_DONE();
+}
+
+/** @} */
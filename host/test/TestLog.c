@@ -0,0 +1,146 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the binary log messages.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	This file is built with LOG_LEVEL set to warnings, to check that info
+*	messages are removed. If an argument is given, the console output is also
+*	written to that file, to try tools/logdecode.py on.
+*
+*	@{
+*/
+
+#define LOG_LEVEL		2
+
+#include "Device.h"
+#include "Test.h"
+
+static const uint8_t *Output(void)
+{
+	return (const uint8_t *)HAL_ConsoleOutput();
+}
+
+static uint16_t OutputId(void)
+{
+	return Output()[1] | (Output()[2] << 8);
+}
+
+static const char *Format(uint16_t Id)
+{
+	return &__start_logfmt[Id];
+}
+
+static void Save(FILE *File)
+{
+	if(File != NULL)
+	{
+		fwrite(HAL_ConsoleOutput(), 1, HAL_ConsoleOutputLength(), File);
+	}
+	return;
+}
+
+static void Filler(void)
+{
+	return;
+}
+
+int main(int argc, char *argv[])
+{
+	FILE *File = NULL;
+	uint16_t FirstId;
+	uint8_t i;
+
+	if(argc > 1)
+	{
+		File = fopen(argv[1], "wb");
+	}
+
+	Device_PowerOn(16, 2);
+
+	//One byte and two byte arguments
+	HAL_ConsoleClear();
+	LOG_WARN("Value %u, offset %d", (uint8_t)5, (int16_t)-2);
+	CHECK_EQ(Output()[0], LOG_FRAME_START);
+	CHECK_EQ(Output()[3], 0xF4);
+	CHECK_EQ(Output()[4], 5);
+	CHECK_EQ(Output()[5], 0xFE);
+	CHECK_EQ(Output()[6], 0xFF);
+	CHECK(strncmp(Format(OutputId()), "W" __FILE__ ":", strlen(__FILE__) + 2) == 0);
+	CHECK(strstr(Format(OutputId()), ": Value %u, offset %d") != NULL);
+	Save(File);
+
+	//No arguments, the frame is only the header
+	HAL_ConsoleClear();
+	LOG_ERROR("Plain message");
+	CHECK_EQ(Output()[3], 0xFF);
+	CHECK_EQ(Output()[0], LOG_FRAME_START);
+	CHECK(strstr(Format(OutputId()), "Plain message") != NULL);
+	CHECK_EQ(Format(OutputId())[0], 'E');
+	Save(File);
+
+	//Four arguments, a 32 bit one last
+	HAL_ConsoleClear();
+	LOG_ERROR("%c %x %u %lu", (char)'a', (uint8_t)0x1F, (uint16_t)1000, (uint32_t)70000);
+	CHECK_EQ(Output()[3], 0x80 | 0x10 | 0x00 | 0x00);
+	CHECK_EQ(Output()[4], 'a');
+	CHECK_EQ(Output()[5], 0x1F);
+	CHECK_EQ(Output()[6], 1000 & 0xFF);
+	CHECK_EQ(Output()[7], 1000 >> 8);
+	CHECK_EQ(Output()[8], 70000 & 0xFF);
+	CHECK_EQ(Output()[10], 70000 >> 16);
+	Save(File);
+
+	//Different messages get different IDs
+	HAL_ConsoleClear();
+	LOG_ERROR("Plain message");
+	FirstId = OutputId();
+	HAL_ConsoleClear();
+	LOG_ERROR("Plain message");
+	CHECK(OutputId() != FirstId);
+
+	//Below the compile time level nothing is sent
+	HAL_ConsoleClear();
+	LOG_INFO("Not sent %u", (uint8_t)1);
+	LOG_DEBUG("Not sent");
+	CHECK_EQ(HAL_ConsoleOutputLength(), 0);
+
+	//Firmware messages, the scheduler is full
+	Scheduler_Init();
+	HAL_ConsoleClear();
+	for(i = 0; i < SCHEDULER_MAX_TASKS; i++)
+	{
+		//The tasks are never run, they only need to be different
+		CHECK_EQ(Scheduler_Start((SchedulerTask)((uintptr_t)Filler + i), 10, 0), 0);
+	}
+	CHECK_EQ(HAL_ConsoleOutputLength(), 0);
+	CHECK_EQ(Scheduler_Start((SchedulerTask)((uintptr_t)Filler + SCHEDULER_MAX_TASKS), 10, 0), 1);
+	CHECK_EQ(Output()[0], LOG_FRAME_START);
+	CHECK(strstr(Format(OutputId()), "Board/Scheduler.c") != NULL);
+	Save(File);
+	Scheduler_Init();
+
+	if(File != NULL)
+	{
+		fclose(File);
+	}
+	return TEST_DONE();
+}
+
+/** @} */
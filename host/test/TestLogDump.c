@@ -0,0 +1,219 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the binary dataflash download.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <util/crc16.h>
+#include "Device.h"
+#include "Test.h"
+
+#define FRAME_SIZE		(5 + DATAFLASH_PAGE_SIZE + 2)
+
+static const uint8_t *Output;
+static uint16_t OutputLength;
+static uint16_t Position;
+
+static void Capture(void)
+{
+	Output = (const uint8_t *)HAL_ConsoleOutput();
+	OutputLength = HAL_ConsoleOutputLength();
+	Position = 0;
+
+	//Skip any text in front of the first frame
+	while((Position < OutputLength) && (Output[Position] != LOGDUMP_FRAME_START))
+	{
+		Position++;
+	}
+	return;
+}
+
+static uint16_t Get16(uint16_t At)
+{
+	return Output[At] | (Output[At + 1] << 8);
+}
+
+//Check the next frame. Returns the page, or -1 if there is no valid frame.
+static int32_t NextFrame(void)
+{
+	uint16_t Length;
+	uint16_t Crc = 0;
+	uint16_t i;
+
+	if(((Position + 7) > OutputLength) || (Output[Position] != LOGDUMP_FRAME_START))
+	{
+		return -1;
+	}
+	Length = Get16(Position + 3);
+	if((Position + 7 + Length) > OutputLength)
+	{
+		return -1;
+	}
+	for(i = 1; i < (5 + Length); i++)
+	{
+		Crc = _crc_xmodem_update(Crc, Output[Position + i]);
+	}
+	if(Crc != Get16(Position + 5 + Length))
+	{
+		return -1;
+	}
+
+	Position += 7 + Length;
+	return Get16(Position - 7 - Length + 1);
+}
+
+static void Fill(uint16_t First, uint16_t Count)
+{
+	uint16_t Page;
+	uint16_t i;
+
+	for(Page = First; Page < (First + Count); Page++)
+	{
+		for(i = 0; i < DATAFLASH_PAGE_SIZE; i++)
+		{
+			FlashModel_Page(Page)[i] = Page + (i * 7);
+		}
+	}
+	return;
+}
+
+static void TestCrc(void)
+{
+	uint8_t Data[9];
+
+	//The CRC-16/XMODEM check value
+	FlashModel_Reset(0xFF);
+	memcpy(FlashModel_Page(3), "123456789", 9);
+	Dataflash_ReadStart(3, 0);
+	CHECK_EQ(SPI_ReadCrc(Data, 9, 0), 0x31C3);
+	SPI_Deselect();
+	CHECK(memcmp(Data, "123456789", 9) == 0);
+	return;
+}
+
+static void TestFrames(void)
+{
+	int32_t Page;
+	uint16_t Expected;
+
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	Fill(10, 5);
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("logdump 10 5"), 0);
+	Capture();
+	CHECK_EQ(OutputLength, (FRAME_SIZE * 5) + 7);
+
+	for(Expected = 10; Expected < 15; Expected++)
+	{
+		CHECK_EQ(Get16(Position + 3), DATAFLASH_PAGE_SIZE);
+		CHECK(memcmp(&Output[Position + 5], FlashModel_Page(Expected), DATAFLASH_PAGE_SIZE) == 0);
+		Page = NextFrame();
+		CHECK_EQ(Page, Expected);
+	}
+	CHECK_EQ(Get16(Position + 3), 0);
+	CHECK_EQ(NextFrame(), LOGDUMP_END_PAGE);
+	CHECK_EQ(Position, OutputLength);
+
+	//A flipped bit is found
+	HAL_ConsoleClear();
+	LogDump_Pages(10, 1);
+	Capture();
+	((uint8_t *)Output)[100] ^= 0x10;
+	CHECK_EQ(NextFrame(), -1);
+
+	//Cut off at the end of the chip
+	HAL_ConsoleClear();
+	CHECK_EQ(LogDump_Pages(DATAFLASH_PAGES - 2, 10), 2);
+	CHECK_EQ(LogDump_Pages(DATAFLASH_PAGES, 1), 0);
+	Capture();
+	CHECK_EQ(NextFrame(), DATAFLASH_PAGES - 2);
+	CHECK_EQ(NextFrame(), DATAFLASH_PAGES - 1);
+	CHECK_EQ(NextFrame(), LOGDUMP_END_PAGE);
+	CHECK_EQ(NextFrame(), LOGDUMP_END_PAGE);
+	return;
+}
+
+static void TestStalled(void)
+{
+	uint16_t Sent;
+	uint16_t i;
+
+	//The console buffer fills up like a host that stops reading
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	HAL_ConsoleClear();
+	Sent = LogDump_Pages(0, 100);
+	CHECK(Sent > 0);
+	CHECK(Sent < 100);
+	Capture();
+	for(i = 0; i < Sent; i++)
+	{
+		CHECK_EQ(NextFrame(), i);
+	}
+	CHECK_EQ(NextFrame(), -1);
+
+	//Resume from there
+	HAL_ConsoleClear();
+	CHECK_EQ(LogDump_Pages(Sent, 2), 2);
+	Capture();
+	CHECK_EQ(NextFrame(), Sent);
+	return;
+}
+
+static void TestRecorded(void)
+{
+	LogStorePage Info;
+
+	//logdump stores the records that are still in the SRAM buffer first
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	HAL_RunCommandLine("recstart 10");
+	Device_RunMS(100);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("logdump 0 1");
+	CHECK_EQ(LogStore_ReadPage(0, &Info), 0);
+	CHECK_EQ(Info.Records, 8);
+	Capture();
+	CHECK_EQ(Output[Position + 5], 'L');
+	CHECK_EQ(NextFrame(), 0);
+
+	//A retry sends what is there without storing a part filled page again
+	Device_RunMS(100);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("logdump 0 2 1");
+	CHECK_EQ(LogStore_ReadPage(1, &Info), 1);
+	HAL_RunCommandLine("recstop");
+	return;
+}
+
+int main(void)
+{
+	TestCrc();
+	TestFrames();
+	TestStalled();
+	TestRecorded();
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,513 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the dataflash driver and the log store.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include "Device.h"
+#include "Test.h"
+
+#define OUTPUT_HAS(Text)	CHECK(strstr(HAL_ConsoleOutput(), (Text)) != NULL)
+
+//Key of the next record from AppendPages(), also stored in its first bytes
+static uint32_t NextKey;
+
+//What Visit() has seen
+static uint32_t VisitTo;
+static uint32_t VisitFirst;
+static uint32_t VisitLast;
+static uint32_t VisitCount;
+static uint8_t VisitGaps;
+
+static void Fill(uint8_t *Data, uint8_t Length, uint8_t Seed)
+{
+	uint8_t i;
+
+	for(i = 0; i < Length; i++)
+	{
+		Data[i] = Seed + i;
+	}
+	return;
+}
+
+//Append records until Pages more pages have been programmed
+static void AppendPages(uint16_t Pages, uint8_t Length)
+{
+	uint8_t Data[LOGSTORE_RECORD_MAX];
+	uint32_t Programs = FlashModel_Stats()->Programs + Pages;
+	uint8_t Seed = 0;
+
+	while(FlashModel_Stats()->Programs < Programs)
+	{
+		Fill(Data, Length, Seed++);
+		memcpy(Data, &NextKey, sizeof(NextKey));
+		if(LogStore_Append(Data, Length, NextKey++) != 0)
+		{
+			CHECK(0);
+			return;
+		}
+	}
+	return;
+}
+
+//Records from AppendPages() start with their key, which goes up by one
+static uint8_t Visit(const uint8_t *Record, uint8_t Length)
+{
+	uint32_t Key;
+
+	memcpy(&Key, Record, sizeof(Key));
+	if(VisitCount == 0)
+	{
+		VisitFirst = Key;
+	}
+	else if(Key != VisitLast + 1)
+	{
+		VisitGaps++;
+	}
+	VisitLast = Key;
+	VisitCount++;
+	return Key >= VisitTo;
+}
+
+//Returns the number of pages read
+static uint16_t Query(uint32_t From, uint32_t To)
+{
+	VisitTo = To;
+	VisitCount = 0;
+	VisitGaps = 0;
+	return LogStore_Read(From, Visit);
+}
+
+static void TestDriver(void)
+{
+	uint8_t Data[20];
+	uint8_t Read[20];
+
+	FlashModel_Reset(0xFF);
+	CHECK_EQ(Dataflash_Init(), 0);
+	CHECK_EQ(Dataflash_Busy(), 0);
+
+	//Program a page, the other buffer can be written while it is busy
+	Fill(Data, sizeof(Data), 1);
+	Dataflash_BufferWrite(0, 100, Data, sizeof(Data));
+	Dataflash_BufferProgram(0, 5);
+	CHECK_EQ(Dataflash_Busy(), 1);
+	Dataflash_BufferWrite(1, 0, Data, sizeof(Data));
+	Dataflash_BufferRead(1, 2, Read, 2);
+	CHECK_EQ(FlashModel_Stats()->BusyErrors, 0);
+	CHECK_EQ(Read[1], Data[3]);
+	Dataflash_Read(5, 100, Read, sizeof(Read));
+	CHECK(memcmp(Data, Read, sizeof(Data)) == 0);
+	CHECK_EQ(FlashModel_Page(5)[100], 1);
+
+	//Reads continue into the next page
+	Dataflash_Read(4, DATAFLASH_PAGE_SIZE - 2, Read, 4);
+	CHECK_EQ(Read[0], 0xFF);
+	CHECK_EQ(FlashModel_Page(5)[0], Read[2]);
+
+	//Erase
+	Dataflash_EraseBlock(0);
+	Dataflash_Read(5, 100, Read, 1);
+	CHECK_EQ(Read[0], 0xFF);
+	CHECK(FlashModel_Stats()->TimeNS >= FLASHMODEL_PROGRAM_NS + FLASHMODEL_BLOCK_ERASE_NS);
+	CHECK_EQ(FlashModel_Stats()->BusyErrors, 0);
+
+	//A reset in the middle of an erase waits for it, without the chip it gives up
+	Dataflash_EraseBlock(3);
+	CHECK_EQ(Dataflash_Init(), 0);
+	CHECK_EQ(Dataflash_Busy(), 0);
+	FlashModel_SetPresent(0);
+	CHECK_EQ(Dataflash_Init(), 1);
+	CHECK_EQ(Dataflash_WaitReady(), 1);
+	FlashModel_SetPresent(1);
+
+	//A chip that stays busy gets no more commands, only the buffer that is not programming can be written
+	FlashModel_ClearStats();
+	CHECK_EQ(Dataflash_BufferWrite(0, 0, Data, sizeof(Data)), 0);
+	CHECK_EQ(Dataflash_BufferProgram(0, 16), 0);
+	FlashModel_SetPresent(0);
+	CHECK_EQ(Dataflash_BufferWrite(0, 0, Data, sizeof(Data)), 1);
+	CHECK_EQ(Dataflash_BufferRead(0, 0, Read, 1), 1);
+	CHECK_EQ(Dataflash_BufferWrite(1, 0, Data, sizeof(Data)), 0);
+	CHECK_EQ(Dataflash_BufferProgram(1, 17), 1);
+	CHECK_EQ(Dataflash_EraseBlock(2), 1);
+	CHECK_EQ(Dataflash_Read(16, 0, Read, 1), 1);
+	CHECK_EQ(Dataflash_ReadStart(16, 0), 1);
+	FlashModel_SetPresent(1);
+	CHECK_EQ(FlashModel_Stats()->BusyErrors, 0);
+	CHECK_EQ(FlashModel_Page(17)[0], 0xFF);
+	CHECK_EQ(Dataflash_WaitReady(), 0);
+	return;
+}
+
+static void TestAppend(void)
+{
+	uint8_t Data[40];
+	uint8_t Read[40];
+	LogStorePage Page;
+	uint8_t Length;
+	uint8_t i;
+
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	CHECK_EQ(LogStore_Head(), 0);
+	CHECK_EQ(LogStore_Sequence(), 1);
+
+	//Nothing is programmed until the page is full
+	for(i = 0; i < 6; i++)
+	{
+		Fill(Data, sizeof(Data), i);
+		CHECK_EQ(LogStore_Append(Data, sizeof(Data), i), 0);
+	}
+	CHECK_EQ(FlashModel_Stats()->Programs, 0);
+	CHECK_EQ(LogStore_ReadPage(0, &Page), 1);
+	Fill(Data, 20, 100);
+	CHECK_EQ(LogStore_Append(Data, 20, 6), 0);
+	CHECK_EQ(FlashModel_Stats()->Programs, 1);
+	CHECK_EQ(LogStore_Head(), 1);
+
+	//The first page holds the six records
+	CHECK_EQ(LogStore_ReadPage(0, &Page), 0);
+	CHECK_EQ(Page.Sequence, 1);
+	CHECK_EQ(Page.Records, 6);
+	CHECK_EQ(Page.Used, 6 * 41);
+	LogStore_ReadData(0, 41 * 5, &Length, 1);
+	CHECK_EQ(Length, 40);
+	LogStore_ReadData(0, (41 * 5) + 1, Read, 40);
+	Fill(Data, sizeof(Data), 5);
+	CHECK(memcmp(Data, Read, sizeof(Data)) == 0);
+
+	//Entering block 0 erased block 1
+	CHECK_EQ(FlashModel_Stats()->BlockErases[1], 1);
+
+	//Flush programs a partly filled page
+	LogStore_Flush();
+	CHECK_EQ(LogStore_ReadPage(1, &Page), 0);
+	CHECK_EQ(Page.Sequence, 2);
+	CHECK_EQ(Page.Records, 1);
+	LogStore_Flush();
+	CHECK_EQ(LogStore_Head(), 2);
+
+	//A flipped bit is found by the CRC
+	FlashModel_Page(1)[LOGSTORE_HEADER_SIZE + 3] ^= 0x01;
+	CHECK_EQ(LogStore_ReadPage(1, &Page), 1);
+
+	//Too long
+	CHECK_EQ(LogStore_Append(Data, LOGSTORE_RECORD_MAX + 1, 7), 1);
+	return;
+}
+
+static void TestWrapAround(void)
+{
+	const FlashModelStats *Stats = FlashModel_Stats();
+	uint16_t Least = 0xFFFF;
+	uint16_t Most = 0;
+	uint16_t i;
+
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	FlashModel_ClearStats();
+
+	//Twice around the chip, one record per page
+	AppendPages(DATAFLASH_PAGES * 2 + 3, LOGSTORE_RECORD_MAX);
+	CHECK_EQ(LogStore_Head(), 3);
+	CHECK_EQ(LogStore_Sequence(), DATAFLASH_PAGES * 2 + 4);
+	CHECK_EQ(Stats->NotErased, 0);
+	CHECK_EQ(Stats->BusyErrors, 0);
+
+	//Every block was erased about as often
+	for(i = 0; i < DATAFLASH_BLOCKS; i++)
+	{
+		Least = (Stats->BlockErases[i] < Least) ? Stats->BlockErases[i] : Least;
+		Most = (Stats->BlockErases[i] > Most) ? Stats->BlockErases[i] : Most;
+	}
+	CHECK_EQ(Least, 2);
+	CHECK_EQ(Most, 3);
+	return;
+}
+
+static void TestPowerOn(void)
+{
+	LogStorePage Page;
+	uint16_t Head;
+	uint32_t Sequence;
+
+	//The log carries on after the newest page
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	AppendPages(DATAFLASH_PAGES + 12, 100);
+	Head = LogStore_Head();
+	Sequence = LogStore_Sequence();
+	Device_PowerOn(16, 2);
+	CHECK_EQ(LogStore_Head(), Head);
+	CHECK_EQ(LogStore_Sequence(), Sequence);
+
+	//A page that was being programmed when the power failed is skipped
+	FlashModel_Page(Head)[LOGSTORE_HEADER_SIZE + 50] = 0x00;
+	Device_PowerOn(16, 2);
+	CHECK_EQ(LogStore_Head(), Head + 1);
+	AppendPages(1, 100);
+	CHECK_EQ(LogStore_ReadPage(Head, &Page), 1);
+	CHECK_EQ(LogStore_ReadPage(Head + 1, &Page), 0);
+	CHECK_EQ(Page.Sequence, Sequence);
+
+	//Half written header, its sequence number is not used
+	Head = LogStore_Head();
+	Sequence = LogStore_Sequence();
+	FlashModel_Page(Head)[0] = 'L';
+	FlashModel_Page(Head)[5] = 0x7F;
+	Device_PowerOn(16, 2);
+	CHECK_EQ(LogStore_Head(), Head + 1);
+	CHECK_EQ(LogStore_Sequence(), Sequence);
+
+	//A damaged page in an old block does not move the log
+	Head = LogStore_Head();
+	FlashModel_Page(DATAFLASH_BLOCK_PAGES * 3)[5] = 0x7F;
+	Device_PowerOn(16, 2);
+	CHECK_EQ(LogStore_Head(), Head);
+	CHECK_EQ(LogStore_Sequence(), Sequence);
+
+	//The block ahead still had old data when the power failed
+	FlashModel_ClearStats();
+	Head = LogStore_Head();
+	FlashModel_Page(((Head / DATAFLASH_BLOCK_PAGES) + 1) * DATAFLASH_BLOCK_PAGES + 2)[0] = 0x12;
+	Device_PowerOn(16, 2);
+	CHECK_EQ(FlashModel_Stats()->Erases, 1);
+	AppendPages(DATAFLASH_BLOCK_PAGES * 2, 100);
+	CHECK_EQ(FlashModel_Stats()->NotErased, 0);
+
+	//A chip that was never used
+	FlashModel_Reset(0x00);
+	Device_PowerOn(16, 2);
+	AppendPages(20, 100);
+	CHECK_EQ(FlashModel_Stats()->NotErased, 0);
+	return;
+}
+
+static void TestIndex(void)
+{
+	uint16_t Pages;
+	uint32_t Oldest;
+
+	//Two records of 100 bytes fit in a page
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	NextKey = 0;
+	CHECK_EQ(Query(0, 0xFFFFFFFF), 0);
+	CHECK_EQ(VisitCount, 0);
+	AppendPages(500, 100);
+	CHECK_EQ(LogStore_Tail(), 0);
+
+	//A range in the middle only reads its own pages
+	Pages = Query(301, 340);
+	CHECK_EQ(VisitFirst, 300);
+	CHECK_EQ(VisitLast, 340);
+	CHECK_EQ(VisitGaps, 0);
+	CHECK_EQ(Pages, 21);
+
+	//The start of the log
+	Query(0, 5);
+	CHECK_EQ(VisitFirst, 0);
+	CHECK_EQ(VisitLast, 5);
+
+	//The record that is still in the SRAM buffer is included
+	Query(NextKey - 3, 0xFFFFFFFF);
+	CHECK_EQ(VisitFirst, NextKey - 5);
+	CHECK_EQ(VisitLast, NextKey - 1);
+	CHECK_EQ(VisitGaps, 0);
+
+	//Around the chip, the oldest block has been erased
+	AppendPages(DATAFLASH_PAGES, 100);
+	CHECK_EQ(LogStore_Tail(), ((LogStore_Head() / DATAFLASH_BLOCK_PAGES) + 2) * DATAFLASH_BLOCK_PAGES);
+	Query(0, 0xFFFFFFFF);
+	Oldest = VisitFirst;
+	CHECK_EQ(VisitLast, NextKey - 1);
+	CHECK_EQ(VisitGaps, 0);
+	CHECK_EQ(VisitCount, NextKey - Oldest);
+	CHECK_EQ(VisitCount, (DATAFLASH_PAGES - DATAFLASH_BLOCK_PAGES - (LogStore_Head() % DATAFLASH_BLOCK_PAGES)) * 2 + 1);
+
+	//Ranges that cross the end of the chip
+	Pages = Query(3000, 3100);
+	CHECK_EQ(VisitFirst, 2998);
+	CHECK_EQ(VisitLast, 3100);
+	CHECK_EQ(Pages, 52);
+	Pages = Query(Oldest + 1, Oldest + 1);
+	CHECK_EQ(VisitFirst, Oldest);
+	CHECK_EQ(Pages, 1);
+
+	//The index is rebuilt at power on, the SRAM buffer is lost
+	Device_PowerOn(16, 2);
+	Pages = Query(3001, 3100);
+	CHECK_EQ(VisitFirst, 3000);
+	CHECK_EQ(Pages, 51);
+	Query(Oldest, 0xFFFFFFFF);
+	CHECK_EQ(VisitFirst, Oldest);
+	CHECK_EQ(VisitLast, NextKey - 2);
+
+	//A damaged index page loses its own records and moves the start back
+	FlashModel_Page(3 * LOGSTORE_INDEX_PAGES)[LOGSTORE_HEADER_SIZE + 8] ^= 0x01;
+	Device_PowerOn(16, 2);
+	Query(2 * (DATAFLASH_PAGES + 3 * LOGSTORE_INDEX_PAGES) + 1, 2 * (DATAFLASH_PAGES + 3 * LOGSTORE_INDEX_PAGES + 2));
+	CHECK_EQ(VisitFirst, 2 * (DATAFLASH_PAGES + 3 * LOGSTORE_INDEX_PAGES - 1));
+	CHECK_EQ(VisitLast, 2 * (DATAFLASH_PAGES + 3 * LOGSTORE_INDEX_PAGES + 2));
+	CHECK_EQ(VisitGaps, 1);
+	Query(2 * (DATAFLASH_PAGES + 3 * LOGSTORE_INDEX_PAGES + 10), 0);
+	CHECK_EQ(VisitFirst, 2 * (DATAFLASH_PAGES + 3 * LOGSTORE_INDEX_PAGES - 1));
+	return;
+}
+
+static void TestLogRead(void)
+{
+	TimeAndDate Time = {2013, 2, 3, 0, 10, 20, 30};
+	const char *Output;
+	uint16_t Lines = 0;
+
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	SetTime(Time);
+
+	//Pressure and humidity come from the sensor models, 96.56kPa and 44.99 %RH
+	HAL_RunCommandLine("recstart 250 5");
+	Device_RunMS(10000);
+
+	//The last two seconds, while the recorder runs
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("logread -2");
+	Output = HAL_ConsoleOutput();
+	CHECK(strncmp(Output, "seconds,pressure,temperature,humidity\n413202038.000,1545,,4499\n", 63) == 0);
+	OUTPUT_HAS("413202040.000,1545,,4499\n");
+	//All 40 compressed samples still fit in the SRAM buffer
+	OUTPUT_HAS("\nRecords: 9, pages read: 0\n");
+	while((Output = strchr(Output, '\n')) != NULL)
+	{
+		Output++;
+		Lines++;
+	}
+	CHECK_EQ(Lines, 11);
+
+	//Absolute times
+	HAL_RunCommandLine("recstop");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("logread 413202031 413202031");
+	OUTPUT_HAS("\n413202031.000,1545,,4499\n413202031.250,1545,,4499\n413202031.500,1545,,4499\n413202031.750,1545,,4499\nRecords: 4,");
+
+	//Arguments as long as the line fits, and the most negative time is from the start
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("logread -2147483648 00000000000000000000413202031");
+	OUTPUT_HAS("\n413202031.750,1545,,4499\nRecords: ");
+	CHECK(strstr(HAL_ConsoleOutput(), "413202032.000") == NULL);
+
+	FlashModel_SetPresent(0);
+	Device_PowerOn(16, 2);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("logread 0");
+	OUTPUT_HAS("No dataflash\n");
+	FlashModel_SetPresent(1);
+	return;
+}
+
+static void TestRecorder(void)
+{
+	LogStorePage Page;
+	RecorderRecord Record;
+	SampleCodecState Decoder;
+	uint8_t Data[SAMPLECODEC_MAX_SIZE];
+	uint8_t Length;
+	uint16_t Head;
+
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	Recorder_SetValue(RECORDER_CHANNEL_TEMPERATURE, 2150);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("recstart 10");
+	Device_RunMS(10 * (RECORDER_BUFFER_RECORDS + 3));
+	HAL_RunCommandLine("recstop");
+	OUTPUT_HAS("Samples: 11, buffers: 2, overruns: 0, errors: 0\n");
+	CHECK(strstr(HAL_ConsoleOutput(), "No storage") == NULL);
+
+	//recstop stores everything
+	CHECK_EQ(LogStore_Head(), 1);
+	CHECK_EQ(LogStore_ReadPage(0, &Page), 0);
+	CHECK_EQ(Page.Records, 11);
+
+	//A keyframe, then deltas of 10ms and no change on the three channels
+	SampleCodec_Reset(&Decoder);
+	LogStore_ReadData(0, 0, &Length, 1);
+	CHECK(Length <= SAMPLECODEC_MAX_SIZE);
+	LogStore_ReadData(0, 1, Data, Length);
+	CHECK_EQ(Data[0], SAMPLECODEC_KEYFRAME | RECORDER_ALL_CHANNELS);
+	CHECK_EQ(SampleCodec_Decode(&Decoder, Data, Length, &Record), 0);
+	CHECK_EQ(Record.Value[RECORDER_CHANNEL_TEMPERATURE], 2150);
+	CHECK_EQ(Record.Milliseconds, 10);
+	CHECK_EQ(Page.Used, (1 + Length) + 10 * 6);
+	LogStore_ReadData(0, 1 + Length, Data, 6);
+	CHECK_EQ(Data[0], 5);
+	CHECK_EQ(SampleCodec_Decode(&Decoder, &Data[1], 5, &Record), 0);
+	CHECK_EQ(Record.Value[RECORDER_CHANNEL_TEMPERATURE], 2150);
+	CHECK_EQ(Record.Milliseconds, 20);
+
+	//A chip that stops answering in the middle of recording stops the log and the recorder
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	HAL_RunCommandLine("recstart 1");
+	Device_RunMS(1000);
+	CHECK(LogStore_Head() > 0);
+	Head = LogStore_Head();
+	FlashModel_SetPresent(0);
+	Device_RunMS(2000);
+	CHECK_EQ(DataRecoderActive, 0);
+	CHECK_EQ(LogStore_Append(&Record, 1, 0), 1);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("recstop");
+	OUTPUT_HAS("errors: 1\n");
+	FlashModel_SetPresent(1);
+	Device_RunMS(1000);
+	CHECK_EQ(LogStore_Head(), Head);
+	CHECK_EQ(FlashModel_Stats()->BusyErrors, 0);
+	CHECK_EQ(FlashModel_Stats()->NotErased, 0);
+	CHECK_EQ(LogStore_ReadPage(Head - 1, &Page), 0);
+
+	//Without the chip the records are dropped
+	FlashModel_SetPresent(0);
+	Device_PowerOn(16, 2);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("recstat");
+	OUTPUT_HAS("No storage");
+	CHECK_EQ(LogStore_Append(&Record, 1, 0), 1);
+	FlashModel_SetPresent(1);
+	return;
+}
+
+int main(void)
+{
+	TestDriver();
+	TestAppend();
+	TestWrapAround();
+	TestPowerOn();
+	TestIndex();
+	TestLogRead();
+	TestRecorder();
+
+	return TEST_DONE();
+}
+
+/** @} */
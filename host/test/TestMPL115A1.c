@@ -0,0 +1,180 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Tests for the MPL115A1 pressure sensor driver.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+#define OUTPUT_HAS(Text)	CHECK(strstr(HAL_ConsoleOutput(), (Text)) != NULL)
+
+//The data sheet formula in floating point, in kPa
+static double Reference(uint16_t Padc, uint16_t Tadc)
+{
+	double A0 = (int16_t)PRESSUREMODEL_A0 / 8.0;
+	double B1 = (int16_t)PRESSUREMODEL_B1 / 8192.0;
+	double B2 = (int16_t)PRESSUREMODEL_B2 / 16384.0;
+	double C12 = ((int16_t)PRESSUREMODEL_C12 >> 2) / 4194304.0;
+	double Pcomp = A0 + (B1 + C12 * Tadc) * Padc + B2 * Tadc;
+
+	return (Pcomp * 65.0 / 1023.0) + 50.0;
+}
+
+static void TestCompensate(void)
+{
+	MPL115A1Coefficients Coef;
+	double Error;
+	double MaxError = 0;
+	uint16_t Padc;
+	uint16_t Tadc;
+	int16_t Pressure;
+
+	PressureModel_Reset();
+	CHECK_EQ(MPL115A1_Init(), 0);
+	MPL115A1_GetCoefficients(&Coef);
+	CHECK_EQ(Coef.A0, (int16_t)PRESSUREMODEL_A0);
+	CHECK_EQ(Coef.B1, (int16_t)PRESSUREMODEL_B1);
+	CHECK_EQ(Coef.B2, (int16_t)PRESSUREMODEL_B2);
+	CHECK_EQ(Coef.C12, (int16_t)PRESSUREMODEL_C12);
+
+	//AN3785 gives 96.59kPa
+	CHECK_EQ(MPL115A1_Compensate(PRESSUREMODEL_PADC, PRESSUREMODEL_TADC), 1545);
+
+	//The whole range, changing the temperature on every reading so the cached terms are worked out each time
+	for(Padc = 0; Padc < 1024; Padc += 3)
+	{
+		for(Tadc = 300; Tadc < 700; Tadc += 7)
+		{
+			Pressure = MPL115A1_Compensate(Padc, Tadc);
+			Error = (Pressure / 16.0) - Reference(Padc, Tadc);
+			if(Error < 0)
+			{
+				Error = -Error;
+			}
+			if(Error > MaxError)
+			{
+				MaxError = Error;
+			}
+		}
+	}
+	CHECK(MaxError < 0.125);
+
+	//The same reading after the cached terms were for another temperature
+	MPL115A1_Compensate(100, 400);
+	CHECK_EQ(MPL115A1_Compensate(PRESSUREMODEL_PADC, PRESSUREMODEL_TADC), 1545);
+	CHECK_EQ(MPL115A1_Compensate(PRESSUREMODEL_PADC, PRESSUREMODEL_TADC), 1545);
+	return;
+}
+
+static void TestConversions(void)
+{
+	const PressureModelStats *Stats = PressureModel_Stats();
+	int16_t Pressure;
+	uint16_t Padc;
+	uint16_t Tadc;
+
+	//The first conversion is queued on the first pass of the main loop, and the SPI interrupt
+	//sends the command in the next millisecond. It is read the same way when it is done.
+	PressureModel_Reset();
+	Device_PowerOn(16, 2);
+	CHECK_EQ(MPL115A1_GetPressure(&Pressure), 1);
+	Device_RunMS(1);
+	CHECK_EQ(Stats->Conversions, 0);
+	Device_RunMS(1);
+	CHECK_EQ(Stats->Conversions, 1);
+	Device_RunMS(MPL115A1_CONVERSION_MS);
+	CHECK_EQ(Stats->Reads, 0);
+	CHECK_EQ(MPL115A1_GetPressure(&Pressure), 1);
+	Device_RunMS(1);
+	CHECK_EQ(Stats->Reads, 1);
+	CHECK_EQ(MPL115A1_GetPressure(&Pressure), 0);
+	CHECK_EQ(Pressure, 1545);
+	MPL115A1_GetRaw(&Padc, &Tadc);
+	CHECK_EQ(Padc, PRESSUREMODEL_PADC);
+	CHECK_EQ(Tadc, PRESSUREMODEL_TADC);
+
+	//One conversion a second, posted to the recorder
+	PressureModel_SetAdc(600, 500);
+	Device_RunMS(MPL115A1_PERIOD);
+	CHECK_EQ(Stats->Conversions, 2);
+	CHECK_EQ(Stats->Reads, 2);
+	MPL115A1_GetPressure(&Pressure);
+	CHECK_EQ(Pressure, MPL115A1_Compensate(600, 500));
+	Device_RunMS(10 * MPL115A1_PERIOD);
+	CHECK_EQ(Stats->Conversions, 12);
+	CHECK_EQ(Stats->EarlyReads, 0);
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("pres");
+	OUTPUT_HAS("Pressure: ");
+	OUTPUT_HAS(" kPa, Padc 600, Tadc 500\n");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("pres 1");
+	OUTPUT_HAS("a0 0x3ECE, b1 0xB3F9, b2 0xC517, c12 0x33C8\n");
+
+	//A faster rate, then stopped
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("pres 2 4");
+	OUTPUT_HAS("Invalid period or no sensor\n");
+	HAL_RunCommandLine("pres 2 100");
+	Device_RunMS(1000);
+	CHECK_EQ(Stats->Conversions, 22);
+	HAL_RunCommandLine("pres 2 0");
+	Device_RunMS(1000);
+	CHECK_EQ(Stats->Conversions, 22);
+	CHECK_EQ(Stats->EarlyReads, 0);
+	return;
+}
+
+static void TestNoSensor(void)
+{
+	const PressureModelStats *Stats = PressureModel_Stats();
+
+	PressureModel_Reset();
+	PressureModel_SetPresent(0);
+	Device_PowerOn(16, 2);
+	Device_RunMS(100);
+	CHECK_EQ(Stats->Conversions, 0);
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("pres");
+	OUTPUT_HAS("No reading\n");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("pres 2 1000");
+	OUTPUT_HAS("Invalid period or no sensor\n");
+	PressureModel_SetPresent(1);
+	return;
+}
+
+int main(void)
+{
+	TestCompensate();
+	TestConversions();
+	TestNoSensor();
+
+	return TEST_DONE();
+}
+
+/** @} */
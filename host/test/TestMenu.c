@@ -0,0 +1,303 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the button handling and LCD menu.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+extern uint8_t LCDMenuState;
+
+//Button presses, the same way the pin interrupts see them
+static void PressCenter(void)
+{
+	INT5_vect();
+	Device_MainLoop();
+	return;
+}
+
+static void PressLeft(void)
+{
+	INT0_vect();
+	Device_MainLoop();
+	return;
+}
+
+static void PressDown(void)
+{
+	PINC = 0x00;
+	PCINT1_vect();
+	PINC = 0x04;
+	Device_MainLoop();
+	return;
+}
+
+static void PressRight(void)
+{
+	PINC = 0x04;
+	PIND = 0x00;
+	PCINT1_vect();
+	PIND = 0x20;
+	Device_MainLoop();
+	return;
+}
+
+//Check the character in a cell is a CGRAM character holding Glyph
+static uint8_t CellIsGlyph(uint8_t x, uint8_t y, const uint8_t *Glyph)
+{
+	char Line[LCDMODEL_MAX_COLUMNS+1];
+	uint8_t Slot;
+	uint8_t i;
+
+	LCDModel_GetLine(y, Line);
+	Slot = (uint8_t)Line[x];
+	if(Slot >= GLYPH_SLOTS)
+	{
+		return 0;
+	}
+	for(i = 0; i < 8; i++)
+	{
+		if(LCDModel_CGRAM((Slot << 3) + i) != pgm_read_byte(&Glyph[i]))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void TestNavigation(void)
+{
+	PressCenter();
+	CHECK_EQ(LCDMenuState, 1);
+	CHECK(CellIsGlyph(15, 0, Glyph_ArrowRight));
+	CHECK(LCDModel_LineIs(1, "Item 1"));
+
+	PressDown();
+	CHECK(LCDModel_LineIs(1, "Set Time"));
+	PressDown();
+	CHECK(LCDModel_LineIs(1, "DFU Mode"));
+	PressDown();
+	CHECK(LCDModel_LineIs(1, "Sensors"));
+	PressDown();
+	CHECK(LCDModel_LineIs(1, "Item 1"));
+
+	//Child menu, which has a parent arrow
+	PressRight();
+	CHECK(CellIsGlyph(15, 1, Glyph_ArrowLeft));
+	PressLeft();
+	CHECK(LCDModel_LineIs(1, "Item 1"));
+	return;
+}
+
+static void TestMarquee(void)
+{
+	char Line[LCDMODEL_MAX_COLUMNS+1];
+
+	PressRight();
+	PressDown();
+	LCDModel_GetLine(0, Line);
+	CHECK(memcmp(Line, "Jon is funny lo", 15) == 0);
+
+	//Holds at the start, then moves one column per step
+	Device_RunMS(MARQUEE_STEP_MS * MARQUEE_HOLD_STEPS);
+	LCDModel_GetLine(0, Line);
+	CHECK(memcmp(Line, "Jon is funny lo", 15) == 0);
+	Device_RunMS(MARQUEE_STEP_MS);
+	LCDModel_GetLine(0, Line);
+	CHECK(memcmp(Line, "on is funny loo", 15) == 0);
+
+	//Leaving the item stops it
+	PressLeft();
+	Device_RunMS(MARQUEE_STEP_MS * 4);
+	CHECK(LCDModel_LineIs(1, "Item 1"));
+	return;
+}
+
+//Check a line without the arrow column
+static uint8_t TextIs(uint8_t y, const char *Text)
+{
+	char Line[LCDMODEL_MAX_COLUMNS+1];
+
+	LCDModel_GetLine(y, Line);
+	Line[15] = 0;
+	while((strlen(Line) > 0) && (Line[strlen(Line) - 1] == ' '))
+	{
+		Line[strlen(Line) - 1] = 0;
+	}
+	return strcmp(Line, Text) == 0;
+}
+
+static void TestSensors(void)
+{
+	char Line[LCDMODEL_MAX_COLUMNS+1];
+
+	PressDown();
+	PressDown();
+	PressDown();
+	CHECK(LCDModel_LineIs(1, "Sensors"));
+
+	//The latest filtered reading, then each window in turn
+	PressRight();
+	CHECK(TextIs(0, "Pressure"));
+	CHECK(TextIs(1, "96.56 kPa"));
+	CHECK(CellIsGlyph(15, 1, Glyph_ArrowLeft));
+	PressCenter();
+	CHECK(TextIs(0, "1m avg 96.56"));
+	CHECK(TextIs(1, "96.56 - 96.56"));
+	PressCenter();
+	CHECK(TextIs(0, "1h avg 96.56"));
+
+	//Redrawn every second
+	PressureModel_SetAdc(600, PRESSUREMODEL_TADC);
+	Device_RunMS(2000);
+	LCDModel_GetLine(0, Line);
+	CHECK(memcmp(Line, "1h avg ", 7) == 0);
+	CHECK(!TextIs(0, "1h avg 96.56"));
+	CHECK(TextIs(1, "72.68 - 96.56"));
+	CHECK(CellIsGlyph(15, 1, Glyph_ArrowLeft));
+	PressCenter();
+	CHECK(TextIs(0, "Pressure"));
+	CHECK(TextIs(1, "72.68 kPa"));
+	PressureModel_SetAdc(PRESSUREMODEL_PADC, PRESSUREMODEL_TADC);
+
+	PressDown();
+	CHECK(TextIs(0, "Temperature"));
+	LCDModel_GetLine(1, Line);
+	CHECK(strstr(Line, " C ") != NULL);
+	PressDown();
+	CHECK(TextIs(0, "Humidity"));
+
+	//Other items are not redrawn
+	PressLeft();
+	Device_RunMS(2000);
+	CHECK(LCDModel_LineIs(1, "Sensors"));
+	PressDown();
+	return;
+}
+
+static void TestTimeout(void)
+{
+	//The menu goes back to the clock 33.5s after the last button press
+	PressDown();
+	Device_RunMS(33000);
+	CHECK(LCDMenuState != 0);
+	Device_RunMS(1000);
+	CHECK_EQ(LCDMenuState, 0);
+	CHECK(!LCDModel_LineIs(0, "Menu"));
+
+	//The backlight fades to the idle level, and back up on a button press
+	Device_RunMS(BACKLIGHT_FADE_STEP_MS * (BACKLIGHT_MAX_LEVEL + 1));
+	CHECK_EQ(Backlight_Level(), Settings.BacklightIdleLevel);
+	PressCenter();
+	Device_RunMS(BACKLIGHT_FADE_STEP_MS * (BACKLIGHT_MAX_LEVEL + 1));
+	CHECK_EQ(Backlight_Level(), Settings.BacklightLevel);
+	return;
+}
+
+//Glyphs that fill the CGRAM, one row each so they are all different
+static const uint8_t FillGlyphs[GLYPH_SLOTS][8] =
+{
+	{0x01}, {0x02}, {0x03}, {0x04}, {0x05}, {0x06}, {0x07}, {0x08},
+};
+
+static void TestClockFallback(void)
+{
+	uint8_t Slots[GLYPH_SLOTS];
+	uint8_t Count;
+	TimeAndDate Time;
+	char Line[LCDMODEL_MAX_COLUMNS+1];
+
+	//Back to the idle clock, then take every slot but one, so the clock gets one glyph and not the other two
+	Device_RunMS(34000);
+	CHECK_EQ(LCDMenuState, 0);
+	BigClock_Stop();
+	for(Count = 0; Count < GLYPH_SLOTS; Count++)
+	{
+		Slots[Count] = Glyph_Acquire(FillGlyphs[Count]);
+		if(Slots[Count] == GLYPH_NO_SLOT)
+		{
+			break;
+		}
+	}
+	CHECK(Count > 0);
+	Glyph_Release(Slots[--Count]);
+
+	memset(&Time, 0, sizeof(Time));
+	Time.year = 2013;
+	Time.month = 2;
+	Time.day = 3;
+	Time.hour = 13;
+	Time.min = 45;
+	Time.sec = 7;
+	SetTime(Time);
+	SPI_LcdBegin();
+	lcd_clrscr();
+	BigClock_Start(&Time);
+	SPI_LcdEnd();
+	CHECK(BigClock_Running());
+	CHECK(LCDModel_LineIs(0, "13:45:07"));
+	CHECK(LCDModel_LineIs(1, ""));
+
+	//The glyph it got was given back
+	Slots[Count] = Glyph_Acquire(FillGlyphs[Count]);
+	CHECK(Slots[Count] != GLYPH_NO_SLOT);
+	Glyph_Release(Slots[Count]);
+
+	//Redrawn each second from the main loop
+	Device_RunMS(1000);
+	CHECK(LCDModel_LineIs(0, "13:45:08"));
+
+	//With the slots free again the next start draws the big digits, 1 PM has the top segment then the block
+	while(Count > 0)
+	{
+		Glyph_Release(Slots[--Count]);
+	}
+	GetTime(&Time);
+	SPI_LcdBegin();
+	BigClock_Stop();
+	lcd_clrscr();
+	BigClock_Start(&Time);
+	SPI_LcdEnd();
+	LCDModel_GetLine(0, Line);
+	CHECK((uint8_t)Line[3] < GLYPH_SLOTS);
+	CHECK_EQ((uint8_t)Line[4], 0xFF);
+	CHECK_EQ(Line[14], 'P');
+	return;
+}
+
+int main(void)
+{
+	Device_PowerOn(16, 2);
+	Device_RunMS(1000);
+
+	TestNavigation();
+	TestMarquee();
+	TestSensors();
+	TestTimeout();
+	TestClockFallback();
+
+	return TEST_DONE();
+}
+
+/** @} */
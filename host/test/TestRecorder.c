@@ -0,0 +1,194 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the data recorder.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include "Device.h"
+#include "Test.h"
+
+#define STORED_MAX		128
+
+static RecorderRecord Stored[STORED_MAX];
+static uint8_t StoredCount;
+static uint8_t StoreCalls;
+static uint8_t StoreFails;
+
+static uint8_t Store(const RecorderRecord *Records, uint8_t Count)
+{
+	StoreCalls++;
+	if(StoreFails)
+	{
+		return 1;
+	}
+	while((Count-- > 0) && (StoredCount < STORED_MAX))
+	{
+		Stored[StoredCount++] = *Records++;
+	}
+	return 0;
+}
+
+static void Reset(void)
+{
+	Recorder_Init();
+	Recorder_SetBackend(Store);
+	StoredCount = 0;
+	StoreCalls = 0;
+	StoreFails = 0;
+	return;
+}
+
+//Run the timer interrupt only, the main loop does not store anything
+static void TickMS(uint16_t ms)
+{
+	while(ms-- > 0)
+	{
+		TIMER0_COMPA_vect();
+	}
+	return;
+}
+
+#define OUTPUT_HAS(Text)	CHECK(strstr(HAL_ConsoleOutput(), (Text)) != NULL)
+
+int main(void)
+{
+	TimeAndDate Time = {2013, 2, 3, 0, 10, 20, 30};
+	RecorderStats Stats;
+	uint8_t i;
+
+	//Values are posted by the test instead of the sensors
+	Device_PowerOn(16, 2);
+	MPL115A1_SetPeriod(0);
+	SHT25_SetPeriod(0);
+	SetTime(Time);
+	Reset();
+
+	//Samples every 10ms, stored a buffer at a time
+	Recorder_SetValue(RECORDER_CHANNEL_PRESSURE, 1600);
+	Recorder_SetValue(RECORDER_CHANNEL_HUMIDITY, 4550);
+	CHECK_EQ(Recorder_Start(10, (1 << RECORDER_CHANNEL_PRESSURE) | (1 << RECORDER_CHANNEL_HUMIDITY)), 0);
+	CHECK_EQ(DataRecoderActive, 1);
+	Device_RunMS(10 * RECORDER_BUFFER_RECORDS - 1);
+	CHECK_EQ(StoredCount, 0);
+	Device_RunMS(1);
+	CHECK_EQ(StoredCount, RECORDER_BUFFER_RECORDS);
+	CHECK_EQ(StoreCalls, 1);
+	CHECK_EQ(Stored[0].Seconds, 413202030UL);
+	CHECK_EQ(Stored[0].Milliseconds, 10);
+	CHECK_EQ(Stored[0].Channels, 0x05);
+	CHECK_EQ(Stored[0].Value[RECORDER_CHANNEL_PRESSURE], 1600);
+	CHECK_EQ(Stored[0].Value[RECORDER_CHANNEL_TEMPERATURE], 0);
+	CHECK_EQ(Stored[0].Value[RECORDER_CHANNEL_HUMIDITY], 4550);
+	CHECK_EQ(Stored[7].Milliseconds, 80);
+
+	//Time carries into the seconds, new values show up in the next sample
+	Recorder_SetValue(RECORDER_CHANNEL_PRESSURE, -5);
+	Device_RunMS(1000);
+	CHECK_EQ(StoredCount, 8 + 96);
+	for(i = 1; i < StoredCount; i++)
+	{
+		CHECK_EQ((Stored[i].Seconds * 1000 + Stored[i].Milliseconds) - (Stored[i - 1].Seconds * 1000 + Stored[i - 1].Milliseconds), 10);
+	}
+	CHECK_EQ(Stored[8].Value[RECORDER_CHANNEL_PRESSURE], -5);
+	CHECK_EQ(Stored[99].Seconds, 413202031UL);
+	CHECK_EQ(Stored[99].Milliseconds, 0);
+
+	//Stopping stores the partly filled buffer
+	Reset();
+	Recorder_Start(5, RECORDER_ALL_CHANNELS);
+	Device_RunMS(5 * 3);
+	Recorder_Stop();
+	CHECK_EQ(DataRecoderActive, 0);
+	CHECK_EQ(StoredCount, 0);
+	Device_RunMS(100);
+	CHECK_EQ(StoredCount, 3);
+	CHECK_EQ(StoreCalls, 1);
+
+	//Both buffers full before the main loop runs, later samples are lost
+	Reset();
+	Recorder_Start(1, RECORDER_ALL_CHANNELS);
+	TickMS(RECORDER_BUFFER_RECORDS * 2 + 5);
+	Recorder_GetStats(&Stats);
+	CHECK_EQ(Stats.Samples, RECORDER_BUFFER_RECORDS * 2);
+	CHECK_EQ(Stats.Overruns, 5);
+	Recorder_Run();
+	CHECK_EQ(StoredCount, RECORDER_BUFFER_RECORDS * 2);
+	CHECK_EQ(Stored[RECORDER_BUFFER_RECORDS].Milliseconds - Stored[RECORDER_BUFFER_RECORDS - 1].Milliseconds, 1);
+
+	//Records are still in order after a stop with both buffers in use
+	TickMS(RECORDER_BUFFER_RECORDS + 2);
+	Recorder_Stop();
+	Recorder_Run();
+	CHECK_EQ(StoredCount, RECORDER_BUFFER_RECORDS * 3 + 2);
+	CHECK(Stored[RECORDER_BUFFER_RECORDS * 3 + 1].Milliseconds > Stored[RECORDER_BUFFER_RECORDS * 3].Milliseconds);
+	CHECK(Stored[RECORDER_BUFFER_RECORDS * 3].Milliseconds > Stored[RECORDER_BUFFER_RECORDS * 2].Milliseconds);
+
+	//A backend error is counted and stops recording
+	Reset();
+	StoreFails = 1;
+	Recorder_Start(1, RECORDER_ALL_CHANNELS);
+	Device_RunMS(RECORDER_BUFFER_RECORDS * 2);
+	Recorder_GetStats(&Stats);
+	CHECK_EQ(Stats.Errors, 1);
+	CHECK_EQ(Stats.Buffers, 0);
+	CHECK_EQ(Stats.Samples, RECORDER_BUFFER_RECORDS);
+	CHECK_EQ(DataRecoderActive, 0);
+	CHECK_EQ(StoreCalls, 1);
+
+	//It can be started again, with empty buffers
+	StoreFails = 0;
+	Recorder_Start(1, RECORDER_ALL_CHANNELS);
+	Device_RunMS(RECORDER_BUFFER_RECORDS);
+	Recorder_GetStats(&Stats);
+	CHECK_EQ(Stats.Buffers, 1);
+	CHECK_EQ(StoredCount, RECORDER_BUFFER_RECORDS);
+	Recorder_Stop();
+
+	//Invalid settings
+	CHECK_EQ(Recorder_Start(0, 1), 1);
+	CHECK_EQ(Recorder_Start(10, 0), 1);
+	CHECK_EQ(Recorder_Start(10, 0x80), 1);
+
+	//Commands
+	Reset();
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("recstart 250"), 0);
+	OUTPUT_HAS("Recorder: on, 250 ms, channels 0x07\n");
+	Device_RunMS(250 * RECORDER_BUFFER_RECORDS);
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("recstat"), 0);
+	OUTPUT_HAS("Samples: 8, buffers: 1, overruns: 0, errors: 0\n");
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("recstop"), 0);
+	OUTPUT_HAS("Recorder: off\n");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("recstart 0 1");
+	OUTPUT_HAS("Invalid");
+	Recorder_SetBackend(NULL);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("recstat");
+	OUTPUT_HAS("No storage");
+
+	return TEST_DONE();
+}
+
+/** @} */
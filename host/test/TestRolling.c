@@ -0,0 +1,197 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+/** \file
+*	\brief		Tests for the rolling statistics of the sensor channels.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+#define OUTPUT_HAS(Text)	CHECK(strstr(HAL_ConsoleOutput(), (Text)) != NULL)
+
+#define CHANNEL		RECORDER_CHANNEL_HUMIDITY
+
+static void Seconds(uint16_t Count)
+{
+	while(Count-- > 0)
+	{
+		Rolling_Second();
+	}
+	return;
+}
+
+static void TestWindows(void)
+{
+	RollingStats Stats;
+
+	Rolling_Init();
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_MINUTE, &Stats), 1);
+	CHECK_EQ(Rolling_Get(RECORDER_CHANNELS, ROLLING_WINDOW_MINUTE, &Stats), 1);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOWS, &Stats), 1);
+
+	Rolling_Add(CHANNEL, 20);
+	Rolling_Add(CHANNEL, 10);
+	Rolling_Add(CHANNEL, 30);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_MINUTE, &Stats), 0);
+	CHECK_EQ(Stats.Min, 10);
+	CHECK_EQ(Stats.Max, 30);
+	CHECK_EQ(Stats.Mean, 20);
+	CHECK_EQ(Stats.Samples, 3);
+	CHECK_EQ(Stats.Seconds, 0);
+	CHECK_EQ(Rolling_Get(RECORDER_CHANNEL_PRESSURE, ROLLING_WINDOW_MINUTE, &Stats), 1);
+
+	//The means of the buckets are weighted by their readings
+	Seconds(ROLLING_MINUTE_BUCKET_S);
+	Rolling_Add(CHANNEL, 40);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_MINUTE, &Stats), 0);
+	CHECK_EQ(Stats.Min, 10);
+	CHECK_EQ(Stats.Max, 40);
+	CHECK_EQ(Stats.Mean, 25);
+	CHECK_EQ(Stats.Samples, 4);
+	CHECK_EQ(Stats.Seconds, ROLLING_MINUTE_BUCKET_S);
+
+	//The first bucket leaves the minute window when it is 80 seconds old
+	Seconds(3 * ROLLING_MINUTE_BUCKET_S - 1);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_MINUTE, &Stats), 0);
+	CHECK_EQ(Stats.Samples, 4);
+	CHECK_EQ(Stats.Seconds, 4 * ROLLING_MINUTE_BUCKET_S - 1);
+	Seconds(1);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_MINUTE, &Stats), 0);
+	CHECK_EQ(Stats.Min, 40);
+	CHECK_EQ(Stats.Max, 40);
+	CHECK_EQ(Stats.Samples, 1);
+	CHECK_EQ(Stats.Seconds, 3 * ROLLING_MINUTE_BUCKET_S);
+	Seconds(2 * ROLLING_MINUTE_BUCKET_S);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_MINUTE, &Stats), 1);
+
+	//but is still in the hour
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_HOUR, &Stats), 0);
+	CHECK_EQ(Stats.Min, 10);
+	CHECK_EQ(Stats.Max, 40);
+	CHECK_EQ(Stats.Mean, 25);
+	CHECK_EQ(Stats.Seconds, 6 * ROLLING_MINUTE_BUCKET_S);
+	Seconds(4 * ROLLING_HOUR_BUCKET_S - 6 * ROLLING_MINUTE_BUCKET_S - 1);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_HOUR, &Stats), 0);
+	Seconds(1);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_HOUR, &Stats), 1);
+
+	//Negative means round to the nearest too
+	Rolling_Add(CHANNEL, -1);
+	Rolling_Add(CHANNEL, -2);
+	Rolling_Add(CHANNEL, -2);
+	Seconds(ROLLING_MINUTE_BUCKET_S);
+	Rolling_Add(CHANNEL, -10);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_MINUTE, &Stats), 0);
+	CHECK_EQ(Stats.Min, -10);
+	CHECK_EQ(Stats.Max, -1);
+	CHECK_EQ(Stats.Mean, -4);
+	return;
+}
+
+static void TestBusy(void)
+{
+	RollingStats Stats;
+	double Reference;
+	uint32_t i;
+	uint8_t Bucket;
+
+	//A bucket's mean is of its first 65535 readings
+	Rolling_Init();
+	for(i = 0; i < 70000; i++)
+	{
+		Rolling_Add(CHANNEL, (i < 65535) ? 1000 : 3000);
+	}
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_HOUR, &Stats), 0);
+	CHECK_EQ(Stats.Mean, 1000);
+	CHECK_EQ(Stats.Max, 3000);
+	CHECK_EQ(Stats.Samples, 65535);
+
+	//Full buckets of large values still add up, the first is gone by the end
+	Rolling_Init();
+	for(Bucket = 0; Bucket < ROLLING_BUCKETS; Bucket++)
+	{
+		for(i = 0; i < ((Bucket == 3) ? 100 : 65535); i++)
+		{
+			Rolling_Add(CHANNEL, (Bucket == 1) ? -32000 : 32000);
+		}
+		Seconds(ROLLING_HOUR_BUCKET_S);
+	}
+	Rolling_Add(CHANNEL, 0);
+	CHECK_EQ(Rolling_Get(CHANNEL, ROLLING_WINDOW_HOUR, &Stats), 0);
+	CHECK_EQ(Stats.Samples, 65535 + 65535 + 100 + 1);
+	CHECK_EQ(Stats.Min, -32000);
+	CHECK_EQ(Stats.Max, 32000);
+	Reference = (65535.0 * -32000 + 65535.0 * 32000 + 100.0 * 32000) / Stats.Samples;
+	CHECK(Stats.Mean > Reference - 2);
+	CHECK(Stats.Mean < Reference + 2);
+	return;
+}
+
+//The sensor readings over a few minutes, seen from the console
+static void TestSensor(void)
+{
+	RollingStats Stats;
+	int16_t Low;
+
+	PressureModel_Reset();
+	Device_PowerOn(16, 2);
+	Device_RunMS(3000);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("stats");
+	OUTPUT_HAS("Pressure: 96.56 kPa\n  1 min: 96.56 to 96.56, mean 96.56, 3 readings in 3 s\n");
+	OUTPUT_HAS("\nTemperature: ");
+	OUTPUT_HAS("\nHumidity: ");
+
+	//A lower pressure for two minutes pushes the first readings out of the minute window
+	PressureModel_SetAdc(600, PRESSUREMODEL_TADC);
+	Low = MPL115A1_Compensate(600, PRESSUREMODEL_TADC);
+	Device_RunMS(120000);
+	CHECK_EQ(Rolling_Get(RECORDER_CHANNEL_PRESSURE, ROLLING_WINDOW_MINUTE, &Stats), 0);
+	CHECK_EQ(Stats.Min, Low);
+	CHECK_EQ(Stats.Max, Low);
+	CHECK(Stats.Seconds >= 60);
+	CHECK_EQ(Rolling_Get(RECORDER_CHANNEL_PRESSURE, ROLLING_WINDOW_HOUR, &Stats), 0);
+	CHECK_EQ(Stats.Min, Low);
+	CHECK_EQ(Stats.Max, 1545);
+	CHECK_EQ(Stats.Samples, 123);
+	CHECK_EQ(Stats.Seconds, 123);
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("stats 1");
+	OUTPUT_HAS("Pressure: 72.68 kPa\n  1 min: no readings\n  1 hour: no readings\n");
+	PressureModel_SetAdc(PRESSUREMODEL_PADC, PRESSUREMODEL_TADC);
+	return;
+}
+
+int main(void)
+{
+	TestWindows();
+	TestBusy();
+	TestSensor();
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,177 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Tests for the SHT25 humidity sensor driver.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+#define OUTPUT_HAS(Text)	CHECK(strstr(HAL_ConsoleOutput(), (Text)) != NULL)
+
+static void TestCrc(void)
+{
+	//Examples from the Sensirion CRC application note
+	static const uint8_t First[] = {0x68, 0x3A};
+	static const uint8_t Second[] = {0x4E, 0x85};
+
+	CHECK_EQ(SHT25_Crc(First, 2), 0x7C);
+	CHECK_EQ(SHT25_Crc(Second, 2), 0x6B);
+	CHECK_EQ(SHT25_Crc(First, 0), 0x00);
+	return;
+}
+
+static void TestMeasure(void)
+{
+	const SHT25ModelStats *Model = SHT25Model_Stats();
+	SHT25Stats Stats;
+	int16_t Temperature;
+	int16_t Humidity;
+
+	SHT25Model_Reset();
+	Device_PowerOn(16, 2);
+	CHECK_EQ(SHT25_GetReading(&Temperature, &Humidity), 1);
+
+	//The temperature command is queued on the first pass of the main loop, and is on the bus for about 1ms
+	Device_RunMS(2);
+	CHECK_EQ(Model->Measurements, 0);
+	Device_RunMS(1);
+	CHECK_EQ(Model->Measurements, 1);
+
+	//Read once after the longest temperature time, which takes 2ms, then the humidity is started
+	Device_RunMS(SHT25_TEMPERATURE_MS);
+	CHECK_EQ(Model->Results, 0);
+	Device_RunMS(1);
+	CHECK_EQ(Model->Results, 1);
+	CHECK_EQ(Model->Measurements, 1);
+	Device_RunMS(2);
+	CHECK_EQ(Model->Measurements, 2);
+	CHECK_EQ(SHT25_GetReading(&Temperature, &Humidity), 1);
+	Device_RunMS(SHT25_HUMIDITY_MS + 1);
+	CHECK_EQ(Model->Results, 2);
+	CHECK_EQ(Model->BusyReads, 0);
+	Device_RunMS(2);
+	CHECK_EQ(SHT25_GetReading(&Temperature, &Humidity), 0);
+	CHECK_EQ(Temperature, 2299);
+	CHECK_EQ(Humidity, 4499);
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("rh");
+	OUTPUT_HAS("Temperature: 22.99 C, humidity: 44.99 %RH\n");
+	OUTPUT_HAS("Measurements: 1, polls: 0, CRC errors: 0, timeouts: 0, bus errors: 0\n");
+
+	//Then every period
+	SHT25Model_SetRaw(0x8000, 0x4000);
+	Device_RunMS(SHT25_PERIOD);
+	SHT25_GetStats(&Stats);
+	CHECK_EQ(Stats.Measurements, 2);
+	SHT25_GetReading(&Temperature, &Humidity);
+	CHECK_EQ(Temperature, 8786 - 4685);
+	CHECK_EQ(Humidity, 3125 - 600);
+
+	//A slow sensor is polled until it is done, which ends this cycle later
+	SHT25Model_SetTimes(SHT25_TEMPERATURE_MS + 8, SHT25_HUMIDITY_MS);
+	Device_RunMS(SHT25_PERIOD + 50);
+	SHT25_GetStats(&Stats);
+	CHECK_EQ(Stats.Measurements, 3);
+	CHECK_EQ(Stats.Polls, 2);
+	CHECK_EQ(Model->BusyReads, 2);
+
+	//One that never finishes gives up after the polls, and the next period tries again
+	SHT25Model_SetTimes(2 * SHT25_TEMPERATURE_MS, SHT25_HUMIDITY_MS);
+	Device_RunMS(SHT25_PERIOD);
+	SHT25_GetStats(&Stats);
+	CHECK_EQ(Stats.Measurements, 3);
+	CHECK_EQ(Stats.Timeouts, 1);
+	SHT25Model_SetTimes(SHT25MODEL_TEMPERATURE_MS, SHT25MODEL_HUMIDITY_MS);
+	Device_RunMS(SHT25_PERIOD);
+	SHT25_GetStats(&Stats);
+	CHECK_EQ(Stats.Measurements, 4);
+
+	//A bad CRC drops the result and keeps the last reading
+	SHT25Model_SetRaw(0x9000, 0x5000);
+	SHT25Model_CorruptCrc(1);
+	Device_RunMS(SHT25_PERIOD);
+	SHT25_GetStats(&Stats);
+	CHECK_EQ(Stats.CrcErrors, 1);
+	CHECK_EQ(Stats.Measurements, 4);
+	SHT25_GetReading(&Temperature, &Humidity);
+	CHECK_EQ(Temperature, 8786 - 4685);
+	Device_RunMS(SHT25_PERIOD);
+	SHT25_GetStats(&Stats);
+	CHECK_EQ(Stats.Measurements, 5);
+	return;
+}
+
+static void TestCommands(void)
+{
+	const SHT25ModelStats *Model = SHT25Model_Stats();
+	uint32_t Measurements;
+
+	SHT25Model_Reset();
+	Device_PowerOn(16, 2);
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("rh 1");
+	OUTPUT_HAS("User register: 0x3A\n");
+	HAL_RunCommandLine("rh 2 59");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("rh 1");
+	OUTPUT_HAS("User register: 0x3B\n");
+
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("rh 3 100");
+	OUTPUT_HAS("Invalid period or no sensor\n");
+	HAL_RunCommandLine("rh 3 0");
+	Measurements = Model->Measurements;
+	Device_RunMS(2 * SHT25_PERIOD);
+	CHECK_EQ(Model->Measurements, Measurements);
+
+	//Without the sensor
+	SHT25Model_SetPresent(0);
+	Device_PowerOn(16, 2);
+	Device_RunMS(SHT25_PERIOD);
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("rh");
+	OUTPUT_HAS("No reading\n");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("rh 3 2000");
+	OUTPUT_HAS("Invalid period or no sensor\n");
+	HAL_ConsoleClear();
+	HAL_RunCommandLine("rh 1");
+	OUTPUT_HAS("I2C error 1\n");
+	SHT25Model_SetPresent(1);
+	return;
+}
+
+int main(void)
+{
+	TestCrc();
+	TestMeasure();
+	TestCommands();
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,383 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+/** \file
+*	\brief		Tests for the shared SPI bus.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+//MPL115A1 register reads, a command byte and then the data in the next byte
+#define READ(Reg)		(0x80 | ((Reg) << 1))
+#define REG_A0			0x04
+#define REG_B1			0x06
+
+static const uint8_t ReadA0[] = {READ(REG_A0), 0, READ(REG_A0 + 1), 0, 0};
+static const uint8_t ReadB1[] = {READ(REG_B1), 0, READ(REG_B1 + 1), 0, 0};
+
+static SPITransaction *Finished[8];
+static uint8_t FinishedCount;
+
+static void Done(SPITransaction *Transaction)
+{
+	if(FinishedCount < 8)
+	{
+		Finished[FinishedCount++] = Transaction;
+	}
+	return;
+}
+
+static void Setup(SPITransaction *Transaction, const uint8_t *Write, uint8_t *Read)
+{
+	memset(Transaction, 0, sizeof(*Transaction));
+	Transaction->Device = SPI_DEVICE_PRESSURE;
+	Transaction->Write = Write;
+	Transaction->Read = Read;
+	Transaction->Length = sizeof(ReadA0);
+	Transaction->Callback = Done;
+	return;
+}
+
+//The bus to itself, without the main loop or the sensor driver using it
+static void PowerOn(void)
+{
+	PressureModel_Reset();
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	SPIModel_Reset();
+	FinishedCount = 0;
+	return;
+}
+
+static uint8_t FlashID(void)
+{
+	uint8_t ID;
+
+	SPI_Select(SPI_DEVICE_DATAFLASH);
+	SPI_Transfer(0x9F);
+	ID = SPI_Transfer(0x00);
+	SPI_Deselect();
+	return ID;
+}
+
+static void TestQueue(void)
+{
+	const SPIModelStats *Stats = SPIModel_Stats();
+	SPITransaction A, B, More[SPI_QUEUE_LENGTH];
+	uint8_t DataA[sizeof(ReadA0)];
+	uint8_t DataB[sizeof(ReadB1)];
+	uint8_t i;
+
+	PowerOn();
+	Setup(&A, ReadA0, DataA);
+	Setup(&B, ReadB1, DataB);
+
+	//The first byte goes out straight away, the rest from the interrupt
+	CHECK_EQ(SPI_Submit(&A), 0);
+	CHECK_EQ(SPI_Submit(&B), 0);
+	CHECK_EQ(Stats->Bytes, 1);
+	CHECK_EQ(A.Status, SPI_STATUS_PENDING);
+	CHECK_EQ(B.Status, SPI_STATUS_PENDING);
+	CHECK(SPCR & (1<<SPIE));
+
+	SPIModel_Tick();
+	CHECK_EQ(A.Status, SPI_STATUS_OK);
+	CHECK_EQ(B.Status, SPI_STATUS_OK);
+	CHECK_EQ(FinishedCount, 2);
+	CHECK(Finished[0] == &A);
+	CHECK(Finished[1] == &B);
+	CHECK_EQ(DataA[1], PRESSUREMODEL_A0 >> 8);
+	CHECK_EQ(DataA[3], PRESSUREMODEL_A0 & 0xFF);
+	CHECK_EQ(DataB[1], PRESSUREMODEL_B1 >> 8);
+	CHECK_EQ(DataB[3], PRESSUREMODEL_B1 & 0xFF);
+	CHECK_EQ(Stats->Bytes, 10);
+	CHECK_EQ(Stats->Interrupts, 10);
+	CHECK_EQ(Stats->Conflicts, 0);
+	CHECK_EQ(Stats->WrongMode, 0);
+
+	//The interrupt is off once the queue is empty
+	CHECK_EQ(SPCR & (1<<SPIE), 0);
+
+	//A full queue and an empty transaction are turned away
+	for(i = 0; i < SPI_QUEUE_LENGTH; i++)
+	{
+		Setup(&More[i], ReadA0, NULL);
+		CHECK_EQ(SPI_Submit(&More[i]), 0);
+	}
+	CHECK_EQ(SPI_Submit(&A), 1);
+	B.Length = 0;
+	CHECK_EQ(SPI_Submit(&B), 1);
+	SPIModel_Tick();
+	for(i = 0; i < SPI_QUEUE_LENGTH; i++)
+	{
+		CHECK_EQ(More[i].Status, SPI_STATUS_OK);
+	}
+	CHECK_EQ(Stats->Conflicts, 0);
+	return;
+}
+
+static void TestSelect(void)
+{
+	const SPIModelStats *Stats = SPIModel_Stats();
+	SPITransaction A, B;
+	uint8_t DataA[sizeof(ReadA0)];
+	uint8_t DataB[sizeof(ReadB1)];
+	uint32_t Bytes;
+
+	PowerOn();
+	Setup(&A, ReadA0, DataA);
+	Setup(&B, ReadB1, DataB);
+
+	//Selecting finishes the transaction on the bus first
+	SPI_Submit(&A);
+	SPI_Select(SPI_DEVICE_DATAFLASH);
+	CHECK_EQ(A.Status, SPI_STATUS_OK);
+	CHECK_EQ(DataA[3], PRESSUREMODEL_A0 & 0xFF);
+	CHECK_EQ(SPCR & 0x03, 0x00);
+	CHECK(SPSR & (1<<SPI2X));
+
+	//and holds the queue until the device is deselected
+	Bytes = Stats->Bytes;
+	SPI_Submit(&B);
+	CHECK_EQ(Stats->Bytes, Bytes);
+	SPI_Transfer(0x9F);
+	CHECK_EQ(SPI_Transfer(0x00), 0x1F);
+	SPIModel_Tick();
+	CHECK_EQ(B.Status, SPI_STATUS_PENDING);
+	SPI_Deselect();
+	CHECK_EQ(Stats->Bytes, Bytes + 3);
+
+	//The pressure sensor is run at Fcpu/8
+	CHECK_EQ(SPCR & 0x03, 0x01);
+	CHECK(SPSR & (1<<SPI2X));
+	SPIModel_Tick();
+	CHECK_EQ(B.Status, SPI_STATUS_OK);
+	CHECK_EQ(DataB[1], PRESSUREMODEL_B1 >> 8);
+
+	//A second deselect does nothing
+	SPI_Deselect();
+	CHECK_EQ(Stats->Conflicts, 0);
+	return;
+}
+
+static void TestLcd(void)
+{
+	const SPIModelStats *Stats = SPIModel_Stats();
+	SPITransaction A;
+	uint8_t DataA[sizeof(ReadA0)];
+
+	PowerOn();
+	Setup(&A, ReadA0, DataA);
+
+	//Nothing starts while the LCD has port B
+	SPI_LcdBegin();
+	CHECK_EQ(SPCR, 0);
+	SPI_Submit(&A);
+	CHECK_EQ(Stats->Bytes, 0);
+	lcd_putc('A');
+	SPIModel_Tick();
+	CHECK_EQ(A.Status, SPI_STATUS_PENDING);
+
+	//The flash can still be used, and port B goes back to the LCD after
+	CHECK_EQ(FlashID(), 0x1F);
+	CHECK_EQ(SPCR, 0);
+	lcd_putc('B');
+	CHECK(LCDModel_LineIs(0, "AB"));
+	CHECK_EQ(Stats->LcdConflicts, 0);
+
+	//Sections nest, the inner end leaves port B with the LCD
+	SPI_LcdBegin();
+	SPI_LcdEnd();
+	CHECK_EQ(SPCR, 0);
+	SPIModel_Tick();
+	CHECK_EQ(A.Status, SPI_STATUS_PENDING);
+
+	SPI_LcdEnd();
+	CHECK_EQ(Stats->Bytes, 3);
+	SPIModel_Tick();
+	CHECK_EQ(A.Status, SPI_STATUS_OK);
+	CHECK_EQ(DataA[1], PRESSUREMODEL_A0 >> 8);
+	CHECK_EQ(Stats->Conflicts, 0);
+	CHECK_EQ(Stats->LcdConflicts, 0);
+
+	//Writing to the LCD while a transaction runs is caught by the model
+	A.Status = 0;
+	SPI_Submit(&A);
+	lcd_putc('C');
+	CHECK(Stats->LcdConflicts > 0);
+	SPIModel_Tick();
+	return;
+}
+
+static void TestModes(void)
+{
+	const SPIModelStats *Stats = SPIModel_Stats();
+	SPITransaction A;
+	uint8_t DataA[sizeof(ReadA0)];
+
+	PowerOn();
+	Setup(&A, ReadA0, DataA);
+
+	//The sensor only takes mode 0
+	SPI_Configure(SPI_DEVICE_PRESSURE, SPI_MODE_1 | SPI_CLOCK_DIV8);
+	SPI_Submit(&A);
+	SPIModel_Tick();
+	CHECK_EQ(Stats->WrongMode, sizeof(ReadA0));
+
+	//The flash takes mode 3 too
+	SPI_Configure(SPI_DEVICE_DATAFLASH, SPI_MODE_3 | SPI_CLOCK_DIV4);
+	CHECK_EQ(FlashID(), 0x1F);
+	CHECK_EQ(Stats->WrongMode, sizeof(ReadA0));
+
+	SPI_Configure(SPI_DEVICE_PRESSURE, SPI_MODE_0 | SPI_CLOCK_DIV8);
+	SPI_Configure(SPI_DEVICE_DATAFLASH, SPI_MODE_0 | SPI_CLOCK_DIV2);
+	SPI_Submit(&A);
+	SPIModel_Tick();
+	CHECK_EQ(DataA[3], PRESSUREMODEL_A0 & 0xFF);
+	CHECK_EQ(Stats->WrongMode, sizeof(ReadA0));
+	CHECK_EQ(Stats->Conflicts, 0);
+	return;
+}
+
+//The sensor, the recorder writing to the flash and the idle clock on the LCD together
+static void TestShared(void)
+{
+	const SPIModelStats *Stats = SPIModel_Stats();
+	RecorderStats Recorded;
+	ISRStat Stat;
+	SPITransaction A;
+	uint32_t Writes;
+	int16_t Pressure;
+
+	PressureModel_Reset();
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+	ISRStats_Clear();
+	CHECK_EQ(Recorder_Start(10, RECORDER_ALL_CHANNELS), 0);
+	Device_RunMS(5000);
+	Recorder_Stop();
+	Device_RunMS(1);
+
+	Recorder_GetStats(&Recorded);
+	CHECK(Recorded.Buffers > 0);
+	CHECK_EQ(Recorded.Errors, 0);
+	CHECK_EQ(MPL115A1_GetPressure(&Pressure), 0);
+	CHECK_EQ(Pressure, 1545);
+	CHECK_EQ(Stats->Conflicts, 0);
+	CHECK_EQ(Stats->WrongMode, 0);
+	CHECK_EQ(Stats->LcdConflicts, 0);
+	CHECK(LCDModel_Stats()->DataWrites > 0);
+
+	//Two interrupts a second for the sensor
+	ISRStats_Get(ISRSTATS_SPI_STC, &Stat);
+	CHECK_EQ(Stat.Count, 5 * (2 + 9));
+
+	//A new second in the middle of a transaction leaves the LCD alone, the clock is drawn from the main loop
+	Writes = LCDModel_Stats()->DataWrites;
+	Setup(&A, ReadA0, NULL);
+	SPI_Submit(&A);
+	ElapsedMS = 999;
+	TIMER0_COMPA_vect();
+	CHECK_EQ(LCDModel_Stats()->DataWrites, Writes);
+	SPIModel_Tick();
+	CHECK_EQ(A.Status, SPI_STATUS_OK);
+	Device_MainLoop();
+	CHECK(LCDModel_Stats()->DataWrites > Writes);
+	CHECK_EQ(Stats->LcdConflicts, 0);
+	return;
+}
+
+static SPITransaction TaskTransaction;
+static uint8_t TaskStatus;
+
+//Scheduler task standing in for a long one, the SPI interrupt comes in while it runs
+static void QueueTask(void)
+{
+	Setup(&TaskTransaction, ReadB1, NULL);
+	SPI_Submit(&TaskTransaction);
+	SPIModel_Tick();
+	TaskStatus = TaskTransaction.Status;
+	return;
+}
+
+//Only the LCD redraws hold the queue, not the whole main loop pass
+static void TestLoop(void)
+{
+	const SPIModelStats *Stats = SPIModel_Stats();
+	char Line[LCDMODEL_MAX_COLUMNS+1];
+	RecorderStats Recorded;
+	uint32_t Writes;
+
+	PressureModel_Reset();
+	FlashModel_Reset(0xFF);
+	Device_PowerOn(16, 2);
+
+	TaskStatus = SPI_STATUS_PENDING;
+	Scheduler_Start(QueueTask, 10, 0);
+	Device_RunMS(20);
+	CHECK_EQ(TaskStatus, SPI_STATUS_OK);
+
+	//A scrolling menu line and the recorder share the bus, center, right and down get to it
+	CHECK_EQ(Recorder_Start(10, RECORDER_ALL_CHANNELS), 0);
+	INT5_vect();
+	Device_RunMS(100);
+	PINC = 0x04;
+	PIND = 0x00;
+	PCINT1_vect();
+	PIND = 0x20;
+	Device_RunMS(100);
+	PINC = 0x00;
+	PCINT1_vect();
+	PINC = 0x04;
+	Device_MainLoop();
+	Writes = LCDModel_Stats()->DataWrites;
+	Device_RunMS(MARQUEE_STEP_MS * (MARQUEE_HOLD_STEPS + 1));
+	LCDModel_GetLine(0, Line);
+	CHECK(memcmp(Line, "on is funny loo", 15) == 0);
+	CHECK(LCDModel_Stats()->DataWrites > Writes);
+	Recorder_Stop();
+	Device_RunMS(1);
+
+	Recorder_GetStats(&Recorded);
+	CHECK(Recorded.Buffers > 0);
+	CHECK_EQ(Recorded.Errors, 0);
+	CHECK_EQ(Stats->Conflicts, 0);
+	CHECK_EQ(Stats->LcdConflicts, 0);
+	return;
+}
+
+int main(void)
+{
+	TestQueue();
+	TestSelect();
+	TestLcd();
+	TestModes();
+	TestShared();
+	TestLoop();
+
+	return TEST_DONE();
+}
+
+/** @} */
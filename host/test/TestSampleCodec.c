@@ -0,0 +1,289 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Tests for the compressed sample encoding.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "Device.h"
+#include "Test.h"
+
+#define FUZZ_SAMPLES		200000
+
+static uint32_t Random = 12345;
+
+//Same sequence on every host, unlike rand()
+static uint32_t NextRandom(void)
+{
+	Random = Random * 1103515245 + 12345;
+	return Random >> 8;
+}
+
+static uint8_t SameRecord(const RecorderRecord *A, const RecorderRecord *B)
+{
+	uint8_t i;
+
+	if((A->Seconds != B->Seconds) || (A->Milliseconds != B->Milliseconds) || (A->Channels != B->Channels))
+	{
+		return 0;
+	}
+	for(i = 0; i < RECORDER_CHANNELS; i++)
+	{
+		if(A->Value[i] != B->Value[i])
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void TestVectors(void)
+{
+	static const uint8_t Keyframe[] = {0x85, 0xF6, 0xEC, 0x83, 0xC5, 0x01, 0xFA, 0x01, 0xA0, 0x19, 0x09};
+	static const uint8_t Delta[] = {0x05, 0xE2, 0x09, 0x05, 0x90, 0x03};
+	static const uint8_t BadMilliseconds[] = {0x81, 0x00, 0xE8, 0x07, 0x00};
+	static const uint8_t BadValue[] = {0x81, 0x00, 0x00, 0x80, 0x80, 0x04};
+	static const uint8_t LongVarint[] = {0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00};
+	RecorderRecord Record = {413202038, 250, 0x05, {1616, 0, -5}};
+	RecorderRecord Decoded;
+	SampleCodecState Encoder;
+	SampleCodecState Decoder;
+	uint8_t Out[SAMPLECODEC_MAX_SIZE];
+	uint8_t Length;
+
+	SampleCodec_Reset(&Encoder);
+	SampleCodec_Reset(&Decoder);
+
+	//No reference yet, so a keyframe even if a delta is asked for
+	Length = SampleCodec_Encode(&Encoder, &Record, 0, Out);
+	CHECK_EQ(Length, sizeof(Keyframe));
+	CHECK(memcmp(Out, Keyframe, sizeof(Keyframe)) == 0);
+	CHECK_EQ(SampleCodec_Decode(&Decoder, Out, Length, &Decoded), 0);
+	CHECK(SameRecord(&Decoded, &Record));
+	SampleCodec_Next(&Encoder, &Record);
+
+	//1.25s later, pressure down 3, humidity up 200
+	Record.Seconds++;
+	Record.Milliseconds = 500;
+	Record.Value[0] -= 3;
+	Record.Value[2] += 200;
+	Length = SampleCodec_Encode(&Encoder, &Record, 0, Out);
+	CHECK_EQ(Length, sizeof(Delta));
+	CHECK(memcmp(Out, Delta, sizeof(Delta)) == 0);
+	CHECK_EQ(SampleCodec_Decode(&Decoder, Out, Length, &Decoded), 0);
+	CHECK(SameRecord(&Decoded, &Record));
+
+	//Encoding does not move the reference
+	CHECK_EQ(SampleCodec_Encode(&Encoder, &Record, 0, Out), sizeof(Delta));
+
+	//A delta without a reference, or with other channels, is not decoded
+	SampleCodec_Reset(&Decoder);
+	CHECK_EQ(SampleCodec_Decode(&Decoder, Delta, sizeof(Delta), &Decoded), 1);
+	CHECK_EQ(SampleCodec_Decode(&Decoder, Keyframe, sizeof(Keyframe), &Decoded), 0);
+	Out[0] = 0x01;
+	CHECK_EQ(SampleCodec_Decode(&Decoder, Out, 3, &Decoded), 1);
+
+	//Unknown flags, cut off and trailing bytes
+	memcpy(Out, Keyframe, sizeof(Keyframe));
+	Out[0] |= 0x40;
+	CHECK_EQ(SampleCodec_Decode(&Decoder, Out, sizeof(Keyframe), &Decoded), 1);
+	CHECK_EQ(SampleCodec_Decode(&Decoder, Keyframe, 0, &Decoded), 1);
+	for(Length = 1; Length < sizeof(Keyframe); Length++)
+	{
+		CHECK_EQ(SampleCodec_Decode(&Decoder, Keyframe, Length, &Decoded), 1);
+	}
+	memcpy(Out, Keyframe, sizeof(Keyframe));
+	Out[sizeof(Keyframe)] = 0;
+	CHECK_EQ(SampleCodec_Decode(&Decoder, Out, sizeof(Keyframe) + 1, &Decoded), 1);
+
+	//Milliseconds of 1000 or more, and a value over 16 bits
+	CHECK_EQ(SampleCodec_Decode(&Decoder, BadMilliseconds, sizeof(BadMilliseconds), &Decoded), 1);
+	CHECK_EQ(SampleCodec_Decode(&Decoder, BadValue, sizeof(BadValue), &Decoded), 1);
+	CHECK_EQ(SampleCodec_Decode(&Decoder, LongVarint, sizeof(LongVarint), &Decoded), 1);
+	return;
+}
+
+static void TestKeyframes(void)
+{
+	RecorderRecord Record = {1000, 900, RECORDER_ALL_CHANNELS, {0, 0, 0}};
+	RecorderRecord Next;
+	SampleCodecState Encoder;
+	uint8_t Out[SAMPLECODEC_MAX_SIZE];
+
+	SampleCodec_Reset(&Encoder);
+	SampleCodec_Next(&Encoder, &Record);
+
+	Next = Record;
+	Next.Milliseconds = 950;
+	CHECK_EQ(SampleCodec_Encode(&Encoder, &Next, 0, Out), 5);
+	CHECK_EQ(Out[0], RECORDER_ALL_CHANNELS);
+	CHECK_EQ(SampleCodec_Encode(&Encoder, &Next, 1, Out), 1 + 2 + 2 + 3);
+	CHECK_EQ(Out[0], SAMPLECODEC_KEYFRAME | RECORDER_ALL_CHANNELS);
+
+	//Other channels
+	Next.Channels = 0x03;
+	SampleCodec_Encode(&Encoder, &Next, 0, Out);
+	CHECK_EQ(Out[0], SAMPLECODEC_KEYFRAME | 0x03);
+
+	//Backwards in time
+	Next = Record;
+	Next.Milliseconds = 899;
+	SampleCodec_Encode(&Encoder, &Next, 0, Out);
+	CHECK_EQ(Out[0], SAMPLECODEC_KEYFRAME | RECORDER_ALL_CHANNELS);
+	Next.Seconds--;
+	Next.Milliseconds = 999;
+	SampleCodec_Encode(&Encoder, &Next, 0, Out);
+	CHECK_EQ(Out[0], SAMPLECODEC_KEYFRAME | RECORDER_ALL_CHANNELS);
+
+	//The longest gap in a delta, and one second more
+	Next = Record;
+	Next.Seconds += SAMPLECODEC_MAX_GAP;
+	CHECK_EQ(SampleCodec_Encode(&Encoder, &Next, 0, Out), 1 + 4 + 3);
+	CHECK_EQ(Out[0], RECORDER_ALL_CHANNELS);
+	Next.Seconds++;
+	SampleCodec_Encode(&Encoder, &Next, 0, Out);
+	CHECK_EQ(Out[0], SAMPLECODEC_KEYFRAME | RECORDER_ALL_CHANNELS);
+
+	//Changes wrap around, so the largest jump is still 3 bytes
+	Next = Record;
+	Record.Value[0] = -32768;
+	SampleCodec_Next(&Encoder, &Record);
+	Next.Value[0] = 32767;
+	CHECK_EQ(SampleCodec_Encode(&Encoder, &Next, 0, Out), 1 + 1 + 1 + 1 + 1);
+	return;
+}
+
+//Random walks with jumps, channel changes, time gaps and forced keyframes
+static void TestFuzz(void)
+{
+	RecorderRecord Record = {0, 0, RECORDER_ALL_CHANNELS, {0, 0, 0}};
+	RecorderRecord Decoded;
+	SampleCodecState Encoder;
+	SampleCodecState Decoder;
+	uint8_t Out[SAMPLECODEC_MAX_SIZE + 1];
+	uint32_t Mismatches = 0;
+	uint32_t TooLong = 0;
+	uint32_t Bytes = 0;
+	uint32_t Choice;
+	uint8_t Length;
+	uint32_t n;
+	uint8_t i;
+
+	SampleCodec_Reset(&Encoder);
+	SampleCodec_Reset(&Decoder);
+
+	for(n = 0; n < FUZZ_SAMPLES; n++)
+	{
+		Choice = NextRandom() % 1000;
+		if(Choice < 5)
+		{
+			Record.Channels = NextRandom() % (RECORDER_ALL_CHANNELS + 1);
+		}
+		if(Choice < 10)
+		{
+			Record.Seconds = NextRandom() * 257;
+			Record.Milliseconds = NextRandom() % 1000;
+		}
+		else if(Choice < 20)
+		{
+			Record.Seconds += NextRandom() % (2 * SAMPLECODEC_MAX_GAP);
+		}
+		else
+		{
+			Record.Milliseconds += 1 + NextRandom() % 2000;
+			Record.Seconds += Record.Milliseconds / 1000;
+			Record.Milliseconds %= 1000;
+		}
+
+		for(i = 0; i < RECORDER_CHANNELS; i++)
+		{
+			if((Record.Channels & (1 << i)) == 0)
+			{
+				Record.Value[i] = 0;
+			}
+			else if(Choice < 30)
+			{
+				Record.Value[i] = NextRandom();
+			}
+			else
+			{
+				Record.Value[i] += (int16_t)(NextRandom() % 21) - 10;
+			}
+		}
+
+		Length = SampleCodec_Encode(&Encoder, &Record, (Choice % 97) == 0, Out);
+		if(Length > SAMPLECODEC_MAX_SIZE)
+		{
+			TooLong++;
+		}
+		if((SampleCodec_Decode(&Decoder, Out, Length, &Decoded) != 0) || !SameRecord(&Decoded, &Record))
+		{
+			Mismatches++;
+		}
+		SampleCodec_Next(&Encoder, &Record);
+		Bytes += Length;
+	}
+	CHECK_EQ(Mismatches, 0);
+	CHECK_EQ(TooLong, 0);
+	CHECK(Bytes < FUZZ_SAMPLES * 7);
+
+	//Garbage must not be read past its length or leave a half decoded reference
+	for(n = 0; n < FUZZ_SAMPLES; n++)
+	{
+		Length = NextRandom() % (sizeof(Out) + 1);
+		for(i = 0; i < Length; i++)
+		{
+			Out[i] = NextRandom();
+		}
+		if((n % 2) == 0)
+		{
+			Out[0] &= SAMPLECODEC_KEYFRAME | RECORDER_ALL_CHANNELS;
+		}
+		Decoder.Last = Record;
+		Decoder.Valid = 1;
+		if(SampleCodec_Decode(&Decoder, Out, Length, &Decoded) != 0)
+		{
+			if(!SameRecord(&Decoder.Last, &Record))
+			{
+				Mismatches++;
+			}
+		}
+		else if(!SameRecord(&Decoder.Last, &Decoded))
+		{
+			Mismatches++;
+		}
+	}
+	CHECK_EQ(Mismatches, 0);
+	return;
+}
+
+int main(void)
+{
+	TestVectors();
+	TestKeyframes();
+	TestFuzz();
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,124 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the millisecond scheduler.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include "Device.h"
+#include "Test.h"
+
+static uint16_t RunsA;
+static uint16_t RunsB;
+static uint16_t RunsOnce;
+
+static void TaskA(void)
+{
+	RunsA++;
+	return;
+}
+
+static void TaskB(void)
+{
+	RunsB++;
+	return;
+}
+
+//Reschedules itself from inside the run
+static void TaskOnce(void)
+{
+	RunsOnce++;
+	if(RunsOnce < 3)
+	{
+		Scheduler_Start(TaskOnce, 5, 0);
+	}
+	return;
+}
+
+static void Filler(void)
+{
+	return;
+}
+
+static void RunMS(uint16_t ms)
+{
+	while(ms-- > 0)
+	{
+		Scheduler_Tick();
+		Scheduler_Run();
+	}
+	return;
+}
+
+int main(void)
+{
+	uint8_t i;
+
+	HAL_Reset();
+	sei();
+	Scheduler_Init();
+
+	//Periodic task with a first delay
+	CHECK_EQ(Scheduler_Start(TaskA, 10, 100), 0);
+	RunMS(9);
+	CHECK_EQ(RunsA, 0);
+	RunMS(1);
+	CHECK_EQ(RunsA, 1);
+	RunMS(300);
+	CHECK_EQ(RunsA, 4);
+
+	//Starting again only changes the timing, it does not use a second slot
+	CHECK_EQ(Scheduler_Start(TaskA, 1, 1), 0);
+	RunMS(10);
+	CHECK_EQ(RunsA, 14);
+
+	//Stop also cancels a run that is already due
+	Scheduler_Tick();
+	Scheduler_Stop(TaskA);
+	Scheduler_Run();
+	CHECK_EQ(RunsA, 14);
+
+	//Single run tasks can schedule themselves again
+	CHECK_EQ(Scheduler_Start(TaskOnce, 5, 0), 0);
+	RunMS(100);
+	CHECK_EQ(RunsOnce, 3);
+
+	//Delay 0 runs on the next tick
+	CHECK_EQ(Scheduler_Start(TaskB, 0, 0), 0);
+	RunMS(1);
+	CHECK_EQ(RunsB, 1);
+
+	//Only SCHEDULER_MAX_TASKS tasks fit, a different function pointer cast is a different task
+	Scheduler_Init();
+	CHECK_EQ(Scheduler_Start(TaskB, 1000, 0), 0);
+	for(i = 1; i < SCHEDULER_MAX_TASKS; i++)
+	{
+		CHECK_EQ(Scheduler_Start((SchedulerTask)((char *)Filler + i), 1000, 0), 0);
+	}
+	CHECK_EQ(Scheduler_Start(TaskA, 1000, 0), 1);
+
+	//Interrupts are left on
+	CHECK((SREG & (1<<SREG_I)) != 0);
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -0,0 +1,316 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+*	\brief		Tests for the interrupt driven I2C master, on the bus model.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include <string.h>
+#include "config.h"
+#include "Device.h"
+#include "Test.h"
+
+//Ticks for a transaction: start, 18 per byte with the address, stop
+#define TICKS(Bytes)		(3 + 18 * ((Bytes) + 1) + 2)
+
+static SoftI2CTransaction *Finished[8];
+static uint8_t FinishedCount;
+
+static void Done(SoftI2CTransaction *Transaction)
+{
+	if(FinishedCount < 8)
+	{
+		Finished[FinishedCount++] = Transaction;
+	}
+	return;
+}
+
+static void Setup(SoftI2CTransaction *Transaction, uint8_t Address, const uint8_t *Write, uint8_t WriteLength, uint8_t *Read, uint8_t ReadLength)
+{
+	Transaction->Address = Address;
+	Transaction->Write = Write;
+	Transaction->WriteLength = WriteLength;
+	Transaction->Read = Read;
+	Transaction->ReadLength = ReadLength;
+	Transaction->Callback = Done;
+	return;
+}
+
+//The bus is free and both lines are let go
+static uint8_t BusIdle(void)
+{
+	return (TCCR1B == 0) && ((DDRB & (1<<7)) == 0) && ((DDRC & (1<<6)) == 0) && (PINB & (1<<7)) && (PINC & (1<<6));
+}
+
+static void Reset(void)
+{
+	SHT25Model_Reset();
+	Device_PowerOn(16, 2);
+	SHT25_SetPeriod(0);
+	MPL115A1_SetPeriod(0);
+	Device_RunMS(1);
+	SoftI2CModel_Reset();
+	FinishedCount = 0;
+	return;
+}
+
+static void TestBlocking(void)
+{
+	const SoftI2CModelStats *Bus = SoftI2CModel_Stats();
+	const uint8_t Command = 0xE7;
+	uint8_t Value = 0;
+
+	Reset();
+
+	//Only the address goes out to a missing device
+	CHECK_EQ(SoftI2C_Transfer(0x50, &Command, 1, &Value, 1), SOFTI2C_STATUS_ADDRESS_NACK);
+	Device_RunMS(1);
+	CHECK_EQ(Bus->Starts, 1);
+	CHECK_EQ(Bus->Stops, 1);
+	CHECK_EQ(Bus->Bytes, 1);
+	CHECK_EQ(Bus->Nacks, 1);
+
+	//Write, repeated start and read
+	SoftI2CModel_Reset();
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, &Command, 1, &Value, 1), SOFTI2C_STATUS_OK);
+	CHECK_EQ(Value, SHT25MODEL_USER_REG);
+	Device_RunMS(1);
+	CHECK_EQ(Bus->Starts, 2);
+	CHECK_EQ(Bus->Stops, 1);
+	CHECK_EQ(Bus->Bytes, 4);
+	CHECK_EQ(Bus->Ticks, TICKS(1) + 3 + 18 + 18);
+	CHECK_EQ(Bus->DrivenHigh, 0);
+	CHECK(BusIdle());
+
+	//Interrupts off makes no difference, the engine runs from the wait loop
+	cli();
+	Value = 0;
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, &Command, 1, &Value, 1), SOFTI2C_STATUS_OK);
+	CHECK_EQ(Value, SHT25MODEL_USER_REG);
+	sei();
+	CHECK_EQ(TIMSK1, (1<<OCIE1A));
+	return;
+}
+
+static void TestQueue(void)
+{
+	const SoftI2CModelStats *Bus = SoftI2CModel_Stats();
+	static const uint8_t Command[2] = {0xE6, 0x3B};
+	static const uint8_t ReadUser = 0xE7;
+	SoftI2CTransaction Transaction[SOFTI2C_QUEUE_LENGTH + 1];
+	uint8_t Value = 0;
+	uint8_t i;
+
+	Reset();
+
+	//Nothing happens until the timer interrupt runs, so the main loop carries on
+	Setup(&Transaction[0], SHT25_ADDRESS, Command, 2, NULL, 0);
+	Setup(&Transaction[1], SHT25_ADDRESS, &ReadUser, 1, &Value, 1);
+	Setup(&Transaction[2], 0x51, NULL, 0, NULL, 0);
+	Setup(&Transaction[3], SHT25_ADDRESS, NULL, 0, NULL, 0);
+	Setup(&Transaction[4], SHT25_ADDRESS, NULL, 0, NULL, 0);
+	for(i = 0; i < SOFTI2C_QUEUE_LENGTH; i++)
+	{
+		CHECK_EQ(SoftI2C_Submit(&Transaction[i]), 0);
+		CHECK_EQ(Transaction[i].Status, SOFTI2C_STATUS_PENDING);
+	}
+	CHECK_EQ(SoftI2C_Submit(&Transaction[SOFTI2C_QUEUE_LENGTH]), 1);
+	CHECK(TCCR1B != 0);
+	CHECK_EQ(Bus->Ticks, 0);
+
+	//40 ticks a millisecond at the default speed
+	Device_RunMS(1);
+	CHECK_EQ(Bus->Ticks, 1000 / SOFTI2C_HALF_BIT_US);
+	CHECK_EQ(FinishedCount, 0);
+	Device_RunMS(2);
+	CHECK_EQ(FinishedCount, 1);
+
+	//Done in order, each with its own status
+	Device_RunMS(5);
+	CHECK_EQ(FinishedCount, 4);
+	for(i = 0; i < 4; i++)
+	{
+		CHECK(Finished[i] == &Transaction[i]);
+	}
+	CHECK_EQ(Transaction[0].Status, SOFTI2C_STATUS_OK);
+	CHECK_EQ(Transaction[1].Status, SOFTI2C_STATUS_OK);
+	CHECK_EQ(Value, 0x3B);
+	CHECK_EQ(Transaction[2].Status, SOFTI2C_STATUS_ADDRESS_NACK);
+	CHECK_EQ(Transaction[3].Status, SOFTI2C_STATUS_OK);
+	CHECK_EQ(Bus->Ticks, TICKS(2) + TICKS(1) + 3 + 18 + 18 + TICKS(0) + TICKS(0));
+	CHECK(BusIdle());
+
+	//A blocking transfer waits for the ones ahead of it
+	FinishedCount = 0;
+	CHECK_EQ(SoftI2C_Submit(&Transaction[2]), 0);
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, NULL, 0, NULL, 0), SOFTI2C_STATUS_OK);
+	CHECK_EQ(FinishedCount, 1);
+	CHECK_EQ(Transaction[2].Status, SOFTI2C_STATUS_ADDRESS_NACK);
+	return;
+}
+
+//Submit the next one from the callback
+static SoftI2CTransaction Chain;
+static uint8_t ChainLeft;
+
+static void ChainDone(SoftI2CTransaction *Transaction)
+{
+	Done(Transaction);
+	if(ChainLeft > 0)
+	{
+		ChainLeft--;
+		SoftI2C_Submit(Transaction);
+	}
+	return;
+}
+
+static void TestChain(void)
+{
+	Reset();
+
+	Setup(&Chain, SHT25_ADDRESS, NULL, 0, NULL, 0);
+	Chain.Callback = ChainDone;
+	ChainLeft = 2;
+	CHECK_EQ(SoftI2C_Submit(&Chain), 0);
+	Device_RunMS(5);
+	CHECK_EQ(FinishedCount, 3);
+	CHECK_EQ(Chain.Status, SOFTI2C_STATUS_OK);
+	CHECK_EQ(SoftI2CModel_Stats()->Starts, 3);
+	CHECK(BusIdle());
+	return;
+}
+
+static void TestErrors(void)
+{
+	const SoftI2CModelStats *Bus = SoftI2CModel_Stats();
+	uint8_t Value;
+
+	Reset();
+
+	//A short stretch is waited for. The high time after it is a full tick, which makes up for the one the stretch started in.
+	SoftI2CModel_Stretch(10);
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, NULL, 0, NULL, 0), SOFTI2C_STATUS_OK);
+	CHECK_EQ(Bus->StretchTicks, 10);
+	CHECK_EQ(Bus->Ticks, TICKS(0) + 10);
+
+	//A device that holds SCL too long ends the transaction, and the lines are let go
+	SoftI2CModel_Stretch(I2C_SOFT_CLOCK_STRETCH_TIMEOUT + 10);
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, NULL, 0, &Value, 1), SOFTI2C_STATUS_TIMEOUT);
+	CHECK_EQ(DDRB & (1<<7), 0);
+	CHECK_EQ(DDRC & (1<<6), 0);
+
+	//The next one waits for the bus to come back
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, NULL, 0, NULL, 0), SOFTI2C_STATUS_OK);
+
+	//Lost arbitration, SDA is low at the start
+	SoftI2CModel_HoldSda(1);
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, NULL, 0, NULL, 0), SOFTI2C_STATUS_ARBITRATION);
+	SoftI2CModel_HoldSda(0);
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, NULL, 0, NULL, 0), SOFTI2C_STATUS_OK);
+
+	//A busy device does not ack
+	SHT25Model_SetPresent(0);
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, NULL, 0, NULL, 0), SOFTI2C_STATUS_ADDRESS_NACK);
+	SHT25Model_SetPresent(1);
+	Device_RunMS(1);
+	CHECK(BusIdle());
+	CHECK_EQ(Bus->DrivenHigh, 0);
+	return;
+}
+
+static void TestSpeed(void)
+{
+	const SoftI2CModelStats *Bus = SoftI2CModel_Stats();
+	SoftI2CTransaction Transaction;
+
+	Reset();
+
+	CHECK_EQ(SoftI2C_SetHalfBit(SOFTI2C_MIN_HALF_BIT_US - 1), 1);
+	CHECK_EQ(SoftI2C_GetHalfBit(), SOFTI2C_HALF_BIT_US);
+	CHECK_EQ(SoftI2C_SetHalfBit(50), 0);
+	CHECK_EQ(SoftI2C_GetHalfBit(), 50);
+	CHECK_EQ(OCR1A, 50 * 8 - 1);
+
+	//Half the ticks a millisecond
+	Setup(&Transaction, SHT25_ADDRESS, NULL, 0, NULL, 0);
+	SoftI2C_Submit(&Transaction);
+	Device_RunMS(1);
+	CHECK_EQ(Bus->Ticks, 20);
+	CHECK_EQ(Transaction.Status, SOFTI2C_STATUS_PENDING);
+	Device_RunMS(1);
+	CHECK_EQ(Bus->Ticks, TICKS(0));
+	CHECK_EQ(Transaction.Status, SOFTI2C_STATUS_OK);
+	SoftI2C_SetHalfBit(SOFTI2C_HALF_BIT_US);
+	return;
+}
+
+//The LCD has port B between SPI_LcdBegin() and SPI_LcdEnd(), so no ticks
+static void TestHold(void)
+{
+	const SoftI2CModelStats *Bus = SoftI2CModel_Stats();
+	SoftI2CTransaction Transaction;
+	uint32_t Ticks;
+
+	Reset();
+
+	Setup(&Transaction, SHT25_ADDRESS, NULL, 0, NULL, 0);
+	Ticks = Bus->Ticks;
+	CHECK_EQ(SoftI2C_Submit(&Transaction), 0);
+
+	//Only the bus model runs, the main loop would give port B back
+	SPI_LcdBegin();
+	CHECK_EQ(TIMSK1 & (1<<OCIE1A), 0);
+	SoftI2CModel_Tick();
+	SoftI2CModel_Tick();
+	CHECK_EQ(Bus->Ticks, Ticks);
+	CHECK_EQ(Transaction.Status, SOFTI2C_STATUS_PENDING);
+
+	//A blocking transfer runs the engine itself and leaves the interrupt masked
+	CHECK_EQ(SoftI2C_Transfer(SHT25_ADDRESS, NULL, 0, NULL, 0), SOFTI2C_STATUS_OK);
+	CHECK_EQ(Transaction.Status, SOFTI2C_STATUS_OK);
+	CHECK_EQ(TIMSK1 & (1<<OCIE1A), 0);
+
+	//The queue carries on once port B is given back
+	CHECK_EQ(SoftI2C_Submit(&Transaction), 0);
+	SoftI2CModel_Tick();
+	CHECK_EQ(Transaction.Status, SOFTI2C_STATUS_PENDING);
+	SPI_LcdEnd();
+	CHECK(TIMSK1 & (1<<OCIE1A));
+	Device_RunMS(2);
+	CHECK_EQ(Transaction.Status, SOFTI2C_STATUS_OK);
+	CHECK(BusIdle());
+	return;
+}
+
+int main(void)
+{
+	TestBlocking();
+	TestQueue();
+	TestChain();
+	TestErrors();
+	TestSpeed();
+	TestHold();
+
+	return TEST_DONE();
+}
+
+/** @} */
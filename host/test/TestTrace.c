@@ -0,0 +1,103 @@
+/*   This program is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+*	\brief		Tests for the event trace.
+*	\author		Pat Satyshur
+*	\version	1.0
+*	\date		2/3/2013
+*	\copyright	Copyright 2013, Pat Satyshur
+*	\ingroup 	host
+*
+*	@{
+*/
+
+#include "Device.h"
+#include "Test.h"
+#include "LCD_Menu.h"
+
+int main(void)
+{
+	TraceRecord Record;
+	uint16_t Start;
+	uint8_t i;
+
+	//No sensor readings, so the scheduler adds no task events
+	Device_PowerOn(16, 2);
+	MPL115A1_SetPeriod(0);
+	SHT25_SetPeriod(0);
+	Trace_Clear();
+	CHECK_EQ(Trace_Read(0, &Record), 1);
+
+	//Records keep the time of the 1ms tick
+	Start = TraceTime;
+	Trace_Event(TRACE_EVENT_MARK, 0x12, 0x34);
+	Device_RunMS(7);
+	Trace_Event(TRACE_EVENT_MARK, 0x56, 0x78);
+	CHECK_EQ(Trace_Read(0, &Record), 0);
+	CHECK_EQ(Record.Event, TRACE_EVENT_MARK);
+	CHECK_EQ(Record.Time, Start);
+	CHECK_EQ(Record.Data[0], 0x12);
+	CHECK_EQ(Record.Data[1], 0x34);
+	CHECK_EQ(Trace_Read(1, &Record), 0);
+	CHECK_EQ(Record.Time, (uint16_t)(Start + 7));
+	CHECK_EQ(Record.Data[0], 0x56);
+	CHECK_EQ(Trace_Read(2, &Record), 1);
+
+	//A full ring drops the oldest records
+	Trace_Clear();
+	for(i = 0; i < (TRACE_SIZE + 5); i++)
+	{
+		Trace_Event(TRACE_EVENT_MARK, i, 0);
+	}
+	CHECK_EQ(Trace_Read(0, &Record), 0);
+	CHECK_EQ(Record.Data[0], 5);
+	CHECK_EQ(Trace_Read(TRACE_SIZE - 1, &Record), 0);
+	CHECK_EQ(Record.Data[0], TRACE_SIZE + 4);
+	CHECK_EQ(Trace_Read(TRACE_SIZE, &Record), 1);
+
+	//Nothing is recorded while disabled
+	Trace_Clear();
+	Trace_Enable(0);
+	Trace_Event(TRACE_EVENT_MARK, 1, 0);
+	Trace_Enable(1);
+	CHECK_EQ(Trace_Read(0, &Record), 1);
+
+	//Button interrupts are traced with the menu state
+	INT0_vect();
+	CHECK_EQ(Trace_Read(0, &Record), 0);
+	CHECK_EQ(Record.Event, TRACE_EVENT_BUTTON);
+	CHECK_EQ(Record.Data[0], LCD_MENU_BUTTON_LEFT);
+	CHECK_EQ(Record.Data[1], LCD_MENU_STATUS_IDLE);
+
+	//Dump format
+	Trace_Clear();
+	TraceTime = 0x0102;
+	Trace_Event(TRACE_EVENT_TASK, 3, 0xAB);
+	HAL_ConsoleClear();
+	CHECK_EQ(HAL_RunCommandLine("trace"), 0);
+	CHECK(strcmp(HAL_ConsoleOutput(), "TRACE 1\n04010203AB\nEND\n") == 0);
+
+	//Markers from the command
+	CHECK_EQ(HAL_RunCommandLine("trace 2 9"), 0);
+	CHECK_EQ(Trace_Read(1, &Record), 0);
+	CHECK_EQ(Record.Event, TRACE_EVENT_MARK);
+	CHECK_EQ(Record.Data[0], 9);
+	CHECK_EQ(HAL_RunCommandLine("trace 1"), 0);
+	CHECK_EQ(Trace_Read(0, &Record), 1);
+
+	return TEST_DONE();
+}
+
+/** @} */
@@ -56,6 +56,7 @@
 /** 
  *  @name  Definitions for Display Size 
  *  Change these definitions to adapt setting to your display
+ *  These are the defaults, the size used at runtime is set in Board/LCDGeometry.h
  */
 #define LCD_LINES           2     /**< number of visible lines of the display */
 #define LCD_DISP_LENGTH    16     /**< visibles characters per line of the display */
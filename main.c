@@ -71,9 +71,6 @@ USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface =
  */
 static FILE USBSerialStream;
 
-int LCD_PutChar(char c, FILE *inFile);
-FILE LCDStream;
-
 //If this is set to 1, the device takes date in the main loop.
 uint8_t DataRecoderActive;
 
@@ -91,17 +88,20 @@ int main(void)
 	CDC_Device_CreateStream(&VirtualSerial_CDC_Interface, &USBSerialStream);
 	stdout = &USBSerialStream;
 	
-	fdev_setup_stream(&LCDStream, LCD_PutChar, NULL, _FDEV_SETUP_WRITE);
-	
-	fprintf(&LCDStream, "Initalized\n");
-	//fprintf(&LCDStream, "blarg");
+	SPI_LcdBegin();
+	lcd_puts_P("Initalized\n");
+	SPI_LcdEnd();
 
 	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
 
 	for (;;)
 	{
+		//The code that writes the LCD takes port B for itself, queued SPI and I2C transfers run the rest of the time
+		LineEdit_Run();
 		RunCommand();
 		HandleButtonPress();
+		Scheduler_Run();
+		Recorder_Run();
 	}
 }
 
@@ -133,9 +133,30 @@ void EVENT_USB_Device_ControlRequest(void)
 	CDC_Device_ProcessControlRequest(&VirtualSerial_CDC_Interface);
 }
 
-//Wrapper function for use with FDEV_SETUP_STREAM
-int LCD_PutChar(char c, FILE *inFile)
+//Sink for the Format_ functions, sends the character directly to the CDC interface
+void Console_PutChar(char c)
+{
+	CDC_Device_SendByte(&VirtualSerial_CDC_Interface, c);
+}
+
+//Drops the characters, stdout is pointed here while the echo is off
+static int Console_Discard(char c, FILE *Stream)
 {
-	lcd_putc(c);
 	return 0;
-}
\ No newline at end of file
+}
+
+static FILE ConsoleDiscardStream = FDEV_SETUP_STREAM(Console_Discard, NULL, _FDEV_SETUP_WRITE);
+
+//Turn the command interpreter's echo on or off. It echoes through stdout, and the
+//line editor has already sent the line it passes on.
+void Console_Echo(uint8_t Enable)
+{
+	stdout = (Enable != 0) ? &USBSerialStream : &ConsoleDiscardStream;
+}
+
+//Send a block of binary data, filling whole packets. Returns 0 if it was sent,
+//or an error if the host stopped reading or went away.
+uint8_t Console_Write(const void *Data, uint16_t Length)
+{
+	return CDC_Device_SendData(&VirtualSerial_CDC_Interface, Data, Length);
+}
@@ -44,6 +44,7 @@
 		#include <avr/eeprom.h>
 		#include <string.h>
 		#include <stdio.h>
+		#include <stdlib.h>
 
 		#include "Descriptors.h"
 
@@ -62,6 +63,31 @@
 		
 		//Board includes
 		#include "Board/Hardware.h"
+		#include "Board/Format.h"
+		#include "Board/Glyph.h"
+		#include "Board/BigClock.h"
+		#include "Board/Scheduler.h"
+		#include "Board/Marquee.h"
+		#include "Board/LCDGeometry.h"
+		#include "Board/Settings.h"
+		#include "Board/Backlight.h"
+		#include "Board/ISRStats.h"
+		#include "Board/Trace.h"
+		#include "Board/Log.h"
+		#include "Board/LineEdit.h"
+		#include "Board/CmdTrie.h"
+		#include "Board/Recorder.h"
+		#include "Board/SampleCodec.h"
+		#include "Board/SPI.h"
+		#include "Board/Dataflash.h"
+		#include "Board/LogStore.h"
+		#include "Board/LogDump.h"
+		#include "Board/MPL115A1.h"
+		#include "Board/SoftI2C.h"
+		#include "Board/SHT25.h"
+		#include "Board/I2CScan.h"
+		#include "Board/Filter.h"
+		#include "Board/Rolling.h"
 		
 	/* Macros: */
 		/** LED mask for the library LED driver, to indicate that the USB interface is not ready. */
@@ -78,8 +104,6 @@
 
 		extern USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface;
 		extern uint8_t DataRecoderActive;
-		
-		extern FILE LCDStream;
 
 	/* Function Prototypes: */
 		//void SetupHardware(void);
@@ -90,5 +114,9 @@
 		void EVENT_USB_Device_ConfigurationChanged(void);
 		void EVENT_USB_Device_ControlRequest(void);
 
+		void Console_PutChar(char c);
+		uint8_t Console_Write(const void *Data, uint16_t Length);
+		void Console_Echo(uint8_t Enable);
+
 #endif
 
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+#
+#   Generate the command name prefix trie used by Board/CmdTrie.c.
+#
+#   The command names are read from the _Fn_NAME strings in Board/commands.c,
+#   in the order of AppCommandList, so a trie entry's command number is its
+#   index in the list. Extra names (the interpreter's built in commands) are
+#   added with the number CMDTRIE_BUILTIN.
+#
+#   gen_cmdtrie.py [--extra help] Board/commands.c CmdTrieData.h
+#
+#   Each node is laid out as:
+#     label length, label characters,
+#     flags (bit 7: a command ends here, bits 0-6: number of children),
+#     number of commands below this node (including this one),
+#     command number (only if a command ends here),
+#     child offsets (2 bytes each, low byte first, sorted by first character)
+#   The root node is first and has an empty label. Edges are compressed, so
+#   every node except the root either ends a command or has 2 or more children.
+#
+
+import argparse
+import re
+import sys
+
+BUILTIN = 0xFF
+
+
+def read_commands(source):
+    """Returns the command names in AppCommandList order."""
+    with open(source) as f:
+        text = f.read()
+    names = dict(re.findall(r'const\s+char\s+(_F\d+)_NAME\[\]\s+PROGMEM\s*=\s*"([^"]*)"', text))
+    table = re.search(r"AppCommandList\[\]\s+PROGMEM\s*=\s*\{(.*?)\};", text, re.S)
+    if table is None:
+        sys.exit("%s: AppCommandList not found" % source)
+    order = re.findall(r"\{\s*(_F\d+)_NAME\s*,", table.group(1))
+    count = re.search(r"NumCommands\s*=\s*(\d+)", text)
+    if count is not None and int(count.group(1)) != len(order):
+        sys.exit("%s: NumCommands is %s but AppCommandList has %u entries" % (source, count.group(1), len(order)))
+    return [names[f] for f in order]
+
+
+class Node:
+    def __init__(self, label):
+        self.label = label
+        self.children = []
+        self.command = None
+
+    def count(self):
+        return (self.command is not None) + sum(c.count() for c in self.children)
+
+
+def insert(node, name, command):
+    for child in node.children:
+        common = 0
+        while common < min(len(child.label), len(name)) and child.label[common] == name[common]:
+            common += 1
+        if common == 0:
+            continue
+        if common < len(child.label):
+            # Split the edge
+            lower = Node(child.label[common:])
+            lower.children, lower.command = child.children, child.command
+            child.label, child.children, child.command = child.label[:common], [lower], None
+        if common == len(name):
+            if child.command is not None:
+                sys.exit("Duplicate command name '%s'" % name)
+            child.command = command
+        else:
+            insert(child, name[common:], command)
+        return
+    leaf = Node(name)
+    leaf.command = command
+    node.children.append(leaf)
+
+
+def layout(root):
+    """Returns the trie as a list of bytes."""
+    nodes = []
+
+    def visit(node):
+        node.children.sort(key=lambda c: c.label)
+        nodes.append(node)
+        for child in node.children:
+            visit(child)
+
+    visit(root)
+    offset = 0
+    for node in nodes:
+        node.offset = offset
+        offset += 1 + len(node.label) + 2 + (node.command is not None) + 2 * len(node.children)
+    if offset > 0xFFFF:
+        sys.exit("Command trie is too large")
+
+    data = []
+    for node in nodes:
+        data.append(len(node.label))
+        data.extend(ord(c) for c in node.label)
+        data.append((0x80 if node.command is not None else 0) | len(node.children))
+        data.append(node.count())
+        if node.command is not None:
+            data.append(node.command)
+        for child in node.children:
+            data.extend((child.offset & 0xFF, child.offset >> 8))
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the command name prefix trie.")
+    parser.add_argument("--extra", action="append", default=[], help="built in command name to add")
+    parser.add_argument("source", help="Board/commands.c")
+    parser.add_argument("output", help="header to write")
+    args = parser.parse_args()
+
+    names = read_commands(args.source)
+    root = Node("")
+    for i, name in enumerate(names):
+        insert(root, name, i)
+    for name in args.extra:
+        insert(root, name, BUILTIN)
+    data = layout(root)
+
+    with open(args.output, "w") as f:
+        f.write("//Generated by tools/gen_cmdtrie.py from %s, do not edit\n\n" % args.source)
+        f.write("#define CMDTRIE_COMMANDS\t\t%u\n" % len(names))
+        f.write("#define CMDTRIE_LONGEST\t\t\t%u\n\n" % max(len(n) for n in names + args.extra))
+        f.write("static const uint8_t CmdTrie[%u] PROGMEM =\n{\n" % len(data))
+        for i in range(0, len(data), 12):
+            f.write("\t" + ", ".join("0x%02X" % b for b in data[i:i + 12]) + ",\n")
+        f.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
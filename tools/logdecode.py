@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+#
+#   Decode the binary log messages sent by the LOG_ macros, see Board/Log.h.
+#
+#   The format strings are read from the 'logfmt' section of the ELF file.
+#   The console stream is read from a capture file, a serial port device, or
+#   stdin. Ordinary console text is passed through and each log frame is
+#   replaced by the formatted message.
+#
+#   logdecode.py main.elf [capture or /dev/ttyACM0]
+#
+
+import re
+import struct
+import sys
+
+FRAME_START = 0x1E
+SIZES = {0: 1, 1: 2, 2: 4}
+LEVELS = {"E": "ERROR", "W": "WARN", "I": "INFO", "D": "DEBUG"}
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l)?([diuxXoc%])")
+
+
+def read_formats(elf_file):
+    """Returns {id: format} from the logfmt section. IDs are offsets into the section."""
+    with open(elf_file, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        raise ValueError("%s is not an ELF file" % elf_file)
+    is64 = elf[4] == 2
+    endian = "<" if elf[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(endian + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x3A)
+        header = endian + "IIQQQQ"
+    else:
+        shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2E)
+        header = endian + "IIIIII"
+
+    sections = [struct.unpack_from(header, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx]
+    for name, _type, _flags, _addr, offset, size in sections:
+        start = names[4] + name
+        if elf[start:elf.index(b"\0", start)] == b"logfmt":
+            data = elf[offset:offset + size]
+            break
+    else:
+        raise ValueError("%s has no logfmt section" % elf_file)
+
+    formats = {}
+    position = 0
+    while position < len(data):
+        end = data.index(b"\0", position)
+        if end > position:
+            formats[position] = data[position:end].decode("latin-1")
+        position = end + 1
+    return formats
+
+
+def format_message(fmt, args):
+    """printf style formatting with integer arguments of known width."""
+    values = iter(args)
+
+    def convert(m):
+        flags, _length, conv = m.groups()
+        if conv == "%":
+            return "%"
+        value, width = next(values, (0, 1))
+        if conv in "di" and value >= (1 << (8 * width - 1)):
+            value -= 1 << (8 * width)
+        if conv == "c":
+            return chr(value & 0xFF)
+        return ("%" + flags + conv.replace("u", "d")) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(formats, stream, out):
+    def read(n):
+        data = stream.read(n)
+        if len(data) < n:
+            raise EOFError
+        return data
+
+    try:
+        while True:
+            c = read(1)
+            if c[0] != FRAME_START:
+                out.write(c.decode("latin-1"))
+                continue
+            frame_id, sizes = struct.unpack("<HB", read(3))
+            args = []
+            for i in range(4):
+                code = (sizes >> (2 * i)) & 3
+                if code == 3:
+                    break
+                width = SIZES[code]
+                args.append((int.from_bytes(read(width), "little"), width))
+            fmt = formats.get(frame_id)
+            if fmt is None:
+                out.write("[?] unknown log ID 0x%04X %s\n" % (frame_id, [a for a, _w in args]))
+            else:
+                out.write("[%s] %s\n" % (LEVELS.get(fmt[0], fmt[0]), format_message(fmt[1:], args)))
+            out.flush()
+    except EOFError:
+        pass
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.stderr.write("Usage: %s <main.elf> [capture]\n" % sys.argv[0])
+        return 2
+    formats = read_formats(sys.argv[1])
+    stream = open(sys.argv[2], "rb", buffering=0) if len(sys.argv) == 3 else sys.stdin.buffer
+    decode(formats, stream, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
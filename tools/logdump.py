@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+#
+#   Download the dataflash with the logdump command, see Board/LogDump.h.
+#
+#   Pages come back as binary frames with a CRC. Pages that are damaged or
+#   missing are asked for again, starting at the first one that is missing.
+#   The image is written with each page at page * 264 bytes, and the transfer
+#   rate is reported. A saved console stream can be given instead of the port.
+#
+#   logdump.py /dev/ttyACM0 image.bin [first page] [pages]
+#   logdump.py --records image.bin
+#
+#   --records prints the data recorder samples in an image as CSV, oldest
+#   first, like the logread command.
+#
+
+import binascii
+import os
+import select
+import stat
+import struct
+import sys
+import termios
+import time
+import tty
+
+FRAME_START = 0x1D
+END_PAGE = 0xFFFF
+PAGE_SIZE = 264
+PAGES = 2048
+TIMEOUT = 1.0
+RETRIES = 5
+
+# Log page header, see Board/LogStore.h
+LOG_HEADER = struct.Struct("<2sIIBBH")
+
+# Recorder samples, see Board/SampleCodec.h
+KEYFRAME = 0x80
+CHANNELS = 3
+
+
+class Source:
+    """Reads from a serial port with a timeout, or from a capture file."""
+
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY if self.is_port(path) else os.O_RDONLY)
+        self.port = self.is_port(path)
+        self.received = 0
+        if self.port:
+            tty.setraw(self.fd)
+            termios.tcflush(self.fd, termios.TCIOFLUSH)
+        self.pending = b""
+
+    @staticmethod
+    def is_port(path):
+        return stat.S_ISCHR(os.stat(path).st_mode)
+
+    def read(self, n):
+        while len(self.pending) < n:
+            if self.port and not select.select([self.fd], [], [], TIMEOUT)[0]:
+                raise EOFError
+            data = os.read(self.fd, 65536)
+            if not data:
+                raise EOFError
+            self.received += len(data)
+            self.pending += data
+        data, self.pending = self.pending[:n], self.pending[n:]
+        return data
+
+    def command(self, line):
+        if self.port:
+            self.pending = b""
+            os.write(self.fd, line.encode("ascii") + b"\r")
+
+
+def frames(source):
+    """Yields (page, data) for each good frame and (None, None) for a damaged one, until the end frame."""
+    try:
+        while True:
+            if source.read(1)[0] != FRAME_START:
+                continue            # Console text, like the echo of the command
+            header = source.read(4)
+            page, length = struct.unpack("<HH", header)
+            if length > PAGE_SIZE:
+                yield None, None
+                continue
+            data = source.read(length)
+            crc, = struct.unpack("<H", source.read(2))
+            if binascii.crc_hqx(header + data, 0) != crc:
+                yield None, None
+            elif page == END_PAGE:
+                return
+            else:
+                yield page, data
+    except EOFError:
+        return
+
+
+def download(source, first, count):
+    pages = {}
+    start = time.monotonic()
+    damaged = 0
+    retries = 0
+    want = first
+
+    while want < first + count:
+        source.command("logdump %d %d %d" % (want, first + count - want, 1 if retries else 0))
+        for page, data in frames(source):
+            if page is None:
+                damaged += 1
+            elif first <= page < first + count:
+                pages[page] = data
+        missing = [p for p in range(want, first + count) if p not in pages]
+        if not missing:
+            break
+        if not source.port or retries == RETRIES:
+            sys.stderr.write("%d pages missing, first %d\n" % (len(missing), missing[0]))
+            break
+        retries += 1
+        want = missing[0]
+
+    seconds = time.monotonic() - start
+    sys.stderr.write("%d pages, %d bytes in %.2f s, %.3f MB/s, %d damaged frames, %d retries\n" % (
+        len(pages), source.received, seconds, source.received / seconds / 1e6 if seconds else 0, damaged, retries))
+    return pages
+
+
+def crc_ccitt(data):
+    """The avr-libc _crc_ccitt_update() started at 0xFFFF."""
+    crc = 0xFFFF
+    for byte in data:
+        byte ^= crc & 0xFF
+        byte = (byte ^ (byte << 4)) & 0xFF
+        crc = ((byte << 8) | (crc >> 8)) ^ (byte >> 4) ^ (byte << 3)
+    return crc & 0xFFFF
+
+
+def varints(data):
+    """Splits the bytes after the flags into varints. Raises ValueError if one is cut off or too long."""
+    value = shift = 0
+    for byte in data:
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            yield value
+            value = shift = 0
+        elif shift == 35:
+            raise ValueError        # Longer than 32 bits
+    if shift:
+        raise ValueError
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def decode_sample(record, last):
+    """Returns (seconds, ms, channels, values), or None if the sample is not valid or a delta has no reference."""
+    flags = record[0]
+    channels = flags & 0x07
+    if flags & ~(KEYFRAME | 0x07) or not (flags & KEYFRAME or (last and last[2] == channels)):
+        return None
+    try:
+        fields = list(varints(record[1:]))
+    except ValueError:
+        return None
+    used = [i for i in range(CHANNELS) if channels & (1 << i)]
+    if len(fields) != (2 if flags & KEYFRAME else 1) + len(used):
+        return None
+    values = [0] * CHANNELS
+    if flags & KEYFRAME:
+        seconds, ms = fields[:2]
+        if ms > 999:
+            return None
+        changes = fields[2:]
+    else:
+        ms = last[1] + fields[0]
+        seconds, ms = last[0] + ms // 1000, ms % 1000
+        changes = fields[1:]
+    for i, change in zip(used, changes):
+        if change > 0xFFFF:
+            return None
+        value = unzigzag(change) + (0 if flags & KEYFRAME else last[3][i])
+        values[i] = (value + 0x8000) % 0x10000 - 0x8000
+    return seconds & 0xFFFFFFFF, ms, channels, values
+
+
+def print_records(image):
+    pages = []
+    for offset in range(0, len(image) - PAGE_SIZE + 1, PAGE_SIZE):
+        page = image[offset:offset + PAGE_SIZE]
+        magic, sequence, _key, _count, used, crc = LOG_HEADER.unpack_from(page)
+        if magic != b"LG" or used > PAGE_SIZE - LOG_HEADER.size:
+            continue
+        data = page[LOG_HEADER.size:LOG_HEADER.size + used]
+        if crc_ccitt(data + page[:LOG_HEADER.size - 2]) == crc:
+            pages.append((sequence, data))
+
+    print("seconds,pressure,temperature,humidity")
+    for _sequence, data in sorted(pages):
+        position = 0
+        last = None                 # Each page starts with a keyframe
+        while position < len(data):
+            length = data[position]
+            record = data[position + 1:position + 1 + length]
+            position += 1 + length
+            sample = decode_sample(record, last) if len(record) == length > 0 else None
+            if sample is None:
+                continue
+            last = sample
+            seconds, ms, channels, values = sample
+            fields = [str(v) if channels & (1 << i) else "" for i, v in enumerate(values)]
+            print("%d.%03d,%s" % (seconds, ms, ",".join(fields)))
+
+
+def main():
+    args = sys.argv[1:]
+    if len(args) == 2 and args[0] == "--records":
+        with open(args[1], "rb") as f:
+            print_records(f.read())
+        return 0
+    if len(args) not in (2, 3, 4):
+        sys.stderr.write("Usage: %s <port or capture> <image> [first page] [pages]\n"
+                         "       %s --records <image>\n" % (sys.argv[0], sys.argv[0]))
+        return 2
+
+    first = int(args[2]) if len(args) > 2 else 0
+    count = int(args[3]) if len(args) > 3 else PAGES - first
+    pages = download(Source(args[0]), first, count)
+
+    image = bytearray(b"\xFF" * (PAGES * PAGE_SIZE))
+    for page, data in pages.items():
+        image[page * PAGE_SIZE:(page + 1) * PAGE_SIZE] = data
+    with open(args[1], "wb") as f:
+        f.write(image)
+    return 0 if len(pages) == count else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
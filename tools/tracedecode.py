@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+#
+#   Decode the output of the 'trace' command into a timeline.
+#
+#   Save a console session that includes a 'trace' dump and pass it to this
+#   script, or pipe it in. Every TRACE ... END block is decoded. Event names
+#   and data descriptions come from the TRACE_EVENT_ lines in Board/Trace.h.
+#
+#   tracedecode.py [--header Board/Trace.h] [capture]
+#
+
+import argparse
+import os
+import re
+import sys
+
+BUTTONS = {0: "none", 1: "up", 2: "down", 3: "left", 4: "right", 5: "center"}
+
+
+def read_events(header):
+    """Returns {number: (name, [data descriptions])} from the TRACE_EVENT_ defines."""
+    events = {}
+    pattern = re.compile(r"#define\s+TRACE_EVENT_(\w+)\s+(\d+)\s*//(.*)")
+    with open(header) as f:
+        for line in f:
+            m = pattern.match(line.strip())
+            if m:
+                name, number, comment = m.group(1), int(m.group(2)), m.group(3)
+                data = comment.split(":", 1)[1] if ":" in comment else ""
+                events[number] = (name, [d.strip() for d in data.split(",")])
+    return events
+
+
+def read_blocks(lines):
+    """Yields the list of records in each TRACE ... END block."""
+    records = None
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TRACE "):
+            records = []
+        elif line == "END" and records is not None:
+            yield records
+            records = None
+        elif records is not None and re.fullmatch(r"[0-9A-Fa-f]{10}", line):
+            raw = bytes.fromhex(line)
+            records.append((raw[0], (raw[1] << 8) | raw[2], raw[3], raw[4]))
+
+
+def describe(events, event, data0, data1):
+    name, fields = events.get(event, ("EVENT_%u" % event, []))
+    if name == "BUTTON":
+        return "%-12s %s, menu state %u" % (name, BUTTONS.get(data0, data0), data1)
+    values = []
+    for i, value in enumerate((data0, data1)):
+        if i < len(fields) and fields[i] and fields[i] != "0":
+            values.append("%s %u (0x%02X)" % (fields[i], value, value))
+    return "%-12s %s" % (name, ", ".join(values))
+
+
+def main():
+    default_header = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Board", "Trace.h")
+    parser = argparse.ArgumentParser(description="Decode a 'trace' command dump.")
+    parser.add_argument("--header", default=default_header, help="Trace.h with the event numbers")
+    parser.add_argument("capture", nargs="?", help="console capture, stdin if not given")
+    args = parser.parse_args()
+
+    events = read_events(args.header)
+    source = open(args.capture) if args.capture else sys.stdin
+
+    for n, records in enumerate(read_blocks(source)):
+        print("Trace %u, %u records" % (n + 1, len(records)))
+        # Timestamps are 16 bit ms, add 65536 each time they go backwards
+        offset = 0
+        last = None
+        start = None
+        for event, time, data0, data1 in records:
+            if last is not None and time < last:
+                offset += 65536
+            last = time
+            time += offset
+            if start is None:
+                start = time
+                previous = time
+            print("%9.3fs %+7ums  %s" % ((time - start) / 1000.0, time - previous, describe(events, event, data0, data1)))
+            previous = time
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())